@@ -5,10 +5,12 @@
 #include <iomanip>
 #include <chrono>
 #include <span>
+#include <sstream>
 #include "zstd.h"
 #include "cli_app.hpp"
 #include "biomxt/biomxt_file.hpp"
 #include "biomxt/biomxt_converter.hpp"
+#include "biomxt/cache/shared_block_cache.hpp"
 
 
 namespace fs = std::filesystem;
@@ -20,17 +22,28 @@ uint64_t get_timestamp() {
 
 
 // 核心转换逻辑封装
-bool convert_csv_bmxt(std::string input, std::string output, uint32_t block_width, uint32_t block_height, char sep, const biomxt::DataType dtype, biomxt::CompressAlgorithm algo)
+bool convert_csv_bmxt(std::string input, std::string output, const biomxt::ConvertOptions& options, const biomxt::DataType dtype)
 {
     // Print params
     std::cout << "---- Conversion Parameters ----" << std::endl;
     std::cout << "Input: " << input << std::endl;
+    std::cout << "Input compression: " << biomxt::text_compression_to_string(biomxt::detect_text_compression(input)) << std::endl;
     std::cout << "Output: " << output << std::endl;
-    std::cout << "Block width: " << block_width << std::endl;
-    std::cout << "Block height: " << block_height << std::endl;
-    std::cout << "Separator: " << sep << std::endl;
+    std::cout << "Block width: " << options.block_width << std::endl;
+    std::cout << "Block height: " << options.block_height << std::endl;
+    std::cout << "Separator: " << options.separator << std::endl;
     std::cout << "Data type: " << biomxt::dtype_to_string(dtype) << std::endl;
-    std::cout << "Compression algo: " << biomxt::algo_to_string(algo) << std::endl;
+    std::cout << "Compression algo: " << biomxt::algo_to_string(options.algo) << std::endl;
+    std::cout << "Block filter: " << biomxt::filter_to_string(options.filter) << std::endl;
+    if (options.dictionary_size > 0) std::cout << "Dictionary: " << (options.dictionary_size >> 10) << " KB" << std::endl;
+    if (options.sparse_threshold > 0) std::cout << "Sparse threshold: " << options.sparse_threshold << std::endl;
+    if (options.integer_codec != biomxt::IntegerCodec::NONE) std::cout << "Integer codec: " << biomxt::integer_codec_to_string(options.integer_codec) << std::endl;
+    if (options.policy.adaptive) std::cout << "Adaptive codec: min decode " << options.policy.min_decode_speed << " MB/s" << std::endl;
+    if (options.frame_height > 0) std::cout << "Frame height: " << options.frame_height << std::endl;
+    if (options.column_major) std::cout << "Block layout: column-major" << std::endl;
+    std::cout << "Threads: " << (options.threads == 0 ? std::thread::hardware_concurrency() : options.threads) << std::endl;
+    if (options.checkpoint_interval > 0) std::cout << "Checkpoint interval: " << (options.checkpoint_interval >> 20) << " MB" << std::endl;
+    if (options.resume) std::cout << "Resume: " << biomxt::checkpoint_path(output) << std::endl;
     std::cout << "-------------------------------" << std::endl;
     std::cout << "Converting..." << std::endl;
 
@@ -39,19 +52,31 @@ bool convert_csv_bmxt(std::string input, std::string output, uint32_t block_widt
     biomxt::FileHeader header;
     switch (dtype) {
         case biomxt::DataType::INT16:
-            header = biomxt::csv_to_bmxt<int16_t>(input, output, block_width, block_height, sep, algo, warnings);
+            header = biomxt::csv_to_bmxt<int16_t>(input, output, options, warnings);
             break;
         case biomxt::DataType::INT32:
-            header = biomxt::csv_to_bmxt<int32_t>(input, output, block_width, block_height, sep, algo, warnings);
+            header = biomxt::csv_to_bmxt<int32_t>(input, output, options, warnings);
             break;
         case biomxt::DataType::INT64:
-            header = biomxt::csv_to_bmxt<int64_t>(input, output, block_width, block_height, sep, algo, warnings);
+            header = biomxt::csv_to_bmxt<int64_t>(input, output, options, warnings);
             break;
         case biomxt::DataType::FLOAT32:
-            header = biomxt::csv_to_bmxt<float>(input, output, block_width, block_height, sep, algo, warnings);
+            header = biomxt::csv_to_bmxt<float>(input, output, options, warnings);
             break;
         case biomxt::DataType::FLOAT64:
-            header = biomxt::csv_to_bmxt<double>(input, output, block_width, block_height, sep, algo, warnings);
+            header = biomxt::csv_to_bmxt<double>(input, output, options, warnings);
+            break;
+        case biomxt::DataType::UINT8:
+            header = biomxt::csv_to_bmxt<uint8_t>(input, output, options, warnings);
+            break;
+        case biomxt::DataType::UINT16:
+            header = biomxt::csv_to_bmxt<uint16_t>(input, output, options, warnings);
+            break;
+        case biomxt::DataType::FLOAT16:
+            header = biomxt::csv_to_bmxt<biomxt::float16>(input, output, options, warnings);
+            break;
+        case biomxt::DataType::BFLOAT16:
+            header = biomxt::csv_to_bmxt<biomxt::bfloat16>(input, output, options, warnings);
             break;
         default:
             throw std::runtime_error("biomxt::csv_to_bmxt: Invalid data type.");
@@ -69,17 +94,239 @@ bool convert_csv_bmxt(std::string input, std::string output, uint32_t block_widt
     return true;
 }
 
+bool convert_mtx_bmxt(std::string input, std::string features, std::string barcodes, std::string output, const biomxt::ConvertOptions& options, const biomxt::DataType dtype)
+{
+    // Print params
+    std::cout << "---- Conversion Parameters ----" << std::endl;
+    std::cout << "Input: " << input << std::endl;
+    std::cout << "Features: " << (features.empty() ? "(index)" : features) << std::endl;
+    std::cout << "Barcodes: " << (barcodes.empty() ? "(index)" : barcodes) << std::endl;
+    std::cout << "Output: " << output << std::endl;
+    std::cout << "Block width: " << options.block_width << std::endl;
+    std::cout << "Block height: " << options.block_height << std::endl;
+    std::cout << "Data type: " << biomxt::dtype_to_string(dtype) << std::endl;
+    std::cout << "Compression algo: " << biomxt::algo_to_string(options.algo) << std::endl;
+    std::cout << "Block filter: " << biomxt::filter_to_string(options.filter) << std::endl;
+    if (options.dictionary_size > 0) std::cout << "Dictionary: " << (options.dictionary_size >> 10) << " KB" << std::endl;
+    if (options.sparse_threshold > 0) std::cout << "Sparse threshold: " << options.sparse_threshold << std::endl;
+    if (options.integer_codec != biomxt::IntegerCodec::NONE) std::cout << "Integer codec: " << biomxt::integer_codec_to_string(options.integer_codec) << std::endl;
+    if (options.policy.adaptive) std::cout << "Adaptive codec: min decode " << options.policy.min_decode_speed << " MB/s" << std::endl;
+    if (options.frame_height > 0) std::cout << "Frame height: " << options.frame_height << std::endl;
+    if (options.column_major) std::cout << "Block layout: column-major" << std::endl;
+    std::cout << "Memory budget: " << (options.memory_budget >> 20) << " MB" << std::endl;
+    std::cout << "Transpose: " << (options.transpose ? "yes" : "no") << std::endl;
+    std::cout << "-------------------------------" << std::endl;
+    std::cout << "Converting..." << std::endl;
+
+    // Convert
+    std::vector<std::string> warnings;
+    biomxt::FileHeader header;
+    switch (dtype) {
+        case biomxt::DataType::INT16:
+            header = biomxt::mtx_to_bmxt<int16_t>(input, features, barcodes, output, options, warnings);
+            break;
+        case biomxt::DataType::INT32:
+            header = biomxt::mtx_to_bmxt<int32_t>(input, features, barcodes, output, options, warnings);
+            break;
+        case biomxt::DataType::INT64:
+            header = biomxt::mtx_to_bmxt<int64_t>(input, features, barcodes, output, options, warnings);
+            break;
+        case biomxt::DataType::FLOAT32:
+            header = biomxt::mtx_to_bmxt<float>(input, features, barcodes, output, options, warnings);
+            break;
+        case biomxt::DataType::FLOAT64:
+            header = biomxt::mtx_to_bmxt<double>(input, features, barcodes, output, options, warnings);
+            break;
+        case biomxt::DataType::UINT8:
+            header = biomxt::mtx_to_bmxt<uint8_t>(input, features, barcodes, output, options, warnings);
+            break;
+        case biomxt::DataType::UINT16:
+            header = biomxt::mtx_to_bmxt<uint16_t>(input, features, barcodes, output, options, warnings);
+            break;
+        case biomxt::DataType::FLOAT16:
+            header = biomxt::mtx_to_bmxt<biomxt::float16>(input, features, barcodes, output, options, warnings);
+            break;
+        case biomxt::DataType::BFLOAT16:
+            header = biomxt::mtx_to_bmxt<biomxt::bfloat16>(input, features, barcodes, output, options, warnings);
+            break;
+        default:
+            throw std::runtime_error("biomxt::mtx_to_bmxt: Invalid data type.");
+    }
+    for (const std::string &warn : warnings)
+    {
+        std::cerr << "Warning: " << warn << std::endl;
+    }
+
+    std::cout << "Row count: " << header.nrow << std::endl;
+    std::cout << "Col count: " << header.ncol << std::endl;
+    std::cout << "Block count: " << header.block_count << std::endl;
+
+    std::cout << "Conversion completed successfully." << std::endl;
+    return true;
+}
+
+bool convert_array_bmxt(std::string input, std::string rownames, std::string colnames, std::string output, const biomxt::ConvertOptions& options, biomxt::DataType dtype, uint32_t nrow, uint32_t ncol, bool fortran_order)
+{
+    // Detect npy by magic string, otherwise a raw array of given shape
+    bool npy = false;
+    {
+        std::ifstream in_file(input, std::ios::binary);
+        char magic[6] = {0};
+        in_file.read(magic, sizeof(magic));
+        npy = in_file.gcount() == sizeof(magic) && std::string_view(magic, sizeof(magic)) == "\x93NUMPY";
+    }
+    if (npy) {
+        biomxt::MappedFile in_file(input);
+        biomxt::NpyHeader npy_header = biomxt::npy_parse_header(in_file.data(), in_file.size());
+        dtype = npy_header.dtype;
+        nrow = npy_header.nrow;
+        ncol = npy_header.ncol;
+        fortran_order = npy_header.fortran_order;
+    } else if (nrow == 0 || ncol == 0) {
+        std::cerr << "Error: Shape is required for raw array." << std::endl;
+        return false;
+    }
+
+    // Print params
+    std::cout << "---- Conversion Parameters ----" << std::endl;
+    std::cout << "Input: " << input << (npy ? " (npy)" : " (raw)") << std::endl;
+    std::cout << "Output: " << output << std::endl;
+    std::cout << "Shape: " << nrow << "x" << ncol << (fortran_order ? ", Fortran order" : ", C order") << std::endl;
+    std::cout << "Block width: " << options.block_width << std::endl;
+    std::cout << "Block height: " << options.block_height << std::endl;
+    std::cout << "Data type: " << biomxt::dtype_to_string(dtype) << std::endl;
+    std::cout << "Compression algo: " << biomxt::algo_to_string(options.algo) << std::endl;
+    std::cout << "Block filter: " << biomxt::filter_to_string(options.filter) << std::endl;
+    if (options.dictionary_size > 0) std::cout << "Dictionary: " << (options.dictionary_size >> 10) << " KB" << std::endl;
+    if (options.sparse_threshold > 0) std::cout << "Sparse threshold: " << options.sparse_threshold << std::endl;
+    if (options.integer_codec != biomxt::IntegerCodec::NONE) std::cout << "Integer codec: " << biomxt::integer_codec_to_string(options.integer_codec) << std::endl;
+    if (options.policy.adaptive) std::cout << "Adaptive codec: min decode " << options.policy.min_decode_speed << " MB/s" << std::endl;
+    if (options.frame_height > 0) std::cout << "Frame height: " << options.frame_height << std::endl;
+    if (options.column_major) std::cout << "Block layout: column-major" << std::endl;
+    std::cout << "-------------------------------" << std::endl;
+    std::cout << "Converting..." << std::endl;
+
+    // Convert
+    std::vector<std::string> warnings;
+    biomxt::FileHeader header;
+    switch (dtype) {
+        case biomxt::DataType::INT16:
+            header = npy ? biomxt::npy_to_bmxt<int16_t>(input, rownames, colnames, output, options, warnings)
+                         : biomxt::raw_to_bmxt<int16_t>(input, nrow, ncol, fortran_order, rownames, colnames, output, options, warnings);
+            break;
+        case biomxt::DataType::INT32:
+            header = npy ? biomxt::npy_to_bmxt<int32_t>(input, rownames, colnames, output, options, warnings)
+                         : biomxt::raw_to_bmxt<int32_t>(input, nrow, ncol, fortran_order, rownames, colnames, output, options, warnings);
+            break;
+        case biomxt::DataType::INT64:
+            header = npy ? biomxt::npy_to_bmxt<int64_t>(input, rownames, colnames, output, options, warnings)
+                         : biomxt::raw_to_bmxt<int64_t>(input, nrow, ncol, fortran_order, rownames, colnames, output, options, warnings);
+            break;
+        case biomxt::DataType::FLOAT32:
+            header = npy ? biomxt::npy_to_bmxt<float>(input, rownames, colnames, output, options, warnings)
+                         : biomxt::raw_to_bmxt<float>(input, nrow, ncol, fortran_order, rownames, colnames, output, options, warnings);
+            break;
+        case biomxt::DataType::FLOAT64:
+            header = npy ? biomxt::npy_to_bmxt<double>(input, rownames, colnames, output, options, warnings)
+                         : biomxt::raw_to_bmxt<double>(input, nrow, ncol, fortran_order, rownames, colnames, output, options, warnings);
+            break;
+        case biomxt::DataType::UINT8:
+            header = npy ? biomxt::npy_to_bmxt<uint8_t>(input, rownames, colnames, output, options, warnings)
+                         : biomxt::raw_to_bmxt<uint8_t>(input, nrow, ncol, fortran_order, rownames, colnames, output, options, warnings);
+            break;
+        case biomxt::DataType::UINT16:
+            header = npy ? biomxt::npy_to_bmxt<uint16_t>(input, rownames, colnames, output, options, warnings)
+                         : biomxt::raw_to_bmxt<uint16_t>(input, nrow, ncol, fortran_order, rownames, colnames, output, options, warnings);
+            break;
+        case biomxt::DataType::FLOAT16:
+            header = npy ? biomxt::npy_to_bmxt<biomxt::float16>(input, rownames, colnames, output, options, warnings)
+                         : biomxt::raw_to_bmxt<biomxt::float16>(input, nrow, ncol, fortran_order, rownames, colnames, output, options, warnings);
+            break;
+        case biomxt::DataType::BFLOAT16:
+            header = npy ? biomxt::npy_to_bmxt<biomxt::bfloat16>(input, rownames, colnames, output, options, warnings)
+                         : biomxt::raw_to_bmxt<biomxt::bfloat16>(input, nrow, ncol, fortran_order, rownames, colnames, output, options, warnings);
+            break;
+        default:
+            throw std::runtime_error("biomxt::npy_to_bmxt: Invalid data type.");
+    }
+    for (const std::string &warn : warnings)
+    {
+        std::cerr << "Warning: " << warn << std::endl;
+    }
+
+    std::cout << "Row count: " << header.nrow << std::endl;
+    std::cout << "Col count: " << header.ncol << std::endl;
+    std::cout << "Block count: " << header.block_count << std::endl;
+
+    std::cout << "Conversion completed successfully." << std::endl;
+    return true;
+}
+
 int main(int argc, char *argv[])
 {
     // Build CLI app
-    cliapp::Command bmxt = cliapp::Command("bmxt", "\tConvert CSV/TSV to BioMXt format")
+    cliapp::Command bmxt = cliapp::Command("bmxt", "\tConvert CSV/TSV, plain or gzip/zstd compressed, to BioMXt format")
         .add_argument(cliapp::Argument("input", "Input file path"))
         .add_option(cliapp::Option::option_with_value("--output", "-o", "Output file path", ""))
         .add_option(cliapp::Option::option_with_value("--block-width", "-w", "Block width, default: 512", "512"))
         .add_option(cliapp::Option::option_with_value("--block-height", "-h", "Block height, default: 512", "512"))
-        .add_option(cliapp::Option::option_with_value("--algorithm", "-a", "Compression algorithm: zstd(default), gzip, lz4", "zstd"))
+        .add_option(cliapp::Option::option_with_value("--algorithm", "-a", "Compression algorithm: zstd(default), gzip, lz4, lz4hc, store", "zstd"))
+        .add_option(cliapp::Option::option_with_value("--filter", "-S", "Pre-compression filter: none(default), shuffle, bitshuffle", "none"))
+        .add_option(cliapp::Option::option_with_value("--dictionary", "-D", "Train a zstd dictionary of N KB on the first block row, for small blocks. default: 0 (disabled)", "0"))
+        .add_option(cliapp::Option::option_with_value("--sparse", "-z", "Store blocks with at most this density of nonzeros sparse, e.g. 0.3. default: 0 (dense)", "0"))
+        .add_option(cliapp::Option::option_with_value("--int-codec", "-I", "Integer codec ahead of compression: none(default), for, delta, fixed, auto", "none"))
+        .add_option(cliapp::Option::option_with_value("--adaptive", "-A", "Choose encoding, filter and algorithm per block: the smallest block estimated to decode at least N MB/s, 0 for the smallest block. default: disabled", "0"))
+        .add_option(cliapp::Option::option_with_value("--frame-height", "-H", "Compress blocks as independent frames of N rows, or N columns if column-major, so that random reads decode one frame. default: 0 (whole blocks)", "0"))
+        .add_option(cliapp::Option::option_without_value("--column-major", "-C", "Store cells of each block column by column, for files read mostly by column"))
         .add_option(cliapp::Option::option_with_value("--separator", "-s", "Separator: ',' or '\\t'. Detect by file extension if not specified, and comma as default if detect failed.", ","))
-        .add_option(cliapp::Option::option_with_value("--data-type", "-t", "Data type: int16, int32, int64, float32(default), float64", "float32"))
+        .add_option(cliapp::Option::option_with_value("--data-type", "-t", "Data type: int16, int32, int64, float32(default), float64, uint8, uint16, float16, bfloat16", "float32"))
+        .add_option(cliapp::Option::option_with_value("--threads", "-j", "Compression threads, default: hardware concurrency", "0"))
+        .add_option(cliapp::Option::option_with_value("--inflight", "-i", "Max block rows held in memory while compressing, default: twice the threads", "0"))
+        .add_option(cliapp::Option::option_with_value("--parse-threads", "-p", "CSV parsing threads, default: hardware concurrency", "0"))
+        .add_option(cliapp::Option::option_with_value("--checkpoint", "-k", "Save a checkpoint to <output>.ckpt every N MB of input, default: 0 (disabled)", "0"))
+        .add_option(cliapp::Option::option_without_value("--resume", "-R", "Resume an interrupted conversion from <output>.ckpt"))
+        .add_option(cliapp::Option::option_without_value("--overwrite", "-f", "Overwrite output file if exists"));
+
+    cliapp::Command mtx = cliapp::Command("mtx", "\tConvert Matrix Market (10x matrix.mtx) to BioMXt format")
+        .add_argument(cliapp::Argument("input", "Input mtx file path"))
+        .add_option(cliapp::Option::option_with_value("--output", "-o", "Output file path", ""))
+        .add_option(cliapp::Option::option_with_value("--features", "-g", "Row names file, first column used. default: features.tsv or genes.tsv next to input, or 1-based index", ""))
+        .add_option(cliapp::Option::option_with_value("--barcodes", "-c", "Column names file, first column used. default: barcodes.tsv next to input, or 1-based index", ""))
+        .add_option(cliapp::Option::option_with_value("--block-width", "-w", "Block width, default: 512", "512"))
+        .add_option(cliapp::Option::option_with_value("--block-height", "-h", "Block height, default: 512", "512"))
+        .add_option(cliapp::Option::option_with_value("--algorithm", "-a", "Compression algorithm: zstd(default), gzip, lz4, lz4hc, store", "zstd"))
+        .add_option(cliapp::Option::option_with_value("--filter", "-S", "Pre-compression filter: none(default), shuffle, bitshuffle", "none"))
+        .add_option(cliapp::Option::option_with_value("--dictionary", "-D", "Train a zstd dictionary of N KB on the first block row, for small blocks. default: 0 (disabled)", "0"))
+        .add_option(cliapp::Option::option_with_value("--sparse", "-z", "Store blocks with at most this density of nonzeros sparse, e.g. 0.3. default: 0 (dense)", "0"))
+        .add_option(cliapp::Option::option_with_value("--int-codec", "-I", "Integer codec ahead of compression: none(default), for, delta, fixed, auto", "none"))
+        .add_option(cliapp::Option::option_with_value("--adaptive", "-A", "Choose encoding, filter and algorithm per block: the smallest block estimated to decode at least N MB/s, 0 for the smallest block. default: disabled", "0"))
+        .add_option(cliapp::Option::option_with_value("--frame-height", "-H", "Compress blocks as independent frames of N rows, or N columns if column-major, so that random reads decode one frame. default: 0 (whole blocks)", "0"))
+        .add_option(cliapp::Option::option_without_value("--column-major", "-C", "Store cells of each block column by column, for files read mostly by column"))
+        .add_option(cliapp::Option::option_with_value("--data-type", "-t", "Data type: int16, int32(default), int64, float32, float64, uint8, uint16, float16, bfloat16", "int32"))
+        .add_option(cliapp::Option::option_with_value("--threads", "-j", "Compression threads, default: hardware concurrency", "0"))
+        .add_option(cliapp::Option::option_with_value("--memory-budget", "-m", "Memory for sparse entries before spilling to disk in MB, default: 1024", "1024"))
+        .add_option(cliapp::Option::option_without_value("--transpose", "-T", "Transpose so that barcodes become rows"))
+        .add_option(cliapp::Option::option_without_value("--overwrite", "-f", "Overwrite output file if exists"));
+
+    cliapp::Command array = cliapp::Command("array", "\tConvert .npy or raw little-endian binary array to BioMXt format")
+        .add_argument(cliapp::Argument("input", "Input npy or raw file path"))
+        .add_option(cliapp::Option::option_with_value("--output", "-o", "Output file path", ""))
+        .add_option(cliapp::Option::option_with_value("--row-names", "-r", "Row names file, one per line. default: 1-based index", ""))
+        .add_option(cliapp::Option::option_with_value("--column-names", "-c", "Column names file, one per line. default: 1-based index", ""))
+        .add_option(cliapp::Option::option_with_value("--shape", "-s", "\tShape of raw array as <rows>x<columns>, read from header for npy", ""))
+        .add_option(cliapp::Option::option_without_value("--fortran", "-F", "\tRaw array is column-major (Fortran order)"))
+        .add_option(cliapp::Option::option_with_value("--data-type", "-t", "Data type of raw array: int16, int32, int64, float32(default), float64, uint8, uint16, float16, bfloat16", "float32"))
+        .add_option(cliapp::Option::option_with_value("--block-width", "-w", "Block width, default: 512", "512"))
+        .add_option(cliapp::Option::option_with_value("--block-height", "-h", "Block height, default: 512", "512"))
+        .add_option(cliapp::Option::option_with_value("--algorithm", "-a", "Compression algorithm: zstd(default), gzip, lz4, lz4hc, store", "zstd"))
+        .add_option(cliapp::Option::option_with_value("--filter", "-S", "Pre-compression filter: none(default), shuffle, bitshuffle", "none"))
+        .add_option(cliapp::Option::option_with_value("--dictionary", "-D", "Train a zstd dictionary of N KB on the first block row, for small blocks. default: 0 (disabled)", "0"))
+        .add_option(cliapp::Option::option_with_value("--sparse", "-z", "Store blocks with at most this density of nonzeros sparse, e.g. 0.3. default: 0 (dense)", "0"))
+        .add_option(cliapp::Option::option_with_value("--int-codec", "-I", "Integer codec ahead of compression: none(default), for, delta, fixed, auto", "none"))
+        .add_option(cliapp::Option::option_with_value("--adaptive", "-A", "Choose encoding, filter and algorithm per block: the smallest block estimated to decode at least N MB/s, 0 for the smallest block. default: disabled", "0"))
+        .add_option(cliapp::Option::option_with_value("--frame-height", "-H", "Compress blocks as independent frames of N rows, or N columns if column-major, so that random reads decode one frame. default: 0 (whole blocks)", "0"))
+        .add_option(cliapp::Option::option_without_value("--column-major", "-C", "Store cells of each block column by column, for files read mostly by column"))
+        .add_option(cliapp::Option::option_with_value("--threads", "-j", "Compression threads, default: hardware concurrency", "0"))
         .add_option(cliapp::Option::option_without_value("--overwrite", "-f", "Overwrite output file if exists"));
 
     cliapp::Command dump = cliapp::Command("dump", "\tDump BioMXt file to CSV/TSV format")
@@ -102,13 +349,26 @@ int main(int argc, char *argv[])
     cliapp::Command header = cliapp::Command("header", "Read header from BioMXt file")
         .add_argument(cliapp::Argument("input", "Input file path"));
 
+    cliapp::Command warm = cliapp::Command("warm", "\tWarm block cache from a list of hot row or column names")
+        .add_argument(cliapp::Argument("input", "Input file path"))
+        .add_option(cliapp::Option::option_with_value("--names-file", "-n", "File of names to warm, one name per line", ""))
+        .add_option(cliapp::Option::option_with_value("--names", "-N", "\tNames to warm, separated by comma", ""))
+        .add_option(cliapp::Option::option_with_value("--by", "-b", "\tMatch names by: row(default), column", "row"))
+        .add_option(cliapp::Option::option_with_value("--threads", "-j", "\tWorker threads, default: hardware concurrency", "0"))
+        .add_option(cliapp::Option::option_with_value("--memory-limit", "-m", "Cache memory limit in MB, default: 128", "128"))
+        .add_option(cliapp::Option::option_with_value("--shared", "-s", "Shared memory cache to warm (e.g. /biomxt), required as it outlives the command", ""))
+        .add_option(cliapp::Option::option_without_value("--pin", "-p", "\tPin warmed blocks so that LRU never evicts them"));
+
     cliapp::App app = cliapp::App("biomxt", "0.1.0", "Lite maxtrix format for bioinformatics")
         .add_option(cliapp::Option::option_without_value("--help", "-h", "Print help message"))
         .add_option(cliapp::Option::option_without_value("--version", "-v", "Print version"))
         .add_command(&bmxt)
+        .add_command(&mtx)
+        .add_command(&array)
         .add_command(&dump)
         .add_command(&cells)
-        .add_command(&header);
+        .add_command(&header)
+        .add_command(&warm);
 
     // Check if CLI usage is valid
     if(!app.parse(argc, argv)) return 1;
@@ -130,10 +390,11 @@ int main(int argc, char *argv[])
         cliapp::Option output_opt = bmxt.find_option("--output", "-o");
         std::string output = output_opt.get_value();
         if (!output_opt.is_provided()) {
-            // Change output file extension to .bmxt if not specified
-            output = fs::path(input.get_value()).replace_extension(".bmxt").string();
+            // Change output file extension to .bmxt if not specified, compression extension is dropped first
+            output = fs::path(biomxt::strip_compression_extension(input.get_value())).replace_extension(".bmxt").string();
         }
-        if (std::filesystem::exists(output)) {
+        bool resume = bmxt.find_option("--resume", "-R").is_provided();
+        if (std::filesystem::exists(output) && !resume) {
             if (!bmxt.find_option("--overwrite", "-f").is_provided()) {
                 std::cerr << "Error: Output file already exists." << std::endl;
                 return 1;
@@ -157,7 +418,7 @@ int main(int argc, char *argv[])
                 sep = ',';
             }
         } else {
-            std::string ext = fs::path(input.get_value()).extension().string();
+            std::string ext = fs::path(biomxt::strip_compression_extension(input.get_value())).extension().string();
             if (ext == ".tsv" || ext == ".TSV") {
                 sep = '\t';
             }
@@ -192,10 +453,386 @@ int main(int argc, char *argv[])
             block_height = std::stoul(block_height_opt.get_value());
         }
         
+        // Confirm compression threads, inflight block rows and parsing threads
+        uint32_t threads = 0;
+        cliapp::Option threads_opt = bmxt.find_option("--threads", "-j");
+        if (threads_opt.is_provided()) {
+            threads = std::stoul(threads_opt.get_value());
+        }
+        uint32_t inflight = 0;
+        cliapp::Option inflight_opt = bmxt.find_option("--inflight", "-i");
+        if (inflight_opt.is_provided()) {
+            inflight = std::stoul(inflight_opt.get_value());
+        }
+
+        uint32_t parse_threads = 0;
+        cliapp::Option parse_threads_opt = bmxt.find_option("--parse-threads", "-p");
+        if (parse_threads_opt.is_provided()) {
+            parse_threads = std::stoul(parse_threads_opt.get_value());
+        }
+
+        // Confirm checkpoint interval
+        uint64_t checkpoint_mb = 0;
+        cliapp::Option checkpoint_opt = bmxt.find_option("--checkpoint", "-k");
+        if (checkpoint_opt.is_provided()) {
+            checkpoint_mb = std::stoull(checkpoint_opt.get_value());
+        }
+
+        // Confirm block filter
+        biomxt::BlockFilter filter = biomxt::BlockFilter::NONE;
+        cliapp::Option filter_opt = bmxt.find_option("--filter", "-S");
+        if (filter_opt.is_provided()) {
+            filter = biomxt::filter_from_string(filter_opt.get_value());
+        }
+
+        // Confirm dictionary size
+        uint32_t dictionary_kb = 0;
+        cliapp::Option dictionary_opt = bmxt.find_option("--dictionary", "-D");
+        if (dictionary_opt.is_provided()) {
+            dictionary_kb = std::stoul(dictionary_opt.get_value());
+        }
+
+        // Confirm sparse threshold
+        float sparse_threshold = 0;
+        cliapp::Option sparse_opt = bmxt.find_option("--sparse", "-z");
+        if (sparse_opt.is_provided()) {
+            sparse_threshold = std::stof(sparse_opt.get_value());
+        }
+
+        // Confirm integer codec
+        biomxt::IntegerCodec integer_codec = biomxt::IntegerCodec::NONE;
+        cliapp::Option integer_codec_opt = bmxt.find_option("--int-codec", "-I");
+        if (integer_codec_opt.is_provided()) {
+            integer_codec = biomxt::integer_codec_from_string(integer_codec_opt.get_value());
+        }
+
+        // Confirm adaptive codec policy
+        biomxt::CodecPolicy policy;
+        cliapp::Option adaptive_opt = bmxt.find_option("--adaptive", "-A");
+        if (adaptive_opt.is_provided()) {
+            policy.adaptive = true;
+            policy.min_decode_speed = std::stoul(adaptive_opt.get_value());
+        }
+
+        // Confirm frame height
+        uint32_t frame_height = 0;
+        cliapp::Option frame_height_opt = bmxt.find_option("--frame-height", "-H");
+        if (frame_height_opt.is_provided()) {
+            frame_height = std::stoul(frame_height_opt.get_value());
+        }
+        if (frame_height > UINT16_MAX) {
+            std::cerr << "Error: Frame height must be at most " << UINT16_MAX << "." << std::endl;
+            return 1;
+        }
+
         // Run conversion
-        return convert_csv_bmxt(input.get_value(), output, block_width, block_height, sep, dtype, algo) ? 0 : 1;
+        biomxt::ConvertOptions options;
+        options.block_width = block_width;
+        options.block_height = block_height;
+        options.separator = sep;
+        options.algo = algo;
+        options.filter = filter;
+        options.dictionary_size = dictionary_kb << 10;
+        options.sparse_threshold = sparse_threshold;
+        options.integer_codec = integer_codec;
+        options.policy = policy;
+        options.frame_height = frame_height;
+        options.column_major = bmxt.find_option("--column-major", "-C").is_provided();
+        options.threads = threads;
+        options.max_inflight_block_rows = inflight;
+        options.parse_threads = parse_threads;
+        options.checkpoint_interval = checkpoint_mb << 20;
+        options.resume = resume;
+        return convert_csv_bmxt(input.get_value(), output, options, dtype) ? 0 : 1;
 
     // }
+    } else if (mtx.is_provided()) {
+        // Check if input file exists
+        cliapp::Argument input = mtx.find_argument("input");
+        if (!input.is_provided()) {
+            std::cerr << "Error: Input file path is required." << std::endl;
+            return 1;
+        }
+        if (!std::filesystem::exists(input.get_value())) {
+            std::cerr << "Error: Input file [" << input.get_value() << "] does not exist." << std::endl;
+            return 1;
+        }
+
+        // Check output file
+        cliapp::Option output_opt = mtx.find_option("--output", "-o");
+        std::string output = output_opt.get_value();
+        if (!output_opt.is_provided()) {
+            output = fs::path(input.get_value()).replace_extension(".bmxt").string();
+        }
+        if (std::filesystem::exists(output) && !mtx.find_option("--overwrite", "-f").is_provided()) {
+            std::cerr << "Error: Output file already exists." << std::endl;
+            return 1;
+        }
+        fs::path output_dir = fs::path(output).parent_path();
+        if (!output_dir.empty() && !std::filesystem::exists(output_dir) && !std::filesystem::create_directories(output_dir)) {
+            std::cerr << "Error: Failed to create output directory." << std::endl;
+            return 1;
+        }
+
+        // Confirm names files, look for 10x names next to input if not specified
+        fs::path input_dir = fs::path(input.get_value()).parent_path();
+        auto find_names = [&](const std::string& opt_long, const std::string& opt_short, const std::vector<std::string>& candidates) {
+            cliapp::Option opt = mtx.find_option(opt_long, opt_short);
+            if (opt.is_provided()) return opt.get_value();
+            for (const std::string& candidate : candidates) {
+                if (std::filesystem::exists(input_dir / candidate)) return (input_dir / candidate).string();
+            }
+            return std::string();
+        };
+        std::string features = find_names("--features", "-g", {"features.tsv", "genes.tsv"});
+        std::string barcodes = find_names("--barcodes", "-c", {"barcodes.tsv"});
+
+        // Confirm data type
+        biomxt::DataType dtype = biomxt::DataType::INT32;
+        cliapp::Option dtype_opt = mtx.find_option("--data-type", "-t");
+        if (dtype_opt.is_provided()) {
+            dtype = biomxt::dtype_from_string(dtype_opt.get_value());
+        }
+
+        // Confirm compression algorithm
+        biomxt::CompressAlgorithm algo = biomxt::CompressAlgorithm::ZSTD;
+        cliapp::Option algo_opt = mtx.find_option("--algorithm", "-a");
+        if (algo_opt.is_provided()) {
+            algo = biomxt::algo_from_string(algo_opt.get_value());
+        }
+
+        // Confirm block width and height
+        uint32_t block_width = 512;
+        cliapp::Option block_width_opt = mtx.find_option("--block-width", "-w");
+        if (block_width_opt.is_provided()) {
+            block_width = std::stoul(block_width_opt.get_value());
+        }
+        uint32_t block_height = 512;
+        cliapp::Option block_height_opt = mtx.find_option("--block-height", "-h");
+        if (block_height_opt.is_provided()) {
+            block_height = std::stoul(block_height_opt.get_value());
+        }
+
+        // Confirm compression threads
+        uint32_t threads = 0;
+        cliapp::Option threads_opt = mtx.find_option("--threads", "-j");
+        if (threads_opt.is_provided()) {
+            threads = std::stoul(threads_opt.get_value());
+        }
+
+        // Confirm block filter
+        biomxt::BlockFilter filter = biomxt::BlockFilter::NONE;
+        cliapp::Option filter_opt = mtx.find_option("--filter", "-S");
+        if (filter_opt.is_provided()) {
+            filter = biomxt::filter_from_string(filter_opt.get_value());
+        }
+
+        // Confirm dictionary size
+        uint32_t dictionary_kb = 0;
+        cliapp::Option dictionary_opt = mtx.find_option("--dictionary", "-D");
+        if (dictionary_opt.is_provided()) {
+            dictionary_kb = std::stoul(dictionary_opt.get_value());
+        }
+
+        // Confirm sparse threshold
+        float sparse_threshold = 0;
+        cliapp::Option sparse_opt = mtx.find_option("--sparse", "-z");
+        if (sparse_opt.is_provided()) {
+            sparse_threshold = std::stof(sparse_opt.get_value());
+        }
+
+        // Confirm integer codec
+        biomxt::IntegerCodec integer_codec = biomxt::IntegerCodec::NONE;
+        cliapp::Option integer_codec_opt = mtx.find_option("--int-codec", "-I");
+        if (integer_codec_opt.is_provided()) {
+            integer_codec = biomxt::integer_codec_from_string(integer_codec_opt.get_value());
+        }
+
+        // Confirm adaptive codec policy
+        biomxt::CodecPolicy policy;
+        cliapp::Option adaptive_opt = mtx.find_option("--adaptive", "-A");
+        if (adaptive_opt.is_provided()) {
+            policy.adaptive = true;
+            policy.min_decode_speed = std::stoul(adaptive_opt.get_value());
+        }
+
+        // Confirm frame height
+        uint32_t frame_height = 0;
+        cliapp::Option frame_height_opt = mtx.find_option("--frame-height", "-H");
+        if (frame_height_opt.is_provided()) {
+            frame_height = std::stoul(frame_height_opt.get_value());
+        }
+        if (frame_height > UINT16_MAX) {
+            std::cerr << "Error: Frame height must be at most " << UINT16_MAX << "." << std::endl;
+            return 1;
+        }
+
+        // Confirm memory budget
+        uint64_t memory_budget_mb = 1024;
+        cliapp::Option memory_budget_opt = mtx.find_option("--memory-budget", "-m");
+        if (memory_budget_opt.is_provided()) {
+            memory_budget_mb = std::stoull(memory_budget_opt.get_value());
+        }
+
+        // Run conversion
+        biomxt::ConvertOptions options;
+        options.block_width = block_width;
+        options.block_height = block_height;
+        options.algo = algo;
+        options.filter = filter;
+        options.dictionary_size = dictionary_kb << 10;
+        options.sparse_threshold = sparse_threshold;
+        options.integer_codec = integer_codec;
+        options.policy = policy;
+        options.frame_height = frame_height;
+        options.column_major = mtx.find_option("--column-major", "-C").is_provided();
+        options.threads = threads;
+        options.memory_budget = memory_budget_mb << 20;
+        options.transpose = mtx.find_option("--transpose", "-T").is_provided();
+        return convert_mtx_bmxt(input.get_value(), features, barcodes, output, options, dtype) ? 0 : 1;
+
+    } else if (array.is_provided()) {
+        // Check if input file exists
+        cliapp::Argument input = array.find_argument("input");
+        if (!input.is_provided()) {
+            std::cerr << "Error: Input file path is required." << std::endl;
+            return 1;
+        }
+        if (!std::filesystem::exists(input.get_value())) {
+            std::cerr << "Error: Input file [" << input.get_value() << "] does not exist." << std::endl;
+            return 1;
+        }
+
+        // Check output file
+        cliapp::Option output_opt = array.find_option("--output", "-o");
+        std::string output = output_opt.get_value();
+        if (!output_opt.is_provided()) {
+            output = fs::path(input.get_value()).replace_extension(".bmxt").string();
+        }
+        if (std::filesystem::exists(output) && !array.find_option("--overwrite", "-f").is_provided()) {
+            std::cerr << "Error: Output file already exists." << std::endl;
+            return 1;
+        }
+        fs::path output_dir = fs::path(output).parent_path();
+        if (!output_dir.empty() && !std::filesystem::exists(output_dir) && !std::filesystem::create_directories(output_dir)) {
+            std::cerr << "Error: Failed to create output directory." << std::endl;
+            return 1;
+        }
+
+        // Confirm names files
+        std::string row_names = array.find_option("--row-names", "-r").get_value();
+        std::string column_names = array.find_option("--column-names", "-c").get_value();
+
+        // Confirm shape, read from header for npy if not provided
+        uint32_t nrow = 0;
+        uint32_t ncol = 0;
+        cliapp::Option shape_opt = array.find_option("--shape", "-s");
+        if (shape_opt.is_provided()) {
+            std::string shape = shape_opt.get_value();
+            size_t x = shape.find_first_of("xX,");
+            if (x == std::string::npos) {
+                std::cerr << "Error: Invalid shape [" << shape << "], expected <rows>x<columns>." << std::endl;
+                return 1;
+            }
+            nrow = std::stoul(shape.substr(0, x));
+            ncol = std::stoul(shape.substr(x + 1));
+        }
+
+        // Confirm data type
+        biomxt::DataType dtype = biomxt::DataType::FLOAT32;
+        cliapp::Option dtype_opt = array.find_option("--data-type", "-t");
+        if (dtype_opt.is_provided()) {
+            dtype = biomxt::dtype_from_string(dtype_opt.get_value());
+        }
+
+        // Confirm compression algorithm
+        biomxt::CompressAlgorithm algo = biomxt::CompressAlgorithm::ZSTD;
+        cliapp::Option algo_opt = array.find_option("--algorithm", "-a");
+        if (algo_opt.is_provided()) {
+            algo = biomxt::algo_from_string(algo_opt.get_value());
+        }
+
+        // Confirm block width and height
+        uint32_t block_width = 512;
+        cliapp::Option block_width_opt = array.find_option("--block-width", "-w");
+        if (block_width_opt.is_provided()) {
+            block_width = std::stoul(block_width_opt.get_value());
+        }
+        uint32_t block_height = 512;
+        cliapp::Option block_height_opt = array.find_option("--block-height", "-h");
+        if (block_height_opt.is_provided()) {
+            block_height = std::stoul(block_height_opt.get_value());
+        }
+
+        // Confirm compression threads
+        uint32_t threads = 0;
+        cliapp::Option threads_opt = array.find_option("--threads", "-j");
+        if (threads_opt.is_provided()) {
+            threads = std::stoul(threads_opt.get_value());
+        }
+
+        // Confirm block filter
+        biomxt::BlockFilter filter = biomxt::BlockFilter::NONE;
+        cliapp::Option filter_opt = array.find_option("--filter", "-S");
+        if (filter_opt.is_provided()) {
+            filter = biomxt::filter_from_string(filter_opt.get_value());
+        }
+
+        // Confirm dictionary size
+        uint32_t dictionary_kb = 0;
+        cliapp::Option dictionary_opt = array.find_option("--dictionary", "-D");
+        if (dictionary_opt.is_provided()) {
+            dictionary_kb = std::stoul(dictionary_opt.get_value());
+        }
+
+        // Confirm sparse threshold
+        float sparse_threshold = 0;
+        cliapp::Option sparse_opt = array.find_option("--sparse", "-z");
+        if (sparse_opt.is_provided()) {
+            sparse_threshold = std::stof(sparse_opt.get_value());
+        }
+
+        // Confirm integer codec
+        biomxt::IntegerCodec integer_codec = biomxt::IntegerCodec::NONE;
+        cliapp::Option integer_codec_opt = array.find_option("--int-codec", "-I");
+        if (integer_codec_opt.is_provided()) {
+            integer_codec = biomxt::integer_codec_from_string(integer_codec_opt.get_value());
+        }
+
+        // Confirm adaptive codec policy
+        biomxt::CodecPolicy policy;
+        cliapp::Option adaptive_opt = array.find_option("--adaptive", "-A");
+        if (adaptive_opt.is_provided()) {
+            policy.adaptive = true;
+            policy.min_decode_speed = std::stoul(adaptive_opt.get_value());
+        }
+
+        // Confirm frame height
+        uint32_t frame_height = 0;
+        cliapp::Option frame_height_opt = array.find_option("--frame-height", "-H");
+        if (frame_height_opt.is_provided()) {
+            frame_height = std::stoul(frame_height_opt.get_value());
+        }
+        if (frame_height > UINT16_MAX) {
+            std::cerr << "Error: Frame height must be at most " << UINT16_MAX << "." << std::endl;
+            return 1;
+        }
+
+        // Run conversion
+        biomxt::ConvertOptions options;
+        options.block_width = block_width;
+        options.block_height = block_height;
+        options.algo = algo;
+        options.filter = filter;
+        options.dictionary_size = dictionary_kb << 10;
+        options.sparse_threshold = sparse_threshold;
+        options.integer_codec = integer_codec;
+        options.policy = policy;
+        options.frame_height = frame_height;
+        options.column_major = array.find_option("--column-major", "-C").is_provided();
+        options.threads = threads;
+        return convert_array_bmxt(input.get_value(), row_names, column_names, output, options, dtype, nrow, ncol, array.find_option("--fortran", "-F").is_provided()) ? 0 : 1;
+
     } else if (header.is_provided()) {
         cliapp::Argument input = header.find_argument("input");
 
@@ -241,7 +878,7 @@ int main(int argc, char *argv[])
                 std::cout << "Cell count: " << cells.size() << std::endl;
                 // Print first 10 cells
                 for (size_t i=0; i<10; i++) {
-                    std::cout << "Cell[" << i << "] = " << cells[i] << std::endl;
+                    std::cout << "Cell[" << i << "] = " << +cells[i] << std::endl;
                 }
             });
             
@@ -250,6 +887,79 @@ int main(int argc, char *argv[])
             std::cerr << "Error: Failed to open input file [" << input.get_value() << "]." << std::endl;
             return 1;
         }
+    } else if (warm.is_provided()) {
+        cliapp::Argument input = warm.find_argument("input");
+
+        // Collect names from file and option
+        std::vector<std::string> names;
+        cliapp::Option names_file_opt = warm.find_option("--names-file", "-n");
+        if (names_file_opt.is_provided()) {
+            std::ifstream names_file(names_file_opt.get_value());
+            if (!names_file.is_open()) {
+                std::cerr << "Error: Failed to open names file [" << names_file_opt.get_value() << "]." << std::endl;
+                return 1;
+            }
+            std::string line;
+            while (std::getline(names_file, line)) {
+                while (!line.empty() && (line.back() == '\r' || line.back() == ' ')) line.pop_back();
+                if (!line.empty()) names.push_back(line);
+            }
+        }
+        cliapp::Option names_opt = warm.find_option("--names", "-N");
+        if (names_opt.is_provided()) {
+            std::stringstream ss(names_opt.get_value());
+            std::string name;
+            while (std::getline(ss, name, ',')) {
+                if (!name.empty()) names.push_back(name);
+            }
+        }
+        if (names.empty()) {
+            std::cerr << "Error: No names provided, use --names-file or --names." << std::endl;
+            return 1;
+        }
+
+        bool by_column = warm.find_option("--by", "-b").is_provided() && warm.find_option("--by", "-b").get_value() == "column";
+        uint32_t threads = warm.find_option("--threads", "-j").is_provided() ? std::stoul(warm.find_option("--threads", "-j").get_value()) : 0;
+        size_t memory_limit = 128;
+        if (warm.find_option("--memory-limit", "-m").is_provided()) {
+            memory_limit = std::stoull(warm.find_option("--memory-limit", "-m").get_value());
+        }
+        bool pin = warm.find_option("--pin", "-p").is_provided();
+
+        // A process-private cache is dropped when the command exits, warming it would be a no-op
+        cliapp::Option shared_opt = warm.find_option("--shared", "-s");
+        if (!shared_opt.is_provided()) {
+            std::cerr << "Error: No shared memory cache provided, use --shared." << std::endl;
+            return 1;
+        }
+
+#if defined(__linux__)
+        try {
+            // Slot size must hold the largest block of the file
+            size_t slot_size = biomxt::BiomxtFile(input.get_value()).get_max_uncompressed_block_size();
+            std::unique_ptr<biomxt::BlockCache> block_cache = std::make_unique<biomxt::SharedBlockCache>(shared_opt.get_value(), memory_limit * 1024 * 1024, slot_size);
+            biomxt::BiomxtFile bmxt = biomxt::BiomxtFile(input.get_value(), block_cache.get());
+
+            uint64_t start_time = get_timestamp();
+            size_t resident = by_column
+                ? bmxt.warm_columns(bmxt.get_column_indices(names), pin, threads)
+                : bmxt.warm_rows(bmxt.get_row_indices(names), pin, threads);
+            uint64_t cost_time = get_timestamp() - start_time;
+
+            std::cout << "Names: " << names.size() << std::endl;
+            std::cout << "Blocks resident: " << resident << std::endl;
+            std::cout << "Cache memory used: " << block_cache->get_memory_used() / 1024.0 / 1024.0 << " MB" << std::endl;
+            std::cout << "Cache memory pinned: " << block_cache->get_memory_pinned() / 1024.0 / 1024.0 << " MB" << std::endl;
+            std::cout << "Warm-up cost: " << cost_time << " ms" << std::endl;
+            bmxt.close();
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+#else
+        std::cerr << "Error: Shared memory cache is only supported on Linux." << std::endl;
+        return 1;
+#endif
     }
 
     // No command provided, check if option provided
@@ -2,19 +2,53 @@
 #include <charconv>
 #include <vector>
 #include <fstream>
+#include <deque>
+#include <future>
+#include <memory>
+#include <optional>
+#include <filesystem>
+#include <cstring>
+#include <cctype>
+#include <algorithm>
 #include "zstd.h"
 #include "zstd_errors.h"
 #include "biomxt/utils/csv_parser.hpp"
+#include "biomxt/utils/csv_chunker.hpp"
+#include "biomxt/utils/mapped_file.hpp"
+#include "biomxt/utils/compressed_reader.hpp"
+#include "biomxt/utils/checkpoint.hpp"
+#include "biomxt/utils/npy_header.hpp"
 #include "biomxt/struct/index_entry.hpp"
 #include "biomxt/struct/compress_algorithm.hpp"
 #include "biomxt/struct/file_header.hpp"
+#include "biomxt/struct/convert_options.hpp"
+#include "biomxt/utils/block_codec.hpp"
+#include "biomxt/utils/block_pipeline.hpp"
+#include "biomxt/utils/fast_divisor.hpp"
 
 
 namespace biomxt
 {
+    /**
+     * @brief Write names, block table and names table after the blocks, then the header at the beginning of file.
+     * @param out Output file stream, positioned right after the last block.
+     * @param header File header, block count and table offsets are filled in.
+     * @param block_table Block table of written blocks.
+     * @param rownames Row names.
+     * @param colnames Column names.
+     * @throws `std::runtime_error` If writing fails.
+     */
+    void write_bmxt_tail(
+        std::ofstream& out,
+        biomxt::FileHeader& header,
+        const std::vector<biomxt::IndexEntry>& block_table,
+        const std::vector<std::string>& rownames,
+        const std::vector<std::string>& colnames);
+
     /**
      * @brief Flush rows buffer by spliting it into blocks, then compress each block and write to file, store index entries in block table.
-     * @param rows_buffer Rows buffer to be flushed.
+     * @param rows_buffer Rows buffer to be flushed, a row-major arena of row_size columns per row.
+     * @param row_size Count of columns per row.
      * @param block_width Width of each block.
      * @param actual_block_height Height of each block.
      * @param block_table Block table to store index entries.
@@ -22,19 +56,32 @@ namespace biomxt
      * @param block Block buffer to store compressed data.
      * @param compress_buffer Compress buffer to store compressed data.
      * @param algo Compression algorithm to be used.
-     * @throws `std::invalid_argument` If rows_buffer is empty.
+     * @param filter Filter applied to each block before compression.
+     * @param sparse_threshold Max density of nonzeros of a block stored sparse, 0 to store every block dense.
+     * @param integer_codec Codec of integer blocks, ignored for floats. Blocks start with their encoding if `has_block_encoding`, so the file must be flagged `HAS_BLOCK_ENCODING`.
+     * @param policy Adaptive codec policy. If adaptive, blocks start with their codec, so the file must be flagged `HAS_BLOCK_CODEC`.
+     * @param frame_height Rows per frame of a block, columns if column-major, 0 to compress blocks whole. Framed blocks need the file flagged `HAS_BLOCK_FRAMES`.
+     * @param column_major Store cells of each block column by column, so the file must be flagged `COLUMN_MAJOR_BLOCKS`.
+     * @throws `std::invalid_argument` If rows_buffer is smaller than its rows.
      * @throws `std::invalid_argument` If compress algo is not supported.
      * @throws `std::runtime_error` If compression fails.
      */
     template <typename T> void flush_rows_buffer(
-        const std::vector<std::vector<T>>& rows_buffer, 
+        const std::vector<T>& rows_buffer, 
+        uint32_t row_size,
         uint32_t block_width, 
         uint32_t actual_block_height,
         std::vector<biomxt::IndexEntry>& block_table,
         std::ofstream& out,
         std::vector<T>& block,
         std::vector<char>& compress_buffer,
-        biomxt::CompressAlgorithm algo);
+        biomxt::CompressAlgorithm algo,
+        biomxt::BlockFilter filter = biomxt::BlockFilter::NONE,
+        float sparse_threshold = 0,
+        biomxt::IntegerCodec integer_codec = biomxt::IntegerCodec::NONE,
+        const biomxt::CodecPolicy& policy = {},
+        uint16_t frame_height = 0,
+        bool column_major = false);
 
     /**
      * @brief Convert a csv file to biomxt format.
@@ -58,4 +105,93 @@ namespace biomxt
         biomxt::CompressAlgorithm algo,
         std::vector<std::string>& warnings);
 
+    /**
+     * @brief Convert a csv file to biomxt format, with a multithreaded compression pipeline.
+     * @param input_file Path to input csv file.
+     * @param output_file Path to output biomxt file.
+     * @param options Conversion options.
+     * @param warnings A vector to store warnings.
+     * @return `biomxt::FileHeader` File header of output biomxt file.
+     * @throws `std::invalid_argument` If block width or height is not greater than 0.
+     * @throws `std::runtime_error` If conversion fails.
+     * @note Input is memory-mapped and split into chunks at record boundaries, chunks are parsed in parallel and reassembled in order into block rows.
+     * @note Gzip or zstd compressed input, detected by magic number or extension, is decompressed on its own thread and chunked as it streams in, without a temporary file.
+     * @note With `checkpoint_interval`, a sidecar `<output>.ckpt` records written block rows about every interval of input. With `resume`, conversion continues after the last complete block row of the sidecar, which is removed on success.
+     * @note Block rows are handed to `biomxt::BlockPipeline` to be compressed and written in order.
+     */
+    template <typename T>biomxt::FileHeader csv_to_bmxt(
+        const std::string& input_file, 
+        const std::string& output_file, 
+        const biomxt::ConvertOptions& options,
+        std::vector<std::string>& warnings);
+
+    /**
+     * @brief Convert a Matrix Market coordinate file (e.g. 10x `matrix.mtx`) to biomxt format, without densifying the whole matrix.
+     * @param matrix_file Path to input mtx file.
+     * @param features_file Path to row names file (e.g. 10x `features.tsv`), first column is used. Empty to name rows by 1-based index.
+     * @param barcodes_file Path to column names file (e.g. 10x `barcodes.tsv`), first column is used. Empty to name columns by 1-based index.
+     * @param output_file Path to output biomxt file.
+     * @param options Conversion options, `separator`, `parse_threads` and `chunk_size` are not used.
+     * @param warnings A vector to store warnings.
+     * @return `biomxt::FileHeader` File header of output biomxt file.
+     * @throws `std::invalid_argument` If block width or height is not greater than 0.
+     * @throws `std::runtime_error` If input is malformed, or conversion fails.
+     * @note Entries are bucketed by block row, buckets are spilled to `<output_file>.spill.<uuid>/`, with the UUID of the output file, once they exceed `options.memory_budget`.
+     * @note Block rows are then compressed by a `BlockPipeline`, whose workers densify one block at a time, so memory is bounded by the budget plus the entries of `options.max_inflight_block_rows` block rows.
+     */
+    template <typename T>biomxt::FileHeader mtx_to_bmxt(
+        const std::string& matrix_file,
+        const std::string& features_file,
+        const std::string& barcodes_file,
+        const std::string& output_file,
+        const biomxt::ConvertOptions& options,
+        std::vector<std::string>& warnings);
+
+    /**
+     * @brief Convert a 2-D `.npy` array to biomxt format, without parsing.
+     * @param input_file Path to input npy file, C or Fortran order, element type must match T.
+     * @param rownames_file Path to row names file, one name per line (first tab-separated column). Empty to name rows by 1-based index.
+     * @param colnames_file Path to column names file, one name per line (first tab-separated column). Empty to name columns by 1-based index.
+     * @param output_file Path to output biomxt file.
+     * @param options Conversion options, `separator`, `parse_threads`, `chunk_size`, `memory_budget` and `transpose` are not used.
+     * @param warnings A vector to store warnings.
+     * @return `biomxt::FileHeader` File header of output biomxt file.
+     * @throws `std::invalid_argument` If block width or height is not greater than 0.
+     * @throws `std::runtime_error` If input is not a matching npy array, names count mismatch, or conversion fails.
+     * @note Input is memory-mapped, block rows are assembled by compression workers straight from the mapping.
+     */
+    template <typename T>biomxt::FileHeader npy_to_bmxt(
+        const std::string& input_file,
+        const std::string& rownames_file,
+        const std::string& colnames_file,
+        const std::string& output_file,
+        const biomxt::ConvertOptions& options,
+        std::vector<std::string>& warnings);
+
+    /**
+     * @brief Convert a raw little-endian array of T to biomxt format, without parsing.
+     * @param input_file Path to input raw file, exactly nrow*ncol elements.
+     * @param nrow Count of rows.
+     * @param ncol Count of columns.
+     * @param fortran_order Whether the array is column-major.
+     * @param rownames_file Path to row names file, one name per line (first tab-separated column). Empty to name rows by 1-based index.
+     * @param colnames_file Path to column names file, one name per line (first tab-separated column). Empty to name columns by 1-based index.
+     * @param output_file Path to output biomxt file.
+     * @param options Conversion options, `separator`, `parse_threads`, `chunk_size`, `memory_budget` and `transpose` are not used.
+     * @param warnings A vector to store warnings.
+     * @return `biomxt::FileHeader` File header of output biomxt file.
+     * @throws `std::invalid_argument` If block width or height is not greater than 0.
+     * @throws `std::runtime_error` If file size does not match the shape, names count mismatch, or conversion fails.
+     */
+    template <typename T>biomxt::FileHeader raw_to_bmxt(
+        const std::string& input_file,
+        uint32_t nrow,
+        uint32_t ncol,
+        bool fortran_order,
+        const std::string& rownames_file,
+        const std::string& colnames_file,
+        const std::string& output_file,
+        const biomxt::ConvertOptions& options,
+        std::vector<std::string>& warnings);
+
 } // namespace biomxt
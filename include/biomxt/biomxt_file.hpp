@@ -9,13 +9,22 @@
 #include <algorithm>
 #include <list>
 #include <memory>
+#include <thread>
+#include <atomic>
+#include <future>
 #include "./cache/block_cache.hpp"
+#include "./cache/disk_block_cache.hpp"
 #include "./struct/cells.hpp"
 #include "./struct/file_header.hpp"
 #include "./struct/compress_algorithm.hpp"
 #include "./struct/uuid.hpp"
 #include "./struct/data_type.hpp"
 #include "./struct/index_entry.hpp"
+#include "./struct/access_hint.hpp"
+#include "./utils/block_codec.hpp"
+#include "./utils/expand_float.hpp"
+#include "./utils/fast_divisor.hpp"
+#include "./utils/sparse_block.hpp"
 
 
 namespace biomxt {
@@ -82,8 +91,21 @@ namespace biomxt {
              * @throws std::out_of_range            If block index exceeds block count
              * @throws std::runtime_error           If compress failed
              * @throws std::runtime_error           If read data from file failed
+             * @note                                Cells are row-major inside the block, column-major if the file is flagged `COLUMN_MAJOR_BLOCKS`
              */
-            void read_block(uint32_t index, std::vector<char>& buffer);
+            void read_block(uint64_t index, std::vector<char>& buffer);
+
+            /**
+             * @brief                               Read a block from file, with access hint of this call
+             * 
+             * @param index                         The block index to read
+             * @param buffer                        The buffer to store decompressed data
+             * @param hint                          Access hint flags, overrides the handle's hint
+             * @throws std::runtime_error           If file is closed
+             * @throws std::out_of_range            If block index exceeds block count
+             * @throws std::runtime_error           If decompress or read failed
+             */
+            void read_block(uint64_t index, std::vector<char>& buffer, AccessHint hint);
 
             /**
              * @brief                               Read a row from file
@@ -93,7 +115,21 @@ namespace biomxt {
              * @throws std::runtime_error           If file is closed
              * @throws std::out_of_range            If row index exceeds row count
              */
-            void read_row_data(uint32_t row_index, std::vector<char>& buffer);
+            void read_row_data(uint64_t row_index, std::vector<char>& buffer);
+
+            /**
+             * @brief                               Read a row from file, with access hint of this call
+             * 
+             * @param row_index                     The row index to read
+             * @param buffer                        The buffer to store read data
+             * @param hint                          Access hint flags, overrides the handle's hint
+             * @note                                With `RANDOM` or `NOCACHE` on a file flagged `HAS_BLOCK_FRAMES` with row-major blocks, blocks missing from
+             *                                      block cache only unpack the frame holding the row, and neither the frame nor the block enters block cache.
+             *                                      Other hints, or the other layout, unpack and cache whole blocks.
+             * @throws std::runtime_error           If file is closed
+             * @throws std::out_of_range            If row index exceeds row count
+             */
+            void read_row_data(uint64_t row_index, std::vector<char>& buffer, AccessHint hint);
 
             /**
              * @brief                               Read a row from file
@@ -117,7 +153,7 @@ namespace biomxt {
              * @throws std::out_of_range            If row index exceeds row count
              * @note                                The function func must accept a biomxt::Cells object as parameter.
              */
-            template <typename F> auto read_row(uint32_t row_index, F&& func) {
+            template <typename F> auto read_row(uint64_t row_index, F&& func) {
                 std::vector<char> buffer(_header.ncol * biomxt::size_of_dtype(_header.dtype));
                 biomxt::BiomxtFile::read_row_data(row_index, buffer);
                 switch (_header.dtype) {
@@ -131,6 +167,14 @@ namespace biomxt {
                         return func(biomxt::Cells<float>(buffer));
                     case biomxt::DataType::FLOAT64:
                         return func(biomxt::Cells<double>(buffer));
+                    case biomxt::DataType::UINT8:
+                        return func(biomxt::Cells<uint8_t>(buffer));
+                    case biomxt::DataType::UINT16:
+                        return func(biomxt::Cells<uint16_t>(buffer));
+                    case biomxt::DataType::FLOAT16:
+                        return func(biomxt::Cells<biomxt::float16>(buffer));
+                    case biomxt::DataType::BFLOAT16:
+                        return func(biomxt::Cells<biomxt::bfloat16>(buffer));
                     default:
                         throw std::invalid_argument("biomxt::BiomxtFile::read_row: unsupported data type [" + std::to_string(_header.dtype) + "]");
                 }
@@ -144,7 +188,21 @@ namespace biomxt {
              * @throws std::runtime_error           If file is closed
              * @throws std::out_of_range            If column index exceeds column count
              */
-            void read_column_data(uint32_t column_index, std::vector<char>& buffer);
+            void read_column_data(uint64_t column_index, std::vector<char>& buffer);
+
+            /**
+             * @brief                               Read a column from file, with access hint of this call
+             * 
+             * @param column_index                  The column index to read
+             * @param buffer                        The buffer to store read data
+             * @param hint                          Access hint flags, overrides the handle's hint
+             * @note                                With `RANDOM` or `NOCACHE` on a file flagged `HAS_BLOCK_FRAMES` with column-major blocks, blocks missing from
+             *                                      block cache only unpack the frame holding the column, and neither the frame nor the block enters block cache.
+             *                                      Other hints, or the other layout, unpack and cache whole blocks.
+             * @throws std::runtime_error           If file is closed
+             * @throws std::out_of_range            If column index exceeds column count
+             */
+            void read_column_data(uint64_t column_index, std::vector<char>& buffer, AccessHint hint);
 
             /**
              * @brief                               Read a column from file
@@ -157,6 +215,170 @@ namespace biomxt {
              */
             void read_column_data(std::string column_name, std::vector<char>& buffer);
 
+            /**
+             * @brief                               Read nonzero cells of a row from file
+             * 
+             * @param row_index                     The row index to read
+             * @param column_indices                The buffer to store column indices of nonzero cells, ascending
+             * @param values                        The buffer to store nonzero cells, packed in the same order
+             * @throws std::runtime_error           If file is closed
+             * @throws std::out_of_range            If row index exceeds row count
+             * @note                                Sparse blocks, or frames, missing from block cache hand out their nonzeros straight from their bitmap and are
+             *                                      not cached. Other blocks are decoded to dense first, and cached as by `read_block` unless framed.
+             */
+            void read_row_sparse(uint64_t row_index, std::vector<uint32_t>& column_indices, std::vector<char>& values);
+
+            /**
+             * @brief                               Read nonzero cells of a column from file
+             * 
+             * @param column_index                  The column index to read
+             * @param row_indices                   The buffer to store row indices of nonzero cells, ascending
+             * @param values                        The buffer to store nonzero cells, packed in the same order
+             * @throws std::runtime_error           If file is closed
+             * @throws std::out_of_range            If column index exceeds column count
+             * @note                                Sparse blocks, or frames, missing from block cache hand out their nonzeros straight from their bitmap and are
+             *                                      not cached. Other blocks are decoded to dense first, and cached as by `read_block` unless framed.
+             */
+            void read_column_sparse(uint64_t column_index, std::vector<uint32_t>& row_indices, std::vector<char>& values);
+
+            /**
+             * @brief                               Read a row from file, expanded to float whatever the stored data type
+             * 
+             * @param row_index                     The row index to read
+             * @param values                        The buffer to store column count floats
+             * @throws std::runtime_error           If file is closed
+             * @throws std::out_of_range            If row index exceeds row count
+             * @note                                Meant for reduced storage types, float16 and bfloat16 expand with F16C and SSE2 where available.
+             */
+            void read_row_float(uint64_t row_index, std::vector<float>& values);
+
+            /**
+             * @brief                               Read a column from file, expanded to float whatever the stored data type
+             * 
+             * @param column_index                  The column index to read
+             * @param values                        The buffer to store row count floats
+             * @throws std::runtime_error           If file is closed
+             * @throws std::out_of_range            If column index exceeds column count
+             */
+            void read_column_float(uint64_t column_index, std::vector<float>& values);
+
+            /**
+             * @brief                               Preload blocks into the cache in parallel.
+             * 
+             * @param block_indices                 The block indices to preload, duplicates are ignored
+             * @param pin                           Pin the blocks so that LRU never evicts them
+             * @param threads                       Worker threads, 0 for hardware concurrency
+             * @return size_t                       Count of requested blocks resident in cache after warm-up
+             * @throws std::runtime_error           If file is closed
+             * @throws std::out_of_range            If any block index exceeds block count
+             * @note                                Each worker opens its own file stream, the handle's stream is untouched.
+             * @note                                Pinned blocks take at most half of the cache, resident blocks beyond it stay unpinned.
+             */
+            size_t warm_blocks(const std::vector<uint64_t>& block_indices, bool pin = false, uint32_t threads = 0);
+
+            /**
+             * @brief                               Preload all blocks covering the given rows.
+             * 
+             * @param row_indices                   The row indices to preload
+             * @param pin                           Pin the blocks so that LRU never evicts them
+             * @param threads                       Worker threads, 0 for hardware concurrency
+             * @return size_t                       Count of blocks resident in cache after warm-up
+             * @throws std::runtime_error           If file is closed
+             * @throws std::out_of_range            If any row index exceeds row count
+             */
+            size_t warm_rows(const std::vector<uint64_t>& row_indices, bool pin = false, uint32_t threads = 0);
+
+            /**
+             * @brief                               Preload all blocks covering the given columns.
+             * 
+             * @param column_indices                The column indices to preload
+             * @param pin                           Pin the blocks so that LRU never evicts them
+             * @param threads                       Worker threads, 0 for hardware concurrency
+             * @return size_t                       Count of blocks resident in cache after warm-up
+             * @throws std::runtime_error           If file is closed
+             * @throws std::out_of_range            If any column index exceeds column count
+             */
+            size_t warm_columns(const std::vector<uint64_t>& column_indices, bool pin = false, uint32_t threads = 0);
+
+            /**
+             * @brief                               Preload all blocks covering a rectangular region.
+             * 
+             * @param row_begin                     First row of the region
+             * @param row_end                       Row after the last row of the region
+             * @param column_begin                  First column of the region
+             * @param column_end                    Column after the last column of the region
+             * @param pin                           Pin the blocks so that LRU never evicts them
+             * @param threads                       Worker threads, 0 for hardware concurrency
+             * @return size_t                       Count of blocks resident in cache after warm-up
+             * @throws std::runtime_error           If file is closed
+             * @throws std::out_of_range            If the region exceeds matrix size
+             */
+            size_t warm_region(uint64_t row_begin, uint64_t row_end, uint64_t column_begin, uint64_t column_end, bool pin = false, uint32_t threads = 0);
+
+            /**
+             * @brief                               Unpin blocks of this file, they become normal LRU entries.
+             * 
+             * @param block_indices                 The block indices to unpin
+             */
+            void unpin_blocks(const std::vector<uint64_t>& block_indices);
+
+            /**
+             * @brief                               Load blocks into the cache in background, the cache level `WILLNEED`.
+             * 
+             * @param block_indices                 The block indices to prefetch
+             * @param threads                       Worker threads, 0 for hardware concurrency
+             * @return std::future<size_t>          Count of blocks resident in cache, rethrows errors of the background task
+             * @throws std::runtime_error           If file is closed
+             * @throws std::out_of_range            If any block index exceeds block count
+             * @note                                The handle must outlive the returned future.
+             */
+            std::future<size_t> prefetch_blocks(const std::vector<uint64_t>& block_indices, uint32_t threads = 1);
+
+            /**
+             * @brief                               Set the access hint of this handle, used by reads without a hint.
+             * 
+             * @param hint                          Access hint flags
+             * @note                                `RANDOM` and `SEQUENTIAL` also set the OS readahead policy of the file.
+             */
+            void set_access_hint(AccessHint hint);
+
+            /**
+             * @brief                               Get the access hint of this handle.
+             * 
+             * @return AccessHint                   Access hint flags
+             */
+            AccessHint get_access_hint() const;
+
+            /**
+             * @brief                               Save keys of the resident blocks of the block cache to a snapshot file.
+             * 
+             * @param path                          The snapshot file path
+             * @param with_payload                  Also save decompressed block data, e.g. to local SSD
+             * @return size_t                       Count of blocks saved
+             * @throws std::runtime_error           If the snapshot file cannot be written
+             * @note                                A shared block cache saves blocks of all files using it.
+             */
+            size_t save_cache_snapshot(const std::string& path, bool with_payload = false) const;
+
+            /**
+             * @brief                               Reload the blocks of this file saved in a snapshot file, in background.
+             * 
+             * @param path                          The snapshot file path
+             * @param threads                       Worker threads for blocks saved without payload, 0 for hardware concurrency
+             * @return std::future<size_t>          Count of blocks restored, rethrows errors of the background task
+             * @throws std::runtime_error           If file is closed
+             * @note                                Blocks are matched by file UUID, the handle must outlive the returned future.
+             */
+            std::future<size_t> restore_cache_snapshot(const std::string& path, uint32_t threads = 0);
+
+            /**
+             * @brief                               Set the on-disk secondary cache of compressed blocks, checked before reading from file.
+             * 
+             * @param disk_cache                    The disk cache, e.g. on local SSD, or nullptr to disable it. Not owned.
+             * @note                                Useful when the file lives on NFS or other slow network storage.
+             */
+            void set_disk_cache(DiskBlockCache* disk_cache);
+
             /**
              * @brief Get row names
              * 
@@ -173,7 +395,7 @@ namespace biomxt {
              * @throws std::runtime_error If the file has been closed.
              * @throws std::runtime_error If any index is out of range.
              */
-            std::vector<std::string> get_row_names(const std::vector<uint32_t>& row_indices) const;
+            std::vector<std::string> get_row_names(const std::vector<uint64_t>& row_indices) const;
 
             /**
              * @brief Get column names
@@ -191,27 +413,27 @@ namespace biomxt {
              * @throws std::runtime_error If the file has been closed.
              * @throws std::runtime_error If any index is out of range.
              */
-            std::vector<std::string> get_column_names(const std::vector<uint32_t>& column_indices) const;
+            std::vector<std::string> get_column_names(const std::vector<uint64_t>& column_indices) const;
             
             /**
              * @brief Get row indices for given names
              * 
              * @param row_names Row names
-             * @return std::vector<uint32_t> Row indices
+             * @return std::vector<uint64_t> Row indices
              * @throws std::runtime_error If the file has been closed.
              * @throws std::runtime_error If any name is not found.
              */
-            std::vector<uint32_t> get_row_indices(const std::vector<std::string>& row_names) const;
+            std::vector<uint64_t> get_row_indices(const std::vector<std::string>& row_names) const;
             
             /**
              * @brief Get column indices for given names
              * 
              * @param column_names Column names
-             * @return std::vector<uint32_t> Column indices
+             * @return std::vector<uint64_t> Column indices
              * @throws std::runtime_error If the file has been closed.
              * @throws std::runtime_error If any name is not found.
              */
-            std::vector<uint32_t> get_column_indices(const std::vector<std::string>& column_names) const;
+            std::vector<uint64_t> get_column_indices(const std::vector<std::string>& column_names) const;
             
             /**
              * @brief Get the file header.
@@ -248,17 +470,138 @@ namespace biomxt {
             uint32_t get_block_cache_memory_limit() const;
 
         private:
+            std::string _path;
             std::ifstream _ifile;
+            int _fd = -1;
+            AccessHint _access_hint = AccessHint::NORMAL;
+            // Blocks advised to OS after a sequential miss
+            static constexpr uint32_t _readahead_blocks = 8;
             FileHeader _header;
+            size_t _header_size = 0;                                            ///< Size of header on disk, by format version.
+            biomxt::FastDivisor _row_divisor;                                   ///< Block height, divides row indices into block rows.
+            biomxt::FastDivisor _column_divisor;                                ///< Block width, divides column indices into block columns.
+            uint64_t _block_columns = 0;                                        ///< Count of blocks in horizontal direction.
             std::vector<IndexEntry> _block_table;
+            std::unique_ptr<biomxt::BlockDictionary> _dictionary = nullptr;    ///< Dictionary of all blocks, if the file has one.
             std::vector<std::string> _row_names;
             std::vector<std::string> _column_names;
-            std::unordered_map<std::string, uint32_t> _row_map;
-            std::unordered_map<std::string, uint32_t> _column_map;
+            std::unordered_map<std::string, uint64_t> _row_map;
+            std::unordered_map<std::string, uint64_t> _column_map;
             uint32_t _max_compressed_block_size = 0;
             uint32_t _max_uncompressed_block_size = 0;
             std::unique_ptr<biomxt::BlockCache> _owned_block_cache = nullptr;
             BlockCache* _block_cache = nullptr;
+            DiskBlockCache* _disk_cache = nullptr;
+
+            /**
+             * @brief Read a block from given stream and decompress it, cache is not involved.
+             * 
+             * @param index The block index to read, must be in range.
+             * @param ifile The file stream to read from.
+             * @param compressed_buffer Buffer to store compressed data.
+             * @param buffer Buffer to store decompressed data.
+             * @throws std::runtime_error If read or decompress failed.
+             */
+            void _load_block(uint64_t index, std::ifstream& ifile, std::vector<char>& compressed_buffer, std::vector<char>& buffer) const;
+
+            /**
+             * @brief Read a block as stored in file, from disk cache if any, else from given stream then into disk cache.
+             * 
+             * @param index The block index to read, must be in range.
+             * @param ifile The file stream to read from, where pread is unavailable.
+             * @param compressed_buffer Buffer to store compressed data, grown if needed.
+             * @throws std::runtime_error If read failed.
+             */
+            void _read_compressed_block(uint64_t index, std::ifstream& ifile, std::vector<char>& compressed_buffer) const;
+
+            /**
+             * @brief Read a byte range of the file, with pread where available, else from given stream.
+             * 
+             * @param offset Offset of the range in file.
+             * @param size Size of the range in bytes.
+             * @param ifile The file stream to read from, where pread is unavailable.
+             * @param dst Receives the range, `size` bytes.
+             * @return bool True if the whole range was read.
+             */
+            bool _read_range(uint64_t offset, size_t size, std::ifstream& ifile, char* dst) const;
+
+            /**
+             * @brief Append nonzero cells of a block along one line, or at one position across every line, without decoding sparse blocks to dense.
+             * 
+             * @param index The block index, must be in range.
+             * @param position The line inner block if along, else the cell inner every line.
+             * @param along Read line `position`, or cell `position` of every line.
+             * @param index_base Index in the row or column of the first cell read.
+             * @param indices Receives indices of nonzero cells, appended in ascending order.
+             * @param values Receives nonzero cells packed, appended in the same order.
+             * @throws std::runtime_error If read or decompress failed.
+             */
+            void _gather_block_sparse(uint64_t index, uint64_t position, bool along, uint32_t index_base, std::vector<uint32_t>& indices, std::vector<char>& values);
+
+            /**
+             * @brief Get the size of a line of a block, i.e. a row, or a column of column-major blocks.
+             * 
+             * @param index The block index, must be in range.
+             * @return size_t Size of a block line in bytes.
+             */
+            size_t _block_line_size(uint64_t index) const;
+
+            /**
+             * @brief Read one line of a block of a framed file, from block cache or by unpacking only the frame holding it, which is not cached.
+             * 
+             * Without disk cache only the two frame ends needed from the frame index and the bytes of the frame are read from file,
+             * with disk cache the whole stored block is read so that the disk cache gets it.
+             * 
+             * @param index The block index, must be in range.
+             * @param line The row inner block, or column of column-major blocks.
+             * @param dst Receives the line, `_block_line_size(index)` bytes.
+             * @param frame_buffer Scratch for the frame, grown if needed.
+             * @param hint Access hint flags, `NOCACHE` drops file pages after read.
+             * @throws std::runtime_error If read or decompress failed.
+             */
+            void _read_block_line(uint64_t index, uint64_t line, char* dst, std::vector<char>& frame_buffer, AccessHint hint);
+
+            /**
+             * @brief Pass an advice about a byte range of the file to the OS, no-op where `posix_fadvise` is missing.
+             * 
+             * @param offset Offset of the range.
+             * @param size Size of the range, 0 means until end of file.
+             * @param hint The access hint to advise.
+             */
+            void _advise(uint64_t offset, uint64_t size, AccessHint hint) const;
+
+            /**
+             * @brief Advise the OS that a list of blocks will be needed soon.
+             * 
+             * @param first First block index.
+             * @param last Last block index, inclusive.
+             * @param step Step between block indices.
+             */
+            void _advise_blocks(uint64_t first, uint64_t last, uint64_t step) const;
+
+            /**
+             * @brief Load blocks into cache on worker threads.
+             * 
+             * @param indices Sorted, unique and in range block indices.
+             * @param pin Pin the blocks.
+             * @param threads Worker threads, 0 for hardware concurrency.
+             * @return size_t Count of blocks resident in cache after warm-up.
+             */
+            size_t _warm_blocks(const std::vector<uint64_t>& indices, bool pin, uint32_t threads);
+
+            /**
+             * @brief Collect sorted, unique block indices covering the given rows and columns ranges.
+             * 
+             * @param block_rows Block row positions.
+             * @param block_columns Block column positions.
+             * @return std::vector<uint64_t> Block indices.
+             */
+            std::vector<uint64_t> _collect_blocks(const std::vector<uint64_t>& block_rows, const std::vector<uint64_t>& block_columns) const;
+
+            /**
+             * @brief Close the file descriptor used for block reads.
+             */
+            void _close_fd();
 
             /**
              * @brief Close the file stream, clear data and release memory.
@@ -266,10 +609,12 @@ namespace biomxt {
             void _release_resources() {
                 // Close the file if it is open
                 if (_ifile.is_open()) _ifile.close();
+                _close_fd();
                 
                 // Clear the chunk table and release memory
                 _block_table.clear();
                 _block_table.shrink_to_fit();
+                _dictionary.reset();
                 
                 // Clear row and column names and release memory
                 _row_names.clear();
@@ -280,8 +625,8 @@ namespace biomxt {
                 _column_names.shrink_to_fit();
 
                 // Release memory of mapping of row and column names by swapping with empty maps
-                std::unordered_map<std::string, uint32_t>().swap(_row_map);
-                std::unordered_map<std::string, uint32_t>().swap(_column_map);
+                std::unordered_map<std::string, uint64_t>().swap(_row_map);
+                std::unordered_map<std::string, uint64_t>().swap(_column_map);
             }
     };
 }
@@ -0,0 +1,155 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <fstream>
+#include "biomxt/struct/file_header.hpp"
+#include "biomxt/struct/index_entry.hpp"
+#include "biomxt/struct/convert_options.hpp"
+#include "biomxt/struct/convert_checkpoint.hpp"
+#include "biomxt/utils/block_pipeline.hpp"
+
+
+namespace biomxt {
+
+    /**
+     * @brief Streaming writer of biomxt files from memory.
+     * @note Rows are buffered into strips of block_height rows, then compressed and written by `biomxt::BlockPipeline`, the same path as the converters.
+     * @note Nothing valid is on disk until `finish` writes names, tables and the header.
+     */
+    template <typename T> class BiomxtWriter {
+        public:
+            /**
+             * @brief Create output file and start the compression pipeline.
+             * @param output_file Path to output biomxt file.
+             * @param colnames Column names, which fix the count of values per row.
+             * @param options Conversion options, `block_width`, `block_height`, `algo`, `filter`, `dictionary_size`, `sparse_threshold`, `integer_codec`, `policy`, `frame_height`, `column_major`, `threads` and `max_inflight_block_rows` are used.
+             * @throws `std::invalid_argument` If block width or height is not greater than 0.
+             * @throws `std::runtime_error` If output file cannot be opened.
+             */
+            BiomxtWriter(
+                const std::string& output_file,
+                std::vector<std::string> colnames,
+                const biomxt::ConvertOptions& options = biomxt::ConvertOptions());
+
+            /**
+             * @brief Reopen an interrupted output file, and continue after the last block row of a checkpoint.
+             * @param output_file Path to output biomxt file, data beyond the checkpoint is dropped.
+             * @param checkpoint Checkpoint taken by `checkpoint`, its data type, compression, dictionary and block size are used.
+             * @param options Conversion options, `threads` and `max_inflight_block_rows` are used.
+             * @throws `std::invalid_argument` If data type of checkpoint mismatch T.
+             * @throws `std::runtime_error` If output file cannot be opened, is shorter than the checkpoint, or its dictionary cannot be read.
+             */
+            BiomxtWriter(
+                const std::string& output_file,
+                const biomxt::ConvertCheckpoint& checkpoint,
+                const biomxt::ConvertOptions& options = biomxt::ConvertOptions());
+
+            /**
+             * @brief Stop the pipeline, an unfinished file is left incomplete.
+             */
+            ~BiomxtWriter();
+
+            BiomxtWriter(const BiomxtWriter&) = delete;
+            BiomxtWriter& operator=(const BiomxtWriter&) = delete;
+
+            /**
+             * @brief Append a row.
+             * @param rowname Name of the row.
+             * @param values Values of the row, one per column.
+             * @throws `std::runtime_error` If writer is finished, or compression fails.
+             */
+            void write_row(std::string rowname, const T* values);
+
+            /**
+             * @brief Append a row.
+             * @param rowname Name of the row.
+             * @param values Values of the row.
+             * @throws `std::invalid_argument` If count of values mismatch count of columns.
+             * @throws `std::runtime_error` If writer is finished, or compression fails.
+             */
+            void write_row(std::string rowname, const std::vector<T>& values);
+
+            /**
+             * @brief Append a batch of rows.
+             * @param rownames Names of the rows, moved into the writer.
+             * @param values Values of the rows, row-major, rownames.size() rows of one value per column.
+             * @throws `std::runtime_error` If writer is finished, or compression fails.
+             */
+            void write_rows(std::vector<std::string>&& rownames, const T* values);
+
+            /**
+             * @brief Append a batch of rows.
+             * @param rownames Names of the rows.
+             * @param values Values of the rows, row-major, rownames.size() rows of one value per column.
+             * @throws `std::runtime_error` If writer is finished, or compression fails.
+             */
+            void write_rows(const std::vector<std::string>& rownames, const T* values);
+
+            /**
+             * @brief Wait for complete block rows to be written and synced to disk, and record them in a checkpoint.
+             * @param checkpoint Receives output state, with only rows and blocks added since the previous checkpoint, input fields are left to the caller.
+             * @return `uint64_t` Count of rows in the checkpoint, rows buffered after the last complete block row are not included.
+             * @throws `std::runtime_error` If writer is finished, or writing fails.
+             */
+            uint64_t checkpoint(biomxt::ConvertCheckpoint& checkpoint);
+
+            /**
+             * @brief Wait for all rows to be written, then write names, tables and header, and close the file.
+             * @return `biomxt::FileHeader` File header of output biomxt file.
+             * @throws `std::runtime_error` If writer is finished, or writing fails.
+             */
+            biomxt::FileHeader finish();
+
+            /**
+             * @brief Get count of rows written so far.
+             * @return `uint64_t` Count of rows.
+             */
+            uint64_t get_row_count() const;
+
+            /**
+             * @brief Get count of columns.
+             * @return `uint64_t` Count of columns.
+             */
+            uint64_t get_column_count() const;
+
+            /**
+             * @brief Check if writer is finished.
+             * @return `bool` True if `finish` was called.
+             */
+            bool is_finished() const;
+
+        private:
+            std::string _output_file;
+            std::ofstream _out;
+            biomxt::FileHeader _header;
+            uint32_t _block_height;
+            float _sparse_threshold;
+            biomxt::IntegerCodec _integer_codec;
+            biomxt::CodecPolicy _policy;
+            std::vector<std::string> _rownames;
+            std::vector<std::string> _colnames;
+            std::vector<T> _rows_buffer;
+            uint32_t _actual_block_height = 0;
+            std::vector<biomxt::IndexEntry> _resumed_blocks;     ///< Blocks written before resuming.
+            uint64_t _checkpoint_rows = 0;                      ///< Rows recorded by checkpoints so far.
+            uint64_t _checkpoint_blocks = 0;                    ///< Blocks recorded by checkpoints so far.
+            std::unique_ptr<biomxt::BlockPipeline<T>> _pipeline;
+            bool _finished = false;
+
+            /**
+             * @brief Copy rows into strips, pushing each full strip to the pipeline.
+             * @param values Values of the rows, row-major.
+             * @param count Count of rows.
+             */
+            void _append(const T* values, size_t count);
+
+            /**
+             * @brief Throw if writer is finished.
+             * @param method Name of calling method, for the error message.
+             */
+            void _check_open(const char* method) const;
+    };
+
+} // namespace biomxt
@@ -6,6 +6,10 @@
 #include <list>
 #include <unordered_map>
 #include <iostream>
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+#include <stdexcept>
 #include "./cache_entry.hpp"
 
 
@@ -16,24 +20,30 @@ namespace biomxt {
             
             // LRU cache list and map
             std::list<CacheEntry> _block_cache_list;
-            // Map between block key <-> list iterator
+            // Pinned entries, never evicted by LRU. Iterators stay valid when spliced between lists.
+            std::list<CacheEntry> _pinned_list;
+            // Map between block key <-> list iterator (in LRU list or pinned list)
             std::unordered_map<BlockKey, std::list<CacheEntry>::iterator, BlockKeyHash> _map;
 
             // RAM used counts
             size_t _memory_used = 0;
 
+            // RAM used by pinned entries
+            size_t _memory_pinned = 0;
+
             // Max RAM limit, default 128MB
             size_t _memory_limit = 1024 * 1024 * 128;
 
         public:
             BlockCache() = default;
-            ~BlockCache() = default;
+            virtual ~BlockCache() = default;
+
             /**
              * @brief Get the memory limit of the cache.
              * 
              * @return size_t The memory limit in bytes.
              */
-            size_t get_memory_limit() const {
+            virtual size_t get_memory_limit() const {
                 std::shared_lock lock(_mutex);
                 return _memory_limit;
             }
@@ -44,7 +54,7 @@ namespace biomxt {
              * @param bytes The memory limit in bytes.
              * @note The cache will evict entries immediately after setting new limit.
              */
-            void set_memory_limit(size_t bytes) {
+            virtual void set_memory_limit(size_t bytes) {
                 std::unique_lock lock(_mutex);
                 _memory_limit = bytes;
                 // Evict entries immediately after setting new limit
@@ -56,41 +66,123 @@ namespace biomxt {
              * 
              * @return size_t The memory used by the cache in bytes.
              */
-            size_t get_memory_used() const {
+            virtual size_t get_memory_used() const {
                 std::shared_lock lock(_mutex);
                 return _memory_used;
             }
 
+            /**
+             * @brief Get the memory used by pinned entries.
+             * 
+             * @return size_t The memory used by pinned entries in bytes.
+             */
+            virtual size_t get_memory_pinned() const {
+                std::shared_lock lock(_mutex);
+                return _memory_pinned;
+            }
+
             /**
              * @brief Insert a block into the cache.
              * 
              * @param key The key of the block.
              * @param data The compressed data of the block.
+             * @param pinned Whether to pin the block, pinned blocks are never evicted by LRU.
+             * @param least_recent Insert as the least recently used entry, e.g. for sequential scans. Ignored if pinned.
+             * @return bool True if the block is resident in the cache after insertion.
              * @note The data used as right-value, will be moved into the cache.
+             * @note A pinned block is rejected if pinned blocks would exceed half of the memory limit.
              */
-            void insert(const BlockKey& key, std::vector<char>&& data) {
+            virtual bool insert(const BlockKey& key, std::vector<char>&& data, bool pinned = false, bool least_recent = false) {
                 std::unique_lock lock(_mutex);
 
                 // Ignore if data size exceeds max limit
-                if (data.size() > _memory_limit) return;
+                if (data.size() > _memory_limit) return false;
 
-                // Remove old entry if exists
+                // An old entry of the key is replaced, its memory counts as freed
                 auto it = _map.find(key);
+                size_t freed_pinned = 0;
                 if (it != _map.end()) {
-                    // Update memory used
-                    _memory_used -= it->second->size();    
-                    // Remove old entry from map and list
-                    _map.erase(it);
-                    _block_cache_list.erase(it->second);
+                    // Keep pinned state of old entry
+                    pinned = pinned || it->second->pinned();
+                    if (it->second->pinned()) freed_pinned = it->second->size();
                 }
 
-                // Evict until enough space
-                _evict_until_enough(data.size());
+                // Pinned blocks can only use their share of the memory limit
+                size_t incoming_size = sizeof(BlockKey) + data.capacity();
+                if (pinned && _memory_pinned - freed_pinned + incoming_size > _memory_limit / 2) return false;
+
+                // Give up if pinned entries leave no room, before the old entry is removed
+                if (_memory_pinned - freed_pinned + incoming_size > _memory_limit) return false;
+
+                // Remove old entry, then evict until enough space
+                if (it != _map.end()) _erase(it);
+                _evict_until_enough(incoming_size);
 
                 // Insert entry to cache list, update counter and map.
-                _block_cache_list.emplace_front(key, std::move(data));
-                _memory_used += _block_cache_list.begin()->size();
-                _map[key] = _block_cache_list.begin();
+                std::list<CacheEntry>& target = pinned ? _pinned_list : _block_cache_list;
+                auto entry = (least_recent && !pinned) ? target.emplace(target.end(), key, std::move(data), pinned) : target.emplace(target.begin(), key, std::move(data), pinned);
+                _memory_used += entry->size();
+                if (pinned) _memory_pinned += entry->size();
+                _map[key] = entry;
+                return true;
+            }
+
+            /**
+             * @brief Check whether a block is resident in the cache, without touching LRU order.
+             * 
+             * @param key The key of the block.
+             * @return bool True if the block is in the cache.
+             */
+            virtual bool contains(const BlockKey& key) const {
+                std::shared_lock lock(_mutex);
+                return _map.find(key) != _map.end();
+            }
+
+            /**
+             * @brief Pin a resident block, so that LRU never evicts it.
+             * 
+             * @param key The key of the block.
+             * @return bool True if the block is resident and pinned.
+             * @note A block is not pinned if pinned blocks would exceed half of the memory limit.
+             */
+            virtual bool pin(const BlockKey& key) {
+                std::unique_lock lock(_mutex);
+                auto it = _map.find(key);
+                if (it == _map.end()) return false;
+                if (it->second->pinned()) return true;
+
+                // Pinned blocks can only use their share of the memory limit
+                if (!_pin_fits(it->second->size())) return false;
+
+                // Move entry from LRU list to pinned list
+                it->second->set_pinned(true);
+                _memory_pinned += it->second->size();
+                _pinned_list.splice(_pinned_list.begin(), _block_cache_list, it->second);
+                return true;
+            }
+
+            /**
+             * @brief Unpin a block, it becomes the most recently used entry of LRU list.
+             * 
+             * @param key The key of the block.
+             * @return bool True if the block was pinned.
+             */
+            virtual bool unpin(const BlockKey& key) {
+                std::unique_lock lock(_mutex);
+                auto it = _map.find(key);
+                if (it == _map.end() || !it->second->pinned()) return false;
+                _unpin(it->second);
+                return true;
+            }
+
+            /**
+             * @brief Unpin all pinned blocks.
+             */
+            virtual void unpin_all() {
+                std::unique_lock lock(_mutex);
+                while (!_pinned_list.empty()) {
+                    _unpin(_pinned_list.begin());
+                }
             }
 
             /**
@@ -99,14 +191,16 @@ namespace biomxt {
              * @param key The key of the block.
              * @return const std::vector<char>& The block data.
              */
-            bool get_block_data(const BlockKey& key, std::vector<char>& buffer, size_t offset, size_t size) {
+            virtual bool get_block_data(const BlockKey& key, std::vector<char>& buffer, size_t offset, size_t size) {
                 std::unique_lock lock(_mutex);
                 // Find entry by key
                 auto it = _map.find(key);
                 if (it == _map.end()) return false;
 
-                // Move entry to front (most recently used)
-                _block_cache_list.splice(_block_cache_list.begin(), _block_cache_list, it->second);
+                // Move entry to front (most recently used), pinned entries are not in LRU list
+                if (!it->second->pinned()) {
+                    _block_cache_list.splice(_block_cache_list.begin(), _block_cache_list, it->second);
+                }
                 // Check range 
                 if (offset + size > it->second->data().size()) return false;
                 // Check buffer size
@@ -116,7 +210,250 @@ namespace biomxt {
                 return true;
             }
 
+            /**
+             * @brief Mark a resident block as the most recently used one.
+             * 
+             * @param key The key of the block.
+             * @return bool True if the block is in the cache.
+             */
+            virtual bool touch(const BlockKey& key) {
+                std::unique_lock lock(_mutex);
+                auto it = _map.find(key);
+                if (it == _map.end()) return false;
+                if (!it->second->pinned()) {
+                    _block_cache_list.splice(_block_cache_list.begin(), _block_cache_list, it->second);
+                }
+                return true;
+            }
+
+            /**
+             * @brief Save keys of resident blocks to a snapshot file, pinned blocks first, then from most to least recently used.
+             * 
+             * @param path The snapshot file path.
+             * @param with_payload Also save the decompressed block data, so that restoring needs no decompression.
+             * @return size_t Count of blocks saved.
+             * @throws std::runtime_error If the snapshot file cannot be written.
+             * @note The snapshot is written to a temporary file and renamed, an existing snapshot is never left half-written.
+             */
+            size_t save_snapshot(const std::string& path, bool with_payload = false) const {
+                // Collect keys in recency order, the lock is not held while writing payloads
+                size_t pinned_count = 0;
+                std::vector<BlockKey> keys = _resident_keys(pinned_count);
+
+                std::string tmp_path = path + ".tmp";
+                std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+                if (!out.is_open()) {
+                    throw std::runtime_error("biomxt::BlockCache::save_snapshot: Cannot open snapshot file: " + tmp_path);
+                }
+
+                // Snapshot header, entry count is patched at the end
+                SnapshotHeader header;
+                header.with_payload = with_payload ? 1 : 0;
+                out.write(reinterpret_cast<const char*>(&header), sizeof(SnapshotHeader));
+
+                std::vector<char> payload;
+                for (size_t i = 0; i < keys.size(); ++i) {
+                    const BlockKey& key = keys[i];
+                    SnapshotEntry entry = {{}, key.block_index(), 0, i < pinned_count ? uint8_t(1) : uint8_t(0), {}};
+                    std::memcpy(entry.uuid, key.uuid().data, sizeof(entry.uuid));
+                    if (with_payload) {
+                        // Skip blocks evicted since keys were collected
+                        if (!_peek(key, payload)) continue;
+                        entry.payload_size = payload.size();
+                    }
+                    out.write(reinterpret_cast<const char*>(&entry), sizeof(SnapshotEntry));
+                    if (with_payload) out.write(payload.data(), payload.size());
+                    header.count++;
+                }
+
+                out.seekp(0);
+                out.write(reinterpret_cast<const char*>(&header), sizeof(SnapshotHeader));
+                out.close();
+                if (!out) {
+                    throw std::runtime_error("biomxt::BlockCache::save_snapshot: Failed to write snapshot file: " + tmp_path);
+                }
+                std::filesystem::rename(tmp_path, path);
+                return header.count;
+            }
+
+            /**
+             * @brief Restore blocks of one file from a snapshot file.
+             * 
+             * @param path The snapshot file path.
+             * @param uuid Only blocks of the file with this UUID are restored.
+             * @param max_payload_size Largest decompressed block size of the file, larger payloads mean a corrupted snapshot.
+             * @param pending Receives keys saved without payload, from most to least recently used, to be loaded by caller.
+             * @param pending_pinned Receives keys saved pinned without payload, to be loaded and pinned by caller.
+             * @return size_t Count of blocks inserted from payloads.
+             * @throws std::runtime_error If the snapshot file cannot be opened or is corrupted.
+             * @note Blocks with payload are inserted from least to most recently used, so that recency order is kept.
+             * @note Payloads are buffered up to the memory limit, less recently used ones would only be evicted and are skipped.
+             */
+            size_t restore_snapshot(const std::string& path, const biomxt::UUID& uuid, size_t max_payload_size, std::vector<BlockKey>& pending, std::vector<BlockKey>& pending_pinned) {
+                std::ifstream in(path, std::ios::binary);
+                if (!in.is_open()) {
+                    throw std::runtime_error("biomxt::BlockCache::restore_snapshot: Cannot open snapshot file: " + path);
+                }
+
+                SnapshotHeader header;
+                if (!in.read(reinterpret_cast<char*>(&header), sizeof(SnapshotHeader)) || std::memcmp(header.magic, "BMXc", 4) != 0) {
+                    throw std::runtime_error("biomxt::BlockCache::restore_snapshot: Corrupted snapshot file: bad magic");
+                }
+                if (header.version != 1) {
+                    throw std::runtime_error("biomxt::BlockCache::restore_snapshot: Unsupported snapshot version [" + std::to_string(header.version) + "]");
+                }
+
+                // Read matched entries, payloads of other files are skipped
+                std::vector<RestoredBlock> restored;
+                size_t restored_size = 0;
+                const size_t memory_limit = get_memory_limit();
+                pending.clear();
+                pending_pinned.clear();
+                for (uint64_t i = 0; i < header.count; ++i) {
+                    SnapshotEntry entry;
+                    if (!in.read(reinterpret_cast<char*>(&entry), sizeof(SnapshotEntry))) {
+                        throw std::runtime_error("biomxt::BlockCache::restore_snapshot: Corrupted snapshot file: truncated at entry [" + std::to_string(i) + "]");
+                    }
+                    if (std::memcmp(entry.uuid, uuid.data, sizeof(entry.uuid)) != 0) {
+                        in.seekg(entry.payload_size, std::ios::cur);
+                        continue;
+                    }
+                    if (entry.payload_size > max_payload_size) {
+                        throw std::runtime_error("biomxt::BlockCache::restore_snapshot: Corrupted snapshot file: payload size [" + std::to_string(entry.payload_size) + "] exceeds block size [" + std::to_string(max_payload_size) + "] at entry [" + std::to_string(i) + "]");
+                    }
+                    BlockKey key = {entry.block_index, uuid};
+                    if (entry.payload_size == 0) {
+                        (entry.pinned ? pending_pinned : pending).push_back(key);
+                        continue;
+                    }
+                    // Entries are saved from most to least recently used, the rest would not fit the cache
+                    if (restored_size + entry.payload_size > memory_limit) {
+                        in.seekg(entry.payload_size, std::ios::cur);
+                        continue;
+                    }
+                    std::vector<char> data(entry.payload_size);
+                    if (!in.read(data.data(), entry.payload_size)) {
+                        throw std::runtime_error("biomxt::BlockCache::restore_snapshot: Corrupted snapshot file: truncated payload at entry [" + std::to_string(i) + "]");
+                    }
+                    restored_size += entry.payload_size;
+                    restored.push_back({key, std::move(data), entry.pinned != 0});
+                }
+
+                size_t inserted = 0;
+                for (auto it = restored.rbegin(); it != restored.rend(); ++it) {
+                    if (!insert(it->key, std::move(it->data))) continue;
+                    // Blocks stay resident unpinned once pinned blocks are full
+                    if (it->pinned) pin(it->key);
+                    inserted++;
+                }
+                return inserted;
+            }
+
+        private:
+            #pragma pack(push, 1)
+            /**
+             * @brief Snapshot file header.
+             */
+            struct SnapshotHeader {
+                char magic[4] = {'B', 'M', 'X', 'c'};
+                uint16_t version = 1;
+                uint8_t with_payload = 0;
+                uint8_t padding = 0;
+                uint64_t count = 0;
+            };
+
+            /**
+             * @brief Snapshot entry, followed by payload_size bytes of decompressed block data.
+             */
+            struct SnapshotEntry {
+                uint8_t uuid[16];
+                uint64_t block_index;
+                uint64_t payload_size;
+                uint8_t pinned;
+                uint8_t padding[7];
+            };
+            #pragma pack(pop)
+
+            /**
+             * @brief Block read from a snapshot, waiting to be inserted.
+             */
+            struct RestoredBlock {
+                BlockKey key;
+                std::vector<char> data;
+                bool pinned;
+            };
+
+        protected:
+            /**
+             * @brief Collect keys of resident blocks, pinned blocks first, then from most to least recently used.
+             * 
+             * @param pinned_count Receives the count of pinned blocks, at the beginning of the keys.
+             * @return std::vector<BlockKey> The keys.
+             */
+            virtual std::vector<BlockKey> _resident_keys(size_t& pinned_count) const {
+                std::shared_lock lock(_mutex);
+                std::vector<BlockKey> keys;
+                keys.reserve(_map.size());
+                for (const CacheEntry& entry : _pinned_list) keys.push_back(entry.key());
+                pinned_count = keys.size();
+                for (const CacheEntry& entry : _block_cache_list) keys.push_back(entry.key());
+                return keys;
+            }
+
+            /**
+             * @brief Copy block data out of the cache without touching LRU order.
+             * 
+             * @param key The key of the block.
+             * @param buffer Buffer to receive the block data.
+             * @return bool True if the block is in the cache.
+             */
+            virtual bool _peek(const BlockKey& key, std::vector<char>& buffer) const {
+                std::shared_lock lock(_mutex);
+                auto it = _map.find(key);
+                if (it == _map.end()) return false;
+                buffer.assign(it->second->data().begin(), it->second->data().end());
+                return true;
+            }
+
         private:
+            /**
+             * @brief Whether pinned blocks stay within half of the memory limit after pinning more, so that LRU always has room to evict.
+             * 
+             * @param incoming_size The size of the block to pin in bytes.
+             * @return bool True if the block can be pinned.
+             */
+            bool _pin_fits(size_t incoming_size) const {
+                return _memory_pinned + incoming_size <= _memory_limit / 2;
+            }
+
+            /**
+             * @brief Remove an entry from map, list and counters.
+             * 
+             * @param it The map iterator of the entry.
+             */
+            void _erase(std::unordered_map<BlockKey, std::list<CacheEntry>::iterator, BlockKeyHash>::iterator it) {
+                auto entry = it->second;
+                _memory_used -= entry->size();
+                _map.erase(it);
+                if (entry->pinned()) {
+                    _memory_pinned -= entry->size();
+                    _pinned_list.erase(entry);
+                } else {
+                    _block_cache_list.erase(entry);
+                }
+            }
+
+            /**
+             * @brief Move a pinned entry back to the front of LRU list.
+             * 
+             * @param entry The list iterator of the pinned entry.
+             */
+            void _unpin(std::list<CacheEntry>::iterator entry) {
+                entry->set_pinned(false);
+                _memory_pinned -= entry->size();
+                _block_cache_list.splice(_block_cache_list.begin(), _pinned_list, entry);
+            }
+
             /**
              * @brief Evict the least recently used block from the cache.
              */
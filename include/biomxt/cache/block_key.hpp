@@ -7,7 +7,7 @@
 namespace biomxt {
     class BlockKey {
         private:
-        uint32_t _block_index;
+        uint64_t _block_index;
         biomxt::UUID _uuid;
 
         public:
@@ -17,14 +17,14 @@ namespace biomxt {
          * @param block_index The block index.
          * @param uuid The block UUID.
          */
-        BlockKey(uint32_t block_index, const biomxt::UUID& uuid)
+        BlockKey(uint64_t block_index, const biomxt::UUID& uuid)
             : _block_index(block_index), _uuid(uuid) {}
 
         bool operator==(const BlockKey& other) const {
             return _block_index == other._block_index && _uuid == other._uuid;
         }
 
-        uint32_t block_index() const {
+        uint64_t block_index() const {
             return _block_index;
         }
 
@@ -44,7 +44,7 @@ namespace biomxt {
             // This ensures that any change in the UUID bits will result in a significant change in the hash value
             std::size_t seed = std::hash<uint64_t>{}(h1);
             seed ^= std::hash<uint64_t>{}(h2) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-            seed ^= std::hash<uint32_t>{}(k.block_index()) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+            seed ^= std::hash<uint64_t>{}(k.block_index()) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
             
             return seed;
         }
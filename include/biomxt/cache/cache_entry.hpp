@@ -8,6 +8,7 @@ namespace biomxt {
         private:
         BlockKey _key;
         std::vector<char> _data;
+        bool _pinned = false;
 
         public:
         /**
@@ -15,10 +16,11 @@ namespace biomxt {
          * 
          * @param key The block key.
          * @param data The block data.
+         * @param pinned Whether the entry is pinned, pinned entries are never evicted by LRU.
          * @note The data param used as right-value, will be moved into the cache entry.
          */
-        CacheEntry(BlockKey key, std::vector<char>&& data)
-            : _key(key), _data(std::move(data)) {}
+        CacheEntry(BlockKey key, std::vector<char>&& data, bool pinned = false)
+            : _key(key), _data(std::move(data)), _pinned(pinned) {}
 
         /**
          * @brief Get the data of the cache entry.
@@ -47,6 +49,24 @@ namespace biomxt {
             return sizeof(BlockKey) + _data.capacity();
         }
 
+        /**
+         * @brief Whether the cache entry is pinned.
+         * 
+         * @return bool True if the entry is pinned.
+         */
+        bool pinned() const {
+            return _pinned;
+        }
+
+        /**
+         * @brief Pin or unpin the cache entry.
+         * 
+         * @param pinned True to pin, false to unpin.
+         */
+        void set_pinned(bool pinned) {
+            _pinned = pinned;
+        }
+
         bool operator==(const CacheEntry& other) const {
             return _key == other._key && _data == other._data;
         }
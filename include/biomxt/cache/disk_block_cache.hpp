@@ -0,0 +1,339 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <list>
+#include <mutex>
+#include <string>
+#include <fstream>
+#include <filesystem>
+#include <stdexcept>
+#include <unordered_map>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <tuple>
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+#include "./block_key.hpp"
+
+
+namespace biomxt {
+    /**
+     * @brief On-disk cache of compressed blocks, meant to sit on local SSD in front of slow or remote storage.
+     *
+     * @note Layout: `<directory>/<file uuid>/<block index>.blk`, each file holds one compressed block with a checksum.
+     * @note Files are written to a temporary name then renamed, a crash never leaves a half-written block visible.
+     * @note Blocks are evicted by least recently used when disk used exceeds capacity, recency is the file modification time.
+     * @note Capacity is shared by all processes using the directory, each one re-indexes it every 1/8 of capacity it writes,
+     *       so disk used exceeds capacity by at most 1/8 per writing process.
+     */
+    class DiskBlockCache {
+        private:
+            #pragma pack(push, 1)
+            /**
+             * @brief Header of a cached block file.
+             */
+            struct BlockFileHeader {
+                char magic[4] = {'B', 'M', 'X', 'd'};
+                uint32_t version = 1;
+                uint64_t size = 0;
+                uint64_t checksum = 0;
+            };
+            #pragma pack(pop)
+
+            // Temporary files older than this are leftovers of a crashed writer
+            static constexpr std::chrono::hours STALE_TMP_AGE{1};
+
+            mutable std::mutex _mutex;
+
+            std::filesystem::path _directory;
+
+            // LRU list of keys, and map between block key <-> (list iterator, file size)
+            std::list<BlockKey> _lru_list;
+            std::unordered_map<BlockKey, std::pair<std::list<BlockKey>::iterator, uint64_t>, BlockKeyHash> _map;
+
+            // Disk used counts
+            uint64_t _disk_used = 0;
+
+            // Max disk limit
+            uint64_t _capacity;
+
+            // Bytes written since the directory was last indexed
+            uint64_t _written_since_scan = 0;
+
+        public:
+            /**
+             * @brief Open or create a disk block cache.
+             *
+             * @param directory The cache directory, created if missing.
+             * @param capacity Max bytes of cached block files.
+             * @throws `std::runtime_error` If the directory cannot be created.
+             * @note Existing blocks are indexed from oldest to newest modification time, stale temporary files are removed.
+             */
+            DiskBlockCache(const std::string& directory, uint64_t capacity) : _directory(directory), _capacity(capacity) {
+                std::error_code ec;
+                std::filesystem::create_directories(_directory, ec);
+                if (!std::filesystem::is_directory(_directory)) {
+                    throw std::runtime_error("biomxt::DiskBlockCache: Cannot create cache directory: " + directory);
+                }
+
+                std::lock_guard lock(_mutex);
+                _scan();
+                _evict_until_fit();
+            }
+
+            /**
+             * @brief Get the max bytes of cached block files.
+             *
+             * @return uint64_t The capacity in bytes.
+             */
+            uint64_t get_capacity() const {
+                std::lock_guard lock(_mutex);
+                return _capacity;
+            }
+
+            /**
+             * @brief Set the max bytes of cached block files.
+             *
+             * @param bytes The capacity in bytes.
+             * @note Block files are removed immediately after setting new capacity.
+             */
+            void set_capacity(uint64_t bytes) {
+                std::lock_guard lock(_mutex);
+                _capacity = bytes;
+                _evict_until_fit();
+            }
+
+            /**
+             * @brief Get the bytes of cached block files.
+             *
+             * @return uint64_t The disk used in bytes.
+             */
+            uint64_t get_disk_used() const {
+                std::lock_guard lock(_mutex);
+                return _disk_used;
+            }
+
+            /**
+             * @brief Read a compressed block from the cache.
+             *
+             * @param key The key of the block.
+             * @param buffer Buffer to receive the compressed data, resized if smaller than expected size.
+             * @param expected_size The compressed size from the block table.
+             * @return bool True if the block was found and is intact, a corrupted file is removed.
+             * @note A hit refreshes the modification time of the file, so that other processes see it as recently used.
+             */
+            bool get(const BlockKey& key, std::vector<char>& buffer, uint64_t expected_size) {
+                {
+                    std::lock_guard lock(_mutex);
+                    auto it = _map.find(key);
+                    if (it == _map.end()) return false;
+                    _lru_list.splice(_lru_list.begin(), _lru_list, it->second.first);
+                }
+
+                // Read outside the lock, a concurrent eviction only makes the open fail
+                std::filesystem::path path = _block_path(key);
+                std::ifstream in(path, std::ios::binary);
+                BlockFileHeader header;
+                bool intact = in.is_open()
+                    && in.read(reinterpret_cast<char*>(&header), sizeof(BlockFileHeader))
+                    && std::string(header.magic, 4) == "BMXd"
+                    && header.size == expected_size;
+                if (intact) {
+                    if (buffer.size() < expected_size) buffer.resize(expected_size);
+                    intact = in.read(buffer.data(), expected_size) && _checksum(buffer.data(), expected_size) == header.checksum;
+                }
+                if (!intact) {
+                    erase(key);
+                    return false;
+                }
+                std::error_code ec;
+                std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ec);
+                return true;
+            }
+
+            /**
+             * @brief Write a compressed block to the cache.
+             *
+             * @param key The key of the block.
+             * @param data The compressed data.
+             * @param size The compressed size.
+             * @return bool True if the block was written.
+             * @note Write errors are not fatal, the cache is only an accelerator.
+             */
+            bool put(const BlockKey& key, const char* data, uint64_t size) {
+                uint64_t file_size = sizeof(BlockFileHeader) + size;
+                if (file_size > get_capacity()) return false;
+
+                std::error_code ec;
+                std::filesystem::path path = _block_path(key);
+                std::filesystem::create_directories(path.parent_path(), ec);
+
+                // Unique temporary name per writer, across processes sharing the directory
+                std::filesystem::path tmp_path = path;
+                tmp_path += _tmp_suffix();
+                {
+                    std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+                    BlockFileHeader header;
+                    header.size = size;
+                    header.checksum = _checksum(data, size);
+                    out.write(reinterpret_cast<const char*>(&header), sizeof(BlockFileHeader));
+                    out.write(data, size);
+                    out.close();
+                    if (!out) {
+                        std::filesystem::remove(tmp_path, ec);
+                        return false;
+                    }
+                }
+                std::filesystem::rename(tmp_path, path, ec);
+                if (ec) {
+                    std::filesystem::remove(tmp_path, ec);
+                    return false;
+                }
+
+                std::lock_guard lock(_mutex);
+                auto it = _map.find(key);
+                if (it != _map.end()) {
+                    _disk_used -= it->second.second;
+                    _lru_list.erase(it->second.first);
+                    _map.erase(it);
+                }
+                _lru_list.push_front(key);
+                _map.emplace(key, std::make_pair(_lru_list.begin(), file_size));
+                _disk_used += file_size;
+
+                // Pick up blocks written by other processes, so that capacity holds for the whole directory
+                _written_since_scan += file_size;
+                if (_written_since_scan > _capacity / 8) _scan();
+                _evict_until_fit();
+                return true;
+            }
+
+            /**
+             * @brief Remove a block from the cache.
+             *
+             * @param key The key of the block.
+             */
+            void erase(const BlockKey& key) {
+                std::lock_guard lock(_mutex);
+                auto it = _map.find(key);
+                if (it == _map.end()) return;
+                _remove(it);
+            }
+
+        private:
+            /**
+             * @brief Index block files of the directory from oldest to newest modification time, and remove stale temporary files.
+             *
+             * @note Replaces the index, blocks written or removed by other processes are picked up.
+             */
+            void _scan() {
+                std::error_code ec;
+                std::vector<std::tuple<std::filesystem::file_time_type, BlockKey, uint64_t>> found;
+                const auto stale_time = std::filesystem::file_time_type::clock::now() - STALE_TMP_AGE;
+                for (const auto& uuid_dir : std::filesystem::directory_iterator(_directory, ec)) {
+                    if (!uuid_dir.is_directory()) continue;
+                    biomxt::UUID uuid;
+                    try {
+                        uuid = biomxt::UUID::from_string(uuid_dir.path().filename().string());
+                    } catch (const std::invalid_argument&) {
+                        continue;
+                    }
+                    for (const auto& file : std::filesystem::directory_iterator(uuid_dir.path(), ec)) {
+                        const std::filesystem::path& path = file.path();
+                        if (path.extension() != ".blk") {
+                            // Temporary file of a crashed write, recent ones may belong to a live writer
+                            if (path.filename().string().find(".tmp") != std::string::npos && file.last_write_time(ec) < stale_time) {
+                                std::filesystem::remove(path, ec);
+                            }
+                            continue;
+                        }
+                        try {
+                            uint64_t block_index = std::stoull(path.stem().string());
+                            found.emplace_back(file.last_write_time(), BlockKey(block_index, uuid), file.file_size());
+                        } catch (const std::exception&) {
+                            continue;
+                        }
+                    }
+                }
+                std::sort(found.begin(), found.end(), [](const auto& a, const auto& b) { return std::get<0>(a) < std::get<0>(b); });
+
+                // Newest files end at the front of LRU list
+                _lru_list.clear();
+                _map.clear();
+                _disk_used = 0;
+                _written_since_scan = 0;
+                for (const auto& [time, key, size] : found) {
+                    _lru_list.push_front(key);
+                    _map.emplace(key, std::make_pair(_lru_list.begin(), size));
+                    _disk_used += size;
+                }
+            }
+
+            /**
+             * @brief Suffix of a temporary file name, unique per process and write.
+             *
+             * @return std::string The suffix, `.tmp.<pid>.<random>`.
+             */
+            static std::string _tmp_suffix() {
+                thread_local std::mt19937_64 generator(std::random_device{}());
+#if defined(_WIN32)
+                int pid = _getpid();
+#else
+                int pid = static_cast<int>(getpid());
+#endif
+                return ".tmp." + std::to_string(pid) + "." + std::to_string(generator());
+            }
+
+            /**
+             * @brief Get the file path of a block.
+             *
+             * @param key The key of the block.
+             * @return std::filesystem::path The block file path.
+             */
+            std::filesystem::path _block_path(const BlockKey& key) const {
+                return _directory / key.uuid().to_string() / (std::to_string(key.block_index()) + ".blk");
+            }
+
+            /**
+             * @brief FNV-1a 64 bits checksum.
+             *
+             * @param data The data.
+             * @param size The data size.
+             * @return uint64_t The checksum.
+             */
+            static uint64_t _checksum(const char* data, uint64_t size) {
+                uint64_t hash = 0xcbf29ce484222325ULL;
+                for (uint64_t i = 0; i < size; ++i) {
+                    hash ^= static_cast<uint8_t>(data[i]);
+                    hash *= 0x100000001b3ULL;
+                }
+                return hash;
+            }
+
+            /**
+             * @brief Remove a block file and its entry.
+             *
+             * @param it The map iterator of the entry.
+             */
+            void _remove(std::unordered_map<BlockKey, std::pair<std::list<BlockKey>::iterator, uint64_t>, BlockKeyHash>::iterator it) {
+                std::error_code ec;
+                std::filesystem::remove(_block_path(it->first), ec);
+                _disk_used -= it->second.second;
+                _lru_list.erase(it->second.first);
+                _map.erase(it);
+            }
+
+            /**
+             * @brief Evict blocks until disk used fits the capacity.
+             */
+            void _evict_until_fit() {
+                while (_disk_used > _capacity && !_lru_list.empty()) {
+                    _remove(_map.find(_lru_list.back()));
+                }
+            }
+    };
+}
@@ -0,0 +1,644 @@
+#pragma once
+#if defined(__linux__)
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <stdexcept>
+#include <cerrno>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "./block_cache.hpp"
+
+
+namespace biomxt {
+    /**
+     * @brief Block cache living in a POSIX shared memory segment, shared by all processes opening the same name.
+     *
+     * @note The data area is split into pages of 1/16 of the largest block, a block takes only the pages it needs.
+     * @note Blocks are indexed by an open addressing hash table of `BlockKey`, and evicted by CLOCK (second chance).
+     * @note All processes share one robust mutex for the index, if a process dies holding it, the next locker resets the cache.
+     * @note Readers copy payloads outside the mutex, a per-slot generation tells them if the block was evicted meanwhile.
+     * @note The segment outlives processes, call `SharedBlockCache::remove` to delete it.
+     */
+    class SharedBlockCache : public BlockCache {
+        private:
+            /**
+             * @brief Segment header, at the beginning of the shared memory segment.
+             */
+            struct SegmentHeader {
+                char magic[4];
+                uint32_t version;
+                std::atomic<uint32_t> ready;
+                uint32_t slot_count;
+                uint64_t slot_size;
+                uint64_t page_size;
+                uint32_t page_count;
+                uint32_t page_limit;
+                uint32_t bucket_count;
+                uint32_t clock_hand;
+                uint32_t used_slots;
+                uint32_t used_pages;
+                uint32_t pinned_pages;
+                uint32_t tombstones;
+                uint32_t free_slot_count;
+                uint32_t free_page_count;
+                pthread_mutex_t mutex;
+            };
+
+            /**
+             * @brief Slot metadata, payload lives in the pages listed for the slot.
+             */
+            struct Slot {
+                uint8_t uuid[16];
+                uint64_t block_index;
+                std::atomic<uint32_t> generation;
+                uint32_t size;
+                uint8_t pages;
+                uint8_t used;
+                uint8_t referenced;
+                uint8_t pinned;
+            };
+
+            static constexpr int32_t BUCKET_EMPTY = -1;
+            static constexpr int32_t BUCKET_TOMBSTONE = -2;
+            static constexpr uint32_t PAGES_PER_SLOT = 16;
+            static constexpr int READ_RETRIES = 3;
+
+            std::string _name;
+            void* _segment = nullptr;
+            size_t _segment_size = 0;
+            SegmentHeader* _header = nullptr;
+            Slot* _slots = nullptr;
+            uint32_t* _slot_pages = nullptr;
+            uint32_t* _free_slots = nullptr;
+            uint32_t* _free_pages = nullptr;
+            int32_t* _buckets = nullptr;
+            char* _data = nullptr;
+
+        public:
+            /**
+             * @brief Create or attach to a shared block cache.
+             *
+             * @param name The shared memory object name, e.g. "/biomxt_cache".
+             * @param memory_limit Total bytes of pages, only used by the process creating the segment.
+             * @param slot_size Max bytes of one block, only used by the process creating the segment.
+             * @throws `std::invalid_argument` If slot size is 0 or memory limit is less than one slot.
+             * @throws `std::runtime_error` If the segment cannot be created, mapped or is not a block cache segment.
+             * @note Blocks larger than slot size are never cached, use `BiomxtFile::get_max_uncompressed_block_size`.
+             */
+            SharedBlockCache(const std::string& name, size_t memory_limit, size_t slot_size) : _name(name) {
+                if (slot_size == 0 || memory_limit < slot_size) {
+                    throw std::invalid_argument("biomxt::SharedBlockCache: memory limit [" + std::to_string(memory_limit) + "] must hold at least one slot of [" + std::to_string(slot_size) + "] bytes");
+                }
+
+                int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+                bool creator = fd >= 0;
+                if (!creator) {
+                    if (errno != EEXIST) {
+                        throw std::runtime_error("biomxt::SharedBlockCache: Cannot create shared memory: " + name);
+                    }
+                    fd = shm_open(name.c_str(), O_RDWR, 0600);
+                    if (fd < 0) throw std::runtime_error("biomxt::SharedBlockCache: Cannot open shared memory: " + name);
+                }
+
+                // Pages are a 16th of the largest block, so that a block wastes less than one page
+                uint64_t page_size = ((slot_size + PAGES_PER_SLOT - 1) / PAGES_PER_SLOT + 63) & ~static_cast<uint64_t>(63);
+                uint32_t page_count = static_cast<uint32_t>(memory_limit / page_size);
+                if (creator) {
+                    _segment_size = _layout(page_count, _bucket_count(page_count), page_size, nullptr);
+                    if (ftruncate(fd, _segment_size) != 0) {
+                        ::close(fd);
+                        shm_unlink(name.c_str());
+                        throw std::runtime_error("biomxt::SharedBlockCache: Cannot resize shared memory: " + name);
+                    }
+                } else {
+                    // Wait until creator has sized the segment
+                    struct stat st;
+                    for (int retry = 0; fstat(fd, &st) == 0 && st.st_size == 0 && retry < 1000; ++retry) {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    }
+                    _segment_size = st.st_size;
+                    if (_segment_size < sizeof(SegmentHeader)) {
+                        ::close(fd);
+                        throw std::runtime_error("biomxt::SharedBlockCache: Corrupted shared memory: bad segment size");
+                    }
+                }
+
+                _segment = mmap(nullptr, _segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                ::close(fd);
+                if (_segment == MAP_FAILED) {
+                    _segment = nullptr;
+                    throw std::runtime_error("biomxt::SharedBlockCache: Cannot map shared memory: " + name);
+                }
+                _header = static_cast<SegmentHeader*>(_segment);
+
+                if (creator) {
+                    _initialize(page_count, slot_size, page_size);
+                } else {
+                    // Wait until creator has initialized the segment
+                    for (int retry = 0; _header->ready.load(std::memory_order_acquire) == 0 && retry < 1000; ++retry) {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    }
+                    if (_header->ready.load(std::memory_order_acquire) == 0 || std::string(_header->magic, 4) != "BMXs" || _header->version != 1) {
+                        munmap(_segment, _segment_size);
+                        _segment = nullptr;
+                        throw std::runtime_error("biomxt::SharedBlockCache: Corrupted shared memory: not a block cache segment: " + name);
+                    }
+                    _layout(_header->page_count, _header->bucket_count, _header->page_size, _segment);
+                }
+            }
+
+            ~SharedBlockCache() override {
+                if (_segment) munmap(_segment, _segment_size);
+            }
+
+            SharedBlockCache(const SharedBlockCache&) = delete;
+            SharedBlockCache& operator=(const SharedBlockCache&) = delete;
+
+            /**
+             * @brief Delete a shared memory segment, processes attached keep their mapping until they exit.
+             *
+             * @param name The shared memory object name.
+             * @return bool True if the segment existed and was removed.
+             */
+            static bool remove(const std::string& name) {
+                return shm_unlink(name.c_str()) == 0;
+            }
+
+            /**
+             * @brief Get the max size of one block.
+             *
+             * @return size_t The slot size in bytes.
+             */
+            size_t get_slot_size() const {
+                return _header->slot_size;
+            }
+
+            size_t get_memory_limit() const override {
+                _SegmentLock lock(this);
+                return static_cast<size_t>(_header->page_limit) * _header->page_size;
+            }
+
+            /**
+             * @brief Set the memory limit of the cache, it cannot grow beyond the size of the segment.
+             *
+             * @param bytes The memory limit in bytes.
+             * @note Unpinned blocks are evicted immediately until the cache fits the new limit.
+             */
+            void set_memory_limit(size_t bytes) override {
+                _SegmentLock lock(this);
+                _header->page_limit = static_cast<uint32_t>(std::min<size_t>(_header->page_count, bytes / _header->page_size));
+                while (_header->used_pages > _header->page_limit && _evict_one()) {}
+            }
+
+            size_t get_memory_used() const override {
+                _SegmentLock lock(this);
+                return static_cast<size_t>(_header->used_pages) * _header->page_size;
+            }
+
+            size_t get_memory_pinned() const override {
+                _SegmentLock lock(this);
+                return static_cast<size_t>(_header->pinned_pages) * _header->page_size;
+            }
+
+            bool insert(const BlockKey& key, std::vector<char>&& data, bool pinned = false, bool least_recent = false) override {
+                if (data.size() > _header->slot_size) return false;
+                uint32_t pages = _pages_of(data.size());
+                _SegmentLock lock(this);
+
+                // An old copy of the key is replaced, its pages count as freed
+                int32_t slot = _find(key);
+                const uint32_t freed_pinned = (slot >= 0 && _slots[slot].pinned) ? _slots[slot].pages : 0;
+                pinned = pinned || (slot >= 0 && _slots[slot].pinned);
+
+                // Pinned blocks can only use their share of the pages
+                if (pinned && _header->pinned_pages - freed_pinned + pages > _header->page_limit / 2) return false;
+
+                // Give up if pinned blocks leave no room, before the old copy is dropped
+                if (_header->pinned_pages - freed_pinned + pages > _header->page_limit) return false;
+
+                // Drop the old copy, its pages are reused
+                if (slot >= 0) _release_slot(slot);
+                while (_header->used_pages + pages > _header->page_limit) {
+                    if (!_evict_one()) return false;
+                }
+
+                slot = _free_slots[--_header->free_slot_count];
+                Slot& s = _slots[slot];
+                std::memcpy(s.uuid, key.uuid().data, sizeof(s.uuid));
+                s.block_index = key.block_index();
+                s.size = static_cast<uint32_t>(data.size());
+                s.pages = static_cast<uint8_t>(pages);
+                s.used = 1;
+                s.pinned = pinned ? 1 : 0;
+                // Without reference bit, CLOCK evicts the block on its first pass
+                s.referenced = least_recent ? 0 : 1;
+
+                // Copy payload page by page
+                uint32_t* slot_pages = _slot_pages + static_cast<size_t>(slot) * PAGES_PER_SLOT;
+                for (uint32_t p = 0; p < pages; ++p) {
+                    slot_pages[p] = _free_pages[--_header->free_page_count];
+                    size_t begin = p * _header->page_size;
+                    std::memcpy(_page_data(slot_pages[p]), data.data() + begin, std::min<size_t>(_header->page_size, data.size() - begin));
+                }
+                _header->used_slots++;
+                _header->used_pages += pages;
+                if (pinned) _header->pinned_pages += pages;
+                _index(slot);
+                return true;
+            }
+
+            bool contains(const BlockKey& key) const override {
+                _SegmentLock lock(this);
+                return _find(key) >= 0;
+            }
+
+            bool pin(const BlockKey& key) override {
+                _SegmentLock lock(this);
+                int32_t slot = _find(key);
+                if (slot < 0) return false;
+                if (!_slots[slot].pinned) {
+                    if (!_pin_fits(_slots[slot].pages)) return false;
+                    _slots[slot].pinned = 1;
+                    _header->pinned_pages += _slots[slot].pages;
+                }
+                return true;
+            }
+
+            bool unpin(const BlockKey& key) override {
+                _SegmentLock lock(this);
+                int32_t slot = _find(key);
+                if (slot < 0 || !_slots[slot].pinned) return false;
+                _slots[slot].pinned = 0;
+                _slots[slot].referenced = 1;
+                _header->pinned_pages -= _slots[slot].pages;
+                return true;
+            }
+
+            void unpin_all() override {
+                _SegmentLock lock(this);
+                for (uint32_t i = 0; i < _header->slot_count; ++i) {
+                    if (_slots[i].used && _slots[i].pinned) {
+                        _slots[i].pinned = 0;
+                        _slots[i].referenced = 1;
+                    }
+                }
+                _header->pinned_pages = 0;
+            }
+
+            bool get_block_data(const BlockKey& key, std::vector<char>& buffer, size_t offset, size_t size) override {
+                return _read(key, true, offset, size, false, buffer);
+            }
+
+            bool touch(const BlockKey& key) override {
+                _SegmentLock lock(this);
+                int32_t slot = _find(key);
+                if (slot < 0) return false;
+                _slots[slot].referenced = 1;
+                return true;
+            }
+
+        protected:
+            /**
+             * @brief Collect keys of resident blocks, pinned blocks first, then referenced blocks, then others.
+             *
+             * @param pinned_count Receives the count of pinned blocks, at the beginning of the keys.
+             * @return std::vector<BlockKey> The keys.
+             */
+            std::vector<BlockKey> _resident_keys(size_t& pinned_count) const override {
+                _SegmentLock lock(this);
+                std::vector<BlockKey> keys;
+                keys.reserve(_header->used_slots);
+                for (int rank = 0; rank < 3; ++rank) {
+                    for (uint32_t i = 0; i < _header->slot_count; ++i) {
+                        const Slot& s = _slots[i];
+                        if (!s.used) continue;
+                        int slot_rank = s.pinned ? 0 : (s.referenced ? 1 : 2);
+                        if (slot_rank == rank) keys.push_back(_key_of(i));
+                    }
+                    if (rank == 0) pinned_count = keys.size();
+                }
+                return keys;
+            }
+
+            bool _peek(const BlockKey& key, std::vector<char>& buffer) const override {
+                return _read(key, false, 0, 0, true, buffer);
+            }
+
+            /**
+             * @brief RAII lock of the segment mutex, recovers the cache if the previous owner died.
+             */
+            class _SegmentLock {
+                private:
+                    const SharedBlockCache* _cache;
+                public:
+                    explicit _SegmentLock(const SharedBlockCache* cache) : _cache(cache) {
+                        int rc = pthread_mutex_lock(&_cache->_header->mutex);
+                        if (rc == EOWNERDEAD) {
+                            // The dead owner may have left the index half-updated, drop everything
+                            const_cast<SharedBlockCache*>(_cache)->_reset();
+                            pthread_mutex_consistent(&_cache->_header->mutex);
+                        } else if (rc != 0) {
+                            throw std::runtime_error("biomxt::SharedBlockCache: Failed to lock shared memory mutex [" + std::to_string(rc) + "]");
+                        }
+                    }
+                    ~_SegmentLock() {
+                        pthread_mutex_unlock(&_cache->_header->mutex);
+                    }
+            };
+
+        private:
+            /**
+             * @brief Copy a range of a block out of its pages, without holding the mutex during the copy.
+             *
+             * @param key The block key.
+             * @param reference Give the block a second chance.
+             * @param offset Offset of the range in the block.
+             * @param size Size of the range.
+             * @param whole Copy the whole block instead of the range, buffer is resized to the block size.
+             * @param buffer Buffer to receive the data.
+             * @return bool True if the block is resident and copied, false if it was evicted during every retry.
+             */
+            bool _read(const BlockKey& key, bool reference, size_t offset, size_t size, bool whole, std::vector<char>& buffer) const {
+                for (int attempt = 0; attempt < READ_RETRIES; ++attempt) {
+                    const Slot* s;
+                    uint32_t generation;
+                    uint32_t pages[PAGES_PER_SLOT];
+                    {
+                        _SegmentLock lock(this);
+                        int32_t slot = _find(key);
+                        if (slot < 0) return false;
+                        if (reference) _slots[slot].referenced = 1;
+                        s = &_slots[slot];
+                        if (whole) {
+                            offset = 0;
+                            size = s->size;
+                        }
+                        // Check range
+                        if (offset + size > s->size) return false;
+                        generation = s->generation.load(std::memory_order_relaxed);
+                        std::memcpy(pages, _slot_pages + static_cast<size_t>(slot) * PAGES_PER_SLOT, sizeof(uint32_t) * s->pages);
+                    }
+
+                    // Check buffer size
+                    if (whole) buffer.resize(size);
+                    else if (buffer.size() < size) buffer.resize(size);
+                    // Copy data, pages may be reused by a writer meanwhile
+                    const size_t page_size = _header->page_size;
+                    for (size_t copied = 0; copied < size;) {
+                        size_t position = offset + copied;
+                        size_t length = std::min(size - copied, page_size - position % page_size);
+                        std::memcpy(buffer.data() + copied, _page_data(pages[position / page_size]) + position % page_size, length);
+                        copied += length;
+                    }
+
+                    // Generation changes when the slot is released, before its pages are handed out again
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    if (s->generation.load(std::memory_order_relaxed) == generation) return true;
+                }
+                return false;
+            }
+
+            /**
+             * @brief Compute segment layout, and assign region pointers if segment is given.
+             *
+             * @param page_count Count of pages, which is also the count of slots.
+             * @param bucket_count Count of hash buckets, power of 2.
+             * @param page_size Size of one page.
+             * @param segment The mapped segment, or nullptr to only compute size.
+             * @return size_t Total segment size in bytes.
+             */
+            size_t _layout(uint32_t page_count, uint32_t bucket_count, uint64_t page_size, void* segment) {
+                auto align = [](size_t n) { return (n + 63) & ~static_cast<size_t>(63); };
+                size_t slots_offset = align(sizeof(SegmentHeader));
+                size_t slot_pages_offset = align(slots_offset + sizeof(Slot) * page_count);
+                size_t free_slots_offset = align(slot_pages_offset + sizeof(uint32_t) * PAGES_PER_SLOT * page_count);
+                size_t free_pages_offset = align(free_slots_offset + sizeof(uint32_t) * page_count);
+                size_t buckets_offset = align(free_pages_offset + sizeof(uint32_t) * page_count);
+                size_t data_offset = align(buckets_offset + sizeof(int32_t) * bucket_count);
+                if (segment) {
+                    char* base = static_cast<char*>(segment);
+                    _slots = reinterpret_cast<Slot*>(base + slots_offset);
+                    _slot_pages = reinterpret_cast<uint32_t*>(base + slot_pages_offset);
+                    _free_slots = reinterpret_cast<uint32_t*>(base + free_slots_offset);
+                    _free_pages = reinterpret_cast<uint32_t*>(base + free_pages_offset);
+                    _buckets = reinterpret_cast<int32_t*>(base + buckets_offset);
+                    _data = base + data_offset;
+                }
+                return data_offset + page_size * page_count;
+            }
+
+            /**
+             * @brief Count of hash buckets for a count of slots, power of 2 and at least twice the slots.
+             *
+             * @param slot_count Count of slots.
+             * @return uint32_t The count of buckets.
+             */
+            static uint32_t _bucket_count(uint32_t slot_count) {
+                uint32_t bucket_count = 1;
+                while (bucket_count < slot_count * 2) bucket_count <<= 1;
+                return bucket_count;
+            }
+
+            /**
+             * @brief Initialize a newly created segment, then mark it ready.
+             *
+             * @param page_count Count of pages, every block takes at least one, so it is also the count of slots.
+             * @param slot_size Max size of one block.
+             * @param page_size Size of one page.
+             */
+            void _initialize(uint32_t page_count, uint64_t slot_size, uint64_t page_size) {
+                std::memcpy(_header->magic, "BMXs", 4);
+                _header->version = 1;
+                _header->slot_count = page_count;
+                _header->slot_size = slot_size;
+                _header->page_size = page_size;
+                _header->page_count = page_count;
+                _header->page_limit = page_count;
+                _header->bucket_count = _bucket_count(page_count);
+                _layout(page_count, _header->bucket_count, page_size, _segment);
+
+                pthread_mutexattr_t attr;
+                pthread_mutexattr_init(&attr);
+                pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+                pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+                pthread_mutex_init(&_header->mutex, &attr);
+                pthread_mutexattr_destroy(&attr);
+
+                _reset();
+                _header->ready.store(1, std::memory_order_release);
+            }
+
+            /**
+             * @brief Drop all blocks, clear slots, free lists and index.
+             */
+            void _reset() {
+                for (uint32_t i = 0; i < _header->slot_count; ++i) {
+                    Slot& s = _slots[i];
+                    // Readers copying out of the slot see it changed
+                    s.generation.fetch_add(1, std::memory_order_relaxed);
+                    s.used = 0;
+                    s.pinned = 0;
+                    s.referenced = 0;
+                    s.pages = 0;
+                    s.size = 0;
+                    _free_slots[i] = i;
+                }
+                for (uint32_t i = 0; i < _header->page_count; ++i) _free_pages[i] = i;
+                std::atomic_thread_fence(std::memory_order_release);
+                std::fill(_buckets, _buckets + _header->bucket_count, BUCKET_EMPTY);
+                _header->free_slot_count = _header->slot_count;
+                _header->free_page_count = _header->page_count;
+                _header->clock_hand = 0;
+                _header->used_slots = 0;
+                _header->used_pages = 0;
+                _header->pinned_pages = 0;
+                _header->tombstones = 0;
+            }
+
+            /**
+             * @brief Hash a block key, stable across processes and builds.
+             *
+             * @param key The block key.
+             * @return uint64_t The hash value.
+             */
+            static uint64_t _hash(const BlockKey& key) {
+                uint64_t h1, h2;
+                std::memcpy(&h1, key.uuid().data, 8);
+                std::memcpy(&h2, key.uuid().data + 8, 8);
+                uint64_t x = h1 ^ (h2 * 0x9e3779b97f4a7c15ULL) ^ (static_cast<uint64_t>(key.block_index()) * 0xbf58476d1ce4e5b9ULL);
+                // splitmix64 finalizer
+                x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ULL;
+                x ^= x >> 27; x *= 0x94d049bb133111ebULL;
+                x ^= x >> 31;
+                return x;
+            }
+
+            char* _page_data(uint32_t page) const {
+                return _data + static_cast<size_t>(page) * _header->page_size;
+            }
+
+            uint32_t _pages_of(size_t size) const {
+                return std::max<uint32_t>(1, static_cast<uint32_t>((size + _header->page_size - 1) / _header->page_size));
+            }
+
+            BlockKey _key_of(uint32_t slot) const {
+                biomxt::UUID uuid;
+                std::memcpy(uuid.data, _slots[slot].uuid, sizeof(uuid.data));
+                return BlockKey(_slots[slot].block_index, uuid);
+            }
+
+            bool _matches(uint32_t slot, const BlockKey& key) const {
+                return _slots[slot].block_index == key.block_index() && std::memcmp(_slots[slot].uuid, key.uuid().data, 16) == 0;
+            }
+
+            /**
+             * @brief Find the slot of a block.
+             *
+             * @param key The block key.
+             * @return int32_t The slot, or -1 if not found.
+             */
+            int32_t _find(const BlockKey& key) const {
+                uint32_t mask = _header->bucket_count - 1;
+                uint32_t pos = static_cast<uint32_t>(_hash(key)) & mask;
+                for (uint32_t probe = 0; probe < _header->bucket_count; ++probe, pos = (pos + 1) & mask) {
+                    int32_t slot = _buckets[pos];
+                    if (slot == BUCKET_EMPTY) return -1;
+                    if (slot >= 0 && _matches(slot, key)) return slot;
+                }
+                return -1;
+            }
+
+            /**
+             * @brief Add a used slot to the index.
+             *
+             * @param slot The slot.
+             */
+            void _index(int32_t slot) {
+                uint32_t mask = _header->bucket_count - 1;
+                uint32_t pos = static_cast<uint32_t>(_hash(_key_of(slot))) & mask;
+                while (_buckets[pos] >= 0) pos = (pos + 1) & mask;
+                if (_buckets[pos] == BUCKET_TOMBSTONE) _header->tombstones--;
+                _buckets[pos] = slot;
+            }
+
+            /**
+             * @brief Remove a slot from the index, and free it with its pages.
+             *
+             * @param slot The slot.
+             */
+            void _release_slot(uint32_t slot) {
+                uint32_t mask = _header->bucket_count - 1;
+                uint32_t pos = static_cast<uint32_t>(_hash(_key_of(slot))) & mask;
+                for (uint32_t probe = 0; probe < _header->bucket_count; ++probe, pos = (pos + 1) & mask) {
+                    if (_buckets[pos] == static_cast<int32_t>(slot)) {
+                        _buckets[pos] = BUCKET_TOMBSTONE;
+                        _header->tombstones++;
+                        break;
+                    }
+                }
+
+                // Readers copying out of the slot see it changed before its pages are written again
+                Slot& s = _slots[slot];
+                s.generation.fetch_add(1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+                const uint32_t* slot_pages = _slot_pages + static_cast<size_t>(slot) * PAGES_PER_SLOT;
+                for (uint32_t p = 0; p < s.pages; ++p) _free_pages[_header->free_page_count++] = slot_pages[p];
+                _free_slots[_header->free_slot_count++] = slot;
+                if (s.pinned) _header->pinned_pages -= s.pages;
+                _header->used_pages -= s.pages;
+                _header->used_slots--;
+                s.used = 0;
+                s.pinned = 0;
+                s.pages = 0;
+
+                // Rebuild index when tombstones make probing long
+                if (_header->tombstones > _header->bucket_count / 4) {
+                    std::fill(_buckets, _buckets + _header->bucket_count, BUCKET_EMPTY);
+                    _header->tombstones = 0;
+                    for (uint32_t i = 0; i < _header->slot_count; ++i) {
+                        if (_slots[i].used) _index(i);
+                    }
+                }
+            }
+
+            /**
+             * @brief Whether pinned blocks stay within half of the pages after pinning more, so that CLOCK always has blocks to evict.
+             *
+             * @param pages Count of pages to pin.
+             * @return bool True if the pages can be pinned.
+             */
+            bool _pin_fits(uint32_t pages) const {
+                return _header->pinned_pages + pages <= _header->page_limit / 2;
+            }
+
+            /**
+             * @brief Evict one unpinned block by CLOCK.
+             *
+             * @return bool True if a block was evicted, false if all blocks are pinned.
+             */
+            bool _evict_one() {
+                uint32_t slot_count = _header->slot_count;
+                for (uint64_t step = 0; step < 2ull * slot_count + 1; ++step) {
+                    uint32_t slot = _header->clock_hand;
+                    _header->clock_hand = (slot + 1) % slot_count;
+                    Slot& s = _slots[slot];
+                    if (!s.used || s.pinned) continue;
+                    if (s.referenced) {
+                        s.referenced = 0;
+                        continue;
+                    }
+                    _release_slot(slot);
+                    return true;
+                }
+                return false;
+            }
+    };
+}
+#endif
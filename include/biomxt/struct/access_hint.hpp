@@ -0,0 +1,73 @@
+#pragma once
+#include <cstdint>
+#include <iostream>
+
+
+namespace biomxt
+{
+    /**
+     * @brief Access hint flags, in the spirit of `posix_fadvise`, can be combined with `|`.
+     * @note `NORMAL`: read through cache, insert as most recently used.
+     * @note `RANDOM`: no OS readahead. Rows of files flagged `HAS_BLOCK_FRAMES`, or columns if also `COLUMN_MAJOR_BLOCKS`, missing from cache only unpack the frame holding them, without caching it.
+     * @note `SEQUENTIAL`: OS readahead of following blocks, insert as least recently used.
+     * @note `NOCACHE`: decode without inserting into cache, drop file pages after read. Rows or columns of framed files only unpack their frame as with `RANDOM`.
+     * @note `WILLNEED`: ask OS to fetch all blocks of a row or column before decoding the first one.
+     */
+    enum AccessHint : uint8_t {
+        NORMAL = 0,
+        RANDOM = 1,
+        SEQUENTIAL = 2,
+        NOCACHE = 4,
+        WILLNEED = 8
+    };
+
+    inline AccessHint operator|(AccessHint a, AccessHint b) {
+        return static_cast<AccessHint>(static_cast<uint8_t>(a) | static_cast<uint8_t>(b));
+    }
+
+    /**
+     * @brief Check whether a hint flag is set.
+     * @param hints Combined hint flags.
+     * @param flag The flag to check.
+     * @return bool True if flag is set.
+     */
+    inline bool has_hint(AccessHint hints, AccessHint flag) {
+        return (static_cast<uint8_t>(hints) & static_cast<uint8_t>(flag)) != 0;
+    }
+
+    /**
+     * @brief Convert access hint flags to string.
+     * @param hints Combined hint flags.
+     * @return std::string String representation, flags joined by `|`.
+     */
+    inline std::string hint_to_string(AccessHint hints) {
+        if (hints == AccessHint::NORMAL) return "normal";
+        std::string result;
+        if (has_hint(hints, AccessHint::RANDOM)) result += "|random";
+        if (has_hint(hints, AccessHint::SEQUENTIAL)) result += "|sequential";
+        if (has_hint(hints, AccessHint::NOCACHE)) result += "|nocache";
+        if (has_hint(hints, AccessHint::WILLNEED)) result += "|willneed";
+        return result.substr(1);
+    }
+
+    /**
+     * @brief Convert string to access hint flags.
+     * @param hints Flags joined by `|` or `,`, e.g. "sequential|nocache".
+     * @return `biomxt::AccessHint` Combined hint flags, unknown flags are ignored.
+     */
+    inline AccessHint hint_from_string(const std::string& hints) {
+        AccessHint result = AccessHint::NORMAL;
+        size_t start = 0;
+        while (start <= hints.size()) {
+            size_t end = hints.find_first_of("|,", start);
+            if (end == std::string::npos) end = hints.size();
+            std::string flag = hints.substr(start, end - start);
+            if (flag == "random") result = result | AccessHint::RANDOM;
+            if (flag == "sequential") result = result | AccessHint::SEQUENTIAL;
+            if (flag == "nocache") result = result | AccessHint::NOCACHE;
+            if (flag == "willneed") result = result | AccessHint::WILLNEED;
+            start = end + 1;
+        }
+        return result;
+    }
+} // namespace biomxt
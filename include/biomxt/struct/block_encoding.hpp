@@ -0,0 +1,50 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "./compress_algorithm.hpp"
+#include "./block_filter.hpp"
+
+
+namespace biomxt
+{
+    /**
+     * @brief Encoding of a block ahead of filter and compression, chosen per block by the converter.
+     * @note `DENSE`: all `width*height` elements, row-major.
+     * @note `BITMAP`: a bitmap of nonzero elements, one bit per element in row-major order, then the nonzero elements packed in the same order.
+     * @note `FOR`, `DELTA`, `FIXED`: integer elements encoded by the `IntegerCodec` of the same name.
+     */
+    enum class BlockEncoding : uint8_t {
+        DENSE = 0,
+        BITMAP = 1,
+        FOR = 2,
+        DELTA = 3,
+        FIXED = 4
+    };
+
+    /**
+     * @brief Convert block encoding enum to string.
+     * @param encoding Block encoding enum.
+     * @return std::string String representation of block encoding.
+     */
+    inline std::string encoding_to_string(BlockEncoding encoding) {
+        switch (encoding) {
+            case BlockEncoding::DENSE: return "dense";
+            case BlockEncoding::BITMAP: return "bitmap";
+            case BlockEncoding::FOR: return "for";
+            case BlockEncoding::DELTA: return "delta";
+            case BlockEncoding::FIXED: return "fixed";
+            default: return "unknown";
+        }
+    }
+
+    /**
+     * @brief Pack the codec of a block into the byte it starts with, in files flagged `HAS_BLOCK_CODEC`.
+     * @param encoding Block encoding, in bits 0-2.
+     * @param filter Block filter, in bits 3-4.
+     * @param algo Compression algorithm, in bits 5-7.
+     * @return uint8_t Codec byte.
+     */
+    inline uint8_t make_block_codec(BlockEncoding encoding, BlockFilter filter, CompressAlgorithm algo) {
+        return static_cast<uint8_t>(encoding) | static_cast<uint8_t>(filter) << 3 | static_cast<uint8_t>(algo) << 5;
+    }
+} // namespace biomxt
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+
+namespace biomxt
+{
+    /**
+     * @brief Filter applied to raw block data before compression, and reverted after decompression.
+     * @note `NONE`: blocks are compressed as is.
+     * @note `SHUFFLE`: byte i of every element is grouped together, so that slowly varying high bytes form long runs.
+     * @note `BITSHUFFLE`: bit i of every element is grouped together, which suits sparse and small integer data.
+     */
+    enum class BlockFilter : uint8_t {
+        NONE = 0,
+        SHUFFLE = 1,
+        BITSHUFFLE = 2
+    };
+
+    /**
+     * @brief Convert block filter enum to string.
+     * @param filter Block filter enum.
+     * @return std::string String representation of block filter.
+     */
+    inline std::string filter_to_string(BlockFilter filter) {
+        switch (filter) {
+            case BlockFilter::NONE: return "none";
+            case BlockFilter::SHUFFLE: return "shuffle";
+            case BlockFilter::BITSHUFFLE: return "bitshuffle";
+            default: return "unknown";
+        }
+    }
+
+    /**
+     * @brief Convert string to block filter enum.
+     * @param filter String representation of block filter.
+     * @return `biomxt::BlockFilter` Block filter enum, `NONE` if not recognized.
+     */
+    inline BlockFilter filter_from_string(const std::string& filter) {
+        if (filter == "shuffle") return BlockFilter::SHUFFLE;
+        if (filter == "bitshuffle") return BlockFilter::BITSHUFFLE;
+        return BlockFilter::NONE;
+    }
+} // namespace biomxt
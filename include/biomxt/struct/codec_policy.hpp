@@ -0,0 +1,15 @@
+#pragma once
+#include <cstdint>
+
+
+namespace biomxt {
+    /**
+     * @brief Policy of adaptive compression, where each block picks its own encoding, filter and algorithm.
+     * @note Candidates are dense, sparse and integer encodings, each with its best filter, compressed by store, lz4 and zstd at levels 1, 3 and 9. The smallest candidate decoding fast enough wins.
+     */
+    struct CodecPolicy {
+        bool adaptive = false;                  ///< Choose the codec of each block, so that blocks start with their codec byte and the file must be flagged `HAS_BLOCK_CODEC`.
+        uint32_t min_decode_speed = 0;          ///< Min decode speed of a block in MB/s of raw data, as estimated by a static cost table of a typical core, so that output is the same on any machine. 0 for the smallest block whatever its speed.
+    };
+
+} // namespace biomxt
@@ -7,11 +7,14 @@ namespace biomxt
 {
     /**
      * @brief Compress algorithm enum.
+     * @note `STORE` keeps blocks uncompressed, for blocks already packed by an integer codec.
      */
     enum CompressAlgorithm : uint8_t {
         ZSTD = 0,
         GZIP = 1,
-        LZ4 = 2
+        LZ4 = 2,
+        LZ4HC = 3,
+        STORE = 4
     };
 
     /**
@@ -24,6 +27,8 @@ namespace biomxt
             case ZSTD: return "zstd";
             case GZIP: return "gzip";
             case LZ4: return "lz4";
+            case LZ4HC: return "lz4hc";
+            case STORE: return "store";
             default: return "unknown";
         }
     }
@@ -37,6 +42,8 @@ namespace biomxt
         if (algo == "zstd") return CompressAlgorithm::ZSTD;
         if (algo == "gzip") return CompressAlgorithm::GZIP;
         if (algo == "lz4") return CompressAlgorithm::LZ4;
+        if (algo == "lz4hc") return CompressAlgorithm::LZ4HC;
+        if (algo == "store") return CompressAlgorithm::STORE;
         return CompressAlgorithm::ZSTD;
     }
 } // namespace biomxt
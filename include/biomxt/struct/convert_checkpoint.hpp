@@ -0,0 +1,43 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "./data_type.hpp"
+#include "./compress_algorithm.hpp"
+#include "./block_filter.hpp"
+#include "./integer_codec.hpp"
+#include "./codec_policy.hpp"
+#include "./index_entry.hpp"
+#include "./uuid.hpp"
+
+
+namespace biomxt {
+    /**
+     * @brief State of an interrupted conversion, enough to continue from the last complete block row.
+     */
+    struct ConvertCheckpoint {
+        biomxt::UUID uuid;                                                  ///< UUID of output file.
+        biomxt::DataType dtype = biomxt::DataType::FLOAT32;                 ///< Data type of output file.
+        biomxt::CompressAlgorithm algo = biomxt::CompressAlgorithm::ZSTD;   ///< Compression algorithm of output file.
+        biomxt::BlockFilter filter = biomxt::BlockFilter::NONE;             ///< Block filter of output file.
+        char separator = ',';                                               ///< Separator of input file.
+        uint32_t block_width = 0;                                           ///< Width of each block.
+        uint32_t block_height = 0;                                          ///< Height of each block.
+        uint32_t dictionary_size = 0;                                       ///< Size of dictionary ahead of the first block, 0 for none.
+        float sparse_threshold = 0;                                         ///< Max density of nonzeros of a block stored sparse, 0 for dense blocks only.
+        biomxt::IntegerCodec integer_codec = biomxt::IntegerCodec::NONE;    ///< Codec of integer blocks.
+        biomxt::CodecPolicy policy;                                         ///< Adaptive codec policy.
+        uint16_t frame_height = 0;                                          ///< Rows per frame of blocks, columns if column-major, 0 for blocks compressed whole.
+        bool column_major = false;                                          ///< Cells of blocks are stored column by column.
+        uint64_t input_size = 0;                                            ///< Size of input file on disk, to detect a changed input.
+        uint64_t input_offset = 0;                                          ///< Offset of the first unconverted record in (decompressed) input.
+        uint64_t input_line = 0;                                            ///< Count of input lines before input_offset, for error messages.
+        uint64_t output_offset = 0;                                         ///< End of the last written block in output file.
+        std::vector<std::string> colnames;                                  ///< Column names, only needed by the first checkpoint of a file.
+        uint64_t row_offset = 0;                                            ///< Count of rows recorded by earlier checkpoints, 0 when rownames holds all rows.
+        uint64_t block_offset = 0;                                          ///< Count of blocks recorded by earlier checkpoints, 0 when block_table holds all blocks.
+        std::vector<std::string> rownames;                                  ///< Names of rows written after row_offset.
+        std::vector<biomxt::IndexEntry> block_table;                        ///< Block table of blocks written after block_offset.
+    };
+
+} // namespace biomxt
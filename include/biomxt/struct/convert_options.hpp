@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include "./compress_algorithm.hpp"
+#include "./block_filter.hpp"
+#include "./integer_codec.hpp"
+#include "./codec_policy.hpp"
+
+
+namespace biomxt {
+    /**
+     * @brief Options of conversion to biomxt format.
+     */
+    struct ConvertOptions {
+        uint32_t block_width = 512;                                         ///< Width of each block.
+        uint32_t block_height = 512;                                        ///< Height of each block.
+        char separator = ',';                                               ///< Separator to be used for csv parsing.
+        biomxt::CompressAlgorithm algo = biomxt::CompressAlgorithm::ZSTD;   ///< Compression algorithm to be used.
+        biomxt::BlockFilter filter = biomxt::BlockFilter::NONE;             ///< Filter applied to blocks before compression.
+        uint32_t dictionary_size = 0;                                       ///< Max size of zstd dictionary trained on the first block row in bytes, 0 to disable.
+        float sparse_threshold = 0;                                         ///< Max density of nonzeros of a block stored sparse, 0 to store every block dense.
+        biomxt::IntegerCodec integer_codec = biomxt::IntegerCodec::NONE;    ///< Codec of integer blocks ahead of compression, ignored for floats.
+        biomxt::CodecPolicy policy;                                         ///< Adaptive codec policy, algo, filter and sparse threshold are chosen per block if adaptive.
+        uint16_t frame_height = 0;                                          ///< Rows per independently compressed frame of a block, columns if column-major, 0 to compress blocks whole.
+        bool column_major = false;                                          ///< Store cells of each block column by column, so that column reads copy contiguous slices.
+        uint32_t threads = 0;                                               ///< Count of compression workers, 0 for hardware concurrency.
+        uint32_t max_inflight_block_rows = 0;                               ///< Max block rows held in memory before written, 0 for twice the workers.
+        uint32_t parse_threads = 0;                                         ///< Count of csv parsing threads, 0 for hardware concurrency.
+        size_t chunk_size = 8 << 20;                                        ///< Size of input chunk parsed by one thread, in bytes.
+        uint64_t memory_budget = 1ull << 30;                                ///< Memory for bucketed sparse entries before spilling to disk, in bytes.
+        bool transpose = false;                                             ///< Transpose sparse input, e.g. 10x barcodes become rows.
+        uint64_t checkpoint_interval = 0;                                   ///< Input bytes between checkpoints of csv conversion, 0 to disable.
+        bool resume = false;                                                ///< Resume csv conversion from its checkpoint if there is one.
+    };
+
+} // namespace biomxt
@@ -1,11 +1,13 @@
 #pragma once
 #include <cstdint>
 #include <iostream>
+#include "./reduced_float.hpp"
 
 
 namespace biomxt {
     /**
      * @brief Biomxt data type enum.
+     * @note `UINT8`, `UINT16`, `FLOAT16` and `BFLOAT16` are reduced storage types, e.g. of raw counts or normalized expression, read back as float by `expand_to_float`.
      */
     enum DataType : uint8_t {
         UNKNOWN = 0,
@@ -13,7 +15,11 @@ namespace biomxt {
         INT32 = 2,
         INT64 = 3,
         FLOAT32 = 4,
-        FLOAT64 = 5
+        FLOAT64 = 5,
+        UINT8 = 6,
+        UINT16 = 7,
+        FLOAT16 = 8,
+        BFLOAT16 = 9
     };
 
     /**
@@ -28,6 +34,10 @@ namespace biomxt {
             case INT64: return "int64";
             case FLOAT32: return "float32";
             case FLOAT64: return "float64";
+            case UINT8: return "uint8";
+            case UINT16: return "uint16";
+            case FLOAT16: return "float16";
+            case BFLOAT16: return "bfloat16";
             default: return "unknown";
         }
     }
@@ -43,6 +53,10 @@ namespace biomxt {
         if (type == "int64") return DataType::INT64;
         if (type == "float32" || type == "float") return DataType::FLOAT32;
         if (type == "float64" || type == "double") return DataType::FLOAT64;
+        if (type == "uint8") return DataType::UINT8;
+        if (type == "uint16") return DataType::UINT16;
+        if (type == "float16" || type == "half") return DataType::FLOAT16;
+        if (type == "bfloat16") return DataType::BFLOAT16;
         return DataType::UNKNOWN;
     }
 
@@ -58,6 +72,10 @@ namespace biomxt {
             case INT64: return sizeof(int64_t);
             case FLOAT32: return sizeof(float);
             case FLOAT64: return sizeof(double);
+            case UINT8: return sizeof(uint8_t);
+            case UINT16: return sizeof(uint16_t);
+            case FLOAT16: return sizeof(biomxt::float16);
+            case BFLOAT16: return sizeof(biomxt::bfloat16);
             default: return 0;
         }
     }
@@ -74,6 +92,10 @@ namespace biomxt {
     template<> struct dtype_from_type<int64_t> { static constexpr DataType value = DataType::INT64; static constexpr bool valid = true; };
     template<> struct dtype_from_type<float>   { static constexpr DataType value = DataType::FLOAT32; static constexpr bool valid = true; };
     template<> struct dtype_from_type<double>  { static constexpr DataType value = DataType::FLOAT64; static constexpr bool valid = true; };
+    template<> struct dtype_from_type<uint8_t> { static constexpr DataType value = DataType::UINT8; static constexpr bool valid = true; };
+    template<> struct dtype_from_type<uint16_t> { static constexpr DataType value = DataType::UINT16; static constexpr bool valid = true; };
+    template<> struct dtype_from_type<biomxt::float16> { static constexpr DataType value = DataType::FLOAT16; static constexpr bool valid = true; };
+    template<> struct dtype_from_type<biomxt::bfloat16> { static constexpr DataType value = DataType::BFLOAT16; static constexpr bool valid = true; };
 
     /**
      * @brief Get type from data type enum.
@@ -86,6 +108,10 @@ namespace biomxt {
     template <> struct type_from_dtype<DataType::INT64>   { using type = int64_t; };
     template <> struct type_from_dtype<DataType::FLOAT32> { using type = float; };
     template <> struct type_from_dtype<DataType::FLOAT64> { using type = double; };
+    template <> struct type_from_dtype<DataType::UINT8>   { using type = uint8_t; };
+    template <> struct type_from_dtype<DataType::UINT16>  { using type = uint16_t; };
+    template <> struct type_from_dtype<DataType::FLOAT16> { using type = biomxt::float16; };
+    template <> struct type_from_dtype<DataType::BFLOAT16> { using type = biomxt::bfloat16; };
 
 
 }
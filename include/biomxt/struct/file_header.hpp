@@ -1,26 +1,84 @@
 #pragma once
 #include <cstdint>
 #include <iostream>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <stdexcept>
 #include "./data_type.hpp"
 #include "./uuid.hpp"
 #include "./compress_algorithm.hpp"
+#include "./block_filter.hpp"
 
 
 #pragma pack(push, 1)
 
 namespace biomxt {
     /**
-     * @brief File header struct.
+     * @brief Flags of file header.
+     */
+    enum FileFlag : uint8_t {
+        HAS_DICTIONARY = 0x01,      ///< A zstd dictionary follows the header, as `uint32_t` size then content.
+        HAS_BLOCK_ENCODING = 0x02,  ///< Each block starts with its `BlockEncoding` byte, then sparse blocks with their count of nonzeros and integer encoded blocks with their encoded size, as `uint32_t`.
+        HAS_BLOCK_CODEC = 0x04,     ///< Each block starts with its codec byte, see `make_block_codec`, then as with `HAS_BLOCK_ENCODING`. Algorithm and filter of header do not apply.
+        HAS_BLOCK_FRAMES = 0x08,    ///< Each block is independent frames of `frame_height` rows behind an index of frame ends, see `pack_framed_block`. Each frame starts as a block would by the other flags.
+        COLUMN_MAJOR_BLOCKS = 0x10  ///< Cells of each block are stored column by column. Frames of `HAS_BLOCK_FRAMES` then hold `frame_height` columns.
+    };
+
+    /**
+     * @brief Format version written, readers also accept version 1.
+     */
+    inline constexpr uint16_t BMXT_VERSION = 2;
+
+    /**
+     * @brief File header struct, format version 2 on disk and in memory for any version.
      */
     struct FileHeader {
         char magic[4] = {'B', 'M', 'X', 't'};
 
-        uint16_t version = 1;
+        uint16_t version = BMXT_VERSION;
 
         DataType dtype = DataType::FLOAT32;
 
         CompressAlgorithm algo = CompressAlgorithm::ZSTD;
 
+        uint64_t nrow;
+
+        uint64_t ncol;
+
+        uint32_t block_width;
+
+        uint32_t block_height;
+
+        uint64_t block_count;
+
+        BlockFilter filter = BlockFilter::NONE;
+
+        uint8_t flags = 0;
+
+        uint16_t frame_height = 0;
+
+        uint8_t padding1[4] = {0, 0, 0, 0};
+
+        uint64_t block_table_offset;
+
+        uint64_t name_table_offset;
+
+        UUID uuid;
+    };
+
+    /**
+     * @brief File header of format version 1, with 32-bit dimensions and block count. Only read, then widened to `FileHeader`.
+     */
+    struct FileHeaderV1 {
+        char magic[4];
+
+        uint16_t version;
+
+        DataType dtype;
+
+        CompressAlgorithm algo;
+
         uint32_t nrow;
 
         uint32_t ncol;
@@ -31,7 +89,11 @@ namespace biomxt {
 
         uint32_t block_count;
 
-        uint32_t padding1 = 0;
+        BlockFilter filter;
+
+        uint8_t flags;
+
+        uint8_t padding1[2];
 
         uint64_t block_table_offset;
 
@@ -40,6 +102,72 @@ namespace biomxt {
         UUID uuid;
     };
 
+    static_assert(sizeof(FileHeaderV1) == 64 && sizeof(FileHeader) == 80, "biomxt::FileHeader layout must match the format");
+
+    /**
+     * @brief Size of file header on disk, where the dictionary or the first block starts.
+     * @param version Format version.
+     * @return size_t Size in bytes, 0 for an unknown version.
+     */
+    inline size_t header_size(uint16_t version) {
+        switch (version) {
+            case 1: return sizeof(FileHeaderV1);
+            case 2: return sizeof(FileHeader);
+            default: return 0;
+        }
+    }
+
+    /**
+     * @brief Read file header of any version from the beginning of a stream.
+     * @param in Stream positioned at the beginning of file, left right after the header.
+     * @param header Receives the header, version 1 fields are widened.
+     * @return size_t Size of header on disk.
+     * @throws `std::runtime_error` If the stream is too short, the magic is bad or the version is unknown.
+     */
+    inline size_t read_bmxt_header(std::istream& in, FileHeader& header) {
+        // Magic and version are at the same place in every version
+        char prefix[6];
+        if (!in.read(prefix, sizeof(prefix))) {
+            throw std::runtime_error("biomxt::read_bmxt_header: Corrupted file: bad header size");
+        }
+        if (std::string(prefix, 4) != "BMXt") {
+            throw std::runtime_error("biomxt::read_bmxt_header: Corrupted file: bad magic: " + std::string(prefix, 4));
+        }
+        uint16_t version;
+        std::memcpy(&version, prefix + 4, sizeof(version));
+        const size_t size = header_size(version);
+        if (size == 0) {
+            throw std::runtime_error("biomxt::read_bmxt_header: Unsupported format version [" + std::to_string(version) + "]");
+        }
+
+        std::vector<char> raw(size);
+        std::memcpy(raw.data(), prefix, sizeof(prefix));
+        if (!in.read(raw.data() + sizeof(prefix), size - sizeof(prefix))) {
+            throw std::runtime_error("biomxt::read_bmxt_header: Corrupted file: bad header size");
+        }
+        if (version == 1) {
+            FileHeaderV1 v1;
+            std::memcpy(&v1, raw.data(), sizeof(v1));
+            header = FileHeader();
+            header.version = v1.version;
+            header.dtype = v1.dtype;
+            header.algo = v1.algo;
+            header.nrow = v1.nrow;
+            header.ncol = v1.ncol;
+            header.block_width = v1.block_width;
+            header.block_height = v1.block_height;
+            header.block_count = v1.block_count;
+            header.filter = v1.filter;
+            header.flags = v1.flags;
+            header.block_table_offset = v1.block_table_offset;
+            header.name_table_offset = v1.name_table_offset;
+            header.uuid = v1.uuid;
+        } else {
+            std::memcpy(&header, raw.data(), sizeof(header));
+        }
+        return size;
+    }
+
     /**
      * @brief Print file header.
      * @param header File header to be printed.
@@ -49,6 +177,12 @@ namespace biomxt {
         std::cout << "Version: \t\t" << header.version << std::endl;
         std::cout << "Data type: \t\t" << biomxt::dtype_to_string(header.dtype) << std::endl;
         std::cout << "Compress algorithm: \t" << biomxt::algo_to_string(header.algo) << std::endl;
+        std::cout << "Block filter: \t\t" << biomxt::filter_to_string(header.filter) << std::endl;
+        std::cout << "Dictionary: \t\t" << ((header.flags & FileFlag::HAS_DICTIONARY) ? "yes" : "no") << std::endl;
+        std::cout << "Block encoding: \t" << ((header.flags & FileFlag::HAS_BLOCK_ENCODING) ? "yes" : "no") << std::endl;
+        std::cout << "Adaptive codec: \t" << ((header.flags & FileFlag::HAS_BLOCK_CODEC) ? "yes" : "no") << std::endl;
+        std::cout << "Block layout: \t\t" << ((header.flags & FileFlag::COLUMN_MAJOR_BLOCKS) ? "column-major" : "row-major") << std::endl;
+        std::cout << "Frame height: \t\t" << ((header.flags & FileFlag::HAS_BLOCK_FRAMES) ? std::to_string(header.frame_height) + ((header.flags & FileFlag::COLUMN_MAJOR_BLOCKS) ? " columns" : " rows") : "none") << std::endl;
         std::cout << "Row counts: \t\t" << header.nrow << std::endl;
         std::cout << "Column counts: \t\t" << header.ncol << std::endl;
         std::cout << "Block width: \t\t" << header.block_width << std::endl;
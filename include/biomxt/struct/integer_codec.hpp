@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+
+namespace biomxt
+{
+    /**
+     * @brief Codec of integer blocks, replacing raw little-endian integers ahead of compression.
+     * @note `NONE`: blocks are stored as raw integers.
+     * @note `FOR`: frame of reference, each group of 128 values is stored as its minimum and the bit-packed differences to it.
+     * @note `DELTA`: differences of consecutive values, zigzag mapped and bit-packed per group of 128 values.
+     * @note `FIXED`: values minus the block minimum, stored in the fewest whole bytes that fit them all, which suits a byte-oriented compressor behind.
+     * @note `AUTO`: the smallest of the above, chosen per block.
+     */
+    enum class IntegerCodec : uint8_t {
+        NONE = 0,
+        FOR = 1,
+        DELTA = 2,
+        FIXED = 3,
+        AUTO = 4
+    };
+
+    /**
+     * @brief Convert integer codec enum to string.
+     * @param codec Integer codec enum.
+     * @return std::string String representation of integer codec.
+     */
+    inline std::string integer_codec_to_string(IntegerCodec codec) {
+        switch (codec) {
+            case IntegerCodec::NONE: return "none";
+            case IntegerCodec::FOR: return "for";
+            case IntegerCodec::DELTA: return "delta";
+            case IntegerCodec::FIXED: return "fixed";
+            case IntegerCodec::AUTO: return "auto";
+            default: return "unknown";
+        }
+    }
+
+    /**
+     * @brief Convert string to integer codec enum.
+     * @param codec String representation of integer codec.
+     * @return `biomxt::IntegerCodec` Integer codec enum, `NONE` if not recognized.
+     */
+    inline IntegerCodec integer_codec_from_string(const std::string& codec) {
+        if (codec == "for") return IntegerCodec::FOR;
+        if (codec == "delta") return IntegerCodec::DELTA;
+        if (codec == "fixed") return IntegerCodec::FIXED;
+        if (codec == "auto") return IntegerCodec::AUTO;
+        return IntegerCodec::NONE;
+    }
+} // namespace biomxt
@@ -0,0 +1,121 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+
+
+namespace biomxt
+{
+    /**
+     * @brief Convert float to IEEE half precision bits, rounding to nearest even.
+     * @param value Float value.
+     * @return uint16_t Half bits, values beyond 65504 round to infinity and NaN stays NaN.
+     */
+    inline uint16_t float_to_half_bits(float value) {
+        uint32_t u;
+        std::memcpy(&u, &value, sizeof(u));
+        const uint32_t sign = u & 0x80000000u;
+        u ^= sign;
+
+        uint16_t bits;
+        if (u >= 0x47800000u) {
+            // Out of range, infinity or NaN
+            bits = u > 0x7F800000u ? 0x7E00 : 0x7C00;
+        } else if (u < 0x38800000u) {
+            // Subnormal half or zero, the float adder rounds the mantissa for us
+            const uint32_t magic_bits = 0x3F000000u;
+            float magic, f;
+            std::memcpy(&magic, &magic_bits, sizeof(magic));
+            std::memcpy(&f, &u, sizeof(f));
+            f += magic;
+            std::memcpy(&u, &f, sizeof(u));
+            bits = static_cast<uint16_t>(u - magic_bits);
+        } else {
+            // Normal half, rebias exponent and round half to even, a carry may round up to infinity
+            const uint32_t odd = (u >> 13) & 1;
+            u += 0xC8000FFFu + odd;
+            bits = static_cast<uint16_t>(u >> 13);
+        }
+        return bits | static_cast<uint16_t>(sign >> 16);
+    }
+
+    /**
+     * @brief Convert IEEE half precision bits to float, exactly.
+     * @param bits Half bits.
+     * @return float Float value.
+     */
+    inline float half_bits_to_float(uint16_t bits) {
+        uint32_t u = static_cast<uint32_t>(bits & 0x7FFF) << 13;
+        const uint32_t exponent = u & 0x0F800000u;
+        u += 0x38000000u;
+        if (exponent == 0x0F800000u) {
+            // Infinity or NaN
+            u += 0x38000000u;
+        } else if (exponent == 0) {
+            // Subnormal half, renormalized by the float subtractor
+            u += 0x00800000u;
+            const uint32_t magic_bits = 0x38800000u;
+            float magic, f;
+            std::memcpy(&magic, &magic_bits, sizeof(magic));
+            std::memcpy(&f, &u, sizeof(f));
+            f -= magic;
+            std::memcpy(&u, &f, sizeof(u));
+        }
+        u |= static_cast<uint32_t>(bits & 0x8000) << 16;
+        float value;
+        std::memcpy(&value, &u, sizeof(value));
+        return value;
+    }
+
+    /**
+     * @brief Convert float to bfloat16 bits, rounding to nearest even.
+     * @param value Float value.
+     * @return uint16_t Bfloat16 bits, the upper half of the rounded float, NaN stays NaN.
+     */
+    inline uint16_t float_to_bfloat16_bits(float value) {
+        uint32_t u;
+        std::memcpy(&u, &value, sizeof(u));
+        if ((u & 0x7FFFFFFFu) > 0x7F800000u) {
+            return static_cast<uint16_t>((u >> 16) | 0x0040);
+        }
+        u += 0x7FFFu + ((u >> 16) & 1);
+        return static_cast<uint16_t>(u >> 16);
+    }
+
+    /**
+     * @brief Convert bfloat16 bits to float, exactly.
+     * @param bits Bfloat16 bits.
+     * @return float Float value.
+     */
+    inline float bfloat16_bits_to_float(uint16_t bits) {
+        const uint32_t u = static_cast<uint32_t>(bits) << 16;
+        float value;
+        std::memcpy(&value, &u, sizeof(value));
+        return value;
+    }
+
+    /**
+     * @brief IEEE half precision storage type: 5 bits of exponent, 10 of mantissa, up to 65504.
+     * @note Quantized from float on construction, expanded back to float on conversion. No arithmetic, values are only stored.
+     */
+    struct float16 {
+        uint16_t bits = 0;
+
+        float16() = default;
+        float16(float value) : bits(biomxt::float_to_half_bits(value)) {}
+        operator float() const { return biomxt::half_bits_to_float(bits); }
+    };
+
+    /**
+     * @brief Bfloat16 storage type: the float exponent with 7 bits of mantissa, so that the whole float range is kept.
+     * @note Quantized from float on construction, expanded back to float on conversion. No arithmetic, values are only stored.
+     */
+    struct bfloat16 {
+        uint16_t bits = 0;
+
+        bfloat16() = default;
+        bfloat16(float value) : bits(biomxt::float_to_bfloat16_bits(value)) {}
+        operator float() const { return biomxt::bfloat16_bits_to_float(bits); }
+    };
+
+    static_assert(sizeof(float16) == 2 && sizeof(bfloat16) == 2, "biomxt::float16 and biomxt::bfloat16 must be 2 bytes");
+} // namespace biomxt
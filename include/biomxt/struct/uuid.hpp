@@ -4,6 +4,8 @@
 #include <sstream>
 #include <iomanip>
 #include <cstring>
+#include <cctype>
+#include <stdexcept>
 
 
 namespace biomxt {
@@ -45,6 +47,30 @@ namespace biomxt {
             return ss.str();
         }
 
+        /**
+         * @brief Parse a UUID from its string representation.
+         * @param str String like "xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx".
+         * @return `biomxt::UUID` The parsed UUID.
+         * @throws `std::invalid_argument` If the string is not a valid UUID.
+         */
+        static UUID from_string(const std::string& str) {
+            UUID uuid;
+            size_t pos = 0;
+            for (int i = 0; i < 16; ++i) {
+                if (i == 4 || i == 6 || i == 8 || i == 10) {
+                    if (pos >= str.size() || str[pos] != '-') throw std::invalid_argument("biomxt::UUID::from_string: Invalid UUID: " + str);
+                    pos++;
+                }
+                if (pos + 2 > str.size() || !std::isxdigit(str[pos]) || !std::isxdigit(str[pos + 1])) {
+                    throw std::invalid_argument("biomxt::UUID::from_string: Invalid UUID: " + str);
+                }
+                uuid.data[i] = static_cast<uint8_t>(std::stoi(str.substr(pos, 2), nullptr, 16));
+                pos += 2;
+            }
+            if (pos != str.size()) throw std::invalid_argument("biomxt::UUID::from_string: Invalid UUID: " + str);
+            return uuid;
+        }
+
         bool operator==(const UUID& other) const {
             return std::memcmp(data, other.data, 16) == 0;
         }
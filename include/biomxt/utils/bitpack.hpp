@@ -0,0 +1,38 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+
+namespace biomxt {
+
+    /**
+     * @brief Count of values of a bit-packed group.
+     */
+    constexpr size_t BITPACK_GROUP = 128;
+
+    /**
+     * @brief Count of bits needed by the largest of some values.
+     * @param values Values.
+     * @param count Count of values.
+     * @return uint32_t Bit width, 0 if all values are 0.
+     */
+    uint32_t bit_width(const uint32_t* values, size_t count);
+
+    /**
+     * @brief Bit-pack a group of 128 values into `4*bits` words.
+     * @param in 128 values, each below `2^bits`.
+     * @param bits Bit width of values, 0 to 32.
+     * @param out Packed words, need not be aligned, nothing is written for a width of 0.
+     * @note Values are spread over 4 interleaved lanes, value i in lane `i%4`, so that SSE2 packs and unpacks 4 values per instruction.
+     */
+    void pack128(const uint32_t* in, uint32_t bits, uint32_t* out);
+
+    /**
+     * @brief Revert `pack128`.
+     * @param in `4*bits` packed words, need not be aligned.
+     * @param bits Bit width of values, 0 to 32.
+     * @param out 128 values.
+     */
+    void unpack128(const uint32_t* in, uint32_t bits, uint32_t* out);
+
+} // namespace biomxt
@@ -0,0 +1,406 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <stdexcept>
+#include "zstd.h"
+#include "zstd_errors.h"
+#include "zdict.h"
+#include "../struct/compress_algorithm.hpp"
+#include "../struct/block_filter.hpp"
+#include "../struct/block_encoding.hpp"
+#include "../struct/integer_codec.hpp"
+#include "../struct/codec_policy.hpp"
+#include "../struct/file_header.hpp"
+
+
+namespace biomxt {
+
+    /**
+     * @brief Zstd dictionary shared by all blocks of a file, digested once into prepared dictionaries.
+     * @note Safe to use from any thread, compression and decompression contexts are kept per thread by the codec.
+     */
+    class BlockDictionary {
+        public:
+            /**
+             * @brief Digest a dictionary.
+             * @param data Dictionary content, e.g. trained by `train_dictionary`.
+             * @param for_compression Also digest it for compression, readers only need decompression.
+             * @throws `std::runtime_error` If zstd fails to load the dictionary.
+             */
+            BlockDictionary(std::vector<char> data, bool for_compression);
+
+            ~BlockDictionary();
+
+            BlockDictionary(const BlockDictionary&) = delete;
+            BlockDictionary& operator=(const BlockDictionary&) = delete;
+
+            /**
+             * @brief Get dictionary content.
+             * @return `const std::vector<char>&` Dictionary content.
+             */
+            const std::vector<char>& data() const;
+
+            /**
+             * @brief Get the digested dictionary for compression.
+             * @return `const ZSTD_CDict*` Digested dictionary, nullptr if not digested for compression.
+             */
+            const ZSTD_CDict* cdict() const;
+
+            /**
+             * @brief Get the digested dictionary for decompression.
+             * @return `const ZSTD_DDict*` Digested dictionary.
+             */
+            const ZSTD_DDict* ddict() const;
+
+        private:
+            std::vector<char> _data;
+            ZSTD_CDict* _cdict = nullptr;
+            ZSTD_DDict* _ddict = nullptr;
+    };
+
+    /**
+     * @brief Train a zstd dictionary from sample blocks.
+     * @param samples Sample blocks, concatenated.
+     * @param sample_sizes Size of each sample in bytes.
+     * @param dictionary_size Max size of dictionary in bytes.
+     * @return `std::vector<char>` Dictionary content, empty if samples are too few or too small to train on.
+     */
+    std::vector<char> train_dictionary(
+        const std::vector<char>& samples,
+        const std::vector<size_t>& sample_sizes,
+        size_t dictionary_size);
+
+    /**
+     * @brief Compress a raw block.
+     * @param src Raw block data.
+     * @param src_size Size of raw block data in bytes.
+     * @param algo Compression algorithm to be used.
+     * @param dst Buffer to store compressed data, grown to the compress bound if needed.
+     * @param dictionary Dictionary of the file, nullptr for none.
+     * @param level Level of zstd, 0 for the default level 3. Ignored with a dictionary, which is digested at the default level.
+     * @return size_t Compressed size in bytes.
+     * @throws `std::invalid_argument` If compress algo is not supported, or a dictionary is given for other algo than zstd.
+     * @throws `std::runtime_error` If compression fails.
+     * @note Levels of other algorithms are fixed: gzip default deflate, lz4 fast, lz4hc default HC level. Store copies the block.
+     */
+    size_t compress_block(
+        const char* src,
+        size_t src_size,
+        biomxt::CompressAlgorithm algo,
+        std::vector<char>& dst,
+        const biomxt::BlockDictionary* dictionary = nullptr,
+        int level = 0);
+
+    /**
+     * @brief Decompress a block.
+     * @param src Compressed block data.
+     * @param src_size Size of compressed data in bytes.
+     * @param algo Compression algorithm of the block.
+     * @param dst Buffer to store decompressed data.
+     * @param dst_size Expected decompressed size in bytes.
+     * @param dictionary Dictionary of the file, nullptr for none.
+     * @throws `std::invalid_argument` If compress algo is not supported, or a dictionary is given for other algo than zstd.
+     * @throws `std::runtime_error` If decompression fails or size mismatch.
+     */
+    void decompress_block(
+        const char* src,
+        size_t src_size,
+        biomxt::CompressAlgorithm algo,
+        char* dst,
+        size_t dst_size,
+        const biomxt::BlockDictionary* dictionary = nullptr);
+
+    /**
+     * @brief Apply a filter to a raw block before compression.
+     * @param src Raw block data.
+     * @param size Size of raw block data in bytes.
+     * @param filter Filter to be applied.
+     * @param element_size Size of each element in bytes.
+     * @param dst Buffer to store filtered data, at least size bytes, must not overlap src.
+     * @throws `std::invalid_argument` If filter is not supported.
+     */
+    void filter_block(
+        const char* src,
+        size_t size,
+        biomxt::BlockFilter filter,
+        size_t element_size,
+        char* dst);
+
+    /**
+     * @brief Revert a filter after decompression.
+     * @param src Filtered block data.
+     * @param size Size of block data in bytes.
+     * @param filter Filter applied to the block.
+     * @param element_size Size of each element in bytes.
+     * @param dst Buffer to store raw data, at least size bytes, must not overlap src.
+     * @throws `std::invalid_argument` If filter is not supported.
+     */
+    void unfilter_block(
+        const char* src,
+        size_t size,
+        biomxt::BlockFilter filter,
+        size_t element_size,
+        char* dst);
+
+    /**
+     * @brief Check blocks are stored with their encoding ahead, as in files flagged `HAS_BLOCK_ENCODING`.
+     * @param sparse_threshold Max density of nonzeros of a sparse block.
+     * @param integer_codec Integer codec of blocks, `NONE` for other data types than integers.
+     * @return bool True if blocks may be encoded otherwise than dense.
+     */
+    inline bool has_block_encoding(float sparse_threshold, biomxt::IntegerCodec integer_codec) {
+        return sparse_threshold > 0 || integer_codec != biomxt::IntegerCodec::NONE;
+    }
+
+    /**
+     * @brief Get the file flags telling how blocks packed with these options start.
+     * @param sparse_threshold Max density of nonzeros of a sparse block.
+     * @param integer_codec Integer codec of blocks, `NONE` for other data types than integers.
+     * @param policy Adaptive codec policy.
+     * @return uint8_t `HAS_BLOCK_CODEC` for adaptive blocks, else `HAS_BLOCK_ENCODING` if `has_block_encoding`, else 0.
+     */
+    inline uint8_t block_flags(float sparse_threshold, biomxt::IntegerCodec integer_codec, const biomxt::CodecPolicy& policy) {
+        if (policy.adaptive) return biomxt::FileFlag::HAS_BLOCK_CODEC;
+        return biomxt::has_block_encoding(sparse_threshold, integer_codec) ? biomxt::FileFlag::HAS_BLOCK_ENCODING : 0;
+    }
+
+    /**
+     * @brief Encode a raw block into the payload to be compressed: sparse encoded if its density of nonzeros is at most sparse_threshold, else integer encoded if it gets smaller, then filtered.
+     * @param src Raw block data.
+     * @param size Size of raw block data in bytes.
+     * @param element_size Size of each element in bytes.
+     * @param filter Filter applied to the block, or to the packed nonzeros of a sparse block. Integer encoded payloads are not filtered.
+     * @param sparse_threshold Max density of nonzeros of a sparse block, 0 to keep every block dense.
+     * @param integer_codec Integer codec of blocks, must be `NONE` for other data types than integers. Elements of 8 bytes stay dense.
+     * @param payload Buffer to store the payload, resized to its size.
+     * @return `biomxt::BlockEncoding` Encoding of the payload.
+     * @note A `BITMAP` payload is the bitmap then the nonzeros, its count of nonzeros is `(payload.size() - bitmap_size(count)) / element_size`.
+     */
+    biomxt::BlockEncoding encode_block(
+        const char* src,
+        size_t size,
+        size_t element_size,
+        biomxt::BlockFilter filter,
+        float sparse_threshold,
+        biomxt::IntegerCodec integer_codec,
+        std::vector<char>& payload);
+
+    /**
+     * @brief Encode and compress a raw block as stored in file.
+     * @param src Raw block data.
+     * @param size Size of raw block data in bytes.
+     * @param element_size Size of each element in bytes.
+     * @param algo Compression algorithm to be used.
+     * @param filter Filter applied to the block.
+     * @param sparse_threshold Max density of nonzeros of a sparse block, 0 to keep every block dense.
+     * @param integer_codec Integer codec of blocks, must be `NONE` for other data types than integers.
+     * @param dst Buffer to store the block, grown if needed.
+     * @param dictionary Dictionary of the file, nullptr for none.
+     * @param policy Adaptive codec policy. If adaptive, algo, filter and sparse_threshold are chosen per block, and the integer codec is one more candidate.
+     * @return size_t Size of stored block in bytes.
+     * @note If `has_block_encoding`, the block starts with its `BlockEncoding` byte, then a `BITMAP` block with its count of nonzeros and an integer encoded block with its payload size as `uint32_t`. Otherwise the block is only filtered and compressed.
+     * @note If adaptive, the block starts with its codec byte of `make_block_codec` instead of the encoding byte. The dictionary only serves zstd candidates.
+     */
+    size_t pack_block(
+        const char* src,
+        size_t size,
+        size_t element_size,
+        biomxt::CompressAlgorithm algo,
+        biomxt::BlockFilter filter,
+        float sparse_threshold,
+        biomxt::IntegerCodec integer_codec,
+        std::vector<char>& dst,
+        const biomxt::BlockDictionary* dictionary = nullptr,
+        const biomxt::CodecPolicy& policy = {});
+
+    /**
+     * @brief Decompress and decode a block as stored in file, back to raw block data.
+     * @param src Stored block data.
+     * @param src_size Size of stored block in bytes.
+     * @param element_size Size of each element in bytes.
+     * @param algo Compression algorithm of the block, unless it starts with its codec.
+     * @param filter Filter applied to the block, unless it starts with its codec.
+     * @param flags File flags, `HAS_BLOCK_ENCODING` or `HAS_BLOCK_CODEC` tell what the block starts with.
+     * @param dst Buffer to store raw block data.
+     * @param dst_size Raw block size in bytes.
+     * @param dictionary Dictionary of the file, nullptr for none.
+     * @throws `std::runtime_error` If the block is corrupted, or decompression fails.
+     * @note Sparse and integer encoded blocks are decoded straight into dst.
+     */
+    void unpack_block(
+        const char* src,
+        size_t src_size,
+        size_t element_size,
+        biomxt::CompressAlgorithm algo,
+        biomxt::BlockFilter filter,
+        uint8_t flags,
+        char* dst,
+        size_t dst_size,
+        const biomxt::BlockDictionary* dictionary = nullptr);
+
+    /**
+     * @brief Decompress a block as stored in file, leaving a sparse block as its bitmap and packed nonzeros instead of decoding it to dense.
+     * @param src Stored block data.
+     * @param src_size Size of stored block in bytes.
+     * @param element_size Size of each element in bytes.
+     * @param algo Compression algorithm of the block, unless it starts with its codec.
+     * @param filter Filter applied to the block, unless it starts with its codec.
+     * @param flags File flags, `HAS_BLOCK_ENCODING` or `HAS_BLOCK_CODEC` tell what the block starts with.
+     * @param dst Buffer to store raw block data of a block other than sparse, left untouched for a sparse block.
+     * @param dst_size Raw block size in bytes.
+     * @param bitmap Receives the bitmap of nonzero elements of a sparse block, `bitmap_size(dst_size / element_size)` bytes.
+     * @param values Receives the nonzero elements of a sparse block, packed and unfiltered.
+     * @param dictionary Dictionary of the file, nullptr for none.
+     * @return bool True if the block is sparse, and bitmap and values hold it.
+     * @throws `std::runtime_error` If the block is corrupted, or decompression fails.
+     */
+    bool unpack_block_sparse(
+        const char* src,
+        size_t src_size,
+        size_t element_size,
+        biomxt::CompressAlgorithm algo,
+        biomxt::BlockFilter filter,
+        uint8_t flags,
+        char* dst,
+        size_t dst_size,
+        std::vector<char>& bitmap,
+        std::vector<char>& values,
+        const biomxt::BlockDictionary* dictionary = nullptr);
+
+    /**
+     * @brief Get the count of frames a block is split into.
+     * @param rows Count of rows of the block.
+     * @param frame_height Rows per frame, must not be 0.
+     * @return size_t Count of frames, the last one may be shorter.
+     */
+    inline size_t frame_count(size_t rows, uint32_t frame_height) {
+        return (rows + frame_height - 1) / frame_height;
+    }
+
+    /**
+     * @brief Pack a raw block as independent frames of a few rows each, as stored in files flagged `HAS_BLOCK_FRAMES`.
+     * @param src Raw block data, row-major, or column-major with frames of columns.
+     * @param size Size of raw block data in bytes.
+     * @param element_size Size of each element in bytes.
+     * @param row_size Size of a row of the block in bytes, of a column for column-major blocks.
+     * @param frame_height Rows per frame, or columns, must not be 0.
+     * @param algo Compression algorithm to be used.
+     * @param filter Filter applied to each frame.
+     * @param sparse_threshold Max density of nonzeros of a sparse frame, 0 to keep every frame dense.
+     * @param integer_codec Integer codec of frames, must be `NONE` for other data types than integers.
+     * @param dst Buffer to store the block, grown if needed.
+     * @param dictionary Dictionary of the file, nullptr for none.
+     * @param policy Adaptive codec policy, applied per frame.
+     * @return size_t Size of stored block in bytes.
+     * @throws `std::runtime_error` If a frame ends beyond 4 GiB.
+     * @note The block starts with the end of each frame as `uint32_t`, counted from the end of this index, then each frame as stored by `pack_block`.
+     */
+    size_t pack_framed_block(
+        const char* src,
+        size_t size,
+        size_t element_size,
+        size_t row_size,
+        uint32_t frame_height,
+        biomxt::CompressAlgorithm algo,
+        biomxt::BlockFilter filter,
+        float sparse_threshold,
+        biomxt::IntegerCodec integer_codec,
+        std::vector<char>& dst,
+        const biomxt::BlockDictionary* dictionary = nullptr,
+        const biomxt::CodecPolicy& policy = {});
+
+    /**
+     * @brief Unpack a single frame of a block stored by `pack_framed_block`, leaving other frames compressed.
+     * @param src Stored block data.
+     * @param src_size Size of stored block in bytes.
+     * @param element_size Size of each element in bytes.
+     * @param row_size Size of a row of the block in bytes, of a column for column-major blocks.
+     * @param frame_height Rows per frame, must not be 0.
+     * @param block_size Raw size of the whole block in bytes.
+     * @param frame Frame to unpack, the one holding row `frame * frame_height` of the block.
+     * @param algo Compression algorithm of frames, unless they start with their codec.
+     * @param filter Filter applied to frames, unless they start with their codec.
+     * @param flags File flags, tell what each frame starts with as for `unpack_block`.
+     * @param dst Buffer to store raw rows of the frame, at least `frame_height * row_size` bytes.
+     * @param dictionary Dictionary of the file, nullptr for none.
+     * @return size_t Raw size of the frame in bytes.
+     * @throws `std::runtime_error` If the frame index is corrupted or out of range, or the frame fails to unpack.
+     */
+    size_t unpack_block_frame(
+        const char* src,
+        size_t src_size,
+        size_t element_size,
+        size_t row_size,
+        uint32_t frame_height,
+        size_t block_size,
+        size_t frame,
+        biomxt::CompressAlgorithm algo,
+        biomxt::BlockFilter filter,
+        uint8_t flags,
+        char* dst,
+        const biomxt::BlockDictionary* dictionary = nullptr);
+
+    /**
+     * @brief Unpack a single frame of a block stored by `pack_framed_block`, leaving a sparse frame as its bitmap and packed nonzeros.
+     * @param src Stored block data.
+     * @param src_size Size of stored block in bytes.
+     * @param element_size Size of each element in bytes.
+     * @param row_size Size of a row of the block in bytes, of a column for column-major blocks.
+     * @param frame_height Rows per frame, must not be 0.
+     * @param block_size Raw size of the whole block in bytes.
+     * @param frame Frame to unpack, the one holding row `frame * frame_height` of the block.
+     * @param algo Compression algorithm of frames, unless they start with their codec.
+     * @param filter Filter applied to frames, unless they start with their codec.
+     * @param flags File flags, tell what each frame starts with as for `unpack_block`.
+     * @param dst Buffer to store raw rows of a frame other than sparse, at least `frame_height * row_size` bytes.
+     * @param bitmap Receives the bitmap of nonzero elements of a sparse frame.
+     * @param values Receives the nonzero elements of a sparse frame, packed and unfiltered.
+     * @param dictionary Dictionary of the file, nullptr for none.
+     * @return bool True if the frame is sparse, and bitmap and values hold it.
+     * @throws `std::runtime_error` If the frame index is corrupted or out of range, or the frame fails to unpack.
+     */
+    bool unpack_block_frame_sparse(
+        const char* src,
+        size_t src_size,
+        size_t element_size,
+        size_t row_size,
+        uint32_t frame_height,
+        size_t block_size,
+        size_t frame,
+        biomxt::CompressAlgorithm algo,
+        biomxt::BlockFilter filter,
+        uint8_t flags,
+        char* dst,
+        std::vector<char>& bitmap,
+        std::vector<char>& values,
+        const biomxt::BlockDictionary* dictionary = nullptr);
+
+    /**
+     * @brief Unpack every frame of a block stored by `pack_framed_block`, back to raw block data.
+     * @param src Stored block data.
+     * @param src_size Size of stored block in bytes.
+     * @param element_size Size of each element in bytes.
+     * @param row_size Size of a row of the block in bytes, of a column for column-major blocks.
+     * @param frame_height Rows per frame, must not be 0.
+     * @param algo Compression algorithm of frames, unless they start with their codec.
+     * @param filter Filter applied to frames, unless they start with their codec.
+     * @param flags File flags, tell what each frame starts with as for `unpack_block`.
+     * @param dst Buffer to store raw block data.
+     * @param dst_size Raw block size in bytes.
+     * @param dictionary Dictionary of the file, nullptr for none.
+     * @throws `std::runtime_error` If the frame index is corrupted, or a frame fails to unpack.
+     */
+    void unpack_framed_block(
+        const char* src,
+        size_t src_size,
+        size_t element_size,
+        size_t row_size,
+        uint32_t frame_height,
+        biomxt::CompressAlgorithm algo,
+        biomxt::BlockFilter filter,
+        uint8_t flags,
+        char* dst,
+        size_t dst_size,
+        const biomxt::BlockDictionary* dictionary = nullptr);
+
+} // namespace biomxt
@@ -0,0 +1,286 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+#include <fstream>
+#include <algorithm>
+#include <stdexcept>
+#include "../struct/index_entry.hpp"
+#include "../struct/compress_algorithm.hpp"
+#include "../struct/data_type.hpp"
+#include "./block_codec.hpp"
+
+
+namespace biomxt {
+
+    /**
+     * @brief Copy one block out of a strip of rows, row-major inside the block.
+     * @param rows_buffer Strip of rows, a row-major arena of row_size columns per row.
+     * @param row_size Count of columns per row in the strip.
+     * @param column_begin First column of the block.
+     * @param actual_block_width Width of the block.
+     * @param actual_block_height Height of the block, rows used from the strip.
+     * @param block Block buffer, resized to width*height.
+     * @note Each block row is one contiguous span of the arena, so assembling is a memcpy per row with both sides streaming.
+     */
+    template <typename T> void assemble_block(
+        const T* rows_buffer,
+        uint32_t row_size,
+        uint32_t column_begin,
+        uint32_t actual_block_width,
+        uint32_t actual_block_height,
+        std::vector<T>& block);
+
+    /**
+     * @brief Copy one block out of a strided view, row-major inside the block.
+     * @param origin Element (0, 0) of the view, element (i, j) is at `origin[i*row_stride + j*column_stride]`.
+     * @param row_stride Distance between rows in elements.
+     * @param column_stride Distance between columns in elements.
+     * @param column_begin First column of the block.
+     * @param actual_block_width Width of the block.
+     * @param actual_block_height Height of the block, rows used from the view.
+     * @param block Block buffer, resized to width*height.
+     * @note Row-major views (column_stride 1) copy a span per row. Column-major views (row_stride 1) are transposed in tiles, so that both reads and writes stay in cache.
+     */
+    template <typename T> void assemble_block_strided(
+        const T* origin,
+        size_t row_stride,
+        size_t column_stride,
+        uint32_t column_begin,
+        uint32_t actual_block_width,
+        uint32_t actual_block_height,
+        std::vector<T>& block);
+
+    /**
+     * @brief Compression pipeline of block rows: N workers assemble and compress blocks, an ordered writer appends them to file.
+     * @note Strips are pushed by the producer (e.g. a parser), each strip is a block row of up to block_height rows.
+     * @note Memory is bounded by max_inflight_rows strips, `push` blocks while that many strips are not written yet.
+     * @note Blocks are written strictly in block index order, so that offsets in block table grow with index.
+     * @note With a dictionary size, blocks of the first strip are sampled to train a zstd dictionary, written as `uint32_t` size and content ahead of the first block.
+     * @note With a sparse threshold or an integer codec, blocks are written with their encoding ahead, as `pack_block` does, so that the file must be flagged `HAS_BLOCK_ENCODING`.
+     * @note With an adaptive policy, blocks are written with their codec ahead, so that the file must be flagged `HAS_BLOCK_CODEC`. A dictionary is only trained if algo is zstd.
+     * @note With a frame height, blocks are written as frames by `pack_framed_block`, so that the file must be flagged `HAS_BLOCK_FRAMES`.
+     * @note Column-major blocks are assembled from the transposed view, so that the file must be flagged `COLUMN_MAJOR_BLOCKS`.
+     */
+    template <typename T> class BlockPipeline {
+        public:
+            /**
+             * @brief Start the pipeline threads.
+             * @param out Output file stream, blocks are appended at its current position.
+             * @param block_width Width of each block.
+             * @param algo Compression algorithm to be used.
+             * @param threads Count of compression workers, 0 for hardware concurrency.
+             * @param max_inflight_rows Max block rows pushed but not written, 0 for twice the workers.
+             * @param filter Filter applied to each block before compression.
+             * @param dictionary_size Max size of dictionary trained on the first strip in bytes, 0 or other algo than zstd for none.
+             * @param sparse_threshold Max density of nonzeros of a block stored sparse, 0 to store every block dense.
+             * @param integer_codec Integer codec of blocks, must be `NONE` unless T is an integer.
+             * @param policy Adaptive codec policy, see `pack_block`.
+             * @param frame_height Rows per frame of a block, columns if column-major, 0 to compress blocks whole.
+             * @param column_major Store cells of each block column by column.
+             */
+            BlockPipeline(
+                std::ofstream& out,
+                uint32_t block_width,
+                biomxt::CompressAlgorithm algo,
+                uint32_t threads,
+                uint32_t max_inflight_rows,
+                biomxt::BlockFilter filter = biomxt::BlockFilter::NONE,
+                uint32_t dictionary_size = 0,
+                float sparse_threshold = 0,
+                biomxt::IntegerCodec integer_codec = biomxt::IntegerCodec::NONE,
+                biomxt::CodecPolicy policy = {},
+                uint16_t frame_height = 0,
+                bool column_major = false);
+
+            /**
+             * @brief Stop the pipeline threads, unfinished strips are dropped.
+             */
+            ~BlockPipeline();
+
+            BlockPipeline(const BlockPipeline&) = delete;
+            BlockPipeline& operator=(const BlockPipeline&) = delete;
+
+            /**
+             * @brief Push a block row to be compressed and written.
+             * @param rows_buffer Strip of rows as a row-major arena, moved into the pipeline. Rows beyond actual_block_height are ignored.
+             * @param row_size Count of columns per row.
+             * @param actual_block_height Count of rows used in the strip.
+             * @throws `std::invalid_argument` If actual_block_height is 0 or rows_buffer is smaller than the rows.
+             * @throws `std::runtime_error` If a worker or the writer failed, or the pipeline is finished.
+             * @note Blocks until the count of inflight block rows drops below the limit.
+             */
+            void push(std::vector<T>&& rows_buffer, uint32_t row_size, uint32_t actual_block_height);
+
+            /**
+             * @brief Push a block row borrowed from memory owned by the caller, e.g. a memory-mapped array.
+             * @param origin Element (0, 0) of the block row, element (i, j) is at `origin[i*row_stride + j*column_stride]`.
+             * @param row_size Count of columns per row.
+             * @param actual_block_height Count of rows in the block row.
+             * @param row_stride Distance between rows in elements.
+             * @param column_stride Distance between columns in elements.
+             * @throws `std::invalid_argument` If actual_block_height is 0.
+             * @throws `std::runtime_error` If a worker or the writer failed, or the pipeline is finished.
+             * @note Memory must stay valid until `finish` returns. Nothing is copied until workers assemble blocks.
+             */
+            void push_view(const T* origin, uint32_t row_size, uint32_t actual_block_height, size_t row_stride, size_t column_stride);
+
+            /**
+             * @brief Push a block row whose blocks are generated on demand, e.g. densified out of sparse entries.
+             * @param generate Called by workers as `generate(block_x, block)`, fills block x of the strip resized to width*height, in the layout of the file.
+             * @param row_size Count of columns per row.
+             * @param actual_block_height Count of rows in the block row.
+             * @throws `std::invalid_argument` If actual_block_height is 0.
+             * @throws `std::runtime_error` If a worker or the writer failed, or the pipeline is finished.
+             * @note Generator is called concurrently for different blocks, and is kept until the strip is written.
+             */
+            void push_generated(std::function<void(uint32_t, std::vector<T>&)> generate, uint32_t row_size, uint32_t actual_block_height);
+
+            /**
+             * @brief Compress with a dictionary already in the output file instead of training one, e.g. when resuming.
+             * @param dictionary Dictionary content.
+             * @throws `std::runtime_error` If a strip was pushed already.
+             */
+            void use_dictionary(std::vector<char> dictionary);
+
+            /**
+             * @brief Get the dictionary blocks are compressed with.
+             * @return `const biomxt::BlockDictionary*` Dictionary, nullptr if none was trained or given.
+             * @note Only safe to call from the pushing thread, or after `finish`.
+             */
+            const biomxt::BlockDictionary* dictionary() const;
+
+            /**
+             * @brief Take back a written strip for reuse, avoiding reallocation of rows.
+             * @param rows_buffer Receives a recycled strip if any.
+             * @return bool True if a strip was recycled.
+             */
+            bool recycle(std::vector<T>& rows_buffer);
+
+            /**
+             * @brief Wait for all pushed block rows to be written, keeping the threads running.
+             * @return `const std::vector<biomxt::IndexEntry>&` Block table of written blocks, valid until the next push.
+             * @throws `std::runtime_error` If a worker or the writer failed.
+             * @note The output stream is idle on return, so that it can be flushed, e.g. for a checkpoint.
+             */
+            const std::vector<biomxt::IndexEntry>& drain();
+
+            /**
+             * @brief Wait for all pushed block rows to be written, then stop the threads.
+             * @return `const std::vector<biomxt::IndexEntry>&` Block table of written blocks.
+             * @throws `std::runtime_error` If a worker or the writer failed.
+             */
+            const std::vector<biomxt::IndexEntry>& finish();
+
+            /**
+             * @brief Get the block table of blocks written so far.
+             * @return `const std::vector<biomxt::IndexEntry>&` Block table.
+             * @note Only safe to call after `finish`.
+             */
+            const std::vector<biomxt::IndexEntry>& block_table() const;
+
+        private:
+            /**
+             * @brief A block row in flight.
+             */
+            struct Strip {
+                std::vector<T> rows;
+                const T* origin = nullptr;
+                size_t row_stride = 0;
+                size_t column_stride = 1;
+                std::function<void(uint32_t, std::vector<T>&)> generate;     ///< Generator of blocks, instead of a view.
+                uint32_t row_size = 0;
+                uint32_t height = 0;
+                uint32_t block_count = 0;
+                uint32_t done = 0;
+                std::vector<std::vector<char>> compressed;
+                std::vector<uint32_t> raw_sizes;
+            };
+
+            /**
+             * @brief A block to be assembled and compressed.
+             */
+            struct Task {
+                Strip* strip;
+                uint32_t block_x;
+            };
+
+            std::ofstream& _out;
+            uint32_t _block_width;
+            biomxt::CompressAlgorithm _algo;
+            biomxt::BlockFilter _filter;
+            float _sparse_threshold;
+            biomxt::IntegerCodec _integer_codec;
+            biomxt::CodecPolicy _policy;
+            uint16_t _frame_height;
+            bool _column_major;
+            uint32_t _max_inflight_rows;
+            uint32_t _dictionary_size;                                  ///< Size of dictionary still to be trained, 0 once done.
+            std::unique_ptr<biomxt::BlockDictionary> _dictionary;
+
+            std::mutex _mutex;
+            std::condition_variable _task_ready;
+            std::condition_variable _strip_done;
+            std::condition_variable _slot_free;
+
+            std::deque<std::unique_ptr<Strip>> _strips;
+            std::deque<Task> _tasks;
+            std::vector<std::vector<T>> _free_rows;
+            std::vector<biomxt::IndexEntry> _block_table;
+            uint32_t _pending = 0;                  ///< Strips pushed but not written.
+            bool _closing = false;
+            bool _stopped = false;
+            std::exception_ptr _error;
+
+            std::vector<std::thread> _workers;
+            std::thread _writer;
+
+            /**
+             * @brief Queue the blocks of a strip and take its slot, waiting for a free slot.
+             * @param strip The strip.
+             */
+            void _enqueue(std::unique_ptr<Strip> strip);
+
+            /**
+             * @brief Assemble a block of a strip, row-major or column-major as the file is.
+             * @param strip The strip.
+             * @param block_x Block index in the strip.
+             * @param block Block buffer, resized to width*height.
+             */
+            void _assemble(const Strip& strip, uint32_t block_x, std::vector<T>& block) const;
+
+            /**
+             * @brief Train a dictionary on blocks of a strip and write it to the output file, nothing is written if training fails.
+             * @param strip The first strip.
+             */
+            void _train(const Strip& strip);
+
+            /**
+             * @brief Worker loop, assemble and compress blocks of queued tasks.
+             */
+            void _work();
+
+            /**
+             * @brief Writer loop, write strips in push order once all their blocks are compressed.
+             */
+            void _write();
+
+            /**
+             * @brief Record the first error and wake up all threads.
+             * @param error The error.
+             */
+            void _fail(std::exception_ptr error);
+
+            /**
+             * @brief Join all threads, workers drain queued tasks if finishing, or quit at once otherwise.
+             */
+            void _stop();
+    };
+
+} // namespace biomxt
@@ -0,0 +1,43 @@
+#pragma once
+#include <string>
+#include <stdexcept>
+#include "../struct/convert_checkpoint.hpp"
+
+
+namespace biomxt {
+
+    /**
+     * @brief Get the checkpoint sidecar path of an output file.
+     * @param output_file Path to output biomxt file.
+     * @return `std::string` Path to its checkpoint file.
+     */
+    std::string checkpoint_path(const std::string& output_file);
+
+    /**
+     * @brief Save a checkpoint durably, appending only rows and blocks added since the previous one.
+     * @param path Path to checkpoint file.
+     * @param checkpoint The checkpoint, a first one of a file has no row or block offset.
+     * @throws `std::runtime_error` If writing fails.
+     * @note The file is a fixed header with column names, then one record per checkpoint of its new row names and block table, so that each checkpoint costs only what it adds.
+     * @note A first checkpoint is written to a temporary file, synced and renamed. Later ones append their record and sync, a torn record is dropped on load.
+     */
+    void save_checkpoint(const std::string& path, const biomxt::ConvertCheckpoint& checkpoint);
+
+    /**
+     * @brief Load a checkpoint.
+     * @param path Path to checkpoint file.
+     * @return `biomxt::ConvertCheckpoint` The last complete checkpoint, with all rows and blocks of the records up to it.
+     * @throws `std::runtime_error` If checkpoint file cannot be opened or is corrupted, or has no complete record.
+     * @note The file is truncated after the last complete record, so that the next checkpoint is appended right after it.
+     */
+    biomxt::ConvertCheckpoint load_checkpoint(const std::string& path);
+
+    /**
+     * @brief Flush written data of a file to the storage device.
+     * @param path Path to the file.
+     * @throws `std::runtime_error` If file cannot be opened or synced.
+     * @note Only effective on POSIX systems, elsewhere the file is left to the OS.
+     */
+    void sync_file(const std::string& path);
+
+} // namespace biomxt
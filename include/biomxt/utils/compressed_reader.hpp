@@ -0,0 +1,126 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <stdexcept>
+
+
+namespace biomxt {
+
+    /**
+     * @brief Compression of a text input file.
+     */
+    enum class TextCompression : uint8_t {
+        NONE = 0,
+        GZIP = 1,
+        ZSTD = 2
+    };
+
+    /**
+     * @brief Convert text compression to string.
+     * @param compression Text compression.
+     * @return `std::string` Name of the compression.
+     */
+    std::string text_compression_to_string(biomxt::TextCompression compression);
+
+    /**
+     * @brief Detect compression of a text file by its magic number, or by its extension if the file is too short.
+     * @param path Path to the file.
+     * @return `biomxt::TextCompression` Detected compression.
+     * @throws `std::runtime_error` If file cannot be opened, or its extension claims a compression its content does not have.
+     * @note Recognized extensions are `.gz`, `.gzip`, `.zst` and `.zstd`.
+     */
+    biomxt::TextCompression detect_text_compression(const std::string& path);
+
+    /**
+     * @brief Strip a compression extension from a path, e.g. `data.csv.gz` to `data.csv`.
+     * @param path Path to the file.
+     * @return `std::string` Path without compression extension, or path itself if it has none.
+     */
+    std::string strip_compression_extension(const std::string& path);
+
+    /**
+     * @brief Streaming reader of a gzip or zstd compressed file, decompressing on its own thread.
+     * @note Decompressed data is handed over in buffers of about buffer_size bytes, at most max_buffers are held at once, so memory stays bounded whatever the file size.
+     * @note Concatenated gzip members and zstd frames are read as one stream.
+     */
+    class CompressedReader {
+        public:
+            /**
+             * @brief Open a compressed file and start decompressing.
+             * @param path Path to the file.
+             * @param compression Compression of the file, must not be NONE.
+             * @param buffer_size Size of each decompressed buffer in bytes.
+             * @param max_buffers Max decompressed buffers held at once.
+             * @throws `std::invalid_argument` If compression is NONE, or buffer_size or max_buffers is 0.
+             * @throws `std::runtime_error` If file cannot be opened.
+             */
+            CompressedReader(
+                const std::string& path,
+                biomxt::TextCompression compression,
+                size_t buffer_size = 4 << 20,
+                size_t max_buffers = 4);
+
+            /**
+             * @brief Stop decompressing and close the file.
+             */
+            ~CompressedReader();
+
+            CompressedReader(const CompressedReader&) = delete;
+            CompressedReader& operator=(const CompressedReader&) = delete;
+
+            /**
+             * @brief Get the next decompressed buffer.
+             * @param buffer Receives the buffer, its previous content is taken back for reuse.
+             * @return bool False if the stream is exhausted.
+             * @throws `std::runtime_error` If reading or decompression fails, or the stream is truncated.
+             */
+            bool next(std::string& buffer);
+
+        private:
+            std::string _path;
+            biomxt::TextCompression _compression;
+            size_t _buffer_size;
+            size_t _max_buffers;
+
+            std::mutex _mutex;
+            std::condition_variable _buffer_ready;
+            std::condition_variable _slot_free;
+            std::deque<std::string> _ready;
+            std::vector<std::string> _free;
+            bool _done = false;
+            bool _stopped = false;
+            std::exception_ptr _error;
+            std::thread _thread;
+
+            /**
+             * @brief Decompression loop, run on its own thread.
+             */
+            void _run();
+
+            /**
+             * @brief Hand a filled buffer to the consumer, waiting for a free slot.
+             * @param buffer The buffer, replaced by an empty one with capacity for reuse.
+             * @return bool False if the reader is stopped.
+             */
+            bool _publish(std::string& buffer);
+
+            /**
+             * @brief Decompress a gzip stream.
+             * @param file Input file.
+             */
+            void _inflate_gzip(std::FILE* file);
+
+            /**
+             * @brief Decompress a zstd stream.
+             * @param file Input file.
+             */
+            void _decompress_zstd(std::FILE* file);
+    };
+
+} // namespace biomxt
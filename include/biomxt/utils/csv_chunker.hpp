@@ -0,0 +1,91 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "./csv_parser.hpp"
+
+
+namespace biomxt {
+
+    /**
+     * @brief Find the newline which ends a csv record, newlines in quotes do not end a record.
+     * @param first Begin of the record.
+     * @param last End of the buffer.
+     * @param in_quote Whether `first` is inside quotes.
+     * @return const char* Position of the ending newline, or `last` if the record runs to the end.
+     */
+    const char* csv_find_record_end(
+        const char* first,
+        const char* last,
+        bool in_quote = false);
+
+    /**
+     * @brief Find the end of the first chunk of about chunk_size bytes, at a record boundary.
+     * @param text Csv text, starts at a record boundary.
+     * @param chunk_size Target size of the chunk in bytes.
+     * @param last Whether text runs to the end of input, so that a record without newline is complete.
+     * @return size_t Size of the chunk including the newline of its last record, or 0 if more text is needed.
+     * @note Quote state at the split point is known from the parity of quotes since the start of text.
+     */
+    size_t csv_chunk_end(
+        std::string_view text,
+        size_t chunk_size,
+        bool last);
+
+    /**
+     * @brief Split csv text into chunks of about chunk_size bytes, each chunk ends at a record boundary.
+     * @note Quote state at the split point is known from the parity of quotes since the previous boundary, so quoted newlines are never split.
+     */
+    class CsvChunker {
+        public:
+            /**
+             * @brief Create a chunker.
+             * @param text Csv text to be split, must outlive the chunker.
+             * @param chunk_size Target size of each chunk in bytes.
+             * @throws `std::invalid_argument` If chunk_size is 0.
+             */
+            CsvChunker(std::string_view text, size_t chunk_size);
+
+            /**
+             * @brief Get the next chunk.
+             * @param chunk Receives the chunk, including the newline of its last record.
+             * @return bool False if text is exhausted.
+             */
+            bool next(std::string_view& chunk);
+
+        private:
+            std::string_view _text;
+            size_t _chunk_size;
+            size_t _offset = 0;
+    };
+
+    /**
+     * @brief Rows parsed from a csv chunk.
+     */
+    template <typename T> struct CsvRows {
+        std::vector<std::string> rownames;      ///< First cell of each row.
+        std::vector<T> values;                  ///< Other cells, row-major.
+        std::vector<size_t> row_ends;           ///< End of each row's record in chunk, past its newline.
+        uint32_t row_count = 0;                 ///< Count of rows.
+        uint64_t newline_count = 0;             ///< Count of newlines in chunk, for line numbers of later chunks.
+        bool failed = false;                    ///< Whether parsing stopped at an error.
+        uint64_t error_line = 0;                ///< Line of the error, 0-based in chunk.
+        std::string error;                      ///< Error message, without line number.
+    };
+
+    /**
+     * @brief Parse data rows of a csv chunk, empty and `#` lines are skipped.
+     * @param chunk Csv chunk, starts at a record boundary.
+     * @param ncol Count of data cells per row, rowname excluded.
+     * @param separator A char to be used as separator during parsing.
+     * @param rows Receives parsed rows, cleared first.
+     * @note Errors are reported through `rows.failed`, so that the caller can raise them in chunk order with global line numbers.
+     */
+    template <typename T> void csv_parse_rows(
+        std::string_view chunk,
+        uint32_t ncol,
+        const char separator,
+        biomxt::CsvRows<T>& rows);
+
+} // namespace biomxt
@@ -1,11 +1,13 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include <vector>
 #include <algorithm>
 #include <cctype>
 #include <cstdint>
 #include <charconv>
 #include <cmath>
+#include <type_traits>
 #include <stdexcept>
 #include <fstream>
 #include "zstd.h"
@@ -15,6 +17,37 @@
 
 namespace biomxt {
 
+    /**
+     * @brief Find the first occurrence of either char in a buffer, scanning 32 or 16 bytes at a time with AVX2 or SSE2 when available.
+     * @param first Begin of the buffer.
+     * @param last End of the buffer.
+     * @param a A char to be found.
+     * @param b Another char to be found.
+     * @return const char* Position of the first match, or `last` if not found.
+     * @note AVX2 is detected at runtime, SSE2 is used on other x86-64 CPUs, and a scalar loop elsewhere.
+     */
+    const char* csv_scan(
+        const char* first,
+        const char* last,
+        const char a,
+        const char b);
+
+    /**
+     * @brief Tokenize a csv line into cell spans, without allocation per cell.
+     * @param line A csv line to be tokenized, trailing \r or \n are ignored.
+     * @param cells A vector to store cell spans, cleared first. Spans of plain cells point into `line`.
+     * @param separator A char to be used as separator during tokenizing.
+     * @param unescape_buffer A buffer to store quoted cells with quotes removed, spans of quoted cells point into it.
+     * @return uint32_t Count of cells obtained.
+     * @throws std::invalid_argument If line contains unclosed quote.
+     * @note Spans stay valid until `line` or `unescape_buffer` is modified. Capacity of both vectors is reused across lines.
+     */
+    uint32_t csv_tokenize_line(
+        std::string_view line,
+        std::vector<std::string_view>& cells,
+        const char separator,
+        std::string& unescape_buffer);
+
     /**
      * @brief Parse a csv line, storage cells into provided vector, return count of cells obtained.
      * @param line A csv line to be parsed.
@@ -40,33 +73,132 @@ namespace biomxt {
         const std::string& line, 
         const char separator);
 
+    /**
+     * @brief Status of numeric parsing.
+     */
+    enum class ParseStatus : uint8_t {
+        OK = 0,             ///< Parsed.
+        EMPTY = 1,          ///< Cell is empty or only spaces.
+        INVALID = 2,        ///< Cell is not a number of the type.
+        OUT_OF_RANGE = 3    ///< Value exceeds range of the type.
+    };
+
+    /**
+     * @brief Convert parse status to string.
+     * @param status Parse status.
+     * @return std::string Description of the status.
+     */
+    inline std::string parse_status_to_string(ParseStatus status) {
+        switch (status) {
+            case ParseStatus::OK: return "ok";
+            case ParseStatus::EMPTY: return "empty";
+            case ParseStatus::INVALID: return "invalid";
+            case ParseStatus::OUT_OF_RANGE: return "out of range";
+            default: return "unknown";
+        }
+    }
+
+    /**
+     * @brief Parse a number of specified type from a char range, without allocation, locale or exception.
+     * @param str Chars to be parsed, surrounding spaces and a leading `+` are accepted.
+     * @param value Receives parsed value, only when status is OK.
+     * @return ParseStatus Status of parsing.
+     * @note Fast paths: a lone "0", and for floating types plain integers up to 15 digits. Other shapes go through `std::from_chars`.
+     * @note For integer types, a fraction of only zeros (e.g. "3.0") is accepted, as count matrices are often written as floats.
+     * @note `float16` and `bfloat16` are specialized, see `parse_reduced_float`.
+     */
+    template <typename T> inline ParseStatus parse_number(std::string_view str, T& value) noexcept {
+        static_assert(dtype_from_type<T>::valid, "biomxt::parse_number<T>: Unsupported type. Only types of biomxt::DataType are allowed.");
+        const char* first = str.data();
+        const char* last = first + str.size();
+
+        // Zero fast path, most cells of count matrices
+        if (last - first == 1 && *first == '0') {
+            value = 0;
+            return ParseStatus::OK;
+        }
+
+        // Trim spaces, and skip leading plus sign which from_chars does not accept
+        while (first < last && *first == ' ') ++first;
+        while (last > first && last[-1] == ' ') --last;
+        if (first == last) return ParseStatus::EMPTY;
+        if (*first == '+') {
+            ++first;
+            if (first == last || *first == '-') return ParseStatus::INVALID;
+        }
+
+        if constexpr (std::is_floating_point_v<T>) {
+            // Plain integer fast path, exact in double and rounded once in float
+            const bool negative = *first == '-';
+            const char* digit = first + negative;
+            if (digit < last && last - digit <= 15) {
+                uint64_t acc = 0;
+                for (; digit < last && static_cast<unsigned char>(*digit - '0') < 10; ++digit) {
+                    acc = acc * 10 + static_cast<uint64_t>(*digit - '0');
+                }
+                if (digit == last && first + negative < last) {
+                    value = negative ? -static_cast<T>(acc) : static_cast<T>(acc);
+                    return ParseStatus::OK;
+                }
+            }
+        }
+
+        T parsed;
+        auto [ptr, ec] = std::from_chars(first, last, parsed);
+        if (ec == std::errc::result_out_of_range) return ParseStatus::OUT_OF_RANGE;
+        if (ec != std::errc()) return ParseStatus::INVALID;
+        if constexpr (std::is_integral_v<T>) {
+            if (ptr < last && *ptr == '.') {
+                ++ptr;
+                while (ptr < last && *ptr == '0') ++ptr;
+            }
+        }
+        if (ptr != last) return ParseStatus::INVALID;
+        value = parsed;
+        return ParseStatus::OK;
+    }
+
+    /**
+     * @brief Parse a reduced float, i.e. `float16` or `bfloat16`, as float then quantize it.
+     * @param str Chars to be parsed, as `parse_number<float>` accepts them.
+     * @param value Receives quantized value, only when status is OK.
+     * @return ParseStatus Status of parsing, finite values that round to infinity are out of range.
+     */
+    template <typename T> inline ParseStatus parse_reduced_float(std::string_view str, T& value) noexcept {
+        float parsed;
+        ParseStatus status = parse_number<float>(str, parsed);
+        if (status != ParseStatus::OK) return status;
+        T quantized(parsed);
+        if (std::isinf(static_cast<float>(quantized)) && !std::isinf(parsed)) return ParseStatus::OUT_OF_RANGE;
+        value = quantized;
+        return ParseStatus::OK;
+    }
+
+    template <> inline ParseStatus parse_number<biomxt::float16>(std::string_view str, biomxt::float16& value) noexcept {
+        return parse_reduced_float(str, value);
+    }
+
+    template <> inline ParseStatus parse_number<biomxt::bfloat16>(std::string_view str, biomxt::bfloat16& value) noexcept {
+        return parse_reduced_float(str, value);
+    }
+
     /**
      * @brief Convert string to specified type.
      * @param str String to be converted.
      * @return T Converted value.
+     * @throws std::invalid_argument If string is empty or not a number of T.
      * @throws std::out_of_range If value exceeds range of T.
      */
-    template <typename T> inline T string_to(const std::string& str) {
-        static_assert(dtype_from_type<T>::valid, "biomxt::string_to<T>: Unsupported type. Only int16_t, int32_t, int64_t, float, and double are allowed.");
-        return T{}; 
-    }
-    template <> inline int16_t string_to<int16_t>(const std::string& str) {
-        int32_t value = std::stoi(str);
-        if (value < INT16_MIN || value > INT16_MAX) {
-            throw std::out_of_range("biomxt::string_to<int16_t>: Value out of range for int16_t.");
+    template <typename T> inline T string_to(std::string_view str) {
+        T value{};
+        ParseStatus status = parse_number<T>(str, value);
+        if (status == ParseStatus::OUT_OF_RANGE) {
+            throw std::out_of_range("biomxt::string_to<" + dtype_to_string(dtype_from_type<T>::value) + ">: Value out of range [" + std::string(str) + "]");
         }
-        return static_cast<int16_t>(value);
-    }
-    template <> inline int32_t string_to<int32_t>(const std::string& str) { return static_cast<int32_t>(std::stoi(str)); }
-    template <> inline int64_t string_to<int64_t>(const std::string& str) { return std::stoll(str); }
-    template <> inline float string_to<float>(const std::string& str) { 
-        float val;
-        auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), val);
-        if (ec != std::errc()) {
-            throw std::invalid_argument("biomxt::string_to<float>: Failed to parse float value.");
+        if (status != ParseStatus::OK) {
+            throw std::invalid_argument("biomxt::string_to<" + dtype_to_string(dtype_from_type<T>::value) + ">: Failed to parse value [" + std::string(str) + "]");
         }
-        return val;
+        return value;
     }
-    template <> inline double string_to<double>(const std::string& str) { return std::stod(str); }
 
 }
\ No newline at end of file
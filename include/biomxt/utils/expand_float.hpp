@@ -0,0 +1,19 @@
+#pragma once
+#include <cstddef>
+#include "../struct/data_type.hpp"
+
+
+namespace biomxt {
+
+    /**
+     * @brief Expand elements of a data type to float, e.g. cells of a reduced storage type as read from file.
+     * @param src Elements, need not be aligned.
+     * @param count Count of elements.
+     * @param dtype Data type of elements.
+     * @param dst Receives count floats, must not overlap src.
+     * @throws `std::invalid_argument` If dtype is unknown.
+     * @note `FLOAT16` is expanded with F16C, `BFLOAT16`, `UINT8` and `UINT16` with SSE2 where the CPU supports it. Other types are cast, so that large integers and doubles may lose precision.
+     */
+    void expand_to_float(const char* src, size_t count, biomxt::DataType dtype, float* dst);
+
+} // namespace biomxt
@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+
+
+namespace biomxt {
+
+    /**
+     * @brief Divisor prepared once for many divisions of 64-bit indices, e.g. row indices by block height.
+     * @note Powers of two divide by shift and mask. Other divisors multiply by a 64-bit reciprocal while the index fits 32 bits, exact for any 32-bit divisor, and fall back to hardware division beyond.
+     */
+    class FastDivisor {
+        private:
+            uint64_t _divisor = 1;
+            uint64_t _reciprocal = 0;
+            uint32_t _shift = 0;
+            bool _power_of_two = true;
+
+        public:
+            FastDivisor() = default;
+
+            /**
+             * @brief Prepare a divisor.
+             * @param divisor Divisor, must be greater than 0.
+             */
+            explicit FastDivisor(uint32_t divisor) : _divisor(divisor) {
+                _power_of_two = (divisor & (divisor - 1)) == 0;
+                if (_power_of_two) {
+                    while ((1ull << _shift) < divisor) _shift++;
+                } else {
+                    // ceil(2^64 / divisor), see Lemire et al., Faster remainder by direct computation
+                    _reciprocal = UINT64_C(0xFFFFFFFFFFFFFFFF) / divisor + 1;
+                }
+            }
+
+            uint64_t divisor() const { return _divisor; }
+
+            /**
+             * @brief Quotient of an index.
+             */
+            uint64_t divide(uint64_t n) const {
+                if (_power_of_two) return n >> _shift;
+#if defined(__SIZEOF_INT128__)
+                if (n <= UINT32_MAX) return static_cast<uint64_t>((static_cast<unsigned __int128>(_reciprocal) * n) >> 64);
+#endif
+                return n / _divisor;
+            }
+
+            /**
+             * @brief Remainder of an index.
+             */
+            uint64_t remainder(uint64_t n) const {
+                if (_power_of_two) return n & (_divisor - 1);
+#if defined(__SIZEOF_INT128__)
+                if (n <= UINT32_MAX) return static_cast<uint64_t>((static_cast<unsigned __int128>(_reciprocal * n) * _divisor) >> 64);
+#endif
+                return n % _divisor;
+            }
+    };
+
+} // namespace biomxt
@@ -0,0 +1,81 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+namespace biomxt {
+
+    /**
+     * @brief Check integer codecs support an element size.
+     * @param element_size Size of each element in bytes.
+     * @return bool True for integers of 1, 2 and 4 bytes, wider ones are left to the compressor.
+     */
+    inline bool int_codec_supported(size_t element_size) {
+        return element_size == 1 || element_size == 2 || element_size == 4;
+    }
+
+    /**
+     * @brief Encode integers with frame of reference: per group of 128 values, the minimum and the bit-packed differences to it.
+     * @param src Signed integers.
+     * @param size Size of integers in bytes, a multiple of element_size.
+     * @param element_size Size of each integer in bytes, see `int_codec_supported`.
+     * @param dst Buffer to store encoded data, resized to its size.
+     * @note Layout: `int32_t` minimum of each group, `uint8_t` bit width of each group, then `4*width` words of each group.
+     */
+    void for_encode(const char* src, size_t size, size_t element_size, std::vector<char>& dst);
+
+    /**
+     * @brief Revert `for_encode`.
+     * @param src Encoded data.
+     * @param src_size Size of encoded data in bytes.
+     * @param size Size of integers in bytes.
+     * @param element_size Size of each integer in bytes.
+     * @param dst Buffer to store integers.
+     * @throws `std::runtime_error` If encoded data does not match the size.
+     */
+    void for_decode(const char* src, size_t src_size, size_t size, size_t element_size, char* dst);
+
+    /**
+     * @brief Encode integers as zigzag mapped differences of consecutive values, bit-packed per group of 128 values.
+     * @param src Signed integers.
+     * @param size Size of integers in bytes, a multiple of element_size.
+     * @param element_size Size of each integer in bytes, see `int_codec_supported`.
+     * @param dst Buffer to store encoded data, resized to its size.
+     * @note Layout: `uint8_t` bit width of each group, then `4*width` words of each group.
+     */
+    void delta_encode(const char* src, size_t size, size_t element_size, std::vector<char>& dst);
+
+    /**
+     * @brief Revert `delta_encode`.
+     * @param src Encoded data.
+     * @param src_size Size of encoded data in bytes.
+     * @param size Size of integers in bytes.
+     * @param element_size Size of each integer in bytes.
+     * @param dst Buffer to store integers.
+     * @throws `std::runtime_error` If encoded data does not match the size.
+     */
+    void delta_decode(const char* src, size_t src_size, size_t size, size_t element_size, char* dst);
+
+    /**
+     * @brief Encode integers as their differences to the block minimum, in the fewest whole bytes that fit them all.
+     * @param src Signed integers.
+     * @param size Size of integers in bytes, a multiple of element_size.
+     * @param element_size Size of each integer in bytes, see `int_codec_supported`.
+     * @param dst Buffer to store encoded data, resized to its size.
+     * @note Layout: `int32_t` minimum, `uint8_t` byte width, then each difference little-endian.
+     */
+    void fixed_encode(const char* src, size_t size, size_t element_size, std::vector<char>& dst);
+
+    /**
+     * @brief Revert `fixed_encode`.
+     * @param src Encoded data.
+     * @param src_size Size of encoded data in bytes.
+     * @param size Size of integers in bytes.
+     * @param element_size Size of each integer in bytes.
+     * @param dst Buffer to store integers.
+     * @throws `std::runtime_error` If encoded data does not match the size.
+     */
+    void fixed_decode(const char* src, size_t src_size, size_t size, size_t element_size, char* dst);
+
+} // namespace biomxt
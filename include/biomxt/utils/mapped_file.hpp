@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <stdexcept>
+
+
+namespace biomxt {
+
+    /**
+     * @brief Read-only view of a whole file, memory-mapped where supported.
+     * @note On POSIX systems the file is mapped with sequential access advice, elsewhere it is read into memory at once.
+     */
+    class MappedFile {
+        public:
+            /**
+             * @brief Map a file.
+             * @param path Path to the file.
+             * @throws `std::runtime_error` If file cannot be opened or mapped.
+             */
+            explicit MappedFile(const std::string& path);
+
+            /**
+             * @brief Unmap the file.
+             */
+            ~MappedFile();
+
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
+
+            /**
+             * @brief Get file content.
+             * @return `const char*` Begin of file content, may be null for an empty file.
+             */
+            const char* data() const { return _data; }
+
+            /**
+             * @brief Get file size.
+             * @return `size_t` File size in bytes.
+             */
+            size_t size() const { return _size; }
+
+            /**
+             * @brief Get file content as a string view.
+             * @return `std::string_view` File content.
+             */
+            std::string_view view() const { return std::string_view(_data, _size); }
+
+        private:
+            const char* _data = nullptr;
+            size_t _size = 0;
+            bool _mapped = false;
+            std::string _buffer;        ///< Content when mapping is not available.
+    };
+
+} // namespace biomxt
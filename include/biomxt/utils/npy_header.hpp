@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <stdexcept>
+#include "../struct/data_type.hpp"
+
+
+namespace biomxt {
+
+    /**
+     * @brief Header of a 2-D `.npy` array.
+     */
+    struct NpyHeader {
+        biomxt::DataType dtype = biomxt::DataType::FLOAT32;    ///< Element type, from `descr`.
+        bool fortran_order = false;                             ///< Whether array is column-major.
+        uint32_t nrow = 0;                                      ///< First dimension of `shape`.
+        uint32_t ncol = 0;                                      ///< Second dimension of `shape`.
+        size_t data_offset = 0;                                 ///< Offset of array data in file.
+    };
+
+    /**
+     * @brief Parse the header of a `.npy` file.
+     * @param data Beginning of the file content.
+     * @param size Size of the file content.
+     * @return `biomxt::NpyHeader` Parsed header.
+     * @throws `std::runtime_error` If content is not a `.npy` file, or the array is not a 2-D little-endian int16/int32/int64/float32/float64 array.
+     * @note Format versions 1.0, 2.0 and 3.0 are supported.
+     */
+    biomxt::NpyHeader npy_parse_header(const char* data, size_t size);
+
+} // namespace biomxt
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+
+
+namespace biomxt {
+
+    /**
+     * @brief Byte-shuffle an array, byte j of element i goes to `dst[j*count + i]`.
+     * @param src Source array.
+     * @param dst Destination, must not overlap src.
+     * @param size Size of array in bytes, trailing bytes of an incomplete element are copied as is.
+     * @param element_size Size of each element in bytes.
+     * @note Elements of 2, 4 and 8 bytes are shuffled with SSSE3 where the CPU supports it.
+     */
+    void byte_shuffle(const char* src, char* dst, size_t size, size_t element_size);
+
+    /**
+     * @brief Revert `byte_shuffle`.
+     * @param src Shuffled array.
+     * @param dst Destination, must not overlap src.
+     * @param size Size of array in bytes.
+     * @param element_size Size of each element in bytes.
+     */
+    void byte_unshuffle(const char* src, char* dst, size_t size, size_t element_size);
+
+    /**
+     * @brief Bit-shuffle an array, bit b of byte j of every element is grouped into bit plane `j*8 + b`.
+     * @param src Source array.
+     * @param dst Destination, must not overlap src.
+     * @param size Size of array in bytes.
+     * @param element_size Size of each element in bytes.
+     * @note Bytes are shuffled first, then every 8 bytes of a byte plane form an 8x8 bit matrix transposed within a 64-bit word, so that the SIMD byte shuffle does the heavy lifting. Trailing elements that do not fill a group of 8 are copied as is.
+     */
+    void bit_shuffle(const char* src, char* dst, size_t size, size_t element_size);
+
+    /**
+     * @brief Revert `bit_shuffle`.
+     * @param src Shuffled array.
+     * @param dst Destination, must not overlap src.
+     * @param size Size of array in bytes.
+     * @param element_size Size of each element in bytes.
+     */
+    void bit_unshuffle(const char* src, char* dst, size_t size, size_t element_size);
+
+} // namespace biomxt
@@ -0,0 +1,89 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+namespace biomxt {
+
+    /**
+     * @brief Size of the nonzero bitmap of a block.
+     * @param count Count of elements in the block.
+     * @return size_t Size of bitmap in bytes, one bit per element.
+     */
+    inline size_t bitmap_size(size_t count) {
+        return (count + 7) / 8;
+    }
+
+    /**
+     * @brief Count nonzero elements of an array.
+     * @param src Source array.
+     * @param size Size of array in bytes, a multiple of element_size.
+     * @param element_size Size of each element in bytes.
+     * @return size_t Count of elements with any bit set, so that -0.0 counts as nonzero and round trips exactly.
+     */
+    size_t count_nonzeros(const char* src, size_t size, size_t element_size);
+
+    /**
+     * @brief Encode an array as a bitmap of nonzero elements followed by the nonzero elements packed.
+     * @param src Source array.
+     * @param size Size of array in bytes, a multiple of element_size.
+     * @param element_size Size of each element in bytes.
+     * @param dst Destination, at least `bitmap_size(count) + (nnz + 1)*element_size` bytes, must not overlap src.
+     * @return size_t Count of nonzero elements packed after the bitmap.
+     * @note Elements are packed without branches, so one more element than packed may be written past the end.
+     */
+    size_t bitmap_encode(const char* src, size_t size, size_t element_size, char* dst);
+
+    /**
+     * @brief Decode a bitmap and packed nonzero elements back to a dense array.
+     * @param bitmap Bitmap of nonzero elements.
+     * @param values Packed nonzero elements.
+     * @param nnz Count of packed elements.
+     * @param size Size of dense array in bytes, a multiple of element_size.
+     * @param element_size Size of each element in bytes.
+     * @param dst Destination of dense array, must not overlap bitmap or values.
+     * @throws `std::runtime_error` If the bitmap does not hold exactly nnz set bits.
+     */
+    void bitmap_decode(const char* bitmap, const char* values, size_t nnz, size_t size, size_t element_size, char* dst);
+
+    /**
+     * @brief Collect nonzero elements of a dense array with their positions.
+     * @param src Dense array.
+     * @param size Size of array in bytes, a multiple of element_size.
+     * @param element_size Size of each element in bytes.
+     * @param indices Receives positions of nonzero elements, ascending.
+     * @param values Receives nonzero elements packed, in the same order.
+     */
+    void sparsify(const char* src, size_t size, size_t element_size, std::vector<uint32_t>& indices, std::vector<char>& values);
+
+    /**
+     * @brief Append nonzero elements of a dense array at evenly spaced positions, with their positions counted from a base.
+     * @param src Dense array.
+     * @param element_size Size of each element in bytes.
+     * @param begin First position to look at.
+     * @param count Count of positions to look at.
+     * @param stride Distance between positions, in elements.
+     * @param index_base Index of the first position, the k-th position gets `index_base + k`.
+     * @param indices Receives indices of nonzero elements, appended in ascending order.
+     * @param values Receives nonzero elements packed, appended in the same order.
+     */
+    void sparsify_strided(const char* src, size_t element_size, size_t begin, size_t count, size_t stride, uint32_t index_base, std::vector<uint32_t>& indices, std::vector<char>& values);
+
+    /**
+     * @brief Append nonzero elements at evenly spaced positions of a bitmap encoded array, without decoding it to dense.
+     * @param bitmap Bitmap of nonzero elements.
+     * @param packed Packed nonzero elements.
+     * @param nnz Count of packed elements.
+     * @param element_size Size of each element in bytes.
+     * @param begin First position to look at.
+     * @param count Count of positions to look at.
+     * @param stride Distance between positions, in elements.
+     * @param index_base Index of the first position, the k-th position gets `index_base + k`.
+     * @param indices Receives indices of nonzero elements, appended in ascending order.
+     * @param values Receives nonzero elements packed, appended in the same order.
+     * @throws `std::runtime_error` If the bitmap holds more set bits than nnz up to the last position.
+     */
+    void bitmap_gather(const char* bitmap, const char* packed, size_t nnz, size_t element_size, size_t begin, size_t count, size_t stride, uint32_t index_base, std::vector<uint32_t>& indices, std::vector<char>& values);
+
+} // namespace biomxt
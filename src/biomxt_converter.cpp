@@ -1,73 +1,209 @@
 #include "biomxt/biomxt_converter.hpp"
+#include "biomxt/biomxt_writer.hpp"
 
 
 namespace biomxt {
 
+    namespace {
+
+        /**
+         * @brief A sparse entry bucketed by block row.
+         */
+        template <typename T> struct MtxEntry {
+            uint32_t row;
+            uint32_t col;
+            T value;
+        };
+
+        /**
+         * @brief Take the next token separated by spaces or tabs, and move pos behind it.
+         */
+        std::string_view _next_token(const char*& pos, const char* last) {
+            while (pos < last && (*pos == ' ' || *pos == '\t')) ++pos;
+            const char* begin = pos;
+            while (pos < last && *pos != ' ' && *pos != '\t') ++pos;
+            return std::string_view(begin, pos - begin);
+        }
+
+        /**
+         * @brief Read first column of a names file, or name by 1-based index if path is empty.
+         */
+        std::vector<std::string> _read_names(const std::string& path, uint32_t count, const std::string& what, const std::string& caller) {
+            std::vector<std::string> names;
+            names.reserve(count);
+            if (path.empty()) {
+                for (uint32_t i = 0; i < count; i++) names.push_back(std::to_string(i + 1));
+                return names;
+            }
+
+            std::ifstream in_file(path);
+            if (!in_file.is_open()) throw std::runtime_error(caller + ": Failed to open " + what + " file: " + path);
+            std::string line;
+            while (std::getline(in_file, line)) {
+                if (!line.empty() && line.back() == '\r') line.pop_back();
+                if (line.empty()) continue;
+                names.emplace_back(line.substr(0, line.find('\t')));
+            }
+            if (names.size() != count) {
+                throw std::runtime_error(caller + ": " + what + " file has " + std::to_string(names.size()) + " names, expected " + std::to_string(count) + ".");
+            }
+            return names;
+        }
+
+        /**
+         * @brief Convert a mapped dense array to biomxt format, block rows are borrowed by the compression pipeline without copy.
+         */
+        template <typename T> biomxt::FileHeader _array_to_bmxt(
+            const T* data,
+            uint32_t nrow,
+            uint32_t ncol,
+            bool fortran_order,
+            std::vector<std::string>&& rownames,
+            std::vector<std::string>&& colnames,
+            const std::string& output_file,
+            const biomxt::ConvertOptions& options,
+            const std::string& caller)
+            {
+                // Check block width and height
+                if (options.block_height == 0 || options.block_width == 0) {
+                    throw std::invalid_argument(caller + ": Block width or height must be greater than 0.");
+                }
+
+                // Create file header and fill some basic information
+                biomxt::FileHeader header; 
+                header.dtype = biomxt::dtype_from_type<T>::value;
+                header.algo = options.algo;
+                header.filter = options.filter;
+                const biomxt::IntegerCodec integer_codec = std::is_integral_v<T> ? options.integer_codec : biomxt::IntegerCodec::NONE;
+                header.flags |= biomxt::block_flags(options.sparse_threshold, integer_codec, options.policy);
+                if (options.frame_height > 0) {
+                    header.flags |= biomxt::FileFlag::HAS_BLOCK_FRAMES;
+                    header.frame_height = options.frame_height;
+                }
+                if (options.column_major) header.flags |= biomxt::FileFlag::COLUMN_MAJOR_BLOCKS;
+                header.block_width = options.block_width;
+                header.block_height = options.block_height;
+                header.uuid = biomxt::UUID::generate();
+                header.nrow = nrow;
+                header.ncol = ncol;
+
+                // Create output file
+                std::ofstream out_file(output_file, std::ios::binary);
+                if (!out_file.is_open()) throw std::runtime_error(caller + ": Failed to open output file: " + output_file);
+
+                // Reserve space for header
+                out_file.seekp(sizeof(biomxt::FileHeader));
+
+                // Hand block rows straight to the pipeline, C order rows are contiguous, Fortran order columns are
+                const size_t row_stride = fortran_order ? 1 : ncol;
+                const size_t column_stride = fortran_order ? nrow : 1;
+                biomxt::BlockPipeline<T> pipeline(out_file, options.block_width, options.algo, options.threads, options.max_inflight_block_rows, options.filter, options.dictionary_size, options.sparse_threshold, integer_codec, options.policy, options.frame_height, options.column_major);
+                for (uint32_t row_begin = 0; row_begin < nrow; row_begin += options.block_height) {
+                    uint32_t actual_block_height = std::min(options.block_height, nrow - row_begin);
+                    pipeline.push_view(data + row_stride * row_begin, ncol, actual_block_height, row_stride, column_stride);
+                }
+                const std::vector<biomxt::IndexEntry>& block_table = pipeline.finish();
+                if (pipeline.dictionary()) header.flags |= biomxt::FileFlag::HAS_DICTIONARY;
+
+                // Write names, tables and header
+                biomxt::write_bmxt_tail(out_file, header, block_table, rownames, colnames);
+
+                // Write done
+                out_file.close();
+                return header;
+            }
+
+        /**
+         * @brief Remove spill directory when conversion ends, either done or failed.
+         */
+        struct SpillGuard {
+            std::filesystem::path directory;
+            ~SpillGuard() {
+                std::error_code ec;
+                std::filesystem::remove_all(directory, ec);
+            }
+        };
+
+    } // namespace
+
+    void write_bmxt_tail(
+        std::ofstream& out,
+        biomxt::FileHeader& header,
+        const std::vector<biomxt::IndexEntry>& block_table,
+        const std::vector<std::string>& rownames,
+        const std::vector<std::string>& colnames)
+        {
+            // Write names to output file
+            std::vector<biomxt::IndexEntry> names_table;
+            names_table.reserve(rownames.size() + colnames.size());
+            for (const std::string& name : rownames) {
+                names_table.push_back({static_cast<uint64_t>(out.tellp()), (uint32_t)name.size(), (uint32_t)name.size()});
+                out.write(name.data(), name.size());
+            }
+            for (const std::string& name : colnames) {
+                names_table.push_back({static_cast<uint64_t>(out.tellp()), (uint32_t)name.size(), (uint32_t)name.size()});
+                out.write(name.data(), name.size());
+            }
+
+            // Write block count and table 
+            header.block_count = block_table.size();
+            header.block_table_offset = static_cast<uint64_t>(out.tellp());
+            out.write(reinterpret_cast<const char*>(block_table.data()), block_table.size() * sizeof(biomxt::IndexEntry));
+
+            // Write names table
+            header.name_table_offset = static_cast<uint64_t>(out.tellp());
+            out.write(reinterpret_cast<const char*>(names_table.data()), names_table.size() * sizeof(biomxt::IndexEntry));
+
+            // Write header to output file
+            out.seekp(0);
+            out.write(reinterpret_cast<const char*>(&header), sizeof(biomxt::FileHeader));
+            if (!out) {
+                throw std::runtime_error("biomxt::write_bmxt_tail: Failed to write output file.");
+            }
+        }
+
     template <typename T> void flush_rows_buffer(
-        const std::vector<std::vector<T>>& rows_buffer, 
+        const std::vector<T>& rows_buffer, 
+        uint32_t row_size,
         uint32_t block_width, 
         uint32_t actual_block_height,
         std::vector<biomxt::IndexEntry>& block_table,
         std::ofstream& out,
         std::vector<T>& block,
         std::vector<char>& compress_buffer,
-        biomxt::CompressAlgorithm algo) 
+        biomxt::CompressAlgorithm algo,
+        biomxt::BlockFilter filter,
+        float sparse_threshold,
+        biomxt::IntegerCodec integer_codec,
+        const biomxt::CodecPolicy& policy,
+        uint16_t frame_height,
+        bool column_major) 
     {
         // Check buffer validity
-        if (rows_buffer.empty()) {
-            throw std::invalid_argument("biomxt::flush_buffer: Buffer is empty.");
+        if (rows_buffer.size() < static_cast<size_t>(row_size)*actual_block_height) {
+            throw std::invalid_argument("biomxt::flush_buffer: Buffer is smaller than its rows.");
         }
         
-        // Split rows buffer into blocks
-        uint32_t row_buffer_size = rows_buffer[0].size();
-        uint32_t steps = 0;
-        uint32_t actual_block_width = 0;
-        for(uint32_t pos = 0; pos < row_buffer_size; pos++) {
-            // When goes into a new block, update actual block width.
-            if (steps == 0) {
-                actual_block_width = std::min(block_width, static_cast<uint32_t>(row_buffer_size-pos));
-                if (block.size() != actual_block_width*actual_block_height) {
-                    block.resize(actual_block_width*actual_block_height);
-                }
-            }
-
-            // Fill the block with current column.
-            for (uint32_t i=0; i<actual_block_height; i++){
-                block[actual_block_width*i+steps] = rows_buffer[i][pos];
-            }
-            steps++;
-
-            // When block is full filled, compress it and write to file.
-            if (steps == actual_block_width) {
-                biomxt::IndexEntry entry;
-                entry.offset = out.tellp();
-                entry.raw_size = block.size()*sizeof(T);
-
-                // Compress
-                size_t dst_size = 0;
-                switch (algo) {
-                    case biomxt::CompressAlgorithm::ZSTD:
-                        dst_size = ZSTD_compressBound(entry.raw_size);
-                        if (dst_size > compress_buffer.size()) {
-                            compress_buffer.resize(dst_size);
-                        }
-                        dst_size = ZSTD_compress(compress_buffer.data(), dst_size, block.data(), entry.raw_size, 3);
-                        if (ZSTD_isError(dst_size)) {
-                            throw std::runtime_error("biomxt::flush_buffer: ZSTD_compress failed.");
-                        }
-                        entry.size = dst_size;
-                        break;
-                    default:
-                        throw std::invalid_argument("biomxt::flush_buffer: Unsupported compression algorithm.");
-                }
-
-                // Write to file
-                out.write(compress_buffer.data(), entry.size);
-                block_table.push_back(entry);
-
-                // Next show go to new block.
-                steps = 0;
+        // Split rows buffer into blocks, compress each block and write to file
+        if (!std::is_integral_v<T>) integer_codec = biomxt::IntegerCodec::NONE;
+        for (uint32_t pos = 0; pos < row_size; pos += block_width) {
+            uint32_t actual_block_width = std::min(block_width, row_size-pos);
+            if (column_major) {
+                biomxt::assemble_block_strided(rows_buffer.data() + pos, 1, row_size, 0, actual_block_height, actual_block_width, block);
+            } else {
+                biomxt::assemble_block(rows_buffer.data(), row_size, pos, actual_block_width, actual_block_height, block);
             }
+
+            biomxt::IndexEntry entry;
+            entry.offset = out.tellp();
+            entry.raw_size = block.size()*sizeof(T);
+            entry.size = frame_height > 0
+                ? biomxt::pack_framed_block(reinterpret_cast<const char*>(block.data()), entry.raw_size, sizeof(T), (column_major ? actual_block_height : actual_block_width) * sizeof(T), frame_height, algo, filter, sparse_threshold, integer_codec, compress_buffer, nullptr, policy)
+                : biomxt::pack_block(reinterpret_cast<const char*>(block.data()), entry.raw_size, sizeof(T), algo, filter, sparse_threshold, integer_codec, compress_buffer, nullptr, policy);
+
+            // Write to file
+            out.write(compress_buffer.data(), entry.size);
+            block_table.push_back(entry);
         }
     }
 
@@ -78,141 +214,588 @@ namespace biomxt {
         uint32_t block_height, 
         char separator, 
         biomxt::CompressAlgorithm algo,
+        std::vector<std::string>& warnings) {
+
+            biomxt::ConvertOptions options;
+            options.block_width = block_width;
+            options.block_height = block_height;
+            options.separator = separator;
+            options.algo = algo;
+            return csv_to_bmxt<T>(input_file, output_file, options, warnings);
+    }
+
+    template <typename T>biomxt::FileHeader csv_to_bmxt(
+        const std::string& input_file, 
+        const std::string& output_file, 
+        const biomxt::ConvertOptions& options,
         std::vector<std::string>& warnings) {
 
             static_assert(biomxt::dtype_from_type<T>::valid, "biomxt::csv_to_bmxt: Invalid data type.");
             warnings.clear();
 
+            char separator = options.separator;
+
             // Check block width and height
-            if (block_height == 0 || block_width == 0) {
+            if (options.block_height == 0 || options.block_width == 0) {
                 throw std::invalid_argument("biomxt::csv_to_bmxt: Block width or height must be greater than 0.");
             }
 
-            // Create file header and fill some basic information
-            biomxt::FileHeader header; 
-            header.dtype = biomxt::dtype_from_type<T>::value;
-            header.algo = algo;
-            header.block_width = block_width;
-            header.block_height = block_height;
-            header.uuid = biomxt::UUID::generate();
+            // Pick up the checkpoint of an interrupted conversion, a stale one is dropped when starting over
+            const std::string checkpoint_file = biomxt::checkpoint_path(output_file);
+            const uint64_t input_size = std::filesystem::file_size(input_file);
+            std::optional<biomxt::ConvertCheckpoint> resumed;
+            if (options.resume && std::filesystem::exists(checkpoint_file)) {
+                resumed = biomxt::load_checkpoint(checkpoint_file);
+                if (resumed->input_size != input_size) {
+                    throw std::runtime_error("biomxt::csv_to_bmxt: Input file changed since checkpoint: " + input_file);
+                }
+                if (resumed->block_width != options.block_width || resumed->block_height != options.block_height || resumed->algo != options.algo || resumed->filter != options.filter || resumed->sparse_threshold != options.sparse_threshold || (std::is_integral_v<T> && resumed->integer_codec != options.integer_codec) || resumed->policy.adaptive != options.policy.adaptive || resumed->policy.min_decode_speed != options.policy.min_decode_speed || resumed->frame_height != options.frame_height || resumed->column_major != options.column_major || resumed->separator != separator) {
+                    warnings.push_back("Block size, compression, filter, sparse threshold, integer codec, codec policy, frame height, block layout and separator of checkpoint are used to resume, given ones are ignored.");
+                }
+                separator = resumed->separator;
+            } else {
+                if (options.resume) {
+                    warnings.push_back("No checkpoint found, conversion starts from the beginning.");
+                }
+                std::filesystem::remove(checkpoint_file);
+            }
+            const uint32_t block_height = resumed ? resumed->block_height : options.block_height;
+            const uint64_t start_offset = resumed ? resumed->input_offset : 0;
+
+            // Chunks of whole records, viewed in the mapped file or owned when streamed out of a compressed one
+            std::unique_ptr<biomxt::MappedFile> in_file;
+            std::unique_ptr<biomxt::CsvChunker> chunker;
+            std::unique_ptr<biomxt::CompressedReader> reader;
+            std::string pending;
+            std::string decompressed;
+            bool exhausted = false;
+            biomxt::TextCompression compression = biomxt::detect_text_compression(input_file);
+            if (compression == biomxt::TextCompression::NONE) {
+                in_file = std::make_unique<biomxt::MappedFile>(input_file);
+                if (start_offset > in_file->size()) {
+                    throw std::runtime_error("biomxt::csv_to_bmxt: Checkpoint offset is beyond the end of input file: " + input_file);
+                }
+                chunker = std::make_unique<biomxt::CsvChunker>(in_file->view().substr(start_offset), options.chunk_size);
+            } else {
+                if (options.chunk_size == 0) {
+                    throw std::invalid_argument("biomxt::csv_to_bmxt: Chunk size must be greater than 0.");
+                }
+                reader = std::make_unique<biomxt::CompressedReader>(input_file, compression);
+            }
+            uint64_t skip = start_offset;
+            uint64_t next_offset = start_offset;
+            auto next_chunk = [&](std::string_view& chunk, std::shared_ptr<const std::string>& owner, uint64_t& offset) -> bool {
+                offset = next_offset;
+                if (chunker) {
+                    if (!chunker->next(chunk)) return false;
+                    next_offset += chunk.size();
+                    return true;
+                }
+                while (true) {
+                    size_t size = biomxt::csv_chunk_end(pending, options.chunk_size, exhausted);
+                    if (size > 0) {
+                        // Keep the chunk in pending's storage and move the remainder out, which is the smaller part
+                        std::string rest = pending.substr(size);
+                        pending.resize(size);
+                        owner = std::make_shared<const std::string>(std::move(pending));
+                        pending = std::move(rest);
+                        chunk = *owner;
+                        next_offset += size;
+                        return true;
+                    }
+                    if (exhausted) return false;
+                    if (reader->next(decompressed)) {
+                        // Text before the checkpoint is decompressed but not parsed again
+                        size_t skipped = std::min<uint64_t>(skip, decompressed.size());
+                        skip -= skipped;
+                        pending.append(decompressed, skipped, std::string::npos);
+                    } else if (skip > 0) {
+                        throw std::runtime_error("biomxt::csv_to_bmxt: Checkpoint offset is beyond the end of input file: " + input_file);
+                    } else {
+                        exhausted = true;
+                    }
+                }
+            };
 
-            // Create output file
-            std::ofstream out_file(output_file, std::ios::binary);
-            if (!out_file.is_open()) throw std::runtime_error("biomxt::csv_to_bmxt: Failed to open output file: " + output_file);
+            std::vector<std::string> colnames;
+            std::vector<std::string_view> parse_buffer;
+            std::string unescape_buffer;
+            uint64_t cur_file_line = resumed ? resumed->input_line : 0;
+
+            // First non-empty line as the header, rest of its chunk is data
+            std::string_view chunk;
+            std::shared_ptr<const std::string> owner;
+            uint64_t chunk_offset = 0;
+            bool header_found = resumed.has_value();
+            while (!header_found && next_chunk(chunk, owner, chunk_offset)) {
+                const char* pos = chunk.data();
+                const char* chunk_end = pos + chunk.size();
+                while (pos < chunk_end && !header_found) {
+                    const char* record_end = biomxt::csv_find_record_end(pos, chunk_end);
+                    std::string_view line(pos, record_end - pos);
+                    pos = record_end < chunk_end ? record_end + 1 : chunk_end;
+
+                    // Skip empty line
+                    if (line.empty() || line[0] == '#' || line == "\r") {
+                        continue;
+                    }
 
-            // Reserve space for header
-            out_file.seekp(sizeof(biomxt::FileHeader));
+                    // Fetch colnames, ignore first column which is row name
+                    biomxt::csv_tokenize_line(line, parse_buffer, separator, unescape_buffer);
+                    colnames.assign(parse_buffer.begin() + 1, parse_buffer.end());
+                    header_found = true;
+                }
+                cur_file_line += std::count(chunk.data(), pos, '\n');
+                chunk_offset += pos - chunk.data();
+                chunk.remove_prefix(pos - chunk.data());
+            }
 
-            // Open input file
-            std::ifstream in_file(input_file);
-            if (!in_file.is_open()) throw std::runtime_error("biomxt::csv_to_bmxt: Failed to open input file: " + input_file);
+            // Compression and writing run in background while parsing, a resumed writer appends to the interrupted file
+            std::unique_ptr<biomxt::BiomxtWriter<T>> writer;
+            const bool was_resumed = resumed.has_value();
+            if (resumed) {
+                writer = std::make_unique<biomxt::BiomxtWriter<T>>(output_file, *resumed, options);
+                resumed.reset();
+            } else {
+                writer = std::make_unique<biomxt::BiomxtWriter<T>>(output_file, std::move(colnames), options);
+            }
+            const uint32_t ncol = writer->get_column_count();
+
+            // A chunk being parsed, kept alive until its rows are consumed
+            struct Parsing {
+                std::future<biomxt::CsvRows<T>> rows;
+                std::string_view chunk;
+                std::shared_ptr<const std::string> owner;
+                uint64_t offset;
+            };
+
+            // Hand parsed chunks in order to the writer
+            uint64_t next_checkpoint = start_offset + options.checkpoint_interval;
+            auto consume = [&](Parsing& parsed) {
+                biomxt::CsvRows<T> rows = parsed.rows.get();
+                if (rows.failed) {
+                    throw std::runtime_error("biomxt::csv_to_bmxt: Line " + std::to_string(cur_file_line + rows.error_line + 1) + " " + rows.error);
+                }
+                uint64_t chunk_line = cur_file_line;
+                cur_file_line += rows.newline_count;
+                writer->write_rows(std::move(rows.rownames), rows.values.data());
+
+                // Once due, checkpoint at the first complete block row ending in a chunk
+                uint32_t buffered = writer->get_row_count() % block_height;
+                if (options.checkpoint_interval > 0 && parsed.offset + parsed.chunk.size() >= next_checkpoint && buffered < rows.row_count) {
+                    size_t boundary = rows.row_ends[rows.row_count - buffered - 1];
+                    biomxt::ConvertCheckpoint checkpoint;
+                    writer->checkpoint(checkpoint);
+                    checkpoint.separator = separator;
+                    checkpoint.input_size = input_size;
+                    checkpoint.input_offset = parsed.offset + boundary;
+                    checkpoint.input_line = chunk_line + std::count(parsed.chunk.data(), parsed.chunk.data() + boundary, '\n');
+                    biomxt::save_checkpoint(checkpoint_file, checkpoint);
+                    next_checkpoint = checkpoint.input_offset + options.checkpoint_interval;
+                }
+            };
+
+            // Parse chunks of data lines in parallel, at most parse_threads chunks in flight
+            uint32_t parse_threads = options.parse_threads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : options.parse_threads;
+            std::deque<Parsing> parsing;
+            bool has_chunk = header_found && !chunk.empty();
+            if (!has_chunk && header_found) has_chunk = next_chunk(chunk, owner, chunk_offset);
+            while (has_chunk) {
+                if (parsing.size() >= parse_threads) {
+                    consume(parsing.front());
+                    parsing.pop_front();
+                }
+                parsing.push_back({std::async(std::launch::async, [chunk, ncol, separator]() {
+                    biomxt::CsvRows<T> rows;
+                    biomxt::csv_parse_rows<T>(chunk, ncol, separator, rows);
+                    return rows;
+                }), chunk, std::move(owner), chunk_offset});
+                owner.reset();
+                has_chunk = next_chunk(chunk, owner, chunk_offset);
+            }
+            while (!parsing.empty()) {
+                consume(parsing.front());
+                parsing.pop_front();
+            }
 
-            std::vector<std::string> colnames;
-            std::vector<std::string> rownames;
+            // Write the last block, names, tables and header, the checkpoint is of no use anymore
+            biomxt::FileHeader header = writer->finish();
+            std::filesystem::remove(checkpoint_file);
+            // Training only runs on the first block row of a fresh conversion, with the algorithm the writer used
+            if (!was_resumed && options.dictionary_size > 0 && header.algo == biomxt::CompressAlgorithm::ZSTD && header.nrow > 0 && !(header.flags & biomxt::FileFlag::HAS_DICTIONARY)) {
+                warnings.push_back("Dictionary training failed on the first block row, blocks are compressed without dictionary.");
+            }
+            return header;
 
-            std::vector<std::vector<T>> rows_buffer(block_height);
-            std::vector<std::string> parse_buffer;
-            size_t actual_block_height = 0;
-            std::vector<T> block;
-            std::vector<biomxt::IndexEntry> block_table;
-            std::vector<char> compress_buffer;
-            std::vector<T> block_buffer;
+    }
 
-            std::string line;
-            uint32_t cur_file_line = 0;
-            uint32_t reserve_size = 0;
-            
-            // Streamly read and write
-            while (std::getline(in_file, line)) {
-                cur_file_line++;
+    template <typename T>biomxt::FileHeader mtx_to_bmxt(
+        const std::string& matrix_file,
+        const std::string& features_file,
+        const std::string& barcodes_file,
+        const std::string& output_file,
+        const biomxt::ConvertOptions& options,
+        std::vector<std::string>& warnings) {
 
-                // Skip empty line
-                if (line.empty() || line[0] == '#') {
-                    continue;
-                }
+            static_assert(biomxt::dtype_from_type<T>::valid, "biomxt::mtx_to_bmxt: Invalid data type.");
+            warnings.clear();
 
-                // First non-empty line as the header
-                if (colnames.empty()) {
-                    // Get ncol
-                    uint32_t ncol = biomxt::csv_parse_line(line, separator);
-                    // Initialize rows buffer by ncol-1 (Ignore first column which is row name)
-                    for (std::vector<T>& row : rows_buffer) {
-                        row.resize(ncol-1);
-                    }
-                    parse_buffer.resize(ncol);
-                    // Fetch colnames
-                    colnames.resize(ncol);
-                    biomxt::csv_parse_line(line, colnames, separator);
-                    colnames.erase(colnames.begin());
-                    continue;
-                }
+            const uint32_t block_width = options.block_width;
+            const uint32_t block_height = options.block_height;
 
-                // Non-first non-empty line as the data
-                size_t ncell = biomxt::csv_parse_line(line, parse_buffer, separator);
-                if (ncell != colnames.size()+1) {
-                    throw std::runtime_error("biomxt::csv_to_bmxt: Line " + std::to_string(cur_file_line) + " has " + std::to_string(ncell-1) + " cells (rowname excluded), expected " + std::to_string(colnames.size()) + " cells.");
-                }
+            // Check block width and height
+            if (block_height == 0 || block_width == 0) {
+                throw std::invalid_argument("biomxt::mtx_to_bmxt: Block width or height must be greater than 0.");
+            }
 
-                // First cell is row name
-                rownames.push_back(parse_buffer[0]);
+            // Map input file, and walk it line by line
+            biomxt::MappedFile in_file(matrix_file);
+            const char* pos = in_file.data();
+            const char* text_end = pos + in_file.size();
+            uint64_t cur_file_line = 0;
+            auto next_line = [&](std::string_view& line) {
+                if (pos >= text_end) return false;
+                const char* end = static_cast<const char*>(std::memchr(pos, '\n', text_end - pos));
+                if (end == nullptr) end = text_end;
+                line = std::string_view(pos, end - pos);
+                if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+                pos = end < text_end ? end + 1 : text_end;
+                cur_file_line++;
+                return true;
+            };
 
-                // Convert cells and add to rows buffer
-                for (size_t i = 1; i < parse_buffer.size(); i++) {
-                    rows_buffer[actual_block_height][i-1] = biomxt::string_to<T>(parse_buffer[i]);
+            // Banner: %%MatrixMarket matrix coordinate <field> <symmetry>
+            std::string_view line;
+            if (!next_line(line) || line.substr(0, 14) != "%%MatrixMarket") {
+                throw std::runtime_error("biomxt::mtx_to_bmxt: Missing %%MatrixMarket banner in " + matrix_file);
+            }
+            std::string banner(line);
+            std::transform(banner.begin(), banner.end(), banner.begin(), [](unsigned char c) { return std::tolower(c); });
+            const char* banner_pos = banner.data();
+            const char* banner_end = banner.data() + banner.size();
+            _next_token(banner_pos, banner_end);
+            std::string_view object = _next_token(banner_pos, banner_end);
+            std::string_view format = _next_token(banner_pos, banner_end);
+            std::string_view field = _next_token(banner_pos, banner_end);
+            std::string_view symmetry = _next_token(banner_pos, banner_end);
+            if (object != "matrix" || format != "coordinate") {
+                throw std::runtime_error("biomxt::mtx_to_bmxt: Only coordinate matrix is supported, got [" + std::string(object) + " " + std::string(format) + "].");
+            }
+            if (field != "integer" && field != "real" && field != "pattern") {
+                throw std::runtime_error("biomxt::mtx_to_bmxt: Unsupported field [" + std::string(field) + "].");
+            }
+            if (symmetry != "general" && symmetry != "symmetric") {
+                throw std::runtime_error("biomxt::mtx_to_bmxt: Unsupported symmetry [" + std::string(symmetry) + "].");
+            }
+            const bool pattern = field == "pattern";
+            const bool symmetric = symmetry == "symmetric";
+
+            // Size line after comments: <nrow> <ncol> <nnz>
+            do {
+                if (!next_line(line)) throw std::runtime_error("biomxt::mtx_to_bmxt: Missing size line in " + matrix_file);
+            } while (line.empty() || line[0] == '%');
+            int64_t mtx_nrow = 0, mtx_ncol = 0, nnz = 0;
+            {
+                const char* p = line.data();
+                const char* e = line.data() + line.size();
+                if (biomxt::parse_number<int64_t>(_next_token(p, e), mtx_nrow) != biomxt::ParseStatus::OK ||
+                    biomxt::parse_number<int64_t>(_next_token(p, e), mtx_ncol) != biomxt::ParseStatus::OK ||
+                    biomxt::parse_number<int64_t>(_next_token(p, e), nnz) != biomxt::ParseStatus::OK ||
+                    mtx_nrow < 0 || mtx_ncol < 0 || nnz < 0) {
+                    throw std::runtime_error("biomxt::mtx_to_bmxt: Line " + std::to_string(cur_file_line) + " is not a valid size line.");
                 }
-                actual_block_height++;
-
-                // Flush rows buffer when it is full
-                if (actual_block_height == block_height) {
-                    flush_rows_buffer(rows_buffer, block_width, actual_block_height, block_table, out_file, block_buffer, compress_buffer, algo);
-                    actual_block_height = 0;
+                if (mtx_nrow > UINT32_MAX || mtx_ncol > UINT32_MAX) {
+                    throw std::runtime_error("biomxt::mtx_to_bmxt: Matrix size exceeds 32-bit row or column count.");
                 }
             }
+            if (symmetric && mtx_nrow != mtx_ncol) {
+                throw std::runtime_error("biomxt::mtx_to_bmxt: Symmetric matrix must be square.");
+            }
 
-            // Input file read done
-            in_file.close();
+            // Rows of mtx are features, columns are barcodes, unless transposed
+            const uint32_t nrow = options.transpose ? mtx_ncol : mtx_nrow;
+            const uint32_t ncol = options.transpose ? mtx_nrow : mtx_ncol;
+            std::vector<std::string> rownames = options.transpose ? _read_names(barcodes_file, nrow, "barcodes", "biomxt::mtx_to_bmxt") : _read_names(features_file, nrow, "features", "biomxt::mtx_to_bmxt");
+            std::vector<std::string> colnames = options.transpose ? _read_names(features_file, ncol, "features", "biomxt::mtx_to_bmxt") : _read_names(barcodes_file, ncol, "barcodes", "biomxt::mtx_to_bmxt");
 
-            // Catch the last block
-            if (actual_block_height > 0) {
-                flush_rows_buffer(rows_buffer, block_width, actual_block_height, block_table, out_file, block_buffer, compress_buffer, algo);
+            // Create file header and fill some basic information
+            biomxt::FileHeader header; 
+            header.dtype = biomxt::dtype_from_type<T>::value;
+            header.algo = options.algo;
+            header.filter = options.filter;
+            const biomxt::IntegerCodec integer_codec = std::is_integral_v<T> ? options.integer_codec : biomxt::IntegerCodec::NONE;
+            header.flags |= biomxt::block_flags(options.sparse_threshold, integer_codec, options.policy);
+            if (options.frame_height > 0) {
+                header.flags |= biomxt::FileFlag::HAS_BLOCK_FRAMES;
+                header.frame_height = options.frame_height;
             }
+            if (options.column_major) header.flags |= biomxt::FileFlag::COLUMN_MAJOR_BLOCKS;
+            header.block_width = block_width;
+            header.block_height = block_height;
+            header.uuid = biomxt::UUID::generate();
+            header.nrow = nrow;
+            header.ncol = ncol;
+
+            // Bucket entries by block row, spill all buckets to disk when they exceed memory budget
+            const uint32_t strip_count = (nrow + block_height - 1) / block_height;
+            std::vector<std::vector<MtxEntry<T>>> buckets(strip_count);
+            std::vector<bool> spilled(strip_count, false);
+            SpillGuard spill_guard{output_file + ".spill." + header.uuid.to_string()};
+            auto spill_path = [&](uint32_t strip) {
+                return spill_guard.directory / ("strip_" + std::to_string(strip) + ".bin");
+            };
+            uint64_t bucket_bytes = 0;
+            auto spill = [&]() {
+                std::filesystem::create_directories(spill_guard.directory);
+                for (uint32_t y = 0; y < strip_count; y++) {
+                    if (buckets[y].empty()) continue;
+                    std::ofstream spill_file(spill_path(y), std::ios::binary | std::ios::app);
+                    spill_file.write(reinterpret_cast<const char*>(buckets[y].data()), buckets[y].size() * sizeof(MtxEntry<T>));
+                    if (!spill_file) throw std::runtime_error("biomxt::mtx_to_bmxt: Failed to write spill file: " + spill_path(y).string());
+                    spilled[y] = true;
+                    buckets[y].clear();
+                    buckets[y].shrink_to_fit();
+                }
+                bucket_bytes = 0;
+            };
+            const biomxt::FastDivisor row_divisor(block_height);
+            const biomxt::FastDivisor column_divisor(block_width);
+            auto add = [&](uint32_t row, uint32_t col, T value) {
+                buckets[row_divisor.divide(row)].push_back({row, col, value});
+                bucket_bytes += sizeof(MtxEntry<T>);
+                if (bucket_bytes >= options.memory_budget) spill();
+            };
+
+            uint64_t entry_count = 0;
+            while (next_line(line)) {
+                if (line.empty() || line[0] == '%') continue;
+                const char* p = line.data();
+                const char* e = line.data() + line.size();
+                std::string_view row_token = _next_token(p, e);
+                std::string_view col_token = _next_token(p, e);
+                int64_t i = 0, j = 0;
+                if (biomxt::parse_number<int64_t>(row_token, i) != biomxt::ParseStatus::OK ||
+                    biomxt::parse_number<int64_t>(col_token, j) != biomxt::ParseStatus::OK ||
+                    i < 1 || i > mtx_nrow || j < 1 || j > mtx_ncol) {
+                    throw std::runtime_error("biomxt::mtx_to_bmxt: Line " + std::to_string(cur_file_line) + " has invalid coordinate [" + std::string(row_token) + " " + std::string(col_token) + "].");
+                }
+                T value = 1;
+                if (!pattern) {
+                    std::string_view value_token = _next_token(p, e);
+                    biomxt::ParseStatus status = biomxt::parse_number<T>(value_token, value);
+                    if (status != biomxt::ParseStatus::OK) {
+                        throw std::runtime_error("biomxt::mtx_to_bmxt: Line " + std::to_string(cur_file_line) + " value [" + std::string(value_token) + "] is " + biomxt::parse_status_to_string(status) + " for " + biomxt::dtype_to_string(header.dtype) + ".");
+                    }
+                }
 
-            header.nrow = rownames.size();
-            header.ncol = colnames.size();
-            
-            // Write names to output file
-            std::vector<biomxt::IndexEntry> names_table;
-            for (const std::string& name : rownames) {
-                names_table.push_back({static_cast<uint64_t>(out_file.tellp()), (uint32_t)name.size(), (uint32_t)name.size()});
-                out_file.write(name.data(), name.size());
+                uint32_t row = static_cast<uint32_t>(options.transpose ? j : i) - 1;
+                uint32_t col = static_cast<uint32_t>(options.transpose ? i : j) - 1;
+                add(row, col, value);
+                if (symmetric && row != col) add(col, row, value);
+                entry_count++;
             }
-            for (const std::string& name : colnames) {
-                names_table.push_back({static_cast<uint64_t>(out_file.tellp()), (uint32_t)name.size(), (uint32_t)name.size()});
-                out_file.write(name.data(), name.size());
+            if (entry_count != static_cast<uint64_t>(nnz)) {
+                warnings.push_back("Matrix has " + std::to_string(entry_count) + " entries, size line declares " + std::to_string(nnz) + ".");
             }
 
-            // Write block count and table 
-            header.block_count = block_table.size();
-            header.block_table_offset = static_cast<uint64_t>(out_file.tellp());
-            out_file.write(reinterpret_cast<const char*>(block_table.data()), block_table.size() * sizeof(biomxt::IndexEntry));
+            // Create output file
+            std::ofstream out_file(output_file, std::ios::binary);
+            if (!out_file.is_open()) throw std::runtime_error("biomxt::mtx_to_bmxt: Failed to open output file: " + output_file);
 
-            // Write names table
-            header.name_table_offset = static_cast<uint64_t>(out_file.tellp());
-            out_file.write(reinterpret_cast<const char*>(names_table.data()), names_table.size() * sizeof(biomxt::IndexEntry));
+            // Reserve space for header
+            out_file.seekp(sizeof(biomxt::FileHeader));
 
-            // Write header to output file
-            out_file.seekp(0);
-            out_file.write(reinterpret_cast<const char*>(&header), sizeof(biomxt::FileHeader));
+            // Compress block rows in the pipeline, which densifies each block out of the entries of its strip
+            const uint32_t block_cols = (ncol + block_width - 1) / block_width;
+            biomxt::BlockPipeline<T> pipeline(out_file, block_width, options.algo, options.threads, options.max_inflight_block_rows, options.filter, options.dictionary_size, options.sparse_threshold, integer_codec, options.policy, options.frame_height, options.column_major);
+            for (uint32_t y = 0; y < strip_count; y++) {
+                // Spilled entries come first, they were read earlier
+                std::vector<MtxEntry<T>> entries;
+                if (spilled[y]) {
+                    std::ifstream spill_file(spill_path(y), std::ios::binary | std::ios::ate);
+                    size_t count = static_cast<size_t>(spill_file.tellg()) / sizeof(MtxEntry<T>);
+                    spill_file.seekg(0);
+                    entries.resize(count);
+                    spill_file.read(reinterpret_cast<char*>(entries.data()), count * sizeof(MtxEntry<T>));
+                    if (!spill_file) throw std::runtime_error("biomxt::mtx_to_bmxt: Failed to read spill file: " + spill_path(y).string());
+                    spill_file.close();
+                    std::filesystem::remove(spill_path(y));
+                }
+                entries.insert(entries.end(), buckets[y].begin(), buckets[y].end());
+                std::vector<MtxEntry<T>>().swap(buckets[y]);
+
+                // Stable counting sort by block column, so later duplicates still win
+                auto offsets = std::make_shared<std::vector<uint64_t>>(block_cols + 1, 0);
+                for (const MtxEntry<T>& entry : entries) (*offsets)[column_divisor.divide(entry.col) + 1]++;
+                for (uint32_t x = 0; x < block_cols; x++) (*offsets)[x + 1] += (*offsets)[x];
+                auto sorted = std::make_shared<std::vector<MtxEntry<T>>>(entries.size());
+                {
+                    std::vector<uint64_t> cursor(offsets->begin(), offsets->end() - 1);
+                    for (const MtxEntry<T>& entry : entries) (*sorted)[cursor[column_divisor.divide(entry.col)]++] = entry;
+                }
+                std::vector<MtxEntry<T>>().swap(entries);
+
+                // Densify block x of this strip, in the layout of the file
+                const uint32_t row_begin = y * block_height;
+                const uint32_t actual_block_height = std::min(block_height, nrow - row_begin);
+                const bool column_major = options.column_major;
+                pipeline.push_generated([=](uint32_t x, std::vector<T>& block) {
+                    const uint32_t column_begin = x * block_width;
+                    const uint32_t actual_block_width = std::min(block_width, ncol - column_begin);
+                    block.assign(static_cast<size_t>(actual_block_width) * actual_block_height, T{});
+                    for (uint64_t k = (*offsets)[x]; k < (*offsets)[x + 1]; k++) {
+                        const MtxEntry<T>& entry = (*sorted)[k];
+                        const size_t cell = column_major
+                            ? static_cast<size_t>(entry.col - column_begin) * actual_block_height + (entry.row - row_begin)
+                            : static_cast<size_t>(entry.row - row_begin) * actual_block_width + (entry.col - column_begin);
+                        block[cell] = entry.value;
+                    }
+                }, ncol, actual_block_height);
+            }
+            const std::vector<biomxt::IndexEntry>& block_table = pipeline.finish();
+            if (pipeline.dictionary()) {
+                header.flags |= biomxt::FileFlag::HAS_DICTIONARY;
+            } else if (options.dictionary_size > 0 && options.algo == biomxt::CompressAlgorithm::ZSTD && strip_count > 0) {
+                warnings.push_back("Dictionary training failed on the first block row, blocks are compressed without dictionary.");
+            }
+
+            // Write names, tables and header
+            biomxt::write_bmxt_tail(out_file, header, block_table, rownames, colnames);
 
             // Write done
             out_file.close();
             return header;
+    }
 
+    template <typename T>biomxt::FileHeader npy_to_bmxt(
+        const std::string& input_file,
+        const std::string& rownames_file,
+        const std::string& colnames_file,
+        const std::string& output_file,
+        const biomxt::ConvertOptions& options,
+        std::vector<std::string>& warnings) {
+
+            static_assert(biomxt::dtype_from_type<T>::valid, "biomxt::npy_to_bmxt: Invalid data type.");
+            warnings.clear();
+
+            // Map input file and check its header
+            biomxt::MappedFile in_file(input_file);
+            biomxt::NpyHeader npy = biomxt::npy_parse_header(in_file.data(), in_file.size());
+            if (npy.dtype != biomxt::dtype_from_type<T>::value) {
+                throw std::runtime_error("biomxt::npy_to_bmxt: Array type " + biomxt::dtype_to_string(npy.dtype) + " does not match " + biomxt::dtype_to_string(biomxt::dtype_from_type<T>::value) + ".");
+            }
+            if (npy.data_offset % alignof(T) != 0) {
+                throw std::runtime_error("biomxt::npy_to_bmxt: Array data is not aligned.");
+            }
+
+            return _array_to_bmxt<T>(
+                reinterpret_cast<const T*>(in_file.data() + npy.data_offset),
+                npy.nrow,
+                npy.ncol,
+                npy.fortran_order,
+                _read_names(rownames_file, npy.nrow, "row names", "biomxt::npy_to_bmxt"),
+                _read_names(colnames_file, npy.ncol, "column names", "biomxt::npy_to_bmxt"),
+                output_file,
+                options,
+                "biomxt::npy_to_bmxt");
+    }
+
+    template <typename T>biomxt::FileHeader raw_to_bmxt(
+        const std::string& input_file,
+        uint32_t nrow,
+        uint32_t ncol,
+        bool fortran_order,
+        const std::string& rownames_file,
+        const std::string& colnames_file,
+        const std::string& output_file,
+        const biomxt::ConvertOptions& options,
+        std::vector<std::string>& warnings) {
+
+            static_assert(biomxt::dtype_from_type<T>::valid, "biomxt::raw_to_bmxt: Invalid data type.");
+            warnings.clear();
+
+            // Raw arrays are little-endian
+            const uint16_t probe = 1;
+            if (*reinterpret_cast<const uint8_t*>(&probe) != 1) {
+                throw std::runtime_error("biomxt::raw_to_bmxt: Raw arrays are only supported on little-endian hosts.");
+            }
+
+            // Map input file and check its size
+            biomxt::MappedFile in_file(input_file);
+            uint64_t expected = static_cast<uint64_t>(nrow) * ncol * sizeof(T);
+            if (in_file.size() != expected) {
+                throw std::runtime_error("biomxt::raw_to_bmxt: File size " + std::to_string(in_file.size()) + " does not match " + std::to_string(nrow) + "x" + std::to_string(ncol) + " " + biomxt::dtype_to_string(biomxt::dtype_from_type<T>::value) + " (" + std::to_string(expected) + " bytes).");
+            }
+
+            return _array_to_bmxt<T>(
+                reinterpret_cast<const T*>(in_file.data()),
+                nrow,
+                ncol,
+                fortran_order,
+                _read_names(rownames_file, nrow, "row names", "biomxt::raw_to_bmxt"),
+                _read_names(colnames_file, ncol, "column names", "biomxt::raw_to_bmxt"),
+                output_file,
+                options,
+                "biomxt::raw_to_bmxt");
     }
 
+    template void flush_rows_buffer<int16_t>(const std::vector<int16_t>&, uint32_t, uint32_t, uint32_t, std::vector<IndexEntry>&, std::ofstream&, std::vector<int16_t>&, std::vector<char>&, CompressAlgorithm, BlockFilter, float, IntegerCodec, const CodecPolicy&, uint16_t, bool);
+    template void flush_rows_buffer<int32_t>(const std::vector<int32_t>&, uint32_t, uint32_t, uint32_t, std::vector<IndexEntry>&, std::ofstream&, std::vector<int32_t>&, std::vector<char>&, CompressAlgorithm, BlockFilter, float, IntegerCodec, const CodecPolicy&, uint16_t, bool);
+    template void flush_rows_buffer<int64_t>(const std::vector<int64_t>&, uint32_t, uint32_t, uint32_t, std::vector<IndexEntry>&, std::ofstream&, std::vector<int64_t>&, std::vector<char>&, CompressAlgorithm, BlockFilter, float, IntegerCodec, const CodecPolicy&, uint16_t, bool);
+    template void flush_rows_buffer<float>(const std::vector<float>&, uint32_t, uint32_t, uint32_t, std::vector<IndexEntry>&, std::ofstream&, std::vector<float>&, std::vector<char>&, CompressAlgorithm, BlockFilter, float, IntegerCodec, const CodecPolicy&, uint16_t, bool);
+    template void flush_rows_buffer<double>(const std::vector<double>&, uint32_t, uint32_t, uint32_t, std::vector<IndexEntry>&, std::ofstream&, std::vector<double>&, std::vector<char>&, CompressAlgorithm, BlockFilter, float, IntegerCodec, const CodecPolicy&, uint16_t, bool);
+    template void flush_rows_buffer<uint8_t>(const std::vector<uint8_t>&, uint32_t, uint32_t, uint32_t, std::vector<IndexEntry>&, std::ofstream&, std::vector<uint8_t>&, std::vector<char>&, CompressAlgorithm, BlockFilter, float, IntegerCodec, const CodecPolicy&, uint16_t, bool);
+    template void flush_rows_buffer<uint16_t>(const std::vector<uint16_t>&, uint32_t, uint32_t, uint32_t, std::vector<IndexEntry>&, std::ofstream&, std::vector<uint16_t>&, std::vector<char>&, CompressAlgorithm, BlockFilter, float, IntegerCodec, const CodecPolicy&, uint16_t, bool);
+    template void flush_rows_buffer<float16>(const std::vector<float16>&, uint32_t, uint32_t, uint32_t, std::vector<IndexEntry>&, std::ofstream&, std::vector<float16>&, std::vector<char>&, CompressAlgorithm, BlockFilter, float, IntegerCodec, const CodecPolicy&, uint16_t, bool);
+    template void flush_rows_buffer<bfloat16>(const std::vector<bfloat16>&, uint32_t, uint32_t, uint32_t, std::vector<IndexEntry>&, std::ofstream&, std::vector<bfloat16>&, std::vector<char>&, CompressAlgorithm, BlockFilter, float, IntegerCodec, const CodecPolicy&, uint16_t, bool);
+
     template biomxt::FileHeader csv_to_bmxt<int16_t>(const std::string&, const std::string&, uint32_t, uint32_t, char, CompressAlgorithm, std::vector<std::string>&);
     template biomxt::FileHeader csv_to_bmxt<int32_t>(const std::string&, const std::string&, uint32_t, uint32_t, char, CompressAlgorithm, std::vector<std::string>&);
     template biomxt::FileHeader csv_to_bmxt<int64_t>(const std::string&, const std::string&, uint32_t, uint32_t, char, CompressAlgorithm, std::vector<std::string>&);
     template biomxt::FileHeader csv_to_bmxt<float>(const std::string&, const std::string&, uint32_t, uint32_t, char, CompressAlgorithm, std::vector<std::string>&);
     template biomxt::FileHeader csv_to_bmxt<double>(const std::string&, const std::string&, uint32_t, uint32_t, char, CompressAlgorithm, std::vector<std::string>&);
+    template biomxt::FileHeader csv_to_bmxt<uint8_t>(const std::string&, const std::string&, uint32_t, uint32_t, char, CompressAlgorithm, std::vector<std::string>&);
+    template biomxt::FileHeader csv_to_bmxt<uint16_t>(const std::string&, const std::string&, uint32_t, uint32_t, char, CompressAlgorithm, std::vector<std::string>&);
+    template biomxt::FileHeader csv_to_bmxt<float16>(const std::string&, const std::string&, uint32_t, uint32_t, char, CompressAlgorithm, std::vector<std::string>&);
+    template biomxt::FileHeader csv_to_bmxt<bfloat16>(const std::string&, const std::string&, uint32_t, uint32_t, char, CompressAlgorithm, std::vector<std::string>&);
+
+    template biomxt::FileHeader csv_to_bmxt<int16_t>(const std::string&, const std::string&, const ConvertOptions&, std::vector<std::string>&);
+    template biomxt::FileHeader csv_to_bmxt<int32_t>(const std::string&, const std::string&, const ConvertOptions&, std::vector<std::string>&);
+    template biomxt::FileHeader csv_to_bmxt<int64_t>(const std::string&, const std::string&, const ConvertOptions&, std::vector<std::string>&);
+    template biomxt::FileHeader csv_to_bmxt<float>(const std::string&, const std::string&, const ConvertOptions&, std::vector<std::string>&);
+    template biomxt::FileHeader csv_to_bmxt<double>(const std::string&, const std::string&, const ConvertOptions&, std::vector<std::string>&);
+    template biomxt::FileHeader csv_to_bmxt<uint8_t>(const std::string&, const std::string&, const ConvertOptions&, std::vector<std::string>&);
+    template biomxt::FileHeader csv_to_bmxt<uint16_t>(const std::string&, const std::string&, const ConvertOptions&, std::vector<std::string>&);
+    template biomxt::FileHeader csv_to_bmxt<float16>(const std::string&, const std::string&, const ConvertOptions&, std::vector<std::string>&);
+    template biomxt::FileHeader csv_to_bmxt<bfloat16>(const std::string&, const std::string&, const ConvertOptions&, std::vector<std::string>&);
+
+    template biomxt::FileHeader mtx_to_bmxt<int16_t>(const std::string&, const std::string&, const std::string&, const std::string&, const ConvertOptions&, std::vector<std::string>&);
+    template biomxt::FileHeader mtx_to_bmxt<int32_t>(const std::string&, const std::string&, const std::string&, const std::string&, const ConvertOptions&, std::vector<std::string>&);
+    template biomxt::FileHeader mtx_to_bmxt<int64_t>(const std::string&, const std::string&, const std::string&, const std::string&, const ConvertOptions&, std::vector<std::string>&);
+    template biomxt::FileHeader mtx_to_bmxt<float>(const std::string&, const std::string&, const std::string&, const std::string&, const ConvertOptions&, std::vector<std::string>&);
+    template biomxt::FileHeader mtx_to_bmxt<double>(const std::string&, const std::string&, const std::string&, const std::string&, const ConvertOptions&, std::vector<std::string>&);
+    template biomxt::FileHeader mtx_to_bmxt<uint8_t>(const std::string&, const std::string&, const std::string&, const std::string&, const ConvertOptions&, std::vector<std::string>&);
+    template biomxt::FileHeader mtx_to_bmxt<uint16_t>(const std::string&, const std::string&, const std::string&, const std::string&, const ConvertOptions&, std::vector<std::string>&);
+    template biomxt::FileHeader mtx_to_bmxt<float16>(const std::string&, const std::string&, const std::string&, const std::string&, const ConvertOptions&, std::vector<std::string>&);
+    template biomxt::FileHeader mtx_to_bmxt<bfloat16>(const std::string&, const std::string&, const std::string&, const std::string&, const ConvertOptions&, std::vector<std::string>&);
+
+    template biomxt::FileHeader npy_to_bmxt<int16_t>(const std::string&, const std::string&, const std::string&, const std::string&, const ConvertOptions&, std::vector<std::string>&);
+    template biomxt::FileHeader npy_to_bmxt<int32_t>(const std::string&, const std::string&, const std::string&, const std::string&, const ConvertOptions&, std::vector<std::string>&);
+    template biomxt::FileHeader npy_to_bmxt<int64_t>(const std::string&, const std::string&, const std::string&, const std::string&, const ConvertOptions&, std::vector<std::string>&);
+    template biomxt::FileHeader npy_to_bmxt<float>(const std::string&, const std::string&, const std::string&, const std::string&, const ConvertOptions&, std::vector<std::string>&);
+    template biomxt::FileHeader npy_to_bmxt<double>(const std::string&, const std::string&, const std::string&, const std::string&, const ConvertOptions&, std::vector<std::string>&);
+    template biomxt::FileHeader npy_to_bmxt<uint8_t>(const std::string&, const std::string&, const std::string&, const std::string&, const ConvertOptions&, std::vector<std::string>&);
+    template biomxt::FileHeader npy_to_bmxt<uint16_t>(const std::string&, const std::string&, const std::string&, const std::string&, const ConvertOptions&, std::vector<std::string>&);
+    template biomxt::FileHeader npy_to_bmxt<float16>(const std::string&, const std::string&, const std::string&, const std::string&, const ConvertOptions&, std::vector<std::string>&);
+    template biomxt::FileHeader npy_to_bmxt<bfloat16>(const std::string&, const std::string&, const std::string&, const std::string&, const ConvertOptions&, std::vector<std::string>&);
+
+    template biomxt::FileHeader raw_to_bmxt<int16_t>(const std::string&, uint32_t, uint32_t, bool, const std::string&, const std::string&, const std::string&, const ConvertOptions&, std::vector<std::string>&);
+    template biomxt::FileHeader raw_to_bmxt<int32_t>(const std::string&, uint32_t, uint32_t, bool, const std::string&, const std::string&, const std::string&, const ConvertOptions&, std::vector<std::string>&);
+    template biomxt::FileHeader raw_to_bmxt<int64_t>(const std::string&, uint32_t, uint32_t, bool, const std::string&, const std::string&, const std::string&, const ConvertOptions&, std::vector<std::string>&);
+    template biomxt::FileHeader raw_to_bmxt<float>(const std::string&, uint32_t, uint32_t, bool, const std::string&, const std::string&, const std::string&, const ConvertOptions&, std::vector<std::string>&);
+    template biomxt::FileHeader raw_to_bmxt<double>(const std::string&, uint32_t, uint32_t, bool, const std::string&, const std::string&, const std::string&, const ConvertOptions&, std::vector<std::string>&);
+    template biomxt::FileHeader raw_to_bmxt<uint8_t>(const std::string&, uint32_t, uint32_t, bool, const std::string&, const std::string&, const std::string&, const ConvertOptions&, std::vector<std::string>&);
+    template biomxt::FileHeader raw_to_bmxt<uint16_t>(const std::string&, uint32_t, uint32_t, bool, const std::string&, const std::string&, const std::string&, const ConvertOptions&, std::vector<std::string>&);
+    template biomxt::FileHeader raw_to_bmxt<float16>(const std::string&, uint32_t, uint32_t, bool, const std::string&, const std::string&, const std::string&, const ConvertOptions&, std::vector<std::string>&);
+    template biomxt::FileHeader raw_to_bmxt<bfloat16>(const std::string&, uint32_t, uint32_t, bool, const std::string&, const std::string&, const std::string&, const ConvertOptions&, std::vector<std::string>&);
 }
\ No newline at end of file
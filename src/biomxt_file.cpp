@@ -1,14 +1,22 @@
 #include "biomxt/biomxt_file.hpp"
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 
 namespace biomxt {
    
-    BiomxtFile::BiomxtFile(const std::string& path, BlockCache* block_cache) {
+    BiomxtFile::BiomxtFile(const std::string& path, BlockCache* block_cache) : _path(path) {
         // Open file in binary mode for reading
         _ifile.open(path, std::ios::binary);
         if (!_ifile.is_open()) {
             throw std::runtime_error("biomxt::BiomxtFile: Cannot open mmxt file: " + path);
         }
+#if !defined(_WIN32)
+        // Blocks are read by pread where available, so that reads are thread safe and access hints reach the OS
+        _fd = ::open(path.c_str(), O_RDONLY);
+#endif
 
         // If cache_entries is nullptr, use the internal cache_entries
         if (block_cache) {
@@ -23,22 +31,43 @@ namespace biomxt {
         std::streamsize file_size = _ifile.tellg();
         _ifile.seekg(0, std::ios::beg);
 
-        // Read file header
-        if (file_size < sizeof(biomxt::FileHeader)) {
+        // Read file header of either format version, version 1 is widened to 64-bit dimensions
+        if (file_size < static_cast<std::streamsize>(sizeof(biomxt::FileHeaderV1))) {
             throw std::runtime_error("biomxt::BiomxtFile: Corrupted file: bad header size");
         }
-        _ifile.read(reinterpret_cast<char*>(&_header), sizeof(biomxt::FileHeader));
+        _header_size = biomxt::read_bmxt_header(_ifile, _header);
+        if (_header.block_width == 0 || _header.block_height == 0) {
+            throw std::runtime_error("biomxt::BiomxtFile: Corrupted file: block width or height is 0");
+        }
+
+        // Block position of every row and column read, divided without hardware division where possible
+        _row_divisor = biomxt::FastDivisor(_header.block_height);
+        _column_divisor = biomxt::FastDivisor(_header.block_width);
+        _block_columns = (_header.ncol + _header.block_width - 1) / _header.block_width;
+        if ((_header.flags & biomxt::FileFlag::HAS_BLOCK_FRAMES) && _header.frame_height == 0) {
+            throw std::runtime_error("biomxt::BiomxtFile: Corrupted file: blocks are framed with frame height 0");
+        }
 
-        // Check magic
-        if (std::string(_header.magic, 4) != "BMXt") {
-            throw std::runtime_error("biomxt::BiomxtFile: Corrupted file: bad magic: " + std::string(_header.magic, 4));
+        // Load dictionary once, every block is decompressed with it
+        if (_header.flags & biomxt::FileFlag::HAS_DICTIONARY) {
+            uint32_t dictionary_size = 0;
+            _ifile.read(reinterpret_cast<char*>(&dictionary_size), sizeof(dictionary_size));
+            if (!_ifile || _header_size + sizeof(dictionary_size) + static_cast<uint64_t>(dictionary_size) > static_cast<uint64_t>(file_size)) {
+                throw std::runtime_error("biomxt::BiomxtFile: Corrupted file: dictionary exceeds file size [" + std::to_string(file_size) + "]");
+            }
+            std::vector<char> dictionary(dictionary_size);
+            _ifile.read(dictionary.data(), dictionary_size);
+            _dictionary = std::make_unique<biomxt::BlockDictionary>(std::move(dictionary), false);
         }
 
         // Read block table
-        if (_header.block_table_offset >= file_size) {
+        if (_header.block_table_offset >= static_cast<uint64_t>(file_size)) {
             throw std::runtime_error("biomxt::BiomxtFile: Corrupted file: block table offset [" + std::to_string(_header.block_table_offset) + "] exceeds file size [" + std::to_string(file_size) + "]");
         }
         _ifile.seekg(_header.block_table_offset, std::ios::beg);
+        if (_header.block_count > (static_cast<uint64_t>(file_size) - _header.block_table_offset) / sizeof(biomxt::IndexEntry)) {
+            throw std::runtime_error("biomxt::BiomxtFile: Corrupted file: block count [" + std::to_string(_header.block_count) + "] exceeds file size [" + std::to_string(file_size) + "]");
+        }
         _block_table.resize(_header.block_count);
         _ifile.read(reinterpret_cast<char*>(_block_table.data()), _header.block_count * sizeof(biomxt::IndexEntry));
 
@@ -50,18 +79,23 @@ namespace biomxt {
         if (block_cache == nullptr) _block_cache->set_memory_limit(std::max(_header.ncol / _header.block_width, _header.nrow / _header.block_height) * (_max_uncompressed_block_size + sizeof(biomxt::CacheEntry)));
 
         // Read names table
-        if (_header.name_table_offset >= file_size) {
+        if (_header.name_table_offset >= static_cast<uint64_t>(file_size)) {
             throw std::runtime_error("Corrupted file: names table offset [" + std::to_string(_header.name_table_offset) + "] exceeds file size [" + std::to_string(file_size) + "]");
         }
         _ifile.seekg(_header.name_table_offset, std::ios::beg);
+        const uint64_t max_names = (static_cast<uint64_t>(file_size) - _header.name_table_offset) / sizeof(biomxt::IndexEntry);
+        if (_header.nrow > max_names || _header.ncol > max_names - _header.nrow) {
+            throw std::runtime_error("biomxt::BiomxtFile: Corrupted file: row and column count [" + std::to_string(_header.nrow) + ", " + std::to_string(_header.ncol) + "] exceed file size [" + std::to_string(file_size) + "]");
+        }
         std::vector<biomxt::IndexEntry> name_table(_header.nrow + _header.ncol);
-        name_table.resize(_header.nrow + _header.ncol);
-        _ifile.read(reinterpret_cast<char*>(name_table.data()), (_header.nrow + _header.ncol) * sizeof(biomxt::IndexEntry));
+        if (!_ifile.read(reinterpret_cast<char*>(name_table.data()), (_header.nrow + _header.ncol) * sizeof(biomxt::IndexEntry))) {
+            throw std::runtime_error("biomxt::BiomxtFile: Corrupted file: read names table failed");
+        }
 
         // Read row names and build map
         _row_names.resize(_header.nrow);
         _row_map.reserve(_header.nrow);
-        for (uint32_t i = 0; i < _header.nrow; ++i) {
+        for (uint64_t i = 0; i < _header.nrow; ++i) {
             _ifile.seekg(name_table[i].offset, std::ios::beg);
             _row_names[i].resize(name_table[i].size);
             _ifile.read(&_row_names[i][0], name_table[i].size);
@@ -71,8 +105,8 @@ namespace biomxt {
         // Read column names and build map
         _column_names.resize(_header.ncol);
         _column_map.reserve(_header.ncol);
-        for (uint32_t i = 0; i < _header.ncol; ++i) {
-            uint32_t idx = _header.nrow + i;
+        for (uint64_t i = 0; i < _header.ncol; ++i) {
+            uint64_t idx = _header.nrow + i;
             _ifile.seekg(name_table[idx].offset, std::ios::beg);
             _column_names[i].resize(name_table[idx].size);
             _ifile.read(&_column_names[i][0], name_table[idx].size);
@@ -92,9 +126,17 @@ namespace biomxt {
             _release_resources();
             
             // Move resources from other to this
+            _path = std::move(other._path);
             _ifile = std::move(other._ifile);
+            _fd = other._fd;
+            _access_hint = other._access_hint;
             _header = other._header;
+            _header_size = other._header_size;
+            _row_divisor = other._row_divisor;
+            _column_divisor = other._column_divisor;
+            _block_columns = other._block_columns;
             _block_table = std::move(other._block_table);
+            _dictionary = std::move(other._dictionary);
             _row_names = std::move(other._row_names);
             _column_names = std::move(other._column_names);
             _row_map = std::move(other._row_map);
@@ -105,15 +147,20 @@ namespace biomxt {
             // Exchange block cache
             _owned_block_cache = std::move(other._owned_block_cache);
             _block_cache = other._block_cache;
+            _disk_cache = other._disk_cache;
             
             // Set other to safty state
             other._header = {}; 
             other._block_cache = nullptr;
+            other._disk_cache = nullptr;
+            other._fd = -1;
         }
         return *this;
     }
 
-    void BiomxtFile::read_block(uint32_t index, std::vector<char>& buffer) {
+    void BiomxtFile::read_block(uint64_t index, std::vector<char>& buffer) { read_block(index, buffer, _access_hint); }
+
+    void BiomxtFile::read_block(uint64_t index, std::vector<char>& buffer, AccessHint hint) {
         // Check file is closed
         if (!_ifile.is_open()) {
             throw std::runtime_error("biomxt::BiomxtFile::read_block: file is closed");
@@ -127,44 +174,366 @@ namespace biomxt {
         // Check buffer size
         const auto& block_index = _block_table[index];
         if (buffer.size() != block_index.raw_size) buffer.resize(block_index.raw_size);
-        std::vector<char> compressed_buffer(block_index.size);
 
         // Check cache
         biomxt::BlockKey key = {index, _header.uuid};
         if (_block_cache->get_block_data(key, buffer, 0, block_index.raw_size)) return;
 
-        // Read from file
-        _ifile.seekg(block_index.offset, std::ios::beg);
-        if (!_ifile.read(compressed_buffer.data(), block_index.size)) {
-            throw std::runtime_error("biomxt::BiomxtFile::read_block: read block [" + std::to_string(index) + "] data from file failed");
+        // Let OS read ahead following blocks of a sequential scan
+        if (has_hint(hint, AccessHint::SEQUENTIAL) && index + 1 < _header.block_count) {
+            _advise_blocks(index + 1, std::min<uint64_t>(index + _readahead_blocks, _header.block_count - 1), 1);
         }
-        
-        // Decompress
-        size_t decompressed_size = 0;
-        switch (_header.algo) {
-            case biomxt::CompressAlgorithm::ZSTD:
-                decompressed_size = ZSTD_decompress(
-                    buffer.data(),                  // target addr
-                    block_index.raw_size,           // target size
-                    compressed_buffer.data(),       // source addr
-                    block_index.size                // source size
-                );
-                if (ZSTD_isError(decompressed_size)) {
-                    throw std::runtime_error("biomxt::BiomxtFile::read_block: ZSTD_decompress error [" + std::string(ZSTD_getErrorName(decompressed_size)) + "]");
-                }
-                break;
-            default:
-                throw std::invalid_argument("biomxt::BiomxtFile::read_block: unsupported compression algorithm [" + std::to_string(_header.algo) + "]");
+
+        // Read from file and decompress
+        std::vector<char> compressed_buffer(block_index.size);
+        _load_block(index, _ifile, compressed_buffer, buffer);
+
+        // Decode only, and drop file pages
+        if (has_hint(hint, AccessHint::NOCACHE)) {
+            _advise(block_index.offset, block_index.size, AccessHint::NOCACHE);
+            return;
         }
 
-        // Cache block data
+        // Cache block data, sequential scans enter as least recently used
         std::vector<char> cache_data(block_index.raw_size);
         std::memcpy(cache_data.data(), buffer.data(), block_index.raw_size);
-        _block_cache->insert({index, _header.uuid}, std::move(cache_data));
+        _block_cache->insert({index, _header.uuid}, std::move(cache_data), false, has_hint(hint, AccessHint::SEQUENTIAL));
         
     }
 
-    void BiomxtFile::read_row_data(uint32_t row_index, std::vector<char>& buffer) {
+    void BiomxtFile::_load_block(uint64_t index, std::ifstream& ifile, std::vector<char>& compressed_buffer, std::vector<char>& buffer) const {
+        const auto& block_index = _block_table[index];
+        if (buffer.size() != block_index.raw_size) buffer.resize(block_index.raw_size);
+        _read_compressed_block(index, ifile, compressed_buffer);
+
+        // Decompress, revert filter and decode sparse blocks, frame by frame in framed files
+        const size_t cell_size = biomxt::size_of_dtype(_header.dtype);
+        if (_header.flags & biomxt::FileFlag::HAS_BLOCK_FRAMES) {
+            biomxt::unpack_framed_block(compressed_buffer.data(), block_index.size, cell_size, _block_line_size(index), _header.frame_height, _header.algo, _header.filter, _header.flags, buffer.data(), block_index.raw_size, _dictionary.get());
+            return;
+        }
+        biomxt::unpack_block(compressed_buffer.data(), block_index.size, cell_size, _header.algo, _header.filter, _header.flags, buffer.data(), block_index.raw_size, _dictionary.get());
+    }
+
+    void BiomxtFile::_read_compressed_block(uint64_t index, std::ifstream& ifile, std::vector<char>& compressed_buffer) const {
+        const auto& block_index = _block_table[index];
+        if (compressed_buffer.size() < block_index.size) compressed_buffer.resize(block_index.size);
+
+        // Read from disk cache, or from file then fill disk cache
+        biomxt::BlockKey key = {index, _header.uuid};
+        if (_disk_cache && _disk_cache->get(key, compressed_buffer, block_index.size)) return;
+        if (!_read_range(block_index.offset, block_index.size, ifile, compressed_buffer.data())) {
+            throw std::runtime_error("biomxt::BiomxtFile::read_block: read block [" + std::to_string(index) + "] data from file failed");
+        }
+        if (_disk_cache) _disk_cache->put(key, compressed_buffer.data(), block_index.size);
+    }
+
+    bool BiomxtFile::_read_range(uint64_t offset, size_t size, std::ifstream& ifile, char* dst) const {
+#if !defined(_WIN32)
+        if (_fd >= 0) {
+            size_t done = 0;
+            while (done < size) {
+                ssize_t n = ::pread(_fd, dst + done, size - done, offset + done);
+                if (n <= 0) return false;
+                done += n;
+            }
+            return true;
+        }
+#endif
+        ifile.seekg(offset, std::ios::beg);
+        return static_cast<bool>(ifile.read(dst, size));
+    }
+
+    size_t BiomxtFile::_block_line_size(uint64_t index) const {
+        const uint64_t block_pos_x = index % _block_columns;
+        const uint64_t actual_block_width = std::min<uint64_t>(_header.block_width, _header.ncol - block_pos_x * _header.block_width);
+        if (_header.flags & biomxt::FileFlag::COLUMN_MAJOR_BLOCKS) return _block_table[index].raw_size / actual_block_width;
+        return actual_block_width * biomxt::size_of_dtype(_header.dtype);
+    }
+
+    void BiomxtFile::_read_block_line(uint64_t index, uint64_t line, char* dst, std::vector<char>& frame_buffer, AccessHint hint) {
+        const auto& block_index = _block_table[index];
+        const size_t line_size = _block_line_size(index);
+
+        // A cached block serves the line as it is
+        biomxt::BlockKey key = {index, _header.uuid};
+        if (_block_cache->get_block_data(key, frame_buffer, line * line_size, line_size)) {
+            std::memcpy(dst, frame_buffer.data(), line_size);
+            return;
+        }
+
+        // Unpack only the frame holding the line
+        const size_t cell_size = biomxt::size_of_dtype(_header.dtype);
+        const size_t frame_size = static_cast<size_t>(_header.frame_height) * line_size;
+        const uint64_t frame = line / _header.frame_height;
+        if (frame_buffer.size() < frame_size) frame_buffer.resize(frame_size);
+        std::vector<char> compressed_buffer;
+        if (_disk_cache) {
+            // Disk cache holds whole stored blocks
+            _read_compressed_block(index, _ifile, compressed_buffer);
+            biomxt::unpack_block_frame(compressed_buffer.data(), block_index.size, cell_size, line_size, _header.frame_height, block_index.raw_size, frame, _header.algo, _header.filter, _header.flags, frame_buffer.data(), _dictionary.get());
+        } else {
+            // Read the ends of this frame and the previous one from the frame index, then only the frame's bytes
+            const size_t index_size = biomxt::frame_count(block_index.raw_size / line_size, _header.frame_height) * sizeof(uint32_t);
+            uint32_t frame_ends[2] = {0, 0};
+            const uint64_t entries = frame > 0 ? 2 : 1;
+            if (index_size > block_index.size || !_read_range(block_index.offset + (frame + 1 - entries) * sizeof(uint32_t), entries * sizeof(uint32_t), _ifile, reinterpret_cast<char*>(frame_ends + 2 - entries))) {
+                throw std::runtime_error("biomxt::BiomxtFile::read_block: read frame index of block [" + std::to_string(index) + "] from file failed");
+            }
+            if (frame_ends[0] > frame_ends[1] || index_size + frame_ends[1] > block_index.size) {
+                throw std::runtime_error("biomxt::BiomxtFile::read_block: frame index of block [" + std::to_string(index) + "] is corrupted at frame [" + std::to_string(frame) + "]");
+            }
+            compressed_buffer.resize(frame_ends[1] - frame_ends[0]);
+            if (!_read_range(block_index.offset + index_size + frame_ends[0], compressed_buffer.size(), _ifile, compressed_buffer.data())) {
+                throw std::runtime_error("biomxt::BiomxtFile::read_block: read frame [" + std::to_string(frame) + "] of block [" + std::to_string(index) + "] from file failed");
+            }
+            const size_t raw_size = std::min<size_t>(frame_size, block_index.raw_size - frame * frame_size);
+            biomxt::unpack_block(compressed_buffer.data(), compressed_buffer.size(), cell_size, _header.algo, _header.filter, _header.flags, frame_buffer.data(), raw_size, _dictionary.get());
+        }
+        std::memcpy(dst, frame_buffer.data() + (line - frame * _header.frame_height) * line_size, line_size);
+
+        if (has_hint(hint, AccessHint::NOCACHE)) {
+            _advise(block_index.offset, block_index.size, AccessHint::NOCACHE);
+        }
+    }
+
+    size_t BiomxtFile::warm_blocks(const std::vector<uint64_t>& block_indices, bool pin, uint32_t threads) {
+        // Check file is closed
+        if (!_ifile.is_open()) {
+            throw std::runtime_error("biomxt::BiomxtFile::warm_blocks: file is closed");
+        }
+
+        // Deduplicate and check index range
+        std::vector<uint64_t> indices(block_indices);
+        std::sort(indices.begin(), indices.end());
+        indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+        if (!indices.empty() && indices.back() >= _header.block_count) {
+            throw std::out_of_range("biomxt::BiomxtFile::warm_blocks: block index [" + std::to_string(indices.back()) + "] exceeds block count [" + std::to_string(_header.block_count) + "]");
+        }
+        return _warm_blocks(indices, pin, threads);
+    }
+
+    size_t BiomxtFile::_warm_blocks(const std::vector<uint64_t>& indices, bool pin, uint32_t threads) {
+        if (indices.empty()) return 0;
+
+        // Decide worker count
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        threads = std::min<uint32_t>(threads, indices.size());
+
+        // Workers take blocks in file order from a shared cursor, each with its own stream
+        std::atomic<size_t> cursor{0};
+        std::atomic<size_t> resident{0};
+        std::vector<std::exception_ptr> errors(threads);
+        auto worker = [&](uint32_t worker_id) {
+            try {
+                // Own stream only needed where pread is unavailable
+                std::ifstream ifile;
+                if (_fd < 0) ifile.open(_path, std::ios::binary);
+                if (_fd < 0 && !ifile.is_open()) {
+                    throw std::runtime_error("biomxt::BiomxtFile::warm_blocks: Cannot open mmxt file: " + _path);
+                }
+                std::vector<char> compressed_buffer(_max_compressed_block_size);
+                std::vector<char> buffer;
+                for (size_t i = cursor++; i < indices.size(); i = cursor++) {
+                    biomxt::BlockKey key = {indices[i], _header.uuid};
+
+                    // Already resident, only pin it if required, it stays resident unpinned once pinned blocks are full
+                    if (_block_cache->contains(key)) {
+                        if (pin) _block_cache->pin(key);
+                        resident++;
+                        continue;
+                    }
+
+                    // Once pinned blocks are full, a decoded block is still cached unpinned
+                    _load_block(indices[i], ifile, compressed_buffer, buffer);
+                    if (_block_cache->insert(key, std::move(buffer), pin) || (pin && _block_cache->insert(key, std::move(buffer), false))) resident++;
+                    buffer = std::vector<char>();
+                }
+            } catch (...) {
+                errors[worker_id] = std::current_exception();
+            }
+        };
+
+        std::vector<std::thread> workers;
+        workers.reserve(threads);
+        for (uint32_t t = 0; t < threads; ++t) workers.emplace_back(worker, t);
+        for (std::thread& t : workers) t.join();
+
+        // Report the first failure
+        for (const std::exception_ptr& error : errors) {
+            if (error) std::rethrow_exception(error);
+        }
+        return resident;
+    }
+
+    size_t BiomxtFile::warm_rows(const std::vector<uint64_t>& row_indices, bool pin, uint32_t threads) {
+        std::vector<uint64_t> block_rows;
+        block_rows.reserve(row_indices.size());
+        for (uint64_t row_index : row_indices) {
+            if (row_index >= _header.nrow) {
+                throw std::out_of_range("biomxt::BiomxtFile::warm_rows: row index [" + std::to_string(row_index) + "] exceeds row count [" + std::to_string(_header.nrow) + "]");
+            }
+            block_rows.push_back(_row_divisor.divide(row_index));
+        }
+
+        // All blocks in horizontal direction
+        std::vector<uint64_t> block_columns(_block_columns);
+        for (uint64_t i = 0; i < block_columns.size(); ++i) block_columns[i] = i;
+
+        return warm_blocks(_collect_blocks(block_rows, block_columns), pin, threads);
+    }
+
+    size_t BiomxtFile::warm_columns(const std::vector<uint64_t>& column_indices, bool pin, uint32_t threads) {
+        std::vector<uint64_t> block_columns;
+        block_columns.reserve(column_indices.size());
+        for (uint64_t column_index : column_indices) {
+            if (column_index >= _header.ncol) {
+                throw std::out_of_range("biomxt::BiomxtFile::warm_columns: column index [" + std::to_string(column_index) + "] exceeds column count [" + std::to_string(_header.ncol) + "]");
+            }
+            block_columns.push_back(_column_divisor.divide(column_index));
+        }
+
+        // All blocks in vertical direction
+        std::vector<uint64_t> block_rows((_header.nrow + _header.block_height - 1) / _header.block_height);
+        for (uint64_t i = 0; i < block_rows.size(); ++i) block_rows[i] = i;
+
+        return warm_blocks(_collect_blocks(block_rows, block_columns), pin, threads);
+    }
+
+    size_t BiomxtFile::warm_region(uint64_t row_begin, uint64_t row_end, uint64_t column_begin, uint64_t column_end, bool pin, uint32_t threads) {
+        if (row_begin > row_end || row_end > _header.nrow || column_begin > column_end || column_end > _header.ncol) {
+            throw std::out_of_range("biomxt::BiomxtFile::warm_region: region rows [" + std::to_string(row_begin) + ", " + std::to_string(row_end) + "), columns [" + std::to_string(column_begin) + ", " + std::to_string(column_end) + ") exceeds matrix size");
+        }
+        if (row_begin == row_end || column_begin == column_end) return 0;
+
+        std::vector<uint64_t> block_rows;
+        for (uint64_t y = _row_divisor.divide(row_begin); y <= _row_divisor.divide(row_end - 1); ++y) block_rows.push_back(y);
+        std::vector<uint64_t> block_columns;
+        for (uint64_t x = _column_divisor.divide(column_begin); x <= _column_divisor.divide(column_end - 1); ++x) block_columns.push_back(x);
+
+        return warm_blocks(_collect_blocks(block_rows, block_columns), pin, threads);
+    }
+
+    void BiomxtFile::unpin_blocks(const std::vector<uint64_t>& block_indices) {
+        for (uint64_t index : block_indices) {
+            _block_cache->unpin({index, _header.uuid});
+        }
+    }
+
+    std::future<size_t> BiomxtFile::prefetch_blocks(const std::vector<uint64_t>& block_indices, uint32_t threads) {
+        // Check file is closed
+        if (!_ifile.is_open()) {
+            throw std::runtime_error("biomxt::BiomxtFile::prefetch_blocks: file is closed");
+        }
+
+        // Deduplicate and check index range
+        std::vector<uint64_t> indices(block_indices);
+        std::sort(indices.begin(), indices.end());
+        indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+        if (!indices.empty() && indices.back() >= _header.block_count) {
+            throw std::out_of_range("biomxt::BiomxtFile::prefetch_blocks: block index [" + std::to_string(indices.back()) + "] exceeds block count [" + std::to_string(_header.block_count) + "]");
+        }
+
+        if (!indices.empty()) _advise_blocks(indices.front(), indices.back(), 1);
+        return std::async(std::launch::async, [this, indices, threads]() {
+            return _warm_blocks(indices, false, threads);
+        });
+    }
+
+    void BiomxtFile::set_access_hint(AccessHint hint) {
+        _access_hint = hint;
+        if (has_hint(hint, AccessHint::SEQUENTIAL)) _advise(0, 0, AccessHint::SEQUENTIAL);
+        else if (has_hint(hint, AccessHint::RANDOM)) _advise(0, 0, AccessHint::RANDOM);
+        else _advise(0, 0, AccessHint::NORMAL);
+    }
+
+    AccessHint BiomxtFile::get_access_hint() const { return _access_hint; }
+
+    void BiomxtFile::_advise(uint64_t offset, uint64_t size, AccessHint hint) const {
+#if defined(__linux__)
+        if (_fd < 0) return;
+        int advice = POSIX_FADV_NORMAL;
+        if (hint == AccessHint::RANDOM) advice = POSIX_FADV_RANDOM;
+        if (hint == AccessHint::SEQUENTIAL) advice = POSIX_FADV_SEQUENTIAL;
+        if (hint == AccessHint::NOCACHE) advice = POSIX_FADV_DONTNEED;
+        if (hint == AccessHint::WILLNEED) advice = POSIX_FADV_WILLNEED;
+        posix_fadvise(_fd, offset, size, advice);
+#endif
+    }
+
+    void BiomxtFile::_advise_blocks(uint64_t first, uint64_t last, uint64_t step) const {
+        if (first > last || last >= _header.block_count) return;
+        // Blocks are written in index order, so consecutive blocks are one range
+        if (step == 1) {
+            const auto& end_block = _block_table[last];
+            _advise(_block_table[first].offset, end_block.offset + end_block.size - _block_table[first].offset, AccessHint::WILLNEED);
+            return;
+        }
+        for (uint64_t i = first; i <= last; i += step) {
+            _advise(_block_table[i].offset, _block_table[i].size, AccessHint::WILLNEED);
+        }
+    }
+
+    void BiomxtFile::_close_fd() {
+#if !defined(_WIN32)
+        if (_fd >= 0) ::close(_fd);
+#endif
+        _fd = -1;
+    }
+
+    void BiomxtFile::set_disk_cache(DiskBlockCache* disk_cache) { _disk_cache = disk_cache; }
+
+    size_t BiomxtFile::save_cache_snapshot(const std::string& path, bool with_payload) const {
+        return _block_cache->save_snapshot(path, with_payload);
+    }
+
+    std::future<size_t> BiomxtFile::restore_cache_snapshot(const std::string& path, uint32_t threads) {
+        // Check file is closed
+        if (!_ifile.is_open()) {
+            throw std::runtime_error("biomxt::BiomxtFile::restore_cache_snapshot: file is closed");
+        }
+
+        return std::async(std::launch::async, [this, path, threads]() {
+            // Blocks with payload are inserted directly, others are pending for loading
+            std::vector<biomxt::BlockKey> pending, pending_pinned;
+            size_t restored = _block_cache->restore_snapshot(path, _header.uuid, _max_uncompressed_block_size, pending, pending_pinned);
+
+            // Pinned blocks are loaded first, so that LRU blocks never evict them
+            for (const std::vector<biomxt::BlockKey>* keys : {&pending_pinned, &pending}) {
+                std::vector<uint64_t> indices;
+                indices.reserve(keys->size());
+                for (const biomxt::BlockKey& key : *keys) {
+                    if (key.block_index() < _header.block_count) indices.push_back(key.block_index());
+                }
+                std::sort(indices.begin(), indices.end());
+                indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+                restored += _warm_blocks(indices, keys == &pending_pinned, threads);
+            }
+
+            // Blocks are loaded in file order, replay recency order from least to most recently used
+            for (auto it = pending.rbegin(); it != pending.rend(); ++it) {
+                _block_cache->touch(*it);
+            }
+            return restored;
+        });
+    }
+
+    std::vector<uint64_t> BiomxtFile::_collect_blocks(const std::vector<uint64_t>& block_rows, const std::vector<uint64_t>& block_columns) const {
+        std::vector<uint64_t> indices;
+        indices.reserve(block_rows.size() * block_columns.size());
+        for (uint64_t block_pos_y : block_rows) {
+            for (uint64_t block_pos_x : block_columns) {
+                indices.push_back(block_pos_y * _block_columns + block_pos_x);
+            }
+        }
+        std::sort(indices.begin(), indices.end());
+        indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+        return indices;
+    }
+
+    void BiomxtFile::read_row_data(uint64_t row_index, std::vector<char>& buffer) { read_row_data(row_index, buffer, _access_hint); }
+
+    void BiomxtFile::read_row_data(uint64_t row_index, std::vector<char>& buffer, AccessHint hint) {
         // Check file is closed
         if (!_ifile.is_open()) {
             throw std::runtime_error("biomxt::BiomxtFile::read_row_data: file is closed");
@@ -180,27 +549,51 @@ namespace biomxt {
         buffer.resize(_header.ncol * cell_size);
 
         // Calculate block pos
-        uint32_t block_pos_y = row_index / _header.block_height; // Block's row index
-        uint32_t row_in_block = row_index % _header.block_height;  // Target row index inner block
+        uint64_t block_pos_y = _row_divisor.divide(row_index); // Block's row index
+        uint64_t row_in_block = _row_divisor.remainder(row_index);  // Target row index inner block
 
         // How many block in horizontal direction
-        uint32_t block_max_x = (_header.ncol + _header.block_width - 1) / _header.block_width;
+        uint64_t block_max_x = _block_columns;
+
+        std::vector<char> block_buffer(static_cast<size_t>(_header.block_width) * _header.block_height * cell_size);
 
-        std::vector<char> block_buffer(_header.block_width * _header.block_height * cell_size);
+        // Ask OS for all blocks of the row at once
+        if (has_hint(hint, AccessHint::WILLNEED)) {
+            _advise_blocks(block_pos_y * block_max_x, block_pos_y * block_max_x + block_max_x - 1, 1);
+        }
+
+        // Rows of framed row-major files read at random only unpack the frame holding them, leaving the cache to whole blocks
+        const bool column_major = (_header.flags & biomxt::FileFlag::COLUMN_MAJOR_BLOCKS) != 0;
+        if ((_header.flags & biomxt::FileFlag::HAS_BLOCK_FRAMES) && !column_major && has_hint(hint, AccessHint::RANDOM | AccessHint::NOCACHE)) {
+            for (uint64_t block_pos_x = 0; block_pos_x < block_max_x; ++block_pos_x) {
+                _read_block_line(block_pos_y * block_max_x + block_pos_x, row_in_block, buffer.data() + block_pos_x * _header.block_width * cell_size, block_buffer, hint);
+            }
+            return;
+        }
 
         // Traverse all blocks in horizontal direction
-        for (uint32_t block_pos_x = 0; block_pos_x < block_max_x; ++block_pos_x) {
-            uint32_t block_idx = (uint32_t)block_pos_y * block_max_x + block_pos_x;
+        for (uint64_t block_pos_x = 0; block_pos_x < block_max_x; ++block_pos_x) {
+            uint64_t block_idx = block_pos_y * block_max_x + block_pos_x;
             
             // Read block
-            this->read_block(block_idx, block_buffer);
+            this->read_block(block_idx, block_buffer, hint);
 
             // Calculate actual block size
-            uint32_t actual_block_width = std::min(_header.block_width, _header.ncol - block_pos_x * _header.block_width);
-
-            // Fetch target inner block row
+            uint64_t actual_block_width = std::min<uint64_t>(_header.block_width, _header.ncol - block_pos_x * _header.block_width);
+
+            // Fetch target inner block row, one cell per column of column-major blocks
+            char* row_dst = buffer.data() + block_pos_x * _header.block_width * cell_size;
+            if (column_major) {
+                const uint64_t actual_block_height = block_buffer.size() / cell_size / actual_block_width;
+                const char* block_ptr = block_buffer.data() + row_in_block * cell_size;
+                for (uint64_t j = 0; j < actual_block_width; ++j) {
+                    std::memcpy(row_dst + j * cell_size, block_ptr, cell_size);
+                    block_ptr += actual_block_height * cell_size;
+                }
+                continue;
+            }
             const char* row_start = block_buffer.data() + (row_in_block * actual_block_width * cell_size);
-            std::copy(row_start, row_start + actual_block_width * cell_size, buffer.begin() + (block_pos_x * _header.block_width * cell_size));
+            std::copy(row_start, row_start + actual_block_width * cell_size, row_dst);
         }
 
     }
@@ -213,7 +606,9 @@ namespace biomxt {
         this->read_row_data(it->second, buffer);
     }
 
-    void BiomxtFile::read_column_data(uint32_t column_index, std::vector<char>& buffer) {
+    void BiomxtFile::read_column_data(uint64_t column_index, std::vector<char>& buffer) { read_column_data(column_index, buffer, _access_hint); }
+
+    void BiomxtFile::read_column_data(uint64_t column_index, std::vector<char>& buffer, AccessHint hint) {
         // Check file is closed
         if (!_ifile.is_open()) {
             throw std::runtime_error("biomxt::BiomxtFile::read_column_data: file is closed");
@@ -228,30 +623,51 @@ namespace biomxt {
         uint32_t cell_size = biomxt::size_of_dtype(_header.dtype);
         buffer.resize(_header.nrow * cell_size);
         // Prepare block buffer
-        std::vector<char> block_buffer(_header.block_width * _header.block_height * cell_size);
+        std::vector<char> block_buffer(static_cast<size_t>(_header.block_width) * _header.block_height * cell_size);
 
         // Calculate block pos
-        uint32_t block_pos_x = column_index / _header.block_width; // Block's column index
-        uint32_t col_in_block = column_index % _header.block_width;  // Target column index inner block
+        uint64_t block_pos_x = _column_divisor.divide(column_index); // Block's column index
+        uint64_t col_in_block = _column_divisor.remainder(column_index);  // Target column index inner block
 
         // How many block in vertical direction
-        uint32_t block_max_x = (_header.ncol + _header.block_width - 1) / _header.block_width;
-        uint32_t block_max_y = (_header.nrow + _header.block_height - 1) / _header.block_height;
+        uint64_t block_max_x = _block_columns;
+        uint64_t block_max_y = (_header.nrow + _header.block_height - 1) / _header.block_height;
+
+        // Ask OS for all blocks of the column at once
+        if (has_hint(hint, AccessHint::WILLNEED)) {
+            _advise_blocks(block_pos_x, (block_max_y - 1) * block_max_x + block_pos_x, block_max_x);
+        }
+
+        // Columns of framed column-major files read at random only unpack the frame holding them, leaving the cache to whole blocks
+        const bool column_major = (_header.flags & biomxt::FileFlag::COLUMN_MAJOR_BLOCKS) != 0;
+        if ((_header.flags & biomxt::FileFlag::HAS_BLOCK_FRAMES) && column_major && has_hint(hint, AccessHint::RANDOM | AccessHint::NOCACHE)) {
+            for (uint64_t block_pos_y = 0; block_pos_y < block_max_y; ++block_pos_y) {
+                _read_block_line(block_pos_y * block_max_x + block_pos_x, col_in_block, buffer.data() + block_pos_y * _header.block_height * cell_size, block_buffer, hint);
+            }
+            return;
+        }
 
         // Traverse all blocks in vertical direction
-        for (uint32_t block_pos_y = 0; block_pos_y < block_max_y; ++block_pos_y) {
-            uint32_t block_idx = (uint32_t)block_pos_y * block_max_x + block_pos_x;
+        for (uint64_t block_pos_y = 0; block_pos_y < block_max_y; ++block_pos_y) {
+            uint64_t block_idx = block_pos_y * block_max_x + block_pos_x;
             
             // Read block
-            this->read_block(block_idx, block_buffer);
+            this->read_block(block_idx, block_buffer, hint);
 
             // Calculate actual block size
-            uint32_t actual_block_width = std::min(_header.block_width, _header.ncol - block_pos_x * _header.block_width);
+            uint64_t actual_block_width = std::min<uint64_t>(_header.block_width, _header.ncol - block_pos_x * _header.block_width);
             uint32_t actual_block_height = block_buffer.size() / cell_size / actual_block_width;
 
+            // Column of a column-major block is one contiguous slice
+            if (column_major) {
+                const char* column_start = block_buffer.data() + col_in_block * actual_block_height * cell_size;
+                std::memcpy(buffer.data() + block_pos_y * _header.block_height * cell_size, column_start, actual_block_height * cell_size);
+                continue;
+            }
+
             // Fetch target inner block col
             char* block_ptr = block_buffer.data() + col_in_block * cell_size; // Target column's first row in block
-            uint64_t cell_offset = (uint64_t)block_pos_y * _header.block_height * cell_size; // Calculate cell offset in result cells
+            uint64_t cell_offset = block_pos_y * _header.block_height * cell_size; // Calculate cell offset in result cells
 
             for (uint32_t i = 0; i < actual_block_height; ++i) {
                 std::memcpy(
@@ -272,6 +688,124 @@ namespace biomxt {
         return read_column_data(it->second, buffer);
     }
 
+    void BiomxtFile::read_row_sparse(uint64_t row_index, std::vector<uint32_t>& column_indices, std::vector<char>& values) {
+        if (!_ifile.is_open()) {
+            throw std::runtime_error("biomxt::BiomxtFile::read_row_sparse: file is closed");
+        }
+        if (row_index >= _header.nrow) {
+            throw std::out_of_range("biomxt::BiomxtFile::read_row_sparse: row index [" + std::to_string(row_index) + "] exceeds row count [" + std::to_string(_header.nrow) + "]");
+        }
+        if (_header.ncol > UINT32_MAX) {
+            throw std::out_of_range("biomxt::BiomxtFile::read_row_sparse: column count [" + std::to_string(_header.ncol) + "] exceeds 32-bit indices");
+        }
+        column_indices.clear();
+        values.clear();
+
+        // A row is a line of row-major blocks, and one cell of every line of column-major blocks
+        const uint64_t block_pos_y = _row_divisor.divide(row_index);
+        const uint64_t row_in_block = _row_divisor.remainder(row_index);
+        const bool column_major = (_header.flags & biomxt::FileFlag::COLUMN_MAJOR_BLOCKS) != 0;
+        for (uint64_t block_pos_x = 0; block_pos_x < _block_columns; ++block_pos_x) {
+            _gather_block_sparse(block_pos_y * _block_columns + block_pos_x, row_in_block, !column_major, static_cast<uint32_t>(block_pos_x * _header.block_width), column_indices, values);
+        }
+    }
+
+    void BiomxtFile::read_column_sparse(uint64_t column_index, std::vector<uint32_t>& row_indices, std::vector<char>& values) {
+        if (!_ifile.is_open()) {
+            throw std::runtime_error("biomxt::BiomxtFile::read_column_sparse: file is closed");
+        }
+        if (column_index >= _header.ncol) {
+            throw std::out_of_range("biomxt::BiomxtFile::read_column_sparse: column index [" + std::to_string(column_index) + "] exceeds column count [" + std::to_string(_header.ncol) + "]");
+        }
+        if (_header.nrow > UINT32_MAX) {
+            throw std::out_of_range("biomxt::BiomxtFile::read_column_sparse: row count [" + std::to_string(_header.nrow) + "] exceeds 32-bit indices");
+        }
+        row_indices.clear();
+        values.clear();
+
+        // A column is a line of column-major blocks, and one cell of every line of row-major blocks
+        const uint64_t block_pos_x = _column_divisor.divide(column_index);
+        const uint64_t col_in_block = _column_divisor.remainder(column_index);
+        const uint64_t block_max_y = (_header.nrow + _header.block_height - 1) / _header.block_height;
+        const bool column_major = (_header.flags & biomxt::FileFlag::COLUMN_MAJOR_BLOCKS) != 0;
+        for (uint64_t block_pos_y = 0; block_pos_y < block_max_y; ++block_pos_y) {
+            _gather_block_sparse(block_pos_y * _block_columns + block_pos_x, col_in_block, column_major, static_cast<uint32_t>(block_pos_y * _header.block_height), row_indices, values);
+        }
+    }
+
+    void BiomxtFile::_gather_block_sparse(uint64_t index, uint64_t position, bool along, uint32_t index_base, std::vector<uint32_t>& indices, std::vector<char>& values) {
+        const auto& block_index = _block_table[index];
+        const size_t cell_size = biomxt::size_of_dtype(_header.dtype);
+        const size_t line_size = _block_line_size(index);
+        const size_t line_length = line_size / cell_size;
+        const size_t lines = block_index.raw_size / line_size;
+
+        // Cells read: all of line `position`, or cell `position` of every line
+        const size_t begin = along ? position * line_length : position;
+        const size_t count = along ? line_length : lines;
+        const size_t stride = along ? 1 : line_length;
+
+        // A cached block is already dense
+        std::vector<char> buffer;
+        biomxt::BlockKey key = {index, _header.uuid};
+        if (_block_cache->contains(key)) {
+            read_block(index, buffer, _access_hint);
+            biomxt::sparsify_strided(buffer.data(), cell_size, begin, count, stride, index_base, indices, values);
+            return;
+        }
+
+        // Sparse blocks, or frames, hand out their nonzeros from the bitmap, others are decoded to dense first
+        std::vector<char> compressed_buffer;
+        std::vector<char> bitmap;
+        std::vector<char> packed;
+        _read_compressed_block(index, _ifile, compressed_buffer);
+        if (!(_header.flags & biomxt::FileFlag::HAS_BLOCK_FRAMES)) {
+            buffer.resize(block_index.raw_size);
+            if (biomxt::unpack_block_sparse(compressed_buffer.data(), block_index.size, cell_size, _header.algo, _header.filter, _header.flags, buffer.data(), block_index.raw_size, bitmap, packed, _dictionary.get())) {
+                biomxt::bitmap_gather(bitmap.data(), packed.data(), packed.size() / cell_size, cell_size, begin, count, stride, index_base, indices, values);
+            } else {
+                biomxt::sparsify_strided(buffer.data(), cell_size, begin, count, stride, index_base, indices, values);
+                if (!has_hint(_access_hint, AccessHint::NOCACHE)) {
+                    _block_cache->insert(key, std::move(buffer), false, has_hint(_access_hint, AccessHint::SEQUENTIAL));
+                }
+            }
+        } else {
+            // A line only needs the frame holding it, cells across lines need every frame
+            const size_t frame_height = _header.frame_height;
+            const size_t first = along ? position / frame_height : 0;
+            const size_t last = along ? first + 1 : biomxt::frame_count(lines, frame_height);
+            buffer.resize(frame_height * line_size);
+            for (size_t frame = first; frame < last; frame++) {
+                const size_t frame_begin = along ? begin - frame * frame_height * line_length : begin;
+                const size_t frame_cells = along ? count : std::min(frame_height, lines - frame * frame_height);
+                const uint32_t frame_base = along ? index_base : index_base + static_cast<uint32_t>(frame * frame_height);
+                if (biomxt::unpack_block_frame_sparse(compressed_buffer.data(), block_index.size, cell_size, line_size, _header.frame_height, block_index.raw_size, frame, _header.algo, _header.filter, _header.flags, buffer.data(), bitmap, packed, _dictionary.get())) {
+                    biomxt::bitmap_gather(bitmap.data(), packed.data(), packed.size() / cell_size, cell_size, frame_begin, frame_cells, stride, frame_base, indices, values);
+                } else {
+                    biomxt::sparsify_strided(buffer.data(), cell_size, frame_begin, frame_cells, stride, frame_base, indices, values);
+                }
+            }
+        }
+
+        if (has_hint(_access_hint, AccessHint::NOCACHE)) {
+            _advise(block_index.offset, block_index.size, AccessHint::NOCACHE);
+        }
+    }
+
+    void BiomxtFile::read_row_float(uint64_t row_index, std::vector<float>& values) {
+        std::vector<char> buffer;
+        read_row_data(row_index, buffer);
+        values.resize(buffer.size() / biomxt::size_of_dtype(_header.dtype));
+        biomxt::expand_to_float(buffer.data(), values.size(), _header.dtype, values.data());
+    }
+
+    void BiomxtFile::read_column_float(uint64_t column_index, std::vector<float>& values) {
+        std::vector<char> buffer;
+        read_column_data(column_index, buffer);
+        values.resize(buffer.size() / biomxt::size_of_dtype(_header.dtype));
+        biomxt::expand_to_float(buffer.data(), values.size(), _header.dtype, values.data());
+    }
+
     const std::vector<std::string>& BiomxtFile::get_row_names() const {
         if (!_ifile.is_open()) {
             throw std::runtime_error("biomxt::BiomxtFile::get_row_names: File has been closed.");
@@ -279,7 +813,7 @@ namespace biomxt {
         return _row_names;
     }
     
-    std::vector<std::string> BiomxtFile::get_row_names(const std::vector<uint32_t>& row_indices) const {
+    std::vector<std::string> BiomxtFile::get_row_names(const std::vector<uint64_t>& row_indices) const {
         if (!_ifile.is_open()) {
             throw std::runtime_error("biomxt::BiomxtFile::get_row_names: File has been closed.");
         }
@@ -288,7 +822,7 @@ namespace biomxt {
         results.reserve(row_indices.size()); 
         
         // Fill
-        for (uint32_t idx : row_indices) {
+        for (uint64_t idx : row_indices) {
             if (idx < _header.nrow) {
                 results.push_back(_row_names[idx]);
             } else {
@@ -305,7 +839,7 @@ namespace biomxt {
         return _column_names;
     }
     
-    std::vector<std::string> BiomxtFile::get_column_names(const std::vector<uint32_t>& column_indices) const {
+    std::vector<std::string> BiomxtFile::get_column_names(const std::vector<uint64_t>& column_indices) const {
         if (!_ifile.is_open()) {
             throw std::runtime_error("biomxt::BiomxtFile::get_column_names: File has been closed.");
         }
@@ -314,7 +848,7 @@ namespace biomxt {
         results.reserve(column_indices.size()); 
         
         // Fill
-        for (uint32_t idx : column_indices) {
+        for (uint64_t idx : column_indices) {
             if (idx < _header.ncol) {
                 results.push_back(_column_names[idx]);
             } else {
@@ -324,12 +858,12 @@ namespace biomxt {
         return results;
     }
     
-    std::vector<uint32_t> BiomxtFile::get_row_indices(const std::vector<std::string>& row_names) const {
+    std::vector<uint64_t> BiomxtFile::get_row_indices(const std::vector<std::string>& row_names) const {
         if (!_ifile.is_open()) {
             throw std::runtime_error("biomxt::BiomxtFile::get_row_indices: File has been closed.");
         }
 
-        std::vector<uint32_t> results;
+        std::vector<uint64_t> results;
         // Reserve
         results.reserve(row_names.size());
 
@@ -349,12 +883,12 @@ namespace biomxt {
         return results;
     }
     
-    std::vector<uint32_t> BiomxtFile::get_column_indices(const std::vector<std::string>& column_names) const {
+    std::vector<uint64_t> BiomxtFile::get_column_indices(const std::vector<std::string>& column_names) const {
         if (!_ifile.is_open()) {
             throw std::runtime_error("biomxt::BiomxtFile::get_column_indices: File has been closed.");
         }
         // Reserve
-        std::vector<uint32_t> results;
+        std::vector<uint64_t> results;
         results.reserve(column_names.size()); 
         
         // Fill
@@ -0,0 +1,250 @@
+#include "biomxt/biomxt_writer.hpp"
+#include "biomxt/biomxt_converter.hpp"
+#include "biomxt/utils/checkpoint.hpp"
+
+
+namespace biomxt {
+
+    template <typename T> BiomxtWriter<T>::BiomxtWriter(
+        const std::string& output_file,
+        std::vector<std::string> colnames,
+        const biomxt::ConvertOptions& options)
+        : _output_file(output_file), _block_height(options.block_height), _sparse_threshold(options.sparse_threshold), _integer_codec(std::is_integral_v<T> ? options.integer_codec : biomxt::IntegerCodec::NONE), _policy(options.policy), _colnames(std::move(colnames))
+        {
+            static_assert(biomxt::dtype_from_type<T>::valid, "biomxt::BiomxtWriter: Invalid data type.");
+
+            // Check block width and height
+            if (options.block_height == 0 || options.block_width == 0) {
+                throw std::invalid_argument("biomxt::BiomxtWriter: Block width or height must be greater than 0.");
+            }
+
+            // Fill some basic information of header
+            _header.dtype = biomxt::dtype_from_type<T>::value;
+            _header.algo = options.algo;
+            _header.filter = options.filter;
+            _header.flags |= biomxt::block_flags(_sparse_threshold, _integer_codec, _policy);
+            if (options.frame_height > 0) {
+                _header.flags |= biomxt::FileFlag::HAS_BLOCK_FRAMES;
+                _header.frame_height = options.frame_height;
+            }
+            if (options.column_major) _header.flags |= biomxt::FileFlag::COLUMN_MAJOR_BLOCKS;
+            _header.block_width = options.block_width;
+            _header.block_height = options.block_height;
+            _header.uuid = biomxt::UUID::generate();
+
+            // Create output file, and reserve space for header
+            _out.open(output_file, std::ios::binary);
+            if (!_out.is_open()) throw std::runtime_error("biomxt::BiomxtWriter: Failed to open output file: " + output_file);
+            _out.seekp(sizeof(biomxt::FileHeader));
+
+            _pipeline = std::make_unique<biomxt::BlockPipeline<T>>(_out, options.block_width, options.algo, options.threads, options.max_inflight_block_rows, options.filter, options.dictionary_size, _sparse_threshold, _integer_codec, _policy, _header.frame_height, (_header.flags & biomxt::FileFlag::COLUMN_MAJOR_BLOCKS) != 0);
+        }
+
+    template <typename T> BiomxtWriter<T>::BiomxtWriter(
+        const std::string& output_file,
+        const biomxt::ConvertCheckpoint& checkpoint,
+        const biomxt::ConvertOptions& options)
+        : _output_file(output_file), _block_height(checkpoint.block_height), _sparse_threshold(checkpoint.sparse_threshold), _integer_codec(checkpoint.integer_codec), _policy(checkpoint.policy), _rownames(checkpoint.rownames), _colnames(checkpoint.colnames), _resumed_blocks(checkpoint.block_table), _checkpoint_rows(checkpoint.rownames.size()), _checkpoint_blocks(checkpoint.block_table.size())
+        {
+            static_assert(biomxt::dtype_from_type<T>::valid, "biomxt::BiomxtWriter: Invalid data type.");
+
+            // Check checkpoint matches the writer
+            if (checkpoint.dtype != biomxt::dtype_from_type<T>::value) {
+                throw std::invalid_argument("biomxt::BiomxtWriter: Checkpoint data type [" + biomxt::dtype_to_string(checkpoint.dtype) + "] mismatch, expected [" + biomxt::dtype_to_string(biomxt::dtype_from_type<T>::value) + "].");
+            }
+            if (checkpoint.block_height == 0 || checkpoint.block_width == 0) {
+                throw std::invalid_argument("biomxt::BiomxtWriter: Block width or height must be greater than 0.");
+            }
+            if (!std::filesystem::exists(output_file) || std::filesystem::file_size(output_file) < checkpoint.output_offset) {
+                throw std::runtime_error("biomxt::BiomxtWriter: Output file is missing or shorter than its checkpoint: " + output_file);
+            }
+
+            // Header of the interrupted file
+            _header.dtype = checkpoint.dtype;
+            _header.algo = checkpoint.algo;
+            _header.filter = checkpoint.filter;
+            _header.flags |= biomxt::block_flags(_sparse_threshold, _integer_codec, _policy);
+            if (checkpoint.frame_height > 0) {
+                _header.flags |= biomxt::FileFlag::HAS_BLOCK_FRAMES;
+                _header.frame_height = checkpoint.frame_height;
+            }
+            if (checkpoint.column_major) _header.flags |= biomxt::FileFlag::COLUMN_MAJOR_BLOCKS;
+            _header.block_width = checkpoint.block_width;
+            _header.block_height = checkpoint.block_height;
+            _header.uuid = checkpoint.uuid;
+
+            // Drop blocks written after the checkpoint, and append from there
+            std::filesystem::resize_file(output_file, checkpoint.output_offset);
+            _out.open(output_file, std::ios::binary | std::ios::in | std::ios::out);
+            if (!_out.is_open()) throw std::runtime_error("biomxt::BiomxtWriter: Failed to open output file: " + output_file);
+            _out.seekp(checkpoint.output_offset);
+
+            _pipeline = std::make_unique<biomxt::BlockPipeline<T>>(_out, checkpoint.block_width, checkpoint.algo, options.threads, options.max_inflight_block_rows, checkpoint.filter, 0, _sparse_threshold, _integer_codec, _policy, _header.frame_height, (_header.flags & biomxt::FileFlag::COLUMN_MAJOR_BLOCKS) != 0);
+
+            // Blocks written so far were compressed with the dictionary ahead of them, so must be the rest
+            if (checkpoint.dictionary_size > 0) {
+                std::vector<char> dictionary(checkpoint.dictionary_size);
+                std::ifstream in(output_file, std::ios::binary);
+                in.seekg(sizeof(biomxt::FileHeader) + sizeof(uint32_t));
+                if (!in.read(dictionary.data(), dictionary.size())) {
+                    throw std::runtime_error("biomxt::BiomxtWriter: Failed to read dictionary of output file: " + output_file);
+                }
+                _pipeline->use_dictionary(std::move(dictionary));
+            }
+        }
+
+    template <typename T> BiomxtWriter<T>::~BiomxtWriter() {
+        // Pipeline threads must stop before the stream they write to is closed
+        _pipeline.reset();
+    }
+
+    template <typename T> void BiomxtWriter<T>::write_row(std::string rowname, const T* values) {
+        _check_open("write_row");
+        _rownames.push_back(std::move(rowname));
+        _append(values, 1);
+    }
+
+    template <typename T> void BiomxtWriter<T>::write_row(std::string rowname, const std::vector<T>& values) {
+        if (values.size() != _colnames.size()) {
+            throw std::invalid_argument("biomxt::BiomxtWriter::write_row: Row has " + std::to_string(values.size()) + " values, expected " + std::to_string(_colnames.size()) + ".");
+        }
+        write_row(std::move(rowname), values.data());
+    }
+
+    template <typename T> void BiomxtWriter<T>::write_rows(std::vector<std::string>&& rownames, const T* values) {
+        _check_open("write_rows");
+        size_t count = rownames.size();
+        if (_rownames.empty()) {
+            _rownames = std::move(rownames);
+        } else {
+            _rownames.insert(_rownames.end(), std::make_move_iterator(rownames.begin()), std::make_move_iterator(rownames.end()));
+        }
+        _append(values, count);
+    }
+
+    template <typename T> void BiomxtWriter<T>::write_rows(const std::vector<std::string>& rownames, const T* values) {
+        write_rows(std::vector<std::string>(rownames), values);
+    }
+
+    template <typename T> uint64_t BiomxtWriter<T>::checkpoint(biomxt::ConvertCheckpoint& checkpoint) {
+        _check_open("checkpoint");
+
+        // Wait for pushed block rows, then make them durable before they are recorded
+        const std::vector<biomxt::IndexEntry>& block_table = _pipeline->drain();
+        _out.flush();
+        if (!_out) {
+            throw std::runtime_error("biomxt::BiomxtWriter::checkpoint: Failed to write output file: " + _output_file);
+        }
+        biomxt::sync_file(_output_file);
+
+        uint64_t row_count = _rownames.size() - _actual_block_height;
+        checkpoint.uuid = _header.uuid;
+        checkpoint.dtype = _header.dtype;
+        checkpoint.algo = _header.algo;
+        checkpoint.filter = _header.filter;
+        checkpoint.block_width = _header.block_width;
+        checkpoint.block_height = _header.block_height;
+        checkpoint.dictionary_size = _pipeline->dictionary() ? _pipeline->dictionary()->data().size() : 0;
+        checkpoint.sparse_threshold = _sparse_threshold;
+        checkpoint.integer_codec = _integer_codec;
+        checkpoint.policy = _policy;
+        checkpoint.frame_height = _header.frame_height;
+        checkpoint.column_major = (_header.flags & biomxt::FileFlag::COLUMN_MAJOR_BLOCKS) != 0;
+        checkpoint.output_offset = static_cast<uint64_t>(_out.tellp());
+
+        // Only rows and blocks since the previous checkpoint, column names once
+        checkpoint.row_offset = _checkpoint_rows;
+        checkpoint.block_offset = _checkpoint_blocks;
+        if (_checkpoint_rows == 0 && _checkpoint_blocks == 0) checkpoint.colnames = _colnames;
+        checkpoint.rownames.assign(_rownames.begin() + _checkpoint_rows, _rownames.begin() + row_count);
+        checkpoint.block_table.assign(block_table.begin() + (_checkpoint_blocks - _resumed_blocks.size()), block_table.end());
+        _checkpoint_rows = row_count;
+        _checkpoint_blocks = _resumed_blocks.size() + block_table.size();
+        return row_count;
+    }
+
+    template <typename T> biomxt::FileHeader BiomxtWriter<T>::finish() {
+        _check_open("finish");
+        _finished = true;
+
+        // Catch the last block
+        const uint32_t ncol = _colnames.size();
+        if (_actual_block_height > 0) {
+            _pipeline->push(std::move(_rows_buffer), ncol, _actual_block_height);
+            _actual_block_height = 0;
+        }
+
+        // Wait for all blocks to be written
+        const std::vector<biomxt::IndexEntry>& block_table = _pipeline->finish();
+
+        // Write names, tables and header
+        if (_pipeline->dictionary()) _header.flags |= biomxt::FileFlag::HAS_DICTIONARY;
+        _header.nrow = _rownames.size();
+        _header.ncol = ncol;
+        if (_resumed_blocks.empty()) {
+            biomxt::write_bmxt_tail(_out, _header, block_table, _rownames, _colnames);
+        } else {
+            _resumed_blocks.insert(_resumed_blocks.end(), block_table.begin(), block_table.end());
+            biomxt::write_bmxt_tail(_out, _header, _resumed_blocks, _rownames, _colnames);
+        }
+
+        // Write done
+        _pipeline.reset();
+        _out.close();
+        return _header;
+    }
+
+    template <typename T> uint64_t BiomxtWriter<T>::get_row_count() const {
+        return _rownames.size();
+    }
+
+    template <typename T> uint64_t BiomxtWriter<T>::get_column_count() const {
+        return _colnames.size();
+    }
+
+    template <typename T> bool BiomxtWriter<T>::is_finished() const {
+        return _finished;
+    }
+
+    template <typename T> void BiomxtWriter<T>::_append(const T* values, size_t count) {
+        // Both sides are row-major with ncol per row, copy as many rows as the strip can take at once
+        const size_t ncol = _colnames.size();
+        size_t r = 0;
+        while (r < count) {
+            if (_rows_buffer.empty()) {
+                // Previous strip went into the pipeline, take back a written one or allocate a new one
+                if (!_pipeline->recycle(_rows_buffer)) {
+                    _rows_buffer.resize(static_cast<size_t>(_block_height) * ncol);
+                }
+            }
+            size_t n = std::min<size_t>(count - r, _block_height - _actual_block_height);
+            std::copy(values + r * ncol, values + (r + n) * ncol, _rows_buffer.begin() + static_cast<size_t>(_actual_block_height) * ncol);
+            r += n;
+            _actual_block_height += n;
+
+            // Hand rows buffer to the pipeline when it is full
+            if (_actual_block_height == _block_height) {
+                _pipeline->push(std::move(_rows_buffer), ncol, _actual_block_height);
+                _rows_buffer.clear();
+                _actual_block_height = 0;
+            }
+        }
+    }
+
+    template <typename T> void BiomxtWriter<T>::_check_open(const char* method) const {
+        if (_finished) {
+            throw std::runtime_error("biomxt::BiomxtWriter::" + std::string(method) + ": Writer is finished.");
+        }
+    }
+
+    template class BiomxtWriter<int16_t>;
+    template class BiomxtWriter<int32_t>;
+    template class BiomxtWriter<int64_t>;
+    template class BiomxtWriter<float>;
+    template class BiomxtWriter<double>;
+    template class BiomxtWriter<uint8_t>;
+    template class BiomxtWriter<uint16_t>;
+    template class BiomxtWriter<float16>;
+    template class BiomxtWriter<bfloat16>;
+
+} // namespace biomxt
@@ -0,0 +1,109 @@
+#include "biomxt/utils/bitpack.hpp"
+#include <cstring>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define BIOMXT_BITPACK_SSE2
+#endif
+
+
+namespace biomxt {
+
+    uint32_t bit_width(const uint32_t* values, size_t count) {
+        uint32_t any = 0;
+        for (size_t i = 0; i < count; i++) any |= values[i];
+        uint32_t bits = 0;
+        while (bits < 32 && (any >> bits) != 0) bits++;
+        return bits;
+    }
+
+#if defined(BIOMXT_BITPACK_SSE2)
+    void pack128(const uint32_t* in, uint32_t bits, uint32_t* out) {
+        if (bits == 0) return;
+        __m128i word = _mm_setzero_si128();
+        uint32_t shift = 0;
+        for (uint32_t k = 0; k < 32; k++) {
+            __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 4 * k));
+            word = _mm_or_si128(word, _mm_sll_epi32(value, _mm_cvtsi32_si128(shift)));
+            shift += bits;
+            if (shift >= 32) {
+                // Word is full, high bits of this value start the next one
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out), word);
+                out += 4;
+                shift -= 32;
+                word = shift ? _mm_srl_epi32(value, _mm_cvtsi32_si128(bits - shift)) : _mm_setzero_si128();
+            }
+        }
+    }
+
+    void unpack128(const uint32_t* in, uint32_t bits, uint32_t* out) {
+        if (bits == 0) {
+            std::memset(out, 0, BITPACK_GROUP * sizeof(uint32_t));
+            return;
+        }
+        const __m128i mask = _mm_set1_epi32(bits == 32 ? -1 : static_cast<int>((1u << bits) - 1));
+        __m128i word = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+        uint32_t shift = 0;
+        for (uint32_t k = 0; k < 32; k++) {
+            __m128i value = _mm_srl_epi32(word, _mm_cvtsi32_si128(shift));
+            shift += bits;
+            if (shift >= 32) {
+                // Word is used up, a value across words takes its high bits from the next one
+                shift -= 32;
+                if (shift > 0 || k < 31) {
+                    in += 4;
+                    word = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+                }
+                if (shift > 0) value = _mm_or_si128(value, _mm_sll_epi32(word, _mm_cvtsi32_si128(bits - shift)));
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4 * k), _mm_and_si128(value, mask));
+        }
+    }
+#else
+    void pack128(const uint32_t* in, uint32_t bits, uint32_t* out) {
+        if (bits == 0) return;
+        for (uint32_t lane = 0; lane < 4; lane++) {
+            uint32_t* dst = out + lane;
+            uint64_t word = 0;
+            uint32_t shift = 0;
+            for (uint32_t k = 0; k < 32; k++) {
+                word |= static_cast<uint64_t>(in[4 * k + lane]) << shift;
+                shift += bits;
+                if (shift >= 32) {
+                    uint32_t full = static_cast<uint32_t>(word);
+                    std::memcpy(dst, &full, sizeof(full));
+                    dst += 4;
+                    word >>= 32;
+                    shift -= 32;
+                }
+            }
+        }
+    }
+
+    void unpack128(const uint32_t* in, uint32_t bits, uint32_t* out) {
+        if (bits == 0) {
+            std::memset(out, 0, BITPACK_GROUP * sizeof(uint32_t));
+            return;
+        }
+        const uint64_t mask = (uint64_t(1) << bits) - 1;
+        for (uint32_t lane = 0; lane < 4; lane++) {
+            const uint32_t* src = in + lane;
+            uint32_t next;
+            std::memcpy(&next, src, sizeof(next));
+            uint64_t word = next;
+            uint32_t available = 32;
+            for (uint32_t k = 0; k < 32; k++) {
+                if (available < bits) {
+                    src += 4;
+                    std::memcpy(&next, src, sizeof(next));
+                    word |= static_cast<uint64_t>(next) << available;
+                    available += 32;
+                }
+                out[4 * k + lane] = static_cast<uint32_t>(word & mask);
+                word >>= bits;
+                available -= bits;
+            }
+        }
+    }
+#endif
+
+} // namespace biomxt
@@ -0,0 +1,831 @@
+#include "biomxt/utils/block_codec.hpp"
+#include "biomxt/utils/shuffle.hpp"
+#include "biomxt/utils/sparse_block.hpp"
+#include "biomxt/utils/int_codec.hpp"
+#include <cstring>
+#include <climits>
+#include <algorithm>
+#include "lz4.h"
+#include "lz4hc.h"
+#include "zlib.h"
+
+
+namespace biomxt {
+
+    namespace {
+
+        // Level of zstd blocks, dictionaries are digested at the same level
+        constexpr int _zstd_level = 3;
+
+        /**
+         * @brief Zstd contexts of a thread, reused by every block it compresses or decompresses.
+         */
+        struct ZstdContexts {
+            ZSTD_CCtx* cctx = nullptr;
+            ZSTD_DCtx* dctx = nullptr;
+
+            ~ZstdContexts() {
+                ZSTD_freeCCtx(cctx);
+                ZSTD_freeDCtx(dctx);
+            }
+
+            ZSTD_CCtx* compression() {
+                if (cctx == nullptr) cctx = ZSTD_createCCtx();
+                if (cctx == nullptr) throw std::runtime_error("biomxt::compress_block: ZSTD_createCCtx failed");
+                return cctx;
+            }
+
+            ZSTD_DCtx* decompression() {
+                if (dctx == nullptr) dctx = ZSTD_createDCtx();
+                if (dctx == nullptr) throw std::runtime_error("biomxt::decompress_block: ZSTD_createDCtx failed");
+                return dctx;
+            }
+        };
+
+        thread_local ZstdContexts _zstd_contexts;
+
+        // Scratch of a thread for payloads and filtered data, reused by every block it packs or unpacks
+        thread_local std::vector<char> _payload_buffer;
+        thread_local std::vector<char> _filter_buffer;
+        thread_local std::vector<char> _compress_buffer;
+        thread_local std::vector<char> _candidate_buffer;
+
+        // Scratch of adaptive packing
+        thread_local std::vector<char> _sparse_payload;
+        thread_local std::vector<char> _integer_payload;
+        thread_local std::vector<char> _filtered_payload;
+
+        // Packed frame of a framed block, before it is appended behind the frame index
+        thread_local std::vector<char> _frame_buffer;
+
+        // Levels of zstd candidates of adaptive blocks, fast to strong
+        constexpr int _adaptive_zstd_levels[] = {1, _zstd_level, 9};
+
+        // Decode costs of adaptive candidates in ns per byte, measured once on a typical core, so that the codec chosen does not depend on load
+        constexpr double _store_cost = 0.05;                ///< Per byte of payload.
+        constexpr double _lz4_cost = 0.4;                   ///< Per byte of payload.
+        constexpr double _zstd_cost = 1.2;                  ///< Per byte of payload.
+        constexpr double _zstd_compressed_cost = 2.0;       ///< Per compressed byte, on top of the payload.
+        constexpr double _shuffle_cost = 0.15;              ///< Per filtered byte.
+        constexpr double _bitshuffle_cost = 0.75;           ///< Per filtered byte.
+        constexpr double _bitmap_cost = 0.25;               ///< Per raw byte.
+        constexpr double _for_cost = 0.3;                   ///< Per raw byte, also of fixed width.
+        constexpr double _delta_cost = 0.45;                ///< Per raw byte.
+
+        /**
+         * @brief Locate a frame of a framed block by its index, checking the index is ordered and within the block.
+         */
+        void _frame_bounds(const char* src, size_t src_size, size_t frames, size_t frame, size_t& begin, size_t& end) {
+            const size_t index_size = frames * sizeof(uint32_t);
+            if (frame >= frames || src_size < index_size) {
+                throw std::runtime_error("biomxt::unpack_block_frame: Frame [" + std::to_string(frame) + "] of [" + std::to_string(frames) + "] frames is out of block");
+            }
+            uint32_t frame_end;
+            std::memcpy(&frame_end, src + frame * sizeof(uint32_t), sizeof(frame_end));
+            end = index_size + frame_end;
+            begin = index_size;
+            if (frame > 0) {
+                uint32_t frame_begin;
+                std::memcpy(&frame_begin, src + (frame - 1) * sizeof(uint32_t), sizeof(frame_begin));
+                begin += frame_begin;
+            }
+            if (begin > end || end > src_size) {
+                throw std::runtime_error("biomxt::unpack_block_frame: Frame index is corrupted at frame [" + std::to_string(frame) + "]");
+            }
+        }
+
+        /**
+         * @brief Read the encoding or codec byte and the extent a stored block starts with, moving src past them.
+         */
+        void _read_block_tag(const char*& src, size_t& src_size, uint8_t flags, biomxt::CompressAlgorithm& algo, biomxt::BlockFilter& filter, const biomxt::BlockDictionary*& dictionary, biomxt::BlockEncoding& encoding, uint32_t& extent) {
+            encoding = biomxt::BlockEncoding::DENSE;
+            extent = 0;
+            if (!(flags & (biomxt::FileFlag::HAS_BLOCK_ENCODING | biomxt::FileFlag::HAS_BLOCK_CODEC))) return;
+            if (src_size < 1) {
+                throw std::runtime_error("biomxt::unpack_block: Block is empty");
+            }
+            uint8_t tag = static_cast<uint8_t>(src[0]);
+            src++;
+            src_size--;
+            if (flags & biomxt::FileFlag::HAS_BLOCK_CODEC) {
+                // Codec of the block overrides that of the file, the dictionary only serves zstd
+                filter = static_cast<biomxt::BlockFilter>(tag >> 3 & 0x03);
+                algo = static_cast<biomxt::CompressAlgorithm>(tag >> 5);
+                if (filter > biomxt::BlockFilter::BITSHUFFLE || algo > biomxt::CompressAlgorithm::STORE) {
+                    throw std::runtime_error("biomxt::unpack_block: Unsupported block codec [" + std::to_string(tag) + "]");
+                }
+                tag &= 0x07;
+                if (algo != biomxt::CompressAlgorithm::ZSTD) dictionary = nullptr;
+            }
+            encoding = static_cast<biomxt::BlockEncoding>(tag);
+            if (encoding > biomxt::BlockEncoding::FIXED) {
+                throw std::runtime_error("biomxt::unpack_block: Unsupported block encoding [" + std::to_string(static_cast<int>(encoding)) + "]");
+            }
+            if (encoding != biomxt::BlockEncoding::DENSE) {
+                if (src_size < sizeof(extent)) {
+                    throw std::runtime_error("biomxt::unpack_block: Block of encoding [" + biomxt::encoding_to_string(encoding) + "] is truncated");
+                }
+                std::memcpy(&extent, src, sizeof(extent));
+                src += sizeof(extent);
+                src_size -= sizeof(extent);
+            }
+        }
+
+        /**
+         * @brief Encode integers with one codec.
+         */
+        biomxt::BlockEncoding _integer_encode(const char* src, size_t size, size_t element_size, biomxt::IntegerCodec codec, std::vector<char>& dst) {
+            switch (codec) {
+                case biomxt::IntegerCodec::FOR:
+                    biomxt::for_encode(src, size, element_size, dst);
+                    return biomxt::BlockEncoding::FOR;
+                case biomxt::IntegerCodec::DELTA:
+                    biomxt::delta_encode(src, size, element_size, dst);
+                    return biomxt::BlockEncoding::DELTA;
+                case biomxt::IntegerCodec::FIXED:
+                    biomxt::fixed_encode(src, size, element_size, dst);
+                    return biomxt::BlockEncoding::FIXED;
+                default:
+                    throw std::invalid_argument("biomxt::encode_block: Unsupported integer codec [" + biomxt::integer_codec_to_string(codec) + "]");
+            }
+        }
+
+        /**
+         * @brief Encode a block as its bitmap then its nonzeros, only the nonzeros are filtered.
+         */
+        void _bitmap_encode(const char* src, size_t size, size_t element_size, biomxt::BlockFilter filter, size_t nnz, std::vector<char>& payload) {
+            const size_t bitmap = biomxt::bitmap_size(size / element_size);
+            const size_t values_size = nnz * element_size;
+            if (filter == biomxt::BlockFilter::NONE) {
+                payload.resize(bitmap + values_size + element_size);
+                biomxt::bitmap_encode(src, size, element_size, payload.data());
+            } else {
+                _filter_buffer.resize(bitmap + values_size + element_size);
+                biomxt::bitmap_encode(src, size, element_size, _filter_buffer.data());
+                payload.resize(bitmap + values_size);
+                std::memcpy(payload.data(), _filter_buffer.data(), bitmap);
+                biomxt::filter_block(_filter_buffer.data() + bitmap, values_size, filter, element_size, payload.data() + bitmap);
+            }
+            payload.resize(bitmap + values_size);
+        }
+
+        /**
+         * @brief Compress a payload behind its tag byte, and its extent unless dense.
+         */
+        size_t _write_block(uint8_t tag, biomxt::BlockEncoding encoding, uint32_t extent, const char* payload, size_t payload_size, biomxt::CompressAlgorithm algo, int level, std::vector<char>& dst, const biomxt::BlockDictionary* dictionary) {
+            char prefix[1 + sizeof(uint32_t)] = {static_cast<char>(tag)};
+            size_t prefix_size = 1;
+            if (encoding != biomxt::BlockEncoding::DENSE) {
+                std::memcpy(prefix + 1, &extent, sizeof(extent));
+                prefix_size += sizeof(extent);
+            }
+            size_t compressed_size = biomxt::compress_block(payload, payload_size, algo, _compress_buffer, dictionary, level);
+            if (dst.size() < prefix_size + compressed_size) {
+                dst.resize(prefix_size + compressed_size);
+            }
+            std::memcpy(dst.data(), prefix, prefix_size);
+            std::memcpy(dst.data() + prefix_size, _compress_buffer.data(), compressed_size);
+            return prefix_size + compressed_size;
+        }
+
+        /**
+         * @brief Payload of one encoding of an adaptive block, before filter.
+         */
+        struct AdaptivePayload {
+            biomxt::BlockEncoding encoding;
+            const char* data;
+            size_t size;
+            size_t head;                    ///< Leading bytes never filtered, the bitmap of a sparse payload or all of an integer one.
+            uint32_t extent;
+        };
+
+        /**
+         * @brief A codec candidate of an adaptive block, with its stored size.
+         */
+        struct AdaptiveCandidate {
+            size_t payload;                 ///< Index of its payload.
+            biomxt::BlockFilter filter;
+            biomxt::CompressAlgorithm algo;
+            int level;
+            size_t size;
+        };
+
+        /**
+         * @brief Filter a payload past its head, no copy without filter.
+         */
+        const char* _filter_payload(const AdaptivePayload& payload, biomxt::BlockFilter filter, size_t element_size) {
+            if (filter == biomxt::BlockFilter::NONE) return payload.data;
+            _filtered_payload.resize(payload.size);
+            std::memcpy(_filtered_payload.data(), payload.data, payload.head);
+            biomxt::filter_block(payload.data + payload.head, payload.size - payload.head, filter, element_size, _filtered_payload.data() + payload.head);
+            return _filtered_payload.data();
+        }
+
+        /**
+         * @brief Pack a block with one candidate codec.
+         */
+        size_t _pack_candidate(const AdaptivePayload& payload, const AdaptiveCandidate& candidate, size_t element_size, std::vector<char>& dst, const biomxt::BlockDictionary* dictionary) {
+            const uint8_t tag = biomxt::make_block_codec(payload.encoding, candidate.filter, candidate.algo);
+            const char* data = _filter_payload(payload, candidate.filter, element_size);
+            return _write_block(tag, payload.encoding, payload.extent, data, payload.size, candidate.algo, candidate.level, dst,
+                candidate.algo == biomxt::CompressAlgorithm::ZSTD ? dictionary : nullptr);
+        }
+
+        /**
+         * @brief Estimate the decode time of a candidate in ns, from the static cost table.
+         */
+        double _decode_cost(const AdaptivePayload& payload, const AdaptiveCandidate& candidate, size_t raw_size) {
+            double cost = 0;
+            switch (candidate.algo) {
+                case biomxt::CompressAlgorithm::STORE: cost += _store_cost * payload.size; break;
+                case biomxt::CompressAlgorithm::LZ4: cost += _lz4_cost * payload.size; break;
+                case biomxt::CompressAlgorithm::ZSTD: cost += _zstd_cost * payload.size + _zstd_compressed_cost * candidate.size; break;
+                default: break;
+            }
+            const size_t filtered = payload.size - payload.head;
+            if (candidate.filter == biomxt::BlockFilter::SHUFFLE) cost += _shuffle_cost * filtered;
+            if (candidate.filter == biomxt::BlockFilter::BITSHUFFLE) cost += _bitshuffle_cost * filtered;
+            switch (payload.encoding) {
+                case biomxt::BlockEncoding::BITMAP: cost += _bitmap_cost * raw_size; break;
+                case biomxt::BlockEncoding::FOR: case biomxt::BlockEncoding::FIXED: cost += _for_cost * raw_size; break;
+                case biomxt::BlockEncoding::DELTA: cost += _delta_cost * raw_size; break;
+                default: break;
+            }
+            return cost;
+        }
+
+        /**
+         * @brief Choose the codec of a block and pack it, see `CodecPolicy`.
+         */
+        size_t _pack_adaptive(const char* src, size_t size, size_t element_size, biomxt::IntegerCodec integer_codec, uint32_t min_decode_speed, std::vector<char>& dst, const biomxt::BlockDictionary* dictionary) {
+            // Payloads of every encoding that shrinks the block, dense always
+            std::vector<AdaptivePayload> payloads = {{biomxt::BlockEncoding::DENSE, src, size, 0, 0}};
+            const size_t count = size / element_size;
+            const size_t nnz = biomxt::count_nonzeros(src, size, element_size);
+            const size_t bitmap = biomxt::bitmap_size(count);
+            if (bitmap + nnz * element_size < size) {
+                _sparse_payload.resize(bitmap + nnz * element_size + element_size);
+                biomxt::bitmap_encode(src, size, element_size, _sparse_payload.data());
+                payloads.push_back({biomxt::BlockEncoding::BITMAP, _sparse_payload.data(), bitmap + nnz * element_size, bitmap, static_cast<uint32_t>(nnz)});
+            }
+            if (integer_codec != biomxt::IntegerCodec::NONE && biomxt::int_codec_supported(element_size)) {
+                biomxt::BlockEncoding encoding = biomxt::encode_block(src, size, element_size, biomxt::BlockFilter::NONE, 0, integer_codec, _integer_payload);
+                if (encoding != biomxt::BlockEncoding::DENSE) {
+                    payloads.push_back({encoding, _integer_payload.data(), _integer_payload.size(), _integer_payload.size(), static_cast<uint32_t>(_integer_payload.size())});
+                }
+            }
+
+            // Filter of each payload chosen by lz4 as a cheap proxy, then every algorithm tried with it
+            std::vector<AdaptiveCandidate> candidates;
+            for (size_t p = 0; p < payloads.size(); p++) {
+                const AdaptivePayload& payload = payloads[p];
+                const size_t prefix_size = payload.encoding == biomxt::BlockEncoding::DENSE ? 1 : 1 + sizeof(uint32_t);
+                biomxt::BlockFilter best_filter = biomxt::BlockFilter::NONE;
+                size_t best_lz4 = biomxt::compress_block(payload.data, payload.size, biomxt::CompressAlgorithm::LZ4, _compress_buffer);
+                if (payload.head < payload.size && element_size > 1) {
+                    for (biomxt::BlockFilter filter : {biomxt::BlockFilter::SHUFFLE, biomxt::BlockFilter::BITSHUFFLE}) {
+                        size_t lz4_size = biomxt::compress_block(_filter_payload(payload, filter, element_size), payload.size, biomxt::CompressAlgorithm::LZ4, _compress_buffer);
+                        if (lz4_size < best_lz4) {
+                            best_lz4 = lz4_size;
+                            best_filter = filter;
+                        }
+                    }
+                }
+                candidates.push_back({p, biomxt::BlockFilter::NONE, biomxt::CompressAlgorithm::STORE, 0, prefix_size + payload.size});
+                candidates.push_back({p, best_filter, biomxt::CompressAlgorithm::LZ4, 0, prefix_size + best_lz4});
+                const char* data = _filter_payload(payload, best_filter, element_size);
+                if (dictionary != nullptr) {
+                    candidates.push_back({p, best_filter, biomxt::CompressAlgorithm::ZSTD, 0, prefix_size + biomxt::compress_block(data, payload.size, biomxt::CompressAlgorithm::ZSTD, _compress_buffer, dictionary)});
+                    continue;
+                }
+                for (int level : _adaptive_zstd_levels) {
+                    candidates.push_back({p, best_filter, biomxt::CompressAlgorithm::ZSTD, level, prefix_size + biomxt::compress_block(data, payload.size, biomxt::CompressAlgorithm::ZSTD, _compress_buffer, nullptr, level)});
+                }
+            }
+            // Ties go to the candidate tried first, i.e. the faster one
+            std::stable_sort(candidates.begin(), candidates.end(), [](const AdaptiveCandidate& a, const AdaptiveCandidate& b) { return a.size < b.size; });
+            if (min_decode_speed == 0) {
+                return _pack_candidate(payloads[candidates[0].payload], candidates[0], element_size, dst, dictionary);
+            }
+
+            // Smallest candidate estimated to decode fast enough, else the fastest one, raw bytes per ns are GB/s
+            double fastest_cost = 0;
+            size_t fastest = 0;
+            for (size_t c = 0; c < candidates.size(); c++) {
+                double cost = _decode_cost(payloads[candidates[c].payload], candidates[c], size);
+                if (static_cast<double>(size) * 1e3 >= min_decode_speed * cost) {
+                    return _pack_candidate(payloads[candidates[c].payload], candidates[c], element_size, dst, dictionary);
+                }
+                if (c == 0 || cost < fastest_cost) {
+                    fastest_cost = cost;
+                    fastest = c;
+                }
+            }
+            return _pack_candidate(payloads[candidates[fastest].payload], candidates[fastest], element_size, dst, dictionary);
+        }
+
+    } // namespace
+
+    BlockDictionary::BlockDictionary(std::vector<char> data, bool for_compression) : _data(std::move(data)) {
+        _ddict = ZSTD_createDDict(_data.data(), _data.size());
+        if (_ddict == nullptr) {
+            throw std::runtime_error("biomxt::BlockDictionary: ZSTD_createDDict failed");
+        }
+        if (for_compression) {
+            _cdict = ZSTD_createCDict(_data.data(), _data.size(), _zstd_level);
+            if (_cdict == nullptr) {
+                ZSTD_freeDDict(_ddict);
+                throw std::runtime_error("biomxt::BlockDictionary: ZSTD_createCDict failed");
+            }
+        }
+    }
+
+    BlockDictionary::~BlockDictionary() {
+        ZSTD_freeCDict(_cdict);
+        ZSTD_freeDDict(_ddict);
+    }
+
+    const std::vector<char>& BlockDictionary::data() const {
+        return _data;
+    }
+
+    const ZSTD_CDict* BlockDictionary::cdict() const {
+        return _cdict;
+    }
+
+    const ZSTD_DDict* BlockDictionary::ddict() const {
+        return _ddict;
+    }
+
+    std::vector<char> train_dictionary(
+        const std::vector<char>& samples,
+        const std::vector<size_t>& sample_sizes,
+        size_t dictionary_size)
+        {
+            std::vector<char> dictionary(dictionary_size);
+            size_t size = ZDICT_trainFromBuffer(dictionary.data(), dictionary.size(), samples.data(), sample_sizes.data(), static_cast<unsigned>(sample_sizes.size()));
+            if (ZDICT_isError(size)) {
+                return {};
+            }
+            dictionary.resize(size);
+            return dictionary;
+        }
+
+    size_t compress_block(
+        const char* src,
+        size_t src_size,
+        biomxt::CompressAlgorithm algo,
+        std::vector<char>& dst,
+        const biomxt::BlockDictionary* dictionary,
+        int level)
+        {
+            if (dictionary != nullptr && algo != biomxt::CompressAlgorithm::ZSTD) {
+                throw std::invalid_argument("biomxt::compress_block: Dictionary is only supported by zstd, not [" + biomxt::algo_to_string(algo) + "]");
+            }
+            size_t dst_size = 0;
+            switch (algo) {
+                case biomxt::CompressAlgorithm::ZSTD:
+                    dst_size = ZSTD_compressBound(src_size);
+                    if (dst_size > dst.size()) {
+                        dst.resize(dst_size);
+                    }
+                    if (dictionary == nullptr) {
+                        dst_size = ZSTD_compressCCtx(_zstd_contexts.compression(), dst.data(), dst_size, src, src_size, level == 0 ? _zstd_level : level);
+                    } else if (dictionary->cdict() != nullptr) {
+                        dst_size = ZSTD_compress_usingCDict(_zstd_contexts.compression(), dst.data(), dst_size, src, src_size, dictionary->cdict());
+                    } else {
+                        throw std::invalid_argument("biomxt::compress_block: Dictionary is not digested for compression");
+                    }
+                    if (ZSTD_isError(dst_size)) {
+                        throw std::runtime_error("biomxt::compress_block: ZSTD_compress failed [" + std::string(ZSTD_getErrorName(dst_size)) + "]");
+                    }
+                    return dst_size;
+                case biomxt::CompressAlgorithm::GZIP: {
+                    uLongf gzip_size = compressBound(static_cast<uLong>(src_size));
+                    if (gzip_size > dst.size()) {
+                        dst.resize(gzip_size);
+                    }
+                    int ret = compress2(reinterpret_cast<Bytef*>(dst.data()), &gzip_size, reinterpret_cast<const Bytef*>(src), static_cast<uLong>(src_size), Z_DEFAULT_COMPRESSION);
+                    if (ret != Z_OK) {
+                        throw std::runtime_error("biomxt::compress_block: compress2 failed [" + std::to_string(ret) + "]");
+                    }
+                    return gzip_size;
+                }
+                case biomxt::CompressAlgorithm::LZ4:
+                case biomxt::CompressAlgorithm::LZ4HC: {
+                    if (src_size > LZ4_MAX_INPUT_SIZE) {
+                        throw std::invalid_argument("biomxt::compress_block: Block of [" + std::to_string(src_size) + "] bytes exceeds LZ4 input limit");
+                    }
+                    int bound = LZ4_compressBound(static_cast<int>(src_size));
+                    if (static_cast<size_t>(bound) > dst.size()) {
+                        dst.resize(bound);
+                    }
+                    // HC spends more time matching for a better ratio, decoding speed is the same
+                    int lz4_size = algo == biomxt::CompressAlgorithm::LZ4
+                        ? LZ4_compress_default(src, dst.data(), static_cast<int>(src_size), bound)
+                        : LZ4_compress_HC(src, dst.data(), static_cast<int>(src_size), bound, LZ4HC_CLEVEL_DEFAULT);
+                    if (lz4_size <= 0) {
+                        throw std::runtime_error("biomxt::compress_block: LZ4 compression failed");
+                    }
+                    return lz4_size;
+                }
+                case biomxt::CompressAlgorithm::STORE:
+                    if (src_size > dst.size()) {
+                        dst.resize(src_size);
+                    }
+                    std::memcpy(dst.data(), src, src_size);
+                    return src_size;
+                default:
+                    throw std::invalid_argument("biomxt::compress_block: Unsupported compression algorithm [" + std::to_string(algo) + "]");
+            }
+        }
+
+    void decompress_block(
+        const char* src,
+        size_t src_size,
+        biomxt::CompressAlgorithm algo,
+        char* dst,
+        size_t dst_size,
+        const biomxt::BlockDictionary* dictionary)
+        {
+            if (dictionary != nullptr && algo != biomxt::CompressAlgorithm::ZSTD) {
+                throw std::invalid_argument("biomxt::decompress_block: Dictionary is only supported by zstd, not [" + biomxt::algo_to_string(algo) + "]");
+            }
+            size_t decompressed_size = 0;
+            switch (algo) {
+                case biomxt::CompressAlgorithm::ZSTD:
+                    decompressed_size = ZSTD_decompress_usingDDict(
+                        _zstd_contexts.decompression(), // context of this thread
+                        dst,                            // target addr
+                        dst_size,                       // target size
+                        src,                            // source addr
+                        src_size,                       // source size
+                        dictionary == nullptr ? nullptr : dictionary->ddict()
+                    );
+                    if (ZSTD_isError(decompressed_size)) {
+                        throw std::runtime_error("biomxt::decompress_block: ZSTD_decompress error [" + std::string(ZSTD_getErrorName(decompressed_size)) + "]");
+                    }
+                    break;
+                case biomxt::CompressAlgorithm::GZIP: {
+                    uLongf gzip_size = static_cast<uLongf>(dst_size);
+                    int ret = uncompress(reinterpret_cast<Bytef*>(dst), &gzip_size, reinterpret_cast<const Bytef*>(src), static_cast<uLong>(src_size));
+                    if (ret != Z_OK) {
+                        throw std::runtime_error("biomxt::decompress_block: uncompress error [" + std::to_string(ret) + "]");
+                    }
+                    decompressed_size = gzip_size;
+                    break;
+                }
+                case biomxt::CompressAlgorithm::LZ4:
+                case biomxt::CompressAlgorithm::LZ4HC: {
+                    if (src_size > INT_MAX || dst_size > INT_MAX) {
+                        throw std::runtime_error("biomxt::decompress_block: LZ4 block size out of range");
+                    }
+                    int lz4_size = LZ4_decompress_safe(src, dst, static_cast<int>(src_size), static_cast<int>(dst_size));
+                    if (lz4_size < 0) {
+                        throw std::runtime_error("biomxt::decompress_block: LZ4_decompress_safe error [" + std::to_string(lz4_size) + "]");
+                    }
+                    decompressed_size = static_cast<size_t>(lz4_size);
+                    break;
+                }
+                case biomxt::CompressAlgorithm::STORE:
+                    decompressed_size = src_size;
+                    if (src_size == dst_size) std::memcpy(dst, src, src_size);
+                    break;
+                default:
+                    throw std::invalid_argument("biomxt::decompress_block: unsupported compression algorithm [" + std::to_string(algo) + "]");
+            }
+            if (decompressed_size != dst_size) {
+                throw std::runtime_error("biomxt::decompress_block: decompressed size [" + std::to_string(decompressed_size) + "] mismatch, expected [" + std::to_string(dst_size) + "]");
+            }
+        }
+
+    void filter_block(
+        const char* src,
+        size_t size,
+        biomxt::BlockFilter filter,
+        size_t element_size,
+        char* dst)
+        {
+            switch (filter) {
+                case biomxt::BlockFilter::NONE:
+                    std::memcpy(dst, src, size);
+                    break;
+                case biomxt::BlockFilter::SHUFFLE:
+                    biomxt::byte_shuffle(src, dst, size, element_size);
+                    break;
+                case biomxt::BlockFilter::BITSHUFFLE:
+                    biomxt::bit_shuffle(src, dst, size, element_size);
+                    break;
+                default:
+                    throw std::invalid_argument("biomxt::filter_block: Unsupported block filter [" + std::to_string(static_cast<int>(filter)) + "]");
+            }
+        }
+
+    void unfilter_block(
+        const char* src,
+        size_t size,
+        biomxt::BlockFilter filter,
+        size_t element_size,
+        char* dst)
+        {
+            switch (filter) {
+                case biomxt::BlockFilter::NONE:
+                    std::memcpy(dst, src, size);
+                    break;
+                case biomxt::BlockFilter::SHUFFLE:
+                    biomxt::byte_unshuffle(src, dst, size, element_size);
+                    break;
+                case biomxt::BlockFilter::BITSHUFFLE:
+                    biomxt::bit_unshuffle(src, dst, size, element_size);
+                    break;
+                default:
+                    throw std::invalid_argument("biomxt::unfilter_block: Unsupported block filter [" + std::to_string(static_cast<int>(filter)) + "]");
+            }
+        }
+
+    biomxt::BlockEncoding encode_block(
+        const char* src,
+        size_t size,
+        size_t element_size,
+        biomxt::BlockFilter filter,
+        float sparse_threshold,
+        biomxt::IntegerCodec integer_codec,
+        std::vector<char>& payload)
+        {
+            const size_t count = size / element_size;
+            if (sparse_threshold > 0) {
+                // Sparse only pays off while bitmap and nonzeros are smaller than the block
+                const size_t nnz = biomxt::count_nonzeros(src, size, element_size);
+                const size_t bitmap = biomxt::bitmap_size(count);
+                if (nnz <= sparse_threshold * count && bitmap + nnz * element_size < size) {
+                    _bitmap_encode(src, size, element_size, filter, nnz, payload);
+                    return biomxt::BlockEncoding::BITMAP;
+                }
+            }
+            if (integer_codec != biomxt::IntegerCodec::NONE && biomxt::int_codec_supported(element_size)) {
+                // Smallest of all codecs, or the given one, as long as it beats raw integers
+                biomxt::BlockEncoding encoding;
+                if (integer_codec == biomxt::IntegerCodec::AUTO) {
+                    encoding = _integer_encode(src, size, element_size, biomxt::IntegerCodec::FOR, payload);
+                    for (biomxt::IntegerCodec codec : {biomxt::IntegerCodec::DELTA, biomxt::IntegerCodec::FIXED}) {
+                        biomxt::BlockEncoding candidate = _integer_encode(src, size, element_size, codec, _candidate_buffer);
+                        if (_candidate_buffer.size() < payload.size()) {
+                            payload.swap(_candidate_buffer);
+                            encoding = candidate;
+                        }
+                    }
+                } else {
+                    encoding = _integer_encode(src, size, element_size, integer_codec, payload);
+                }
+                if (payload.size() < size) return encoding;
+            }
+            payload.resize(size);
+            biomxt::filter_block(src, size, filter, element_size, payload.data());
+            return biomxt::BlockEncoding::DENSE;
+        }
+
+    size_t pack_block(
+        const char* src,
+        size_t size,
+        size_t element_size,
+        biomxt::CompressAlgorithm algo,
+        biomxt::BlockFilter filter,
+        float sparse_threshold,
+        biomxt::IntegerCodec integer_codec,
+        std::vector<char>& dst,
+        const biomxt::BlockDictionary* dictionary,
+        const biomxt::CodecPolicy& policy)
+        {
+            if (policy.adaptive) {
+                return _pack_adaptive(src, size, element_size, integer_codec, policy.min_decode_speed, dst, dictionary);
+            }
+
+            // Untagged block, as in files without block encoding
+            if (!biomxt::has_block_encoding(sparse_threshold, integer_codec)) {
+                if (filter == biomxt::BlockFilter::NONE) {
+                    return biomxt::compress_block(src, size, algo, dst, dictionary);
+                }
+                _payload_buffer.resize(size);
+                biomxt::filter_block(src, size, filter, element_size, _payload_buffer.data());
+                return biomxt::compress_block(_payload_buffer.data(), size, algo, dst, dictionary);
+            }
+
+            // Encoding byte, then count of nonzeros of a sparse block or payload size of an integer encoded one, ahead of the compressed payload
+            biomxt::BlockEncoding encoding = biomxt::encode_block(src, size, element_size, filter, sparse_threshold, integer_codec, _payload_buffer);
+            uint32_t extent = encoding == biomxt::BlockEncoding::BITMAP
+                ? (_payload_buffer.size() - biomxt::bitmap_size(size / element_size)) / element_size
+                : _payload_buffer.size();
+            return _write_block(static_cast<uint8_t>(encoding), encoding, extent, _payload_buffer.data(), _payload_buffer.size(), algo, 0, dst, dictionary);
+        }
+
+    void unpack_block(
+        const char* src,
+        size_t src_size,
+        size_t element_size,
+        biomxt::CompressAlgorithm algo,
+        biomxt::BlockFilter filter,
+        uint8_t flags,
+        char* dst,
+        size_t dst_size,
+        const biomxt::BlockDictionary* dictionary)
+        {
+            // Encoding or codec byte, then count of nonzeros of a sparse block or payload size of an integer encoded one
+            biomxt::BlockEncoding encoding;
+            uint32_t extent;
+            _read_block_tag(src, src_size, flags, algo, filter, dictionary, encoding, extent);
+
+            if (encoding == biomxt::BlockEncoding::DENSE) {
+                if (filter == biomxt::BlockFilter::NONE) {
+                    biomxt::decompress_block(src, src_size, algo, dst, dst_size, dictionary);
+                    return;
+                }
+                _payload_buffer.resize(dst_size);
+                biomxt::decompress_block(src, src_size, algo, _payload_buffer.data(), dst_size, dictionary);
+                biomxt::unfilter_block(_payload_buffer.data(), dst_size, filter, element_size, dst);
+                return;
+            }
+
+            // Integers decoded from the payload, in place when it is stored uncompressed
+            if (encoding != biomxt::BlockEncoding::BITMAP) {
+                const char* payload = src;
+                if (algo != biomxt::CompressAlgorithm::STORE || src_size != extent) {
+                    _payload_buffer.resize(extent);
+                    biomxt::decompress_block(src, src_size, algo, _payload_buffer.data(), extent, dictionary);
+                    payload = _payload_buffer.data();
+                }
+                switch (encoding) {
+                    case biomxt::BlockEncoding::FOR:
+                        biomxt::for_decode(payload, extent, dst_size, element_size, dst);
+                        break;
+                    case biomxt::BlockEncoding::DELTA:
+                        biomxt::delta_decode(payload, extent, dst_size, element_size, dst);
+                        break;
+                    default:
+                        biomxt::fixed_decode(payload, extent, dst_size, element_size, dst);
+                        break;
+                }
+                return;
+            }
+
+            // Bitmap then nonzeros, scattered into the zeroed block
+            const uint32_t nnz = extent;
+            const size_t count = dst_size / element_size;
+            if (nnz > count) {
+                throw std::runtime_error("biomxt::unpack_block: Sparse block has [" + std::to_string(nnz) + "] nonzeros, more than its [" + std::to_string(count) + "] elements");
+            }
+            const size_t bitmap = biomxt::bitmap_size(count);
+            const size_t values_size = static_cast<size_t>(nnz) * element_size;
+            _payload_buffer.resize(bitmap + values_size);
+            biomxt::decompress_block(src, src_size, algo, _payload_buffer.data(), _payload_buffer.size(), dictionary);
+            const char* values = _payload_buffer.data() + bitmap;
+            if (filter != biomxt::BlockFilter::NONE) {
+                _filter_buffer.resize(values_size);
+                biomxt::unfilter_block(values, values_size, filter, element_size, _filter_buffer.data());
+                values = _filter_buffer.data();
+            }
+            biomxt::bitmap_decode(_payload_buffer.data(), values, nnz, dst_size, element_size, dst);
+        }
+
+    size_t pack_framed_block(
+        const char* src,
+        size_t size,
+        size_t element_size,
+        size_t row_size,
+        uint32_t frame_height,
+        biomxt::CompressAlgorithm algo,
+        biomxt::BlockFilter filter,
+        float sparse_threshold,
+        biomxt::IntegerCodec integer_codec,
+        std::vector<char>& dst,
+        const biomxt::BlockDictionary* dictionary,
+        const biomxt::CodecPolicy& policy)
+        {
+            // Index of frame ends, filled in as frames are appended behind it
+            const size_t frame_size = static_cast<size_t>(frame_height) * row_size;
+            const size_t frames = biomxt::frame_count(size / row_size, frame_height);
+            const size_t index_size = frames * sizeof(uint32_t);
+            if (dst.size() < index_size) dst.resize(index_size);
+            size_t offset = index_size;
+            for (size_t frame = 0; frame < frames; frame++) {
+                const size_t begin = frame * frame_size;
+                const size_t packed_size = biomxt::pack_block(src + begin, std::min(frame_size, size - begin), element_size, algo, filter, sparse_threshold, integer_codec, _frame_buffer, dictionary, policy);
+                if (offset + packed_size - index_size > UINT32_MAX) {
+                    throw std::runtime_error("biomxt::pack_framed_block: Frames of block exceed 4 GiB");
+                }
+                if (dst.size() < offset + packed_size) dst.resize(offset + packed_size);
+                std::memcpy(dst.data() + offset, _frame_buffer.data(), packed_size);
+                offset += packed_size;
+                const uint32_t frame_end = static_cast<uint32_t>(offset - index_size);
+                std::memcpy(dst.data() + frame * sizeof(uint32_t), &frame_end, sizeof(frame_end));
+            }
+            return offset;
+        }
+
+    bool unpack_block_sparse(
+        const char* src,
+        size_t src_size,
+        size_t element_size,
+        biomxt::CompressAlgorithm algo,
+        biomxt::BlockFilter filter,
+        uint8_t flags,
+        char* dst,
+        size_t dst_size,
+        std::vector<char>& bitmap,
+        std::vector<char>& values,
+        const biomxt::BlockDictionary* dictionary)
+        {
+            const char* payload = src;
+            size_t payload_size = src_size;
+            biomxt::BlockEncoding encoding;
+            uint32_t nnz;
+            _read_block_tag(payload, payload_size, flags, algo, filter, dictionary, encoding, nnz);
+            if (encoding != biomxt::BlockEncoding::BITMAP) {
+                biomxt::unpack_block(src, src_size, element_size, algo, filter, flags, dst, dst_size, dictionary);
+                return false;
+            }
+
+            // Bitmap then nonzeros, the nonzeros are unfiltered but left packed
+            const size_t count = dst_size / element_size;
+            if (nnz > count) {
+                throw std::runtime_error("biomxt::unpack_block: Sparse block has [" + std::to_string(nnz) + "] nonzeros, more than its [" + std::to_string(count) + "] elements");
+            }
+            const size_t bitmap_size = biomxt::bitmap_size(count);
+            const size_t values_size = static_cast<size_t>(nnz) * element_size;
+            bitmap.resize(bitmap_size + values_size);
+            biomxt::decompress_block(payload, payload_size, algo, bitmap.data(), bitmap.size(), dictionary);
+            values.resize(values_size);
+            if (filter != biomxt::BlockFilter::NONE) {
+                biomxt::unfilter_block(bitmap.data() + bitmap_size, values_size, filter, element_size, values.data());
+            } else if (values_size > 0) {
+                std::memcpy(values.data(), bitmap.data() + bitmap_size, values_size);
+            }
+            bitmap.resize(bitmap_size);
+            return true;
+        }
+
+    size_t unpack_block_frame(
+        const char* src,
+        size_t src_size,
+        size_t element_size,
+        size_t row_size,
+        uint32_t frame_height,
+        size_t block_size,
+        size_t frame,
+        biomxt::CompressAlgorithm algo,
+        biomxt::BlockFilter filter,
+        uint8_t flags,
+        char* dst,
+        const biomxt::BlockDictionary* dictionary)
+        {
+            const size_t frame_size = static_cast<size_t>(frame_height) * row_size;
+            size_t begin, end;
+            _frame_bounds(src, src_size, biomxt::frame_count(block_size / row_size, frame_height), frame, begin, end);
+            const size_t raw_size = std::min(frame_size, block_size - frame * frame_size);
+            biomxt::unpack_block(src + begin, end - begin, element_size, algo, filter, flags, dst, raw_size, dictionary);
+            return raw_size;
+        }
+
+    bool unpack_block_frame_sparse(
+        const char* src,
+        size_t src_size,
+        size_t element_size,
+        size_t row_size,
+        uint32_t frame_height,
+        size_t block_size,
+        size_t frame,
+        biomxt::CompressAlgorithm algo,
+        biomxt::BlockFilter filter,
+        uint8_t flags,
+        char* dst,
+        std::vector<char>& bitmap,
+        std::vector<char>& values,
+        const biomxt::BlockDictionary* dictionary)
+        {
+            const size_t frame_size = static_cast<size_t>(frame_height) * row_size;
+            size_t begin, end;
+            _frame_bounds(src, src_size, biomxt::frame_count(block_size / row_size, frame_height), frame, begin, end);
+            const size_t raw_size = std::min(frame_size, block_size - frame * frame_size);
+            return biomxt::unpack_block_sparse(src + begin, end - begin, element_size, algo, filter, flags, dst, raw_size, bitmap, values, dictionary);
+        }
+
+    void unpack_framed_block(
+        const char* src,
+        size_t src_size,
+        size_t element_size,
+        size_t row_size,
+        uint32_t frame_height,
+        biomxt::CompressAlgorithm algo,
+        biomxt::BlockFilter filter,
+        uint8_t flags,
+        char* dst,
+        size_t dst_size,
+        const biomxt::BlockDictionary* dictionary)
+        {
+            const size_t frame_size = static_cast<size_t>(frame_height) * row_size;
+            const size_t frames = biomxt::frame_count(dst_size / row_size, frame_height);
+            for (size_t frame = 0; frame < frames; frame++) {
+                biomxt::unpack_block_frame(src, src_size, element_size, row_size, frame_height, dst_size, frame, algo, filter, flags, dst + frame * frame_size, dictionary);
+            }
+        }
+
+} // namespace biomxt
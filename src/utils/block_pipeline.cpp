@@ -0,0 +1,410 @@
+#include "biomxt/utils/block_pipeline.hpp"
+#include <cstring>
+
+
+namespace biomxt {
+
+    template <typename T> void assemble_block(
+        const T* rows_buffer,
+        uint32_t row_size,
+        uint32_t column_begin,
+        uint32_t actual_block_width,
+        uint32_t actual_block_height,
+        std::vector<T>& block)
+        {
+            if (block.size() != static_cast<size_t>(actual_block_width)*actual_block_height) {
+                block.resize(static_cast<size_t>(actual_block_width)*actual_block_height);
+            }
+
+            // Block spans whole rows, one copy for all
+            const T* src = rows_buffer + column_begin;
+            T* dst = block.data();
+            if (actual_block_width == row_size) {
+                std::memcpy(dst, src, block.size()*sizeof(T));
+                return;
+            }
+            for (uint32_t i = 0; i < actual_block_height; i++) {
+                std::memcpy(dst, src, actual_block_width*sizeof(T));
+                src += row_size;
+                dst += actual_block_width;
+            }
+        }
+
+    template <typename T> void assemble_block_strided(
+        const T* origin,
+        size_t row_stride,
+        size_t column_stride,
+        uint32_t column_begin,
+        uint32_t actual_block_width,
+        uint32_t actual_block_height,
+        std::vector<T>& block)
+        {
+            if (block.size() != static_cast<size_t>(actual_block_width)*actual_block_height) {
+                block.resize(static_cast<size_t>(actual_block_width)*actual_block_height);
+            }
+
+            // Row-major view, a span per row
+            if (column_stride == 1) {
+                const T* src = origin + column_begin;
+                for (uint32_t i = 0; i < actual_block_height; i++) {
+                    std::memcpy(block.data() + static_cast<size_t>(actual_block_width)*i, src + row_stride*i, actual_block_width*sizeof(T));
+                }
+                return;
+            }
+
+            // Tiles of 64 bytes wide on the source side, so each source cache line is read once per tile
+            constexpr uint32_t tile = std::max<uint32_t>(8, 64 / sizeof(T));
+            const T* src = origin + column_stride*column_begin;
+            T* dst = block.data();
+            for (uint32_t i0 = 0; i0 < actual_block_height; i0 += tile) {
+                uint32_t i1 = std::min(actual_block_height, i0 + tile);
+                for (uint32_t j0 = 0; j0 < actual_block_width; j0 += tile) {
+                    uint32_t j1 = std::min(actual_block_width, j0 + tile);
+                    for (uint32_t j = j0; j < j1; j++) {
+                        const T* column = src + column_stride*j;
+                        for (uint32_t i = i0; i < i1; i++) {
+                            dst[static_cast<size_t>(actual_block_width)*i + j] = column[row_stride*i];
+                        }
+                    }
+                }
+            }
+        }
+
+    template <typename T> BlockPipeline<T>::BlockPipeline(
+        std::ofstream& out,
+        uint32_t block_width,
+        biomxt::CompressAlgorithm algo,
+        uint32_t threads,
+        uint32_t max_inflight_rows,
+        biomxt::BlockFilter filter,
+        uint32_t dictionary_size,
+        float sparse_threshold,
+        biomxt::IntegerCodec integer_codec,
+        biomxt::CodecPolicy policy,
+        uint16_t frame_height,
+        bool column_major)
+        : _out(out), _block_width(block_width), _algo(algo), _filter(filter), _sparse_threshold(sparse_threshold), _integer_codec(integer_codec), _policy(policy), _frame_height(frame_height), _column_major(column_major), _dictionary_size(algo == biomxt::CompressAlgorithm::ZSTD ? dictionary_size : 0)
+        {
+            if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+            _max_inflight_rows = max_inflight_rows == 0 ? threads * 2 : max_inflight_rows;
+
+            for (uint32_t i = 0; i < threads; ++i) {
+                _workers.emplace_back(&BlockPipeline<T>::_work, this);
+            }
+            _writer = std::thread(&BlockPipeline<T>::_write, this);
+        }
+
+    template <typename T> BlockPipeline<T>::~BlockPipeline() {
+        _stop();
+    }
+
+    template <typename T> void BlockPipeline<T>::push(std::vector<T>&& rows_buffer, uint32_t row_size, uint32_t actual_block_height) {
+        // Check buffer validity
+        if (actual_block_height == 0) {
+            throw std::invalid_argument("biomxt::BlockPipeline::push: Buffer is empty.");
+        }
+        if (rows_buffer.size() < static_cast<size_t>(row_size)*actual_block_height) {
+            throw std::invalid_argument("biomxt::BlockPipeline::push: Buffer is smaller than its rows.");
+        }
+
+        auto strip = std::make_unique<Strip>();
+        strip->row_size = row_size;
+        strip->height = actual_block_height;
+        strip->rows = std::move(rows_buffer);
+        strip->origin = strip->rows.data();
+        strip->row_stride = row_size;
+        strip->column_stride = 1;
+        _enqueue(std::move(strip));
+    }
+
+    template <typename T> void BlockPipeline<T>::push_view(const T* origin, uint32_t row_size, uint32_t actual_block_height, size_t row_stride, size_t column_stride) {
+        // Check view validity
+        if (actual_block_height == 0) {
+            throw std::invalid_argument("biomxt::BlockPipeline::push_view: View is empty.");
+        }
+
+        auto strip = std::make_unique<Strip>();
+        strip->row_size = row_size;
+        strip->height = actual_block_height;
+        strip->origin = origin;
+        strip->row_stride = row_stride;
+        strip->column_stride = column_stride;
+        _enqueue(std::move(strip));
+    }
+
+    template <typename T> void BlockPipeline<T>::push_generated(std::function<void(uint32_t, std::vector<T>&)> generate, uint32_t row_size, uint32_t actual_block_height) {
+        // Check strip validity
+        if (actual_block_height == 0) {
+            throw std::invalid_argument("biomxt::BlockPipeline::push_generated: Strip is empty.");
+        }
+
+        auto strip = std::make_unique<Strip>();
+        strip->row_size = row_size;
+        strip->height = actual_block_height;
+        strip->generate = std::move(generate);
+        _enqueue(std::move(strip));
+    }
+
+    template <typename T> void BlockPipeline<T>::_enqueue(std::unique_ptr<Strip> strip) {
+        strip->block_count = (strip->row_size + _block_width - 1) / _block_width;
+        strip->compressed.resize(strip->block_count);
+        strip->raw_sizes.resize(strip->block_count);
+
+        // Nothing is written yet, so the dictionary goes ahead of the first block
+        if (_dictionary_size > 0) _train(*strip);
+
+        std::unique_lock lock(_mutex);
+        // Wait for a free slot, so that memory stays bounded
+        _slot_free.wait(lock, [this] { return _strips.size() < _max_inflight_rows || _error || _stopped; });
+        if (_error) std::rethrow_exception(_error);
+        if (_stopped || _closing) {
+            throw std::runtime_error("biomxt::BlockPipeline::push: Pipeline is finished.");
+        }
+
+        // A strip without columns has nothing to compress, but still keeps its place
+        for (uint32_t x = 0; x < strip->block_count; ++x) {
+            _tasks.push_back({strip.get(), x});
+        }
+        _strips.push_back(std::move(strip));
+        _pending++;
+        _task_ready.notify_all();
+        _strip_done.notify_one();
+    }
+
+    template <typename T> void BlockPipeline<T>::_assemble(const Strip& strip, uint32_t block_x, std::vector<T>& block) const {
+        uint32_t column_begin = block_x * _block_width;
+        uint32_t actual_block_width = std::min(_block_width, strip.row_size - column_begin);
+        if (strip.generate) {
+            strip.generate(block_x, block);
+            if (block.size() != static_cast<size_t>(actual_block_width) * strip.height) {
+                throw std::runtime_error("biomxt::BlockPipeline: Generated block size does not match the block.");
+            }
+            return;
+        }
+        if (!_column_major) {
+            biomxt::assemble_block_strided(strip.origin, strip.row_stride, strip.column_stride, column_begin, actual_block_width, strip.height, block);
+            return;
+        }
+        // Column-major block is the row-major block of the transposed view
+        biomxt::assemble_block_strided(strip.origin + strip.column_stride * column_begin, strip.column_stride, strip.row_stride, 0, strip.height, actual_block_width, block);
+    }
+
+    template <typename T> void BlockPipeline<T>::_train(const Strip& strip) {
+        const uint32_t dictionary_size = _dictionary_size;
+        _dictionary_size = 0;
+        if (strip.block_count == 0) return;
+
+        // Whole blocks as samples, evenly spread over the strip when all of them exceed about 100 times the dictionary
+        const uint64_t budget = static_cast<uint64_t>(dictionary_size) * 100;
+        const uint64_t strip_size = static_cast<uint64_t>(strip.row_size) * strip.height * sizeof(T);
+        const uint32_t step = std::max<uint64_t>(1, strip_size / std::max<uint64_t>(1, budget));
+        std::vector<char> samples;
+        std::vector<size_t> sample_sizes;
+        std::vector<T> block;
+        std::vector<char> payload;
+        for (uint32_t x = 0; x < strip.block_count; x += step) {
+            _assemble(strip, x, block);
+
+            // Dictionary must match what is compressed, i.e. encoded and filtered blocks
+            biomxt::encode_block(reinterpret_cast<const char*>(block.data()), block.size() * sizeof(T), sizeof(T), _filter, _sparse_threshold, _integer_codec, payload);
+            samples.insert(samples.end(), payload.begin(), payload.end());
+            sample_sizes.push_back(payload.size());
+        }
+
+        std::vector<char> dictionary = biomxt::train_dictionary(samples, sample_sizes, dictionary_size);
+        if (dictionary.empty()) return;
+        uint32_t size = dictionary.size();
+        _out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+        _out.write(dictionary.data(), size);
+        if (!_out) {
+            throw std::runtime_error("biomxt::BlockPipeline: Failed to write dictionary to output file.");
+        }
+        _dictionary = std::make_unique<biomxt::BlockDictionary>(std::move(dictionary), true);
+    }
+
+    template <typename T> void BlockPipeline<T>::use_dictionary(std::vector<char> dictionary) {
+        std::lock_guard lock(_mutex);
+        if (_pending > 0 || !_block_table.empty()) {
+            throw std::runtime_error("biomxt::BlockPipeline::use_dictionary: Strips were pushed already.");
+        }
+        _dictionary_size = 0;
+        _dictionary = std::make_unique<biomxt::BlockDictionary>(std::move(dictionary), true);
+    }
+
+    template <typename T> const biomxt::BlockDictionary* BlockPipeline<T>::dictionary() const {
+        return _dictionary.get();
+    }
+
+    template <typename T> bool BlockPipeline<T>::recycle(std::vector<T>& rows_buffer) {
+        std::lock_guard lock(_mutex);
+        if (_free_rows.empty()) return false;
+        rows_buffer = std::move(_free_rows.back());
+        _free_rows.pop_back();
+        return true;
+    }
+
+    template <typename T> const std::vector<biomxt::IndexEntry>& BlockPipeline<T>::drain() {
+        std::unique_lock lock(_mutex);
+        _slot_free.wait(lock, [this] { return _pending == 0 || _error || _stopped; });
+        if (_error) std::rethrow_exception(_error);
+        if (_stopped) {
+            throw std::runtime_error("biomxt::BlockPipeline::drain: Pipeline is finished.");
+        }
+        return _block_table;
+    }
+
+    template <typename T> const std::vector<biomxt::IndexEntry>& BlockPipeline<T>::finish() {
+        {
+            std::unique_lock lock(_mutex);
+            _closing = true;
+            _task_ready.notify_all();
+            _strip_done.notify_all();
+        }
+        _stop();
+        if (_error) std::rethrow_exception(_error);
+        return _block_table;
+    }
+
+    template <typename T> const std::vector<biomxt::IndexEntry>& BlockPipeline<T>::block_table() const {
+        return _block_table;
+    }
+
+    template <typename T> void BlockPipeline<T>::_work() {
+        std::vector<T> block;
+        std::vector<char> compress_buffer;
+        while (true) {
+            Task task;
+            {
+                std::unique_lock lock(_mutex);
+                _task_ready.wait(lock, [this] { return !_tasks.empty() || _closing || _stopped || _error; });
+                if (_tasks.empty() || _stopped || _error) return;
+                task = _tasks.front();
+                _tasks.pop_front();
+            }
+
+            try {
+                // Assemble and compress outside the lock
+                Strip& strip = *task.strip;
+                uint32_t actual_block_width = std::min(_block_width, strip.row_size - task.block_x * _block_width);
+                _assemble(strip, task.block_x, block);
+
+                // Frames hold rows, or columns of column-major blocks
+                uint32_t raw_size = block.size() * sizeof(T);
+                size_t line_size = (_column_major ? strip.height : actual_block_width) * sizeof(T);
+                size_t size = _frame_height > 0
+                    ? biomxt::pack_framed_block(reinterpret_cast<const char*>(block.data()), raw_size, sizeof(T), line_size, _frame_height, _algo, _filter, _sparse_threshold, _integer_codec, compress_buffer, _dictionary.get(), _policy)
+                    : biomxt::pack_block(reinterpret_cast<const char*>(block.data()), raw_size, sizeof(T), _algo, _filter, _sparse_threshold, _integer_codec, compress_buffer, _dictionary.get(), _policy);
+                std::vector<char> compressed(compress_buffer.begin(), compress_buffer.begin() + size);
+
+                std::lock_guard lock(_mutex);
+                strip.compressed[task.block_x] = std::move(compressed);
+                strip.raw_sizes[task.block_x] = raw_size;
+                if (++strip.done == strip.block_count) _strip_done.notify_one();
+            } catch (...) {
+                _fail(std::current_exception());
+                return;
+            }
+        }
+    }
+
+    template <typename T> void BlockPipeline<T>::_write() {
+        while (true) {
+            std::unique_ptr<Strip> strip;
+            {
+                std::unique_lock lock(_mutex);
+                // Wait for the oldest strip to be fully compressed
+                _strip_done.wait(lock, [this] {
+                    return _stopped || _error || (!_strips.empty() && _strips.front()->done == _strips.front()->block_count) || (_strips.empty() && _closing);
+                });
+                if (_stopped || _error || _strips.empty()) return;
+                strip = std::move(_strips.front());
+                _strips.pop_front();
+            }
+
+            try {
+                // Write blocks in order, outside the lock
+                for (uint32_t x = 0; x < strip->block_count; ++x) {
+                    biomxt::IndexEntry entry;
+                    entry.offset = _out.tellp();
+                    entry.size = strip->compressed[x].size();
+                    entry.raw_size = strip->raw_sizes[x];
+                    _out.write(strip->compressed[x].data(), entry.size);
+                    _block_table.push_back(entry);
+                }
+                if (!_out) {
+                    throw std::runtime_error("biomxt::BlockPipeline: Failed to write blocks to output file.");
+                }
+            } catch (...) {
+                _fail(std::current_exception());
+                return;
+            }
+
+            // Release the slot, and keep rows for reuse
+            std::lock_guard lock(_mutex);
+            if (!strip->rows.empty() && _free_rows.size() < _max_inflight_rows) _free_rows.push_back(std::move(strip->rows));
+            _pending--;
+            _slot_free.notify_all();
+        }
+    }
+
+    template <typename T> void BlockPipeline<T>::_fail(std::exception_ptr error) {
+        std::lock_guard lock(_mutex);
+        if (!_error) _error = error;
+        _task_ready.notify_all();
+        _strip_done.notify_all();
+        _slot_free.notify_all();
+    }
+
+    template <typename T> void BlockPipeline<T>::_stop() {
+        // Workers drain tasks when closing, or quit at once when stopped
+        {
+            std::lock_guard lock(_mutex);
+            if (!_closing) _stopped = true;
+            _task_ready.notify_all();
+            _strip_done.notify_all();
+            _slot_free.notify_all();
+        }
+        for (std::thread& worker : _workers) {
+            if (worker.joinable()) worker.join();
+        }
+        {
+            // Writer may wait for the last strip done by a worker
+            std::lock_guard lock(_mutex);
+            _strip_done.notify_all();
+        }
+        if (_writer.joinable()) _writer.join();
+        std::lock_guard lock(_mutex);
+        _stopped = true;
+        _slot_free.notify_all();
+    }
+
+    template void assemble_block<int16_t>(const int16_t*, uint32_t, uint32_t, uint32_t, uint32_t, std::vector<int16_t>&);
+    template void assemble_block<int32_t>(const int32_t*, uint32_t, uint32_t, uint32_t, uint32_t, std::vector<int32_t>&);
+    template void assemble_block<int64_t>(const int64_t*, uint32_t, uint32_t, uint32_t, uint32_t, std::vector<int64_t>&);
+    template void assemble_block<float>(const float*, uint32_t, uint32_t, uint32_t, uint32_t, std::vector<float>&);
+    template void assemble_block<double>(const double*, uint32_t, uint32_t, uint32_t, uint32_t, std::vector<double>&);
+    template void assemble_block<uint8_t>(const uint8_t*, uint32_t, uint32_t, uint32_t, uint32_t, std::vector<uint8_t>&);
+    template void assemble_block<uint16_t>(const uint16_t*, uint32_t, uint32_t, uint32_t, uint32_t, std::vector<uint16_t>&);
+    template void assemble_block<float16>(const float16*, uint32_t, uint32_t, uint32_t, uint32_t, std::vector<float16>&);
+    template void assemble_block<bfloat16>(const bfloat16*, uint32_t, uint32_t, uint32_t, uint32_t, std::vector<bfloat16>&);
+
+    template void assemble_block_strided<int16_t>(const int16_t*, size_t, size_t, uint32_t, uint32_t, uint32_t, std::vector<int16_t>&);
+    template void assemble_block_strided<int32_t>(const int32_t*, size_t, size_t, uint32_t, uint32_t, uint32_t, std::vector<int32_t>&);
+    template void assemble_block_strided<int64_t>(const int64_t*, size_t, size_t, uint32_t, uint32_t, uint32_t, std::vector<int64_t>&);
+    template void assemble_block_strided<float>(const float*, size_t, size_t, uint32_t, uint32_t, uint32_t, std::vector<float>&);
+    template void assemble_block_strided<double>(const double*, size_t, size_t, uint32_t, uint32_t, uint32_t, std::vector<double>&);
+    template void assemble_block_strided<uint8_t>(const uint8_t*, size_t, size_t, uint32_t, uint32_t, uint32_t, std::vector<uint8_t>&);
+    template void assemble_block_strided<uint16_t>(const uint16_t*, size_t, size_t, uint32_t, uint32_t, uint32_t, std::vector<uint16_t>&);
+    template void assemble_block_strided<float16>(const float16*, size_t, size_t, uint32_t, uint32_t, uint32_t, std::vector<float16>&);
+    template void assemble_block_strided<bfloat16>(const bfloat16*, size_t, size_t, uint32_t, uint32_t, uint32_t, std::vector<bfloat16>&);
+
+    template class BlockPipeline<int16_t>;
+    template class BlockPipeline<int32_t>;
+    template class BlockPipeline<int64_t>;
+    template class BlockPipeline<float>;
+    template class BlockPipeline<double>;
+    template class BlockPipeline<uint8_t>;
+    template class BlockPipeline<uint16_t>;
+    template class BlockPipeline<float16>;
+    template class BlockPipeline<bfloat16>;
+}
@@ -0,0 +1,262 @@
+#include "biomxt/utils/checkpoint.hpp"
+#include <fstream>
+#include <cstring>
+#include <filesystem>
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+namespace biomxt {
+
+    namespace {
+
+#pragma pack(push, 1)
+        /**
+         * @brief Checkpoint file header, followed by column names, then records.
+         */
+        struct CheckpointHeader {
+            char magic[4] = {'B', 'M', 'X', 'k'};
+            uint16_t version = 1;
+            biomxt::DataType dtype = biomxt::DataType::FLOAT32;
+            biomxt::CompressAlgorithm algo = biomxt::CompressAlgorithm::ZSTD;
+            char separator = ',';
+            biomxt::BlockFilter filter = biomxt::BlockFilter::NONE;
+            biomxt::IntegerCodec integer_codec = biomxt::IntegerCodec::NONE;
+            uint8_t column_major = 0;
+            uint32_t block_width = 0;
+            uint32_t block_height = 0;
+            uint64_t input_size = 0;
+            uint64_t ncol = 0;
+            float sparse_threshold = 0;
+            uint32_t min_decode_speed = 0;
+            uint8_t adaptive = 0;
+            uint8_t padding[1] = {0};
+            uint16_t frame_height = 0;
+            biomxt::UUID uuid;
+        };
+
+        /**
+         * @brief Record of one checkpoint, followed by its payload: names of rows and entries of blocks added since the previous record.
+         */
+        struct CheckpointRecord {
+            char magic[4] = {'B', 'M', 'X', 'r'};
+            uint32_t dictionary_size = 0;
+            uint64_t input_offset = 0;
+            uint64_t input_line = 0;
+            uint64_t output_offset = 0;
+            uint64_t row_offset = 0;
+            uint64_t row_count = 0;
+            uint64_t block_offset = 0;
+            uint64_t block_count = 0;
+            uint64_t payload_size = 0;
+            uint64_t checksum = 0;                  ///< FNV-1a of the payload.
+        };
+#pragma pack(pop)
+
+        uint64_t _checksum(const char* data, size_t size) {
+            uint64_t hash = 0xcbf29ce484222325ULL;
+            for (size_t i = 0; i < size; i++) {
+                hash ^= static_cast<uint8_t>(data[i]);
+                hash *= 0x100000001b3ULL;
+            }
+            return hash;
+        }
+
+        void _write_names(std::string& out, const std::vector<std::string>& names) {
+            for (const std::string& name : names) {
+                uint32_t size = name.size();
+                out.append(reinterpret_cast<const char*>(&size), sizeof(size));
+                out.append(name);
+            }
+        }
+
+        bool _read_names(const char*& pos, const char* end, uint64_t count, std::vector<std::string>& names) {
+            for (uint64_t i = 0; i < count; i++) {
+                uint32_t size = 0;
+                if (static_cast<size_t>(end - pos) < sizeof(size)) return false;
+                std::memcpy(&size, pos, sizeof(size));
+                pos += sizeof(size);
+                if (static_cast<size_t>(end - pos) < size) return false;
+                names.emplace_back(pos, size);
+                pos += size;
+            }
+            return true;
+        }
+
+    } // namespace
+
+    std::string checkpoint_path(const std::string& output_file) {
+        return output_file + ".ckpt";
+    }
+
+    void save_checkpoint(const std::string& path, const biomxt::ConvertCheckpoint& checkpoint) {
+        CheckpointRecord record;
+        record.dictionary_size = checkpoint.dictionary_size;
+        record.input_offset = checkpoint.input_offset;
+        record.input_line = checkpoint.input_line;
+        record.output_offset = checkpoint.output_offset;
+        record.row_offset = checkpoint.row_offset;
+        record.row_count = checkpoint.rownames.size();
+        record.block_offset = checkpoint.block_offset;
+        record.block_count = checkpoint.block_table.size();
+        std::string payload;
+        _write_names(payload, checkpoint.rownames);
+        payload.append(reinterpret_cast<const char*>(checkpoint.block_table.data()), checkpoint.block_table.size() * sizeof(biomxt::IndexEntry));
+        record.payload_size = payload.size();
+        record.checksum = _checksum(payload.data(), payload.size());
+
+        // Later checkpoints append their record only
+        if (checkpoint.row_offset > 0 || checkpoint.block_offset > 0) {
+            std::ofstream out(path, std::ios::binary | std::ios::app);
+            if (!out.is_open()) {
+                throw std::runtime_error("biomxt::save_checkpoint: Cannot open checkpoint file: " + path);
+            }
+            out.write(reinterpret_cast<const char*>(&record), sizeof(CheckpointRecord));
+            out.write(payload.data(), payload.size());
+            out.close();
+            if (!out) {
+                throw std::runtime_error("biomxt::save_checkpoint: Failed to write checkpoint file: " + path);
+            }
+            biomxt::sync_file(path);
+            return;
+        }
+
+        // First checkpoint writes the header and column names ahead of its record
+        CheckpointHeader header;
+        header.dtype = checkpoint.dtype;
+        header.algo = checkpoint.algo;
+        header.filter = checkpoint.filter;
+        header.integer_codec = checkpoint.integer_codec;
+        header.separator = checkpoint.separator;
+        header.column_major = checkpoint.column_major;
+        header.block_width = checkpoint.block_width;
+        header.block_height = checkpoint.block_height;
+        header.input_size = checkpoint.input_size;
+        header.ncol = checkpoint.colnames.size();
+        header.sparse_threshold = checkpoint.sparse_threshold;
+        header.min_decode_speed = checkpoint.policy.min_decode_speed;
+        header.adaptive = checkpoint.policy.adaptive;
+        header.frame_height = checkpoint.frame_height;
+        header.uuid = checkpoint.uuid;
+        std::string colnames;
+        _write_names(colnames, checkpoint.colnames);
+
+        std::string tmp_path = path + ".tmp";
+        std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            throw std::runtime_error("biomxt::save_checkpoint: Cannot open checkpoint file: " + tmp_path);
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(CheckpointHeader));
+        out.write(colnames.data(), colnames.size());
+        out.write(reinterpret_cast<const char*>(&record), sizeof(CheckpointRecord));
+        out.write(payload.data(), payload.size());
+        out.close();
+        if (!out) {
+            throw std::runtime_error("biomxt::save_checkpoint: Failed to write checkpoint file: " + tmp_path);
+        }
+        biomxt::sync_file(tmp_path);
+        std::filesystem::rename(tmp_path, path);
+    }
+
+    biomxt::ConvertCheckpoint load_checkpoint(const std::string& path) {
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        if (!in.is_open()) {
+            throw std::runtime_error("biomxt::load_checkpoint: Cannot open checkpoint file: " + path);
+        }
+        const uint64_t file_size = static_cast<uint64_t>(in.tellg());
+        in.seekg(0);
+
+        CheckpointHeader header;
+        if (!in.read(reinterpret_cast<char*>(&header), sizeof(CheckpointHeader)) || std::memcmp(header.magic, "BMXk", 4) != 0) {
+            throw std::runtime_error("biomxt::load_checkpoint: Corrupted checkpoint file: bad magic");
+        }
+        if (header.version != 1) {
+            throw std::runtime_error("biomxt::load_checkpoint: Unsupported checkpoint version [" + std::to_string(header.version) + "]");
+        }
+
+        biomxt::ConvertCheckpoint checkpoint;
+        checkpoint.uuid = header.uuid;
+        checkpoint.dtype = header.dtype;
+        checkpoint.algo = header.algo;
+        checkpoint.filter = header.filter;
+        checkpoint.integer_codec = header.integer_codec;
+        checkpoint.separator = header.separator;
+        checkpoint.block_width = header.block_width;
+        checkpoint.block_height = header.block_height;
+        checkpoint.input_size = header.input_size;
+        checkpoint.sparse_threshold = header.sparse_threshold;
+        checkpoint.policy.adaptive = header.adaptive != 0;
+        checkpoint.policy.min_decode_speed = header.min_decode_speed;
+        checkpoint.column_major = header.column_major != 0;
+        checkpoint.frame_height = header.frame_height;
+
+        // Column names, written at once with the first record
+        std::string payload;
+        for (uint64_t i = 0; i < header.ncol; i++) {
+            uint32_t size = 0;
+            if (!in.read(reinterpret_cast<char*>(&size), sizeof(size)) || size > file_size) {
+                throw std::runtime_error("biomxt::load_checkpoint: Corrupted checkpoint file: truncated");
+            }
+            std::string& name = checkpoint.colnames.emplace_back(size, '\0');
+            if (!in.read(name.data(), size)) {
+                throw std::runtime_error("biomxt::load_checkpoint: Corrupted checkpoint file: truncated");
+            }
+        }
+
+        // Replay records up to the first torn one, each only adds rows and blocks
+        uint64_t record_end = 0;
+        CheckpointRecord record;
+        while (in.read(reinterpret_cast<char*>(&record), sizeof(CheckpointRecord))) {
+            const uint64_t payload_begin = static_cast<uint64_t>(in.tellg());
+            if (std::memcmp(record.magic, "BMXr", 4) != 0 || record.payload_size > file_size - payload_begin) break;
+            payload.resize(record.payload_size);
+            if (!in.read(payload.data(), payload.size()) || _checksum(payload.data(), payload.size()) != record.checksum) break;
+            if (record.row_offset != checkpoint.rownames.size() || record.block_offset != checkpoint.block_table.size()) {
+                throw std::runtime_error("biomxt::load_checkpoint: Corrupted checkpoint file: record out of order");
+            }
+
+            const char* pos = payload.data();
+            const char* end = payload.data() + payload.size();
+            if (!_read_names(pos, end, record.row_count, checkpoint.rownames) || static_cast<uint64_t>(end - pos) != record.block_count * sizeof(biomxt::IndexEntry)) {
+                throw std::runtime_error("biomxt::load_checkpoint: Corrupted checkpoint file: bad record");
+            }
+            const size_t block_begin = checkpoint.block_table.size();
+            checkpoint.block_table.resize(block_begin + record.block_count);
+            std::memcpy(checkpoint.block_table.data() + block_begin, pos, end - pos);
+
+            checkpoint.dictionary_size = record.dictionary_size;
+            checkpoint.input_offset = record.input_offset;
+            checkpoint.input_line = record.input_line;
+            checkpoint.output_offset = record.output_offset;
+            record_end = payload_begin + record.payload_size;
+        }
+        in.close();
+        if (record_end == 0) {
+            throw std::runtime_error("biomxt::load_checkpoint: Corrupted checkpoint file: no complete record");
+        }
+
+        // Drop the torn record, so that the next one is appended after the last complete one
+        if (record_end < file_size) std::filesystem::resize_file(path, record_end);
+        return checkpoint;
+    }
+
+    void sync_file(const std::string& path) {
+#if !defined(_WIN32)
+        // fsync flushes the file itself, whichever descriptor it is called on
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("biomxt::sync_file: Failed to open file: " + path);
+        }
+        int ret = ::fsync(fd);
+        ::close(fd);
+        if (ret != 0) {
+            throw std::runtime_error("biomxt::sync_file: Failed to sync file: " + path);
+        }
+#else
+        (void)path;
+#endif
+    }
+
+} // namespace biomxt
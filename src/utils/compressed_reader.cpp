@@ -0,0 +1,288 @@
+#include "biomxt/utils/compressed_reader.hpp"
+#include <cstdio>
+#include <cstring>
+#include <cctype>
+#include <algorithm>
+#include "zlib.h"
+#include "zstd.h"
+
+
+namespace biomxt {
+
+    namespace {
+
+        // Size of compressed input read at once
+        constexpr size_t INPUT_CHUNK_SIZE = 1 << 20;
+
+        bool _ends_with(const std::string& str, const char* suffix) {
+            size_t n = std::strlen(suffix);
+            if (str.size() < n) return false;
+            for (size_t i = 0; i < n; i++) {
+                if (std::tolower(static_cast<unsigned char>(str[str.size() - n + i])) != suffix[i]) return false;
+            }
+            return true;
+        }
+
+        biomxt::TextCompression _compression_from_extension(const std::string& path, size_t* ext_size = nullptr) {
+            static const std::pair<const char*, biomxt::TextCompression> extensions[] = {
+                {".gz", biomxt::TextCompression::GZIP},
+                {".gzip", biomxt::TextCompression::GZIP},
+                {".zst", biomxt::TextCompression::ZSTD},
+                {".zstd", biomxt::TextCompression::ZSTD}
+            };
+            for (const auto& [ext, compression] : extensions) {
+                if (_ends_with(path, ext)) {
+                    if (ext_size) *ext_size = std::strlen(ext);
+                    return compression;
+                }
+            }
+            return biomxt::TextCompression::NONE;
+        }
+
+    } // namespace
+
+    std::string text_compression_to_string(biomxt::TextCompression compression) {
+        switch (compression) {
+            case biomxt::TextCompression::NONE: return "none";
+            case biomxt::TextCompression::GZIP: return "gzip";
+            case biomxt::TextCompression::ZSTD: return "zstd";
+            default: return "unknown";
+        }
+    }
+
+    biomxt::TextCompression detect_text_compression(const std::string& path) {
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        if (!file) {
+            throw std::runtime_error("biomxt::detect_text_compression: Failed to open file: " + path);
+        }
+        unsigned char magic[4] = {0, 0, 0, 0};
+        size_t n = std::fread(magic, 1, sizeof(magic), file);
+        std::fclose(file);
+
+        // Magic number wins over extension
+        if (n >= 2 && magic[0] == 0x1f && magic[1] == 0x8b) return biomxt::TextCompression::GZIP;
+        if (n >= 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd) return biomxt::TextCompression::ZSTD;
+
+        biomxt::TextCompression by_extension = _compression_from_extension(path);
+        if (by_extension != biomxt::TextCompression::NONE && n > 0) {
+            throw std::runtime_error("biomxt::detect_text_compression: File [" + path + "] has " + text_compression_to_string(by_extension) + " extension but no " + text_compression_to_string(by_extension) + " magic number.");
+        }
+        return biomxt::TextCompression::NONE;
+    }
+
+    std::string strip_compression_extension(const std::string& path) {
+        size_t ext_size = 0;
+        if (_compression_from_extension(path, &ext_size) == biomxt::TextCompression::NONE) return path;
+        return path.substr(0, path.size() - ext_size);
+    }
+
+    CompressedReader::CompressedReader(
+        const std::string& path,
+        biomxt::TextCompression compression,
+        size_t buffer_size,
+        size_t max_buffers)
+        : _path(path), _compression(compression), _buffer_size(buffer_size), _max_buffers(max_buffers)
+        {
+            if (compression == biomxt::TextCompression::NONE) {
+                throw std::invalid_argument("biomxt::CompressedReader: File is not compressed: " + path);
+            }
+            if (buffer_size == 0 || max_buffers == 0) {
+                throw std::invalid_argument("biomxt::CompressedReader: Buffer size and max buffers must be greater than 0.");
+            }
+            // Fail early on a missing file, rather than on the first next()
+            std::FILE* file = std::fopen(path.c_str(), "rb");
+            if (!file) {
+                throw std::runtime_error("biomxt::CompressedReader: Failed to open file: " + path);
+            }
+            std::fclose(file);
+
+            _thread = std::thread(&CompressedReader::_run, this);
+        }
+
+    CompressedReader::~CompressedReader() {
+        {
+            std::lock_guard lock(_mutex);
+            _stopped = true;
+            _slot_free.notify_all();
+        }
+        if (_thread.joinable()) _thread.join();
+    }
+
+    bool CompressedReader::next(std::string& buffer) {
+        std::unique_lock lock(_mutex);
+        if (buffer.capacity() > 0 && _free.size() < _max_buffers) {
+            buffer.clear();
+            _free.push_back(std::move(buffer));
+        }
+        buffer.clear();
+        _buffer_ready.wait(lock, [this] { return !_ready.empty() || _done || _error; });
+        if (_error) std::rethrow_exception(_error);
+        if (_ready.empty()) return false;
+        buffer = std::move(_ready.front());
+        _ready.pop_front();
+        _slot_free.notify_one();
+        return true;
+    }
+
+    void CompressedReader::_run() {
+        std::FILE* file = std::fopen(_path.c_str(), "rb");
+        try {
+            if (!file) {
+                throw std::runtime_error("biomxt::CompressedReader: Failed to open file: " + _path);
+            }
+            if (_compression == biomxt::TextCompression::GZIP) {
+                _inflate_gzip(file);
+            } else {
+                _decompress_zstd(file);
+            }
+            std::fclose(file);
+            std::lock_guard lock(_mutex);
+            _done = true;
+            _buffer_ready.notify_all();
+        } catch (...) {
+            if (file) std::fclose(file);
+            std::lock_guard lock(_mutex);
+            _error = std::current_exception();
+            _buffer_ready.notify_all();
+        }
+    }
+
+    bool CompressedReader::_publish(std::string& buffer) {
+        std::unique_lock lock(_mutex);
+        _slot_free.wait(lock, [this] { return _ready.size() < _max_buffers || _stopped; });
+        if (_stopped) return false;
+        _ready.push_back(std::move(buffer));
+        _buffer_ready.notify_one();
+
+        // Take back a consumed buffer, so that steady state allocates nothing
+        if (!_free.empty()) {
+            buffer = std::move(_free.back());
+            _free.pop_back();
+        } else {
+            buffer = std::string();
+        }
+        return true;
+    }
+
+    void CompressedReader::_inflate_gzip(std::FILE* file) {
+        z_stream stream;
+        std::memset(&stream, 0, sizeof(stream));
+        // 15 bits window, +32 to detect gzip or zlib header
+        if (inflateInit2(&stream, 15 + 32) != Z_OK) {
+            throw std::runtime_error("biomxt::CompressedReader: Failed to initialize gzip decompression.");
+        }
+        struct Guard { z_stream* s; ~Guard() { inflateEnd(s); } } guard{&stream};
+
+        std::vector<unsigned char> input(INPUT_CHUNK_SIZE);
+        std::string output;
+        output.resize(_buffer_size);
+        size_t filled = 0;
+        bool eof = false;
+        bool in_member = false;
+        bool pending = false;
+        while (true) {
+            if (stream.avail_in == 0 && !eof) {
+                size_t n = std::fread(input.data(), 1, input.size(), file);
+                if (std::ferror(file)) {
+                    throw std::runtime_error("biomxt::CompressedReader: Failed to read file: " + _path);
+                }
+                eof = n < input.size();
+                stream.next_in = input.data();
+                stream.avail_in = static_cast<uInt>(n);
+            }
+            // Inflate may hold output back when the last call filled the buffer
+            if (stream.avail_in == 0 && eof && !pending) break;
+
+            stream.next_out = reinterpret_cast<Bytef*>(output.data() + filled);
+            stream.avail_out = static_cast<uInt>(output.size() - filled);
+            in_member = true;
+            int ret = inflate(&stream, Z_NO_FLUSH);
+            filled = output.size() - stream.avail_out;
+            pending = stream.avail_out == 0 && ret != Z_STREAM_END;
+            if (ret == Z_STREAM_END) {
+                // Another member may follow
+                in_member = false;
+                inflateReset(&stream);
+            } else if (ret != Z_OK && ret != Z_BUF_ERROR) {
+                throw std::runtime_error("biomxt::CompressedReader: Gzip decompression error [" + std::string(stream.msg ? stream.msg : std::to_string(ret)) + "] in file: " + _path);
+            }
+
+            if (filled == output.size()) {
+                if (!_publish(output)) return;
+                output.resize(_buffer_size);
+                filled = 0;
+            }
+        }
+        if (in_member) {
+            throw std::runtime_error("biomxt::CompressedReader: Gzip stream is truncated in file: " + _path);
+        }
+        if (filled > 0) {
+            output.resize(filled);
+            _publish(output);
+        }
+    }
+
+    void CompressedReader::_decompress_zstd(std::FILE* file) {
+        ZSTD_DStream* stream = ZSTD_createDStream();
+        if (!stream) {
+            throw std::runtime_error("biomxt::CompressedReader: Failed to initialize zstd decompression.");
+        }
+        struct Guard { ZSTD_DStream* s; ~Guard() { ZSTD_freeDStream(s); } } guard{stream};
+        ZSTD_initDStream(stream);
+
+        std::vector<char> input(std::max(INPUT_CHUNK_SIZE, ZSTD_DStreamInSize()));
+        std::string output;
+        output.resize(_buffer_size);
+        ZSTD_inBuffer in = {input.data(), 0, 0};
+        size_t filled = 0;
+        size_t hint = 0;
+        bool eof = false;
+        while (true) {
+            if (in.pos == in.size && !eof) {
+                size_t n = std::fread(input.data(), 1, input.size(), file);
+                if (std::ferror(file)) {
+                    throw std::runtime_error("biomxt::CompressedReader: Failed to read file: " + _path);
+                }
+                eof = n < input.size();
+                in = {input.data(), n, 0};
+            }
+            if (in.pos == in.size && eof) break;
+
+            ZSTD_outBuffer out = {output.data(), output.size(), filled};
+            hint = ZSTD_decompressStream(stream, &out, &in);
+            if (ZSTD_isError(hint)) {
+                throw std::runtime_error("biomxt::CompressedReader: Zstd decompression error [" + std::string(ZSTD_getErrorName(hint)) + "] in file: " + _path);
+            }
+            filled = out.pos;
+
+            if (filled == output.size()) {
+                if (!_publish(output)) return;
+                output.resize(_buffer_size);
+                filled = 0;
+            }
+        }
+        // Decoder may still hold data of the last frame
+        while (hint != 0) {
+            ZSTD_inBuffer empty = {input.data(), 0, 0};
+            ZSTD_outBuffer out = {output.data(), output.size(), filled};
+            hint = ZSTD_decompressStream(stream, &out, &empty);
+            if (ZSTD_isError(hint)) {
+                throw std::runtime_error("biomxt::CompressedReader: Zstd decompression error [" + std::string(ZSTD_getErrorName(hint)) + "] in file: " + _path);
+            }
+            if (out.pos == filled && hint != 0) {
+                throw std::runtime_error("biomxt::CompressedReader: Zstd stream is truncated in file: " + _path);
+            }
+            filled = out.pos;
+            if (filled == output.size()) {
+                if (!_publish(output)) return;
+                output.resize(_buffer_size);
+                filled = 0;
+            }
+        }
+        if (filled > 0) {
+            output.resize(filled);
+            _publish(output);
+        }
+    }
+
+} // namespace biomxt
@@ -0,0 +1,131 @@
+#include "biomxt/utils/csv_chunker.hpp"
+
+
+namespace biomxt {
+
+    const char* csv_find_record_end(
+        const char* first,
+        const char* last,
+        bool in_quote)
+        {
+            while (true) {
+                first = biomxt::csv_scan(first, last, '\n', '"');
+                if (first == last) return last;
+                if (*first == '"') {
+                    in_quote = !in_quote;
+                } else if (!in_quote) {
+                    return first;
+                }
+                ++first;
+            }
+        }
+
+    size_t csv_chunk_end(
+        std::string_view text,
+        size_t chunk_size,
+        bool last)
+        {
+            if (text.size() <= chunk_size) return last ? text.size() : 0;
+
+            const char* first = text.data();
+            const char* end_of_text = first + text.size();
+            const char* split = first + chunk_size;
+
+            // Odd count of quotes before the split point means it is inside quotes
+            bool in_quote = std::count(first, split, '"') % 2 == 1;
+            const char* end = csv_find_record_end(split, end_of_text, in_quote);
+            if (end < end_of_text) return end - first + 1;
+            return last ? text.size() : 0;
+        }
+
+    CsvChunker::CsvChunker(std::string_view text, size_t chunk_size) : _text(text), _chunk_size(chunk_size) {
+        if (chunk_size == 0) {
+            throw std::invalid_argument("biomxt::CsvChunker: Chunk size must be greater than 0.");
+        }
+    }
+
+    bool CsvChunker::next(std::string_view& chunk) {
+        if (_offset >= _text.size()) return false;
+
+        chunk = _text.substr(_offset, biomxt::csv_chunk_end(_text.substr(_offset), _chunk_size, true));
+        _offset += chunk.size();
+        return true;
+    }
+
+    template <typename T> void csv_parse_rows(
+        std::string_view chunk,
+        uint32_t ncol,
+        const char separator,
+        biomxt::CsvRows<T>& rows)
+        {
+            rows.rownames.clear();
+            rows.values.clear();
+            rows.row_ends.clear();
+            rows.row_count = 0;
+            rows.failed = false;
+            rows.error.clear();
+            rows.newline_count = std::count(chunk.begin(), chunk.end(), '\n');
+
+            std::vector<std::string_view> cells;
+            std::string unescape_buffer;
+            auto fail = [&](const char* record, const std::string& error) {
+                rows.values.resize(static_cast<size_t>(rows.row_count) * ncol);
+                rows.failed = true;
+                rows.error_line = std::count(chunk.data(), record, '\n');
+                rows.error = error;
+            };
+
+            const char* pos = chunk.data();
+            const char* last = chunk.data() + chunk.size();
+            while (pos < last) {
+                const char* record_end = csv_find_record_end(pos, last);
+                std::string_view line(pos, record_end - pos);
+                const char* record = pos;
+                pos = record_end < last ? record_end + 1 : last;
+
+                // Skip empty line and comment line
+                if (line.empty() || line[0] == '#' || line == "\r") continue;
+
+                try {
+                    uint32_t ncell = biomxt::csv_tokenize_line(line, cells, separator, unescape_buffer);
+                    if (ncell != ncol + 1) {
+                        throw std::runtime_error("has " + std::to_string(ncell - 1) + " cells (rowname excluded), expected " + std::to_string(ncol) + " cells.");
+                    }
+                    // Rows of a chunk are about the same length, reserve by the first one
+                    if (rows.row_count == 0) {
+                        rows.values.reserve((chunk.size() / (line.size() + 1) + 1) * ncol);
+                    }
+
+                    // Convert cells, first cell is row name
+                    size_t base = rows.values.size();
+                    rows.values.resize(base + ncol);
+                    for (uint32_t i = 1; i <= ncol; i++) {
+                        biomxt::ParseStatus status = biomxt::parse_number<T>(cells[i], rows.values[base + i - 1]);
+                        if (status != biomxt::ParseStatus::OK) {
+                            throw std::runtime_error("cell " + std::to_string(i + 1) + " [" + std::string(cells[i]) + "] is " + biomxt::parse_status_to_string(status) + " for " + biomxt::dtype_to_string(biomxt::dtype_from_type<T>::value) + ".");
+                        }
+                    }
+                    rows.rownames.emplace_back(cells[0]);
+                    rows.row_ends.push_back(pos - chunk.data());
+                    rows.row_count++;
+                } catch (const std::invalid_argument&) {
+                    fail(record, "contains unclosed quote.");
+                    return;
+                } catch (const std::runtime_error& e) {
+                    fail(record, e.what());
+                    return;
+                }
+            }
+        }
+
+    template void csv_parse_rows<int16_t>(std::string_view, uint32_t, const char, CsvRows<int16_t>&);
+    template void csv_parse_rows<int32_t>(std::string_view, uint32_t, const char, CsvRows<int32_t>&);
+    template void csv_parse_rows<int64_t>(std::string_view, uint32_t, const char, CsvRows<int64_t>&);
+    template void csv_parse_rows<float>(std::string_view, uint32_t, const char, CsvRows<float>&);
+    template void csv_parse_rows<double>(std::string_view, uint32_t, const char, CsvRows<double>&);
+    template void csv_parse_rows<uint8_t>(std::string_view, uint32_t, const char, CsvRows<uint8_t>&);
+    template void csv_parse_rows<uint16_t>(std::string_view, uint32_t, const char, CsvRows<uint16_t>&);
+    template void csv_parse_rows<float16>(std::string_view, uint32_t, const char, CsvRows<float16>&);
+    template void csv_parse_rows<bfloat16>(std::string_view, uint32_t, const char, CsvRows<bfloat16>&);
+
+} // namespace biomxt
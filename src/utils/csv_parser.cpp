@@ -1,116 +1,194 @@
 #include "biomxt/utils/csv_parser.hpp"
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#include <immintrin.h>
+#define BIOMXT_CSV_SIMD_X86
+#endif
 
 
 namespace biomxt {
-    uint32_t csv_parse_line(
-        const std::string& line, 
-        std::vector<std::string>& cells,
-        const char separator)
-        {
-            // Locate the actual end posotion, exclude \r or \n.
-            size_t end_pos = line.size();
-            while (end_pos > 0 && (line[end_pos - 1] == '\r' || line[end_pos - 1] == '\n')) {
-                end_pos--;
-            }
 
-            // If it is empty line
-            if (end_pos == 0) return 0;
+    namespace {
 
-            // Status: whether we are in a quote.
-            bool in_quote = false;
+        using ScanFunc = const char* (*)(const char*, const char*, char, char);
 
-            // Parse the line char by char
-            uint32_t cell_count = 0;
-            const size_t max_cells = cells.size();
-            if (max_cells == 0) {
-                throw std::invalid_argument("biomxt::csv_parse_line: Size of cells vector cannot be zero");
+        const char* _scan_scalar(const char* first, const char* last, char a, char b) {
+            for (; first < last; ++first) {
+                if (*first == a || *first == b) return first;
             }
-            cells[0].clear();
-            for (size_t i = 0; i < end_pos; ++i) {
-                const char c = line[i];
-                // Detect double quote escape.
-                if (c == '"') {
-                    if (!in_quote){
-                        // Enter quote mode.
-                        in_quote = true;
-                    } else if ( i + 1 < end_pos && line[i+1] == '"'){
-                        // Current char is double quote, append it and skip next quote.
-                        cells[cell_count] += '"';
-                        ++i;
-                    } else {
-                        in_quote = false;
-                    }
-                } else if (c == separator && !in_quote) {
-                    // Encounter separator, and not in quote mode, move to next cell.
-                    cell_count++;
+            return last;
+        }
 
-                    // Check container size.
-                    if (cell_count >= max_cells) {
-                        throw std::out_of_range("biomxt::csv_parse_line: This line contains too much cells, exceeds cells vector size: " + std::to_string(max_cells));
-                    }
-                    cells[cell_count].clear();
-                } else {
-                    // Current char neither separator nor quote, append it directly to cell.
-                    cells[cell_count] += line[i];
-                }
+#if defined(BIOMXT_CSV_SIMD_X86)
+        const char* _scan_sse2(const char* first, const char* last, char a, char b) {
+            const __m128i va = _mm_set1_epi8(a);
+            const __m128i vb = _mm_set1_epi8(b);
+            for (; last - first >= 16; first += 16) {
+                __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+                int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, va), _mm_cmpeq_epi8(chunk, vb)));
+                if (mask != 0) return first + __builtin_ctz(mask);
             }
+            return _scan_scalar(first, last, a, b);
+        }
 
-            if (in_quote) {
-                throw std::invalid_argument("biomxt::csv_parse_line: This line contains unclosed quote.");
+        __attribute__((target("avx2"))) const char* _scan_avx2(const char* first, const char* last, char a, char b) {
+            const __m256i va = _mm256_set1_epi8(a);
+            const __m256i vb = _mm256_set1_epi8(b);
+            for (; last - first >= 32; first += 32) {
+                __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+                uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, va), _mm256_cmpeq_epi8(chunk, vb))));
+                if (mask != 0) return first + __builtin_ctz(mask);
             }
+            return _scan_sse2(first, last, a, b);
+        }
+#endif
 
-            // There will not be a separator at the end of last cell, so we need to add the count manually for it.
-            return cell_count + 1;
+        ScanFunc _select_scan() {
+#if defined(BIOMXT_CSV_SIMD_X86)
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2")) return _scan_avx2;
+            return _scan_sse2;
+#else
+            return _scan_scalar;
+#endif
         }
 
-    uint32_t csv_parse_line(
-        const std::string& line, 
-        const char separator) 
-        {
+        const ScanFunc _scan = _select_scan();
+
+        /**
+         * @brief Walk cells of a line, call `on_cell(first, last, quoted)` with raw span of each cell.
+         * @note Quoted raw spans still contain their quotes, they are removed by `_unescape`.
+         */
+        template <typename F> uint32_t _walk_cells(const char* first, const char* last, const char separator, F&& on_cell) {
             // Locate the actual end posotion, exclude \r or \n.
-            size_t end_pos = line.size();
-            while (end_pos > 0 && (line[end_pos - 1] == '\r' || line[end_pos - 1] == '\n')) {
-                end_pos--;
+            while (last > first && (last[-1] == '\r' || last[-1] == '\n')) {
+                last--;
             }
 
             // If it is empty line
-            if (end_pos == 0) return 0;
-
-            // Status: whether we are in a quote.
-            bool in_quote = false;
+            if (last == first) return 0;
 
-            // Parse the line char by char
             uint32_t cell_count = 0;
-            for (size_t i = 0; i < end_pos; ++i) {
-                const char c = line[i];
-                // Detect double quote escape.
-                if (c == '"') {
-                    if (!in_quote){
-                        // Enter quote mode.
-                        in_quote = true;
-                    } else if ( i + 1 < end_pos && line[i+1] == '"'){
-                        // Current char is double quote, append it and skip next quote.
-                        // cell += '"';
-                        ++i;
-                    } else {
-                        in_quote = false;
-                    }
-                } else if (c == separator && !in_quote) {
-                    // Encounter separator, and not in quote mode, means a cell end.
-                    // cells.push_back(std::move(cell));
-                    // cell.clear();
+            const char* cell = first;
+            bool quoted = false;
+            const char* pos = first;
+            while (true) {
+                pos = _scan(pos, last, separator, '"');
+                if (pos == last) break;
+                if (*pos == separator) {
+                    // Encounter separator out of quote, a cell ends.
+                    on_cell(cell, pos, quoted);
                     cell_count++;
+                    cell = ++pos;
+                    quoted = false;
+                    continue;
+                }
+
+                // Enter quote mode, jump to the closing quote, skipping escaped double quotes.
+                quoted = true;
+                ++pos;
+                while (true) {
+                    pos = _scan(pos, last, '"', '"');
+                    if (pos == last) {
+                        throw std::invalid_argument("biomxt::csv_parse_line: This line contains unclosed quote.");
+                    }
+                    if (pos + 1 < last && pos[1] == '"') {
+                        pos += 2;
+                        continue;
+                    }
+                    ++pos;
+                    break;
+                }
+            }
+
+            // There will not be a separator at the end of last cell, so we need to add it manually.
+            on_cell(cell, last, quoted);
+            return cell_count + 1;
+        }
+
+        /**
+         * @brief Remove quotes of a raw cell, double quotes in quote mode become one quote.
+         * @return char* End of unescaped chars written to `out`.
+         */
+        char* _unescape(const char* first, const char* last, char* out) {
+            bool in_quote = false;
+            for (; first < last; ++first) {
+                if (*first != '"') {
+                    *out++ = *first;
+                } else if (in_quote && first + 1 < last && first[1] == '"') {
+                    *out++ = '"';
+                    ++first;
                 } else {
-                    // Current char neither separator nor quote, append it to cell.
-                    // cell += line[i];
+                    in_quote = !in_quote;
                 }
             }
+            return out;
+        }
+
+    } // namespace
 
-            if (in_quote) {
-                throw std::invalid_argument("biomxt::csv_parse_line: This line contains unclosed quote.");
+    const char* csv_scan(
+        const char* first,
+        const char* last,
+        const char a,
+        const char b)
+        {
+            return _scan(first, last, a, b);
+        }
+
+    uint32_t csv_tokenize_line(
+        std::string_view line,
+        std::vector<std::string_view>& cells,
+        const char separator,
+        std::string& unescape_buffer)
+        {
+            cells.clear();
+            // Unescaped chars never outnumber the line, so the buffer never reallocates while spans point into it.
+            if (unescape_buffer.size() < line.size()) {
+                unescape_buffer.resize(line.size());
             }
+            char* out = unescape_buffer.data();
+            return _walk_cells(line.data(), line.data() + line.size(), separator, [&](const char* first, const char* last, bool quoted) {
+                if (!quoted) {
+                    cells.emplace_back(first, last - first);
+                    return;
+                }
+                char* end = _unescape(first, last, out);
+                cells.emplace_back(out, end - out);
+                out = end;
+            });
+        }
 
-            cell_count++;
-            return cell_count;
+    uint32_t csv_parse_line(
+        const std::string& line, 
+        std::vector<std::string>& cells,
+        const char separator)
+        {
+            const size_t max_cells = cells.size();
+            if (max_cells == 0) {
+                throw std::invalid_argument("biomxt::csv_parse_line: Size of cells vector cannot be zero");
+            }
+            cells[0].clear();
+
+            uint32_t cell_count = 0;
+            return _walk_cells(line.data(), line.data() + line.size(), separator, [&](const char* first, const char* last, bool quoted) {
+                // Check container size.
+                if (cell_count >= max_cells) {
+                    throw std::out_of_range("biomxt::csv_parse_line: This line contains too much cells, exceeds cells vector size: " + std::to_string(max_cells));
+                }
+                std::string& cell = cells[cell_count++];
+                if (!quoted) {
+                    cell.assign(first, last);
+                    return;
+                }
+                cell.resize(last - first);
+                cell.resize(_unescape(first, last, cell.data()) - cell.data());
+            });
+        }
+
+    uint32_t csv_parse_line(
+        const std::string& line, 
+        const char separator) 
+        {
+            return _walk_cells(line.data(), line.data() + line.size(), separator, [](const char*, const char*, bool) {});
         }
-}
\ No newline at end of file
+}
@@ -0,0 +1,145 @@
+#include "biomxt/utils/expand_float.hpp"
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#include <immintrin.h>
+#define BIOMXT_EXPAND_SIMD_X86
+#endif
+
+
+namespace biomxt {
+
+    namespace {
+
+        // Expand kernels take whole elements and return how many of them were done, the rest is left to scalar code
+        using ExpandFunc = size_t (*)(const char*, size_t, float*);
+
+        size_t _expand_none(const char*, size_t, float*) {
+            return 0;
+        }
+
+#if defined(BIOMXT_EXPAND_SIMD_X86)
+        __attribute__((target("avx,f16c"))) size_t _expand_half_f16c(const char* src, size_t count, float* dst) {
+            const size_t n = count & ~static_cast<size_t>(7);
+            for (size_t i = 0; i < n; i += 8) {
+                __m128i half = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2));
+                _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(half));
+            }
+            return n;
+        }
+
+        // Bfloat16 is the upper half of a float, interleaving zeros below it is all it takes
+        size_t _expand_bfloat16_sse2(const char* src, size_t count, float* dst) {
+            const size_t n = count & ~static_cast<size_t>(7);
+            const __m128i zero = _mm_setzero_si128();
+            for (size_t i = 0; i < n; i += 8) {
+                __m128i bits = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_unpacklo_epi16(zero, bits));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 4), _mm_unpackhi_epi16(zero, bits));
+            }
+            return n;
+        }
+
+        size_t _expand_uint16_sse2(const char* src, size_t count, float* dst) {
+            const size_t n = count & ~static_cast<size_t>(7);
+            const __m128i zero = _mm_setzero_si128();
+            for (size_t i = 0; i < n; i += 8) {
+                __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2));
+                _mm_storeu_ps(dst + i, _mm_cvtepi32_ps(_mm_unpacklo_epi16(values, zero)));
+                _mm_storeu_ps(dst + i + 4, _mm_cvtepi32_ps(_mm_unpackhi_epi16(values, zero)));
+            }
+            return n;
+        }
+
+        size_t _expand_uint8_sse2(const char* src, size_t count, float* dst) {
+            const size_t n = count & ~static_cast<size_t>(15);
+            const __m128i zero = _mm_setzero_si128();
+            for (size_t i = 0; i < n; i += 16) {
+                __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+                __m128i low = _mm_unpacklo_epi8(values, zero);
+                __m128i high = _mm_unpackhi_epi8(values, zero);
+                _mm_storeu_ps(dst + i, _mm_cvtepi32_ps(_mm_unpacklo_epi16(low, zero)));
+                _mm_storeu_ps(dst + i + 4, _mm_cvtepi32_ps(_mm_unpackhi_epi16(low, zero)));
+                _mm_storeu_ps(dst + i + 8, _mm_cvtepi32_ps(_mm_unpacklo_epi16(high, zero)));
+                _mm_storeu_ps(dst + i + 12, _mm_cvtepi32_ps(_mm_unpackhi_epi16(high, zero)));
+            }
+            return n;
+        }
+#endif
+
+        ExpandFunc _select_expand(biomxt::DataType dtype) {
+#if defined(BIOMXT_EXPAND_SIMD_X86)
+            __builtin_cpu_init();
+            switch (dtype) {
+                case biomxt::DataType::FLOAT16:
+                    if (__builtin_cpu_supports("f16c") && __builtin_cpu_supports("avx")) return _expand_half_f16c;
+                    break;
+                case biomxt::DataType::BFLOAT16:
+                    return _expand_bfloat16_sse2;
+                case biomxt::DataType::UINT16:
+                    return _expand_uint16_sse2;
+                case biomxt::DataType::UINT8:
+                    return _expand_uint8_sse2;
+                default:
+                    break;
+            }
+#endif
+            (void)dtype;
+            return _expand_none;
+        }
+
+        const ExpandFunc _expand_half = _select_expand(biomxt::DataType::FLOAT16);
+        const ExpandFunc _expand_bfloat16 = _select_expand(biomxt::DataType::BFLOAT16);
+        const ExpandFunc _expand_uint16 = _select_expand(biomxt::DataType::UINT16);
+        const ExpandFunc _expand_uint8 = _select_expand(biomxt::DataType::UINT8);
+
+        /**
+         * @brief Cast the elements left by a kernel, from element `begin` on.
+         */
+        template <typename T> void _expand_scalar(const char* src, size_t begin, size_t count, float* dst) {
+            for (size_t i = begin; i < count; i++) {
+                T value;
+                std::memcpy(&value, src + i * sizeof(T), sizeof(T));
+                dst[i] = static_cast<float>(value);
+            }
+        }
+
+    } // namespace
+
+    void expand_to_float(const char* src, size_t count, biomxt::DataType dtype, float* dst) {
+        switch (dtype) {
+            case biomxt::DataType::INT16:
+                _expand_scalar<int16_t>(src, 0, count, dst);
+                break;
+            case biomxt::DataType::INT32:
+                _expand_scalar<int32_t>(src, 0, count, dst);
+                break;
+            case biomxt::DataType::INT64:
+                _expand_scalar<int64_t>(src, 0, count, dst);
+                break;
+            case biomxt::DataType::FLOAT32:
+                std::memcpy(dst, src, count * sizeof(float));
+                break;
+            case biomxt::DataType::FLOAT64:
+                _expand_scalar<double>(src, 0, count, dst);
+                break;
+            case biomxt::DataType::UINT8:
+                _expand_scalar<uint8_t>(src, _expand_uint8(src, count, dst), count, dst);
+                break;
+            case biomxt::DataType::UINT16:
+                _expand_scalar<uint16_t>(src, _expand_uint16(src, count, dst), count, dst);
+                break;
+            case biomxt::DataType::FLOAT16:
+                _expand_scalar<biomxt::float16>(src, _expand_half(src, count, dst), count, dst);
+                break;
+            case biomxt::DataType::BFLOAT16:
+                _expand_scalar<biomxt::bfloat16>(src, _expand_bfloat16(src, count, dst), count, dst);
+                break;
+            default:
+                throw std::invalid_argument("biomxt::expand_to_float: Unsupported data type [" + std::to_string(dtype) + "]");
+        }
+    }
+
+} // namespace biomxt
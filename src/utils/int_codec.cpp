@@ -0,0 +1,271 @@
+#include "biomxt/utils/int_codec.hpp"
+#include "biomxt/utils/bitpack.hpp"
+#include <cstring>
+#include <string>
+#include <stdexcept>
+#include <algorithm>
+
+
+namespace biomxt {
+
+    namespace {
+
+        // Integers are widened to 32 bits, differences wrap around so that every bit pattern round trips
+        template <typename S> inline uint32_t _load(const char* src, size_t i) {
+            S value;
+            std::memcpy(&value, src + i * sizeof(S), sizeof(S));
+            return static_cast<uint32_t>(static_cast<int32_t>(value));
+        }
+
+        template <typename S> inline void _store(char* dst, size_t i, uint32_t value) {
+            S narrow = static_cast<S>(value);
+            std::memcpy(dst + i * sizeof(S), &narrow, sizeof(S));
+        }
+
+        inline uint32_t _zigzag(uint32_t delta) {
+            return (delta << 1) ^ static_cast<uint32_t>(static_cast<int32_t>(delta) >> 31);
+        }
+
+        inline uint32_t _unzigzag(uint32_t value) {
+            return (value >> 1) ^ (0u - (value & 1));
+        }
+
+        // Packed words start 4 bytes aligned behind the group headers
+        inline size_t _align4(size_t size) {
+            return (size + 3) & ~size_t(3);
+        }
+
+        /**
+         * @brief Check encoded size, given group headers and bit widths of every group.
+         */
+        void _check_packed_size(const uint8_t* widths, size_t groups, size_t header_size, size_t src_size, const std::string& caller) {
+            size_t expected = header_size;
+            for (size_t g = 0; g < groups; g++) {
+                if (widths[g] > 32) {
+                    throw std::runtime_error(caller + ": Group bit width [" + std::to_string(widths[g]) + "] exceeds 32");
+                }
+                expected += widths[g] * 4 * sizeof(uint32_t);
+            }
+            if (expected != src_size) {
+                throw std::runtime_error(caller + ": Encoded size [" + std::to_string(src_size) + "] mismatch, expected [" + std::to_string(expected) + "]");
+            }
+        }
+
+        template <typename S> void _for_encode(const char* src, size_t count, std::vector<char>& dst) {
+            const size_t groups = (count + BITPACK_GROUP - 1) / BITPACK_GROUP;
+            const size_t header_size = _align4(groups * (sizeof(int32_t) + 1));
+            dst.resize(header_size + groups * BITPACK_GROUP * sizeof(uint32_t));
+            size_t offset = header_size;
+            uint32_t values[BITPACK_GROUP];
+            for (size_t g = 0; g < groups; g++) {
+                const size_t base = g * BITPACK_GROUP;
+                const size_t n = std::min(BITPACK_GROUP, count - base);
+                int32_t reference = static_cast<int32_t>(_load<S>(src, base));
+                for (size_t k = 1; k < n; k++) reference = std::min(reference, static_cast<int32_t>(_load<S>(src, base + k)));
+                for (size_t k = 0; k < n; k++) values[k] = _load<S>(src, base + k) - static_cast<uint32_t>(reference);
+                std::fill(values + n, values + BITPACK_GROUP, 0);
+
+                uint32_t bits = biomxt::bit_width(values, n);
+                std::memcpy(dst.data() + g * sizeof(int32_t), &reference, sizeof(reference));
+                dst[groups * sizeof(int32_t) + g] = static_cast<char>(bits);
+                biomxt::pack128(values, bits, reinterpret_cast<uint32_t*>(dst.data() + offset));
+                offset += bits * 4 * sizeof(uint32_t);
+            }
+            dst.resize(offset);
+        }
+
+        template <typename S> void _for_decode(const char* src, size_t src_size, size_t count, char* dst) {
+            const size_t groups = (count + BITPACK_GROUP - 1) / BITPACK_GROUP;
+            const size_t header_size = _align4(groups * (sizeof(int32_t) + 1));
+            if (src_size < header_size) {
+                throw std::runtime_error("biomxt::for_decode: Encoded data is truncated");
+            }
+            const uint8_t* widths = reinterpret_cast<const uint8_t*>(src + groups * sizeof(int32_t));
+            _check_packed_size(widths, groups, header_size, src_size, "biomxt::for_decode");
+
+            const uint32_t* words = reinterpret_cast<const uint32_t*>(src + header_size);
+            uint32_t values[BITPACK_GROUP];
+            for (size_t g = 0; g < groups; g++) {
+                const size_t base = g * BITPACK_GROUP;
+                const size_t n = std::min(BITPACK_GROUP, count - base);
+                int32_t reference;
+                std::memcpy(&reference, src + g * sizeof(int32_t), sizeof(reference));
+                biomxt::unpack128(words, widths[g], values);
+                words += widths[g] * 4;
+                for (size_t k = 0; k < n; k++) _store<S>(dst, base + k, values[k] + static_cast<uint32_t>(reference));
+            }
+        }
+
+        template <typename S> void _delta_encode(const char* src, size_t count, std::vector<char>& dst) {
+            const size_t groups = (count + BITPACK_GROUP - 1) / BITPACK_GROUP;
+            const size_t header_size = _align4(groups);
+            dst.resize(header_size + groups * BITPACK_GROUP * sizeof(uint32_t));
+            size_t offset = header_size;
+            uint32_t values[BITPACK_GROUP];
+            uint32_t previous = 0;
+            for (size_t g = 0; g < groups; g++) {
+                const size_t base = g * BITPACK_GROUP;
+                const size_t n = std::min(BITPACK_GROUP, count - base);
+                for (size_t k = 0; k < n; k++) {
+                    uint32_t value = _load<S>(src, base + k);
+                    values[k] = _zigzag(value - previous);
+                    previous = value;
+                }
+                std::fill(values + n, values + BITPACK_GROUP, 0);
+
+                uint32_t bits = biomxt::bit_width(values, n);
+                dst[g] = static_cast<char>(bits);
+                biomxt::pack128(values, bits, reinterpret_cast<uint32_t*>(dst.data() + offset));
+                offset += bits * 4 * sizeof(uint32_t);
+            }
+            dst.resize(offset);
+        }
+
+        template <typename S> void _delta_decode(const char* src, size_t src_size, size_t count, char* dst) {
+            const size_t groups = (count + BITPACK_GROUP - 1) / BITPACK_GROUP;
+            const size_t header_size = _align4(groups);
+            if (src_size < header_size) {
+                throw std::runtime_error("biomxt::delta_decode: Encoded data is truncated");
+            }
+            const uint8_t* widths = reinterpret_cast<const uint8_t*>(src);
+            _check_packed_size(widths, groups, header_size, src_size, "biomxt::delta_decode");
+
+            const uint32_t* words = reinterpret_cast<const uint32_t*>(src + header_size);
+            uint32_t values[BITPACK_GROUP];
+            uint32_t previous = 0;
+            for (size_t g = 0; g < groups; g++) {
+                const size_t base = g * BITPACK_GROUP;
+                const size_t n = std::min(BITPACK_GROUP, count - base);
+                biomxt::unpack128(words, widths[g], values);
+                words += widths[g] * 4;
+                for (size_t k = 0; k < n; k++) {
+                    previous += _unzigzag(values[k]);
+                    _store<S>(dst, base + k, previous);
+                }
+            }
+        }
+
+        template <typename S> void _fixed_encode(const char* src, size_t count, std::vector<char>& dst) {
+            int32_t reference = 0;
+            uint32_t range = 0;
+            if (count > 0) {
+                int32_t low = static_cast<int32_t>(_load<S>(src, 0));
+                int32_t high = low;
+                for (size_t i = 1; i < count; i++) {
+                    int32_t value = static_cast<int32_t>(_load<S>(src, i));
+                    low = std::min(low, value);
+                    high = std::max(high, value);
+                }
+                reference = low;
+                range = static_cast<uint32_t>(high) - static_cast<uint32_t>(low);
+            }
+            const uint8_t width = range == 0 ? 0 : range <= 0xFF ? 1 : range <= 0xFFFF ? 2 : 4;
+
+            dst.resize(sizeof(int32_t) + 1 + count * width);
+            std::memcpy(dst.data(), &reference, sizeof(reference));
+            dst[sizeof(int32_t)] = static_cast<char>(width);
+            char* out = dst.data() + sizeof(int32_t) + 1;
+            for (size_t i = 0; i < count; i++) {
+                uint32_t value = _load<S>(src, i) - static_cast<uint32_t>(reference);
+                std::memcpy(out + i * width, &value, width);
+            }
+        }
+
+        template <typename S> void _fixed_decode(const char* src, size_t src_size, size_t count, char* dst) {
+            if (src_size < sizeof(int32_t) + 1) {
+                throw std::runtime_error("biomxt::fixed_decode: Encoded data is truncated");
+            }
+            int32_t reference;
+            std::memcpy(&reference, src, sizeof(reference));
+            const uint8_t width = static_cast<uint8_t>(src[sizeof(int32_t)]);
+            if ((width != 0 && width != 1 && width != 2 && width != 4) || src_size != sizeof(int32_t) + 1 + count * width) {
+                throw std::runtime_error("biomxt::fixed_decode: Encoded size [" + std::to_string(src_size) + "] mismatch with byte width [" + std::to_string(width) + "]");
+            }
+            const char* in = src + sizeof(int32_t) + 1;
+            switch (width) {
+                case 0:
+                    for (size_t i = 0; i < count; i++) _store<S>(dst, i, static_cast<uint32_t>(reference));
+                    break;
+                case 1:
+                    for (size_t i = 0; i < count; i++) _store<S>(dst, i, static_cast<uint8_t>(in[i]) + static_cast<uint32_t>(reference));
+                    break;
+                case 2:
+                    for (size_t i = 0; i < count; i++) {
+                        uint16_t value;
+                        std::memcpy(&value, in + i * 2, 2);
+                        _store<S>(dst, i, value + static_cast<uint32_t>(reference));
+                    }
+                    break;
+                default:
+                    for (size_t i = 0; i < count; i++) {
+                        uint32_t value;
+                        std::memcpy(&value, in + i * 4, 4);
+                        _store<S>(dst, i, value + static_cast<uint32_t>(reference));
+                    }
+                    break;
+            }
+        }
+
+    } // namespace
+
+    void for_encode(const char* src, size_t size, size_t element_size, std::vector<char>& dst) {
+        switch (element_size) {
+            case 1: _for_encode<int8_t>(src, size / element_size, dst); break;
+            case 2: _for_encode<int16_t>(src, size / element_size, dst); break;
+            case 4: _for_encode<int32_t>(src, size / element_size, dst); break;
+            default:
+                throw std::invalid_argument("biomxt::for_encode: Unsupported element size [" + std::to_string(element_size) + "]");
+        }
+    }
+
+    void for_decode(const char* src, size_t src_size, size_t size, size_t element_size, char* dst) {
+        switch (element_size) {
+            case 1: _for_decode<int8_t>(src, src_size, size / element_size, dst); break;
+            case 2: _for_decode<int16_t>(src, src_size, size / element_size, dst); break;
+            case 4: _for_decode<int32_t>(src, src_size, size / element_size, dst); break;
+            default:
+                throw std::invalid_argument("biomxt::for_decode: Unsupported element size [" + std::to_string(element_size) + "]");
+        }
+    }
+
+    void delta_encode(const char* src, size_t size, size_t element_size, std::vector<char>& dst) {
+        switch (element_size) {
+            case 1: _delta_encode<int8_t>(src, size / element_size, dst); break;
+            case 2: _delta_encode<int16_t>(src, size / element_size, dst); break;
+            case 4: _delta_encode<int32_t>(src, size / element_size, dst); break;
+            default:
+                throw std::invalid_argument("biomxt::delta_encode: Unsupported element size [" + std::to_string(element_size) + "]");
+        }
+    }
+
+    void delta_decode(const char* src, size_t src_size, size_t size, size_t element_size, char* dst) {
+        switch (element_size) {
+            case 1: _delta_decode<int8_t>(src, src_size, size / element_size, dst); break;
+            case 2: _delta_decode<int16_t>(src, src_size, size / element_size, dst); break;
+            case 4: _delta_decode<int32_t>(src, src_size, size / element_size, dst); break;
+            default:
+                throw std::invalid_argument("biomxt::delta_decode: Unsupported element size [" + std::to_string(element_size) + "]");
+        }
+    }
+
+    void fixed_encode(const char* src, size_t size, size_t element_size, std::vector<char>& dst) {
+        switch (element_size) {
+            case 1: _fixed_encode<int8_t>(src, size / element_size, dst); break;
+            case 2: _fixed_encode<int16_t>(src, size / element_size, dst); break;
+            case 4: _fixed_encode<int32_t>(src, size / element_size, dst); break;
+            default:
+                throw std::invalid_argument("biomxt::fixed_encode: Unsupported element size [" + std::to_string(element_size) + "]");
+        }
+    }
+
+    void fixed_decode(const char* src, size_t src_size, size_t size, size_t element_size, char* dst) {
+        switch (element_size) {
+            case 1: _fixed_decode<int8_t>(src, src_size, size / element_size, dst); break;
+            case 2: _fixed_decode<int16_t>(src, src_size, size / element_size, dst); break;
+            case 4: _fixed_decode<int32_t>(src, src_size, size / element_size, dst); break;
+            default:
+                throw std::invalid_argument("biomxt::fixed_decode: Unsupported element size [" + std::to_string(element_size) + "]");
+        }
+    }
+
+} // namespace biomxt
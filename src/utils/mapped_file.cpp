@@ -0,0 +1,56 @@
+#include "biomxt/utils/mapped_file.hpp"
+#include <fstream>
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+
+namespace biomxt {
+
+    MappedFile::MappedFile(const std::string& path) {
+#if !defined(_WIN32)
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("biomxt::MappedFile: Failed to open file: " + path);
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("biomxt::MappedFile: Failed to stat file: " + path);
+        }
+        _size = static_cast<size_t>(st.st_size);
+        if (_size > 0) {
+            void* addr = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("biomxt::MappedFile: Failed to map file: " + path);
+            }
+            ::madvise(addr, _size, MADV_SEQUENTIAL);
+            _data = static_cast<const char*>(addr);
+            _mapped = true;
+        }
+        // Mapping stays valid after the descriptor is closed
+        ::close(fd);
+#else
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file.is_open()) {
+            throw std::runtime_error("biomxt::MappedFile: Failed to open file: " + path);
+        }
+        _buffer.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(_buffer.data(), _buffer.size());
+        _data = _buffer.data();
+        _size = _buffer.size();
+#endif
+    }
+
+    MappedFile::~MappedFile() {
+#if !defined(_WIN32)
+        if (_mapped) ::munmap(const_cast<char*>(_data), _size);
+#endif
+    }
+
+} // namespace biomxt
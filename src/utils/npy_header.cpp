@@ -0,0 +1,122 @@
+#include "biomxt/utils/npy_header.hpp"
+#include <cstring>
+#include <charconv>
+
+
+namespace biomxt {
+
+    namespace {
+
+        /**
+         * @brief Find the value of a key in the header dict, as the text up to the next comma at depth 0.
+         */
+        std::string_view _dict_value(std::string_view dict, std::string_view key) {
+            size_t pos = dict.find("'" + std::string(key) + "'");
+            if (pos == std::string_view::npos) {
+                throw std::runtime_error("biomxt::npy_parse_header: Missing key [" + std::string(key) + "] in header.");
+            }
+            pos = dict.find(':', pos);
+            if (pos == std::string_view::npos) {
+                throw std::runtime_error("biomxt::npy_parse_header: Malformed header.");
+            }
+            pos++;
+            while (pos < dict.size() && dict[pos] == ' ') pos++;
+            int depth = 0;
+            size_t end = pos;
+            for (; end < dict.size(); end++) {
+                char c = dict[end];
+                if (c == '(' || c == '[') depth++;
+                else if (c == ')' || c == ']') depth--;
+                else if ((c == ',' || c == '}') && depth == 0) break;
+            }
+            return dict.substr(pos, end - pos);
+        }
+
+    } // namespace
+
+    biomxt::NpyHeader npy_parse_header(const char* data, size_t size) {
+        // Magic string, version, and header length
+        if (size < 10 || std::memcmp(data, "\x93NUMPY", 6) != 0) {
+            throw std::runtime_error("biomxt::npy_parse_header: Not a npy file.");
+        }
+        uint8_t major = static_cast<uint8_t>(data[6]);
+        size_t header_len = 0;
+        size_t dict_offset = 0;
+        if (major == 1) {
+            header_len = static_cast<uint8_t>(data[8]) | (static_cast<uint8_t>(data[9]) << 8);
+            dict_offset = 10;
+        } else if (major == 2 || major == 3) {
+            if (size < 12) throw std::runtime_error("biomxt::npy_parse_header: Truncated header.");
+            for (int i = 3; i >= 0; i--) header_len = (header_len << 8) | static_cast<uint8_t>(data[8 + i]);
+            dict_offset = 12;
+        } else {
+            throw std::runtime_error("biomxt::npy_parse_header: Unsupported npy version [" + std::to_string(major) + "].");
+        }
+        if (dict_offset + header_len > size) {
+            throw std::runtime_error("biomxt::npy_parse_header: Truncated header.");
+        }
+
+        biomxt::NpyHeader header;
+        header.data_offset = dict_offset + header_len;
+        std::string_view dict(data + dict_offset, header_len);
+
+        // Element type, little-endian or native on a little-endian host
+        std::string_view descr = _dict_value(dict, "descr");
+        if (descr.size() < 5 || (descr[0] != '\'' && descr[0] != '"')) {
+            throw std::runtime_error("biomxt::npy_parse_header: Malformed descr [" + std::string(descr) + "].");
+        }
+        std::string_view type = descr.substr(1, descr.size() - 2);
+        const uint16_t probe = 1;
+        const bool little_host = *reinterpret_cast<const uint8_t*>(&probe) == 1;
+        if (type[0] != '<' && !(type[0] == '=' && little_host) && type != "|u1") {
+            throw std::runtime_error("biomxt::npy_parse_header: Only little-endian arrays are supported, got [" + std::string(type) + "].");
+        }
+        type.remove_prefix(1);
+        if (type == "i2") header.dtype = biomxt::DataType::INT16;
+        else if (type == "i4") header.dtype = biomxt::DataType::INT32;
+        else if (type == "i8") header.dtype = biomxt::DataType::INT64;
+        else if (type == "f4") header.dtype = biomxt::DataType::FLOAT32;
+        else if (type == "f8") header.dtype = biomxt::DataType::FLOAT64;
+        else if (type == "u1") header.dtype = biomxt::DataType::UINT8;
+        else if (type == "u2") header.dtype = biomxt::DataType::UINT16;
+        else if (type == "f2") header.dtype = biomxt::DataType::FLOAT16;
+        else throw std::runtime_error("biomxt::npy_parse_header: Unsupported element type [" + std::string(type) + "].");
+
+        // Memory order
+        std::string_view order = _dict_value(dict, "fortran_order");
+        if (order == "True") header.fortran_order = true;
+        else if (order == "False") header.fortran_order = false;
+        else throw std::runtime_error("biomxt::npy_parse_header: Malformed fortran_order [" + std::string(order) + "].");
+
+        // Shape of 2 dimensions
+        std::string_view shape = _dict_value(dict, "shape");
+        uint64_t dims[2] = {0, 0};
+        size_t dim_count = 0;
+        const char* pos = shape.data();
+        const char* last = shape.data() + shape.size();
+        while (pos < last) {
+            if (*pos < '0' || *pos > '9') { pos++; continue; }
+            if (dim_count == 2) {
+                throw std::runtime_error("biomxt::npy_parse_header: Only 2-D arrays are supported, got shape " + std::string(shape) + ".");
+            }
+            auto [ptr, ec] = std::from_chars(pos, last, dims[dim_count]);
+            if (ec != std::errc()) throw std::runtime_error("biomxt::npy_parse_header: Malformed shape " + std::string(shape) + ".");
+            dim_count++;
+            pos = ptr;
+        }
+        if (dim_count != 2) {
+            throw std::runtime_error("biomxt::npy_parse_header: Only 2-D arrays are supported, got shape " + std::string(shape) + ".");
+        }
+        if (dims[0] > UINT32_MAX || dims[1] > UINT32_MAX) {
+            throw std::runtime_error("biomxt::npy_parse_header: Shape " + std::string(shape) + " exceeds 32-bit row or column count.");
+        }
+        header.nrow = static_cast<uint32_t>(dims[0]);
+        header.ncol = static_cast<uint32_t>(dims[1]);
+
+        if ((size - header.data_offset) / biomxt::size_of_dtype(header.dtype) < static_cast<uint64_t>(header.nrow) * header.ncol) {
+            throw std::runtime_error("biomxt::npy_parse_header: Array data is truncated.");
+        }
+        return header;
+    }
+
+} // namespace biomxt
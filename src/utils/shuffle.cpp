@@ -0,0 +1,244 @@
+#include "biomxt/utils/shuffle.hpp"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#include <immintrin.h>
+#define BIOMXT_SHUFFLE_SIMD_X86
+#endif
+
+
+namespace biomxt {
+
+    namespace {
+
+        // Shuffle kernels take whole elements and return how many of them were done, the rest is left to scalar code
+        using ShuffleFunc = size_t (*)(const char*, char*, size_t, size_t);
+
+        size_t _shuffle_none(const char*, char*, size_t, size_t) {
+            return 0;
+        }
+
+#if defined(BIOMXT_SHUFFLE_SIMD_X86)
+        /**
+         * @brief Transpose 4x4 lanes of 32 bits.
+         */
+        __attribute__((target("ssse3"))) inline void _transpose_4x32(__m128i x[4]) {
+            __m128i b0 = _mm_unpacklo_epi32(x[0], x[1]);
+            __m128i b1 = _mm_unpackhi_epi32(x[0], x[1]);
+            __m128i b2 = _mm_unpacklo_epi32(x[2], x[3]);
+            __m128i b3 = _mm_unpackhi_epi32(x[2], x[3]);
+            x[0] = _mm_unpacklo_epi64(b0, b2);
+            x[1] = _mm_unpackhi_epi64(b0, b2);
+            x[2] = _mm_unpacklo_epi64(b1, b3);
+            x[3] = _mm_unpackhi_epi64(b1, b3);
+        }
+
+        /**
+         * @brief Transpose 8x8 lanes of 16 bits.
+         */
+        __attribute__((target("ssse3"))) inline void _transpose_8x16(__m128i x[8]) {
+            __m128i b[8], c[8];
+            for (int r = 0; r < 4; r++) {
+                b[2*r] = _mm_unpacklo_epi16(x[2*r], x[2*r + 1]);
+                b[2*r + 1] = _mm_unpackhi_epi16(x[2*r], x[2*r + 1]);
+            }
+            for (int r = 0; r < 2; r++) {
+                c[4*r] = _mm_unpacklo_epi32(b[4*r], b[4*r + 2]);
+                c[4*r + 1] = _mm_unpackhi_epi32(b[4*r], b[4*r + 2]);
+                c[4*r + 2] = _mm_unpacklo_epi32(b[4*r + 1], b[4*r + 3]);
+                c[4*r + 3] = _mm_unpackhi_epi32(b[4*r + 1], b[4*r + 3]);
+            }
+            for (int r = 0; r < 4; r++) {
+                x[2*r] = _mm_unpacklo_epi64(c[r], c[r + 4]);
+                x[2*r + 1] = _mm_unpackhi_epi64(c[r], c[r + 4]);
+            }
+        }
+
+        __attribute__((target("ssse3"))) size_t _shuffle_ssse3(const char* src, char* dst, size_t count, size_t element_size) {
+            const size_t n = count & ~static_cast<size_t>(15);
+            if (element_size == 2) {
+                // Split even and odd bytes of 8 elements, then join halves of two registers
+                const __m128i mask = _mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
+                for (size_t i = 0; i < n; i += 16) {
+                    __m128i a = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i*2)), mask);
+                    __m128i b = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i*2 + 16)), mask);
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_unpacklo_epi64(a, b));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + count + i), _mm_unpackhi_epi64(a, b));
+                }
+            } else if (element_size == 4) {
+                // Group bytes of 4 elements into 32-bit lanes, then transpose lanes of 4 registers
+                const __m128i mask = _mm_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+                __m128i x[4];
+                for (size_t i = 0; i < n; i += 16) {
+                    for (int r = 0; r < 4; r++) {
+                        x[r] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i*4 + 16*r)), mask);
+                    }
+                    _transpose_4x32(x);
+                    for (int j = 0; j < 4; j++) {
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + j*count + i), x[j]);
+                    }
+                }
+            } else if (element_size == 8) {
+                // Pair bytes of 2 elements into 16-bit lanes, then transpose lanes of 8 registers
+                const __m128i mask = _mm_setr_epi8(0, 8, 1, 9, 2, 10, 3, 11, 4, 12, 5, 13, 6, 14, 7, 15);
+                __m128i x[8];
+                for (size_t i = 0; i < n; i += 16) {
+                    for (int r = 0; r < 8; r++) {
+                        x[r] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i*8 + 16*r)), mask);
+                    }
+                    _transpose_8x16(x);
+                    for (int j = 0; j < 8; j++) {
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + j*count + i), x[j]);
+                    }
+                }
+            } else {
+                return 0;
+            }
+            return n;
+        }
+
+        __attribute__((target("ssse3"))) size_t _unshuffle_ssse3(const char* src, char* dst, size_t count, size_t element_size) {
+            const size_t n = count & ~static_cast<size_t>(15);
+            if (element_size == 2) {
+                const __m128i mask = _mm_setr_epi8(0, 8, 1, 9, 2, 10, 3, 11, 4, 12, 5, 13, 6, 14, 7, 15);
+                for (size_t i = 0; i < n; i += 16) {
+                    __m128i p0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+                    __m128i p1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + count + i));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i*2), _mm_shuffle_epi8(_mm_unpacklo_epi64(p0, p1), mask));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i*2 + 16), _mm_shuffle_epi8(_mm_unpackhi_epi64(p0, p1), mask));
+                }
+            } else if (element_size == 4) {
+                // Same transpose brings 4 elements of each plane together, the byte mask is its own inverse
+                const __m128i mask = _mm_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+                __m128i x[4];
+                for (size_t i = 0; i < n; i += 16) {
+                    for (int j = 0; j < 4; j++) {
+                        x[j] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + j*count + i));
+                    }
+                    _transpose_4x32(x);
+                    for (int r = 0; r < 4; r++) {
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i*4 + 16*r), _mm_shuffle_epi8(x[r], mask));
+                    }
+                }
+            } else if (element_size == 8) {
+                const __m128i mask = _mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
+                __m128i x[8];
+                for (size_t i = 0; i < n; i += 16) {
+                    for (int j = 0; j < 8; j++) {
+                        x[j] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + j*count + i));
+                    }
+                    _transpose_8x16(x);
+                    for (int r = 0; r < 8; r++) {
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i*8 + 16*r), _mm_shuffle_epi8(x[r], mask));
+                    }
+                }
+            } else {
+                return 0;
+            }
+            return n;
+        }
+#endif
+
+        ShuffleFunc _select_shuffle(bool forward) {
+#if defined(BIOMXT_SHUFFLE_SIMD_X86)
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("ssse3")) return forward ? _shuffle_ssse3 : _unshuffle_ssse3;
+#endif
+            (void)forward;
+            return _shuffle_none;
+        }
+
+        const ShuffleFunc _shuffle = _select_shuffle(true);
+        const ShuffleFunc _unshuffle = _select_shuffle(false);
+
+        /**
+         * @brief Transpose an 8x8 bit matrix, byte i bit b goes to byte b bit i.
+         */
+        inline uint64_t _transpose_8x8(uint64_t x) {
+            uint64_t t;
+            t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAull;
+            x = x ^ t ^ (t << 7);
+            t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCull;
+            x = x ^ t ^ (t << 14);
+            t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ull;
+            x = x ^ t ^ (t << 28);
+            return x;
+        }
+
+        /**
+         * @brief Transpose each 8-byte word of an array as an 8x8 bit matrix, in place.
+         */
+        void _transpose_words(char* data, size_t count) {
+            for (size_t i = 0; i < count; i++) {
+                uint64_t x;
+                std::memcpy(&x, data + i*8, sizeof(x));
+                x = _transpose_8x8(x);
+                std::memcpy(data + i*8, &x, sizeof(x));
+            }
+        }
+
+    } // namespace
+
+    void byte_shuffle(const char* src, char* dst, size_t size, size_t element_size) {
+        if (element_size <= 1) {
+            std::memcpy(dst, src, size);
+            return;
+        }
+        const size_t count = size / element_size;
+        for (size_t i = _shuffle(src, dst, count, element_size); i < count; i++) {
+            for (size_t j = 0; j < element_size; j++) {
+                dst[j*count + i] = src[i*element_size + j];
+            }
+        }
+        std::memcpy(dst + count*element_size, src + count*element_size, size - count*element_size);
+    }
+
+    void byte_unshuffle(const char* src, char* dst, size_t size, size_t element_size) {
+        if (element_size <= 1) {
+            std::memcpy(dst, src, size);
+            return;
+        }
+        const size_t count = size / element_size;
+        for (size_t i = _unshuffle(src, dst, count, element_size); i < count; i++) {
+            for (size_t j = 0; j < element_size; j++) {
+                dst[i*element_size + j] = src[j*count + i];
+            }
+        }
+        std::memcpy(dst + count*element_size, src + count*element_size, size - count*element_size);
+    }
+
+    void bit_shuffle(const char* src, char* dst, size_t size, size_t element_size) {
+        if (element_size == 0) element_size = 1;
+        const size_t groups = size / element_size / 8;
+        const size_t done = groups*8*element_size;
+
+        // Byte planes first, each 8 bytes of a plane is an 8x8 bit matrix of 8 elements
+        thread_local std::vector<char> planes;
+        planes.resize(done);
+        byte_shuffle(src, planes.data(), done, element_size);
+        _transpose_words(planes.data(), done / 8);
+
+        // Byte b of every word of plane j goes to bit plane `j*8 + b`, a byte shuffle of 8-byte elements
+        for (size_t j = 0; j < element_size; j++) {
+            byte_shuffle(planes.data() + j*8*groups, dst + j*8*groups, 8*groups, 8);
+        }
+        std::memcpy(dst + done, src + done, size - done);
+    }
+
+    void bit_unshuffle(const char* src, char* dst, size_t size, size_t element_size) {
+        if (element_size == 0) element_size = 1;
+        const size_t groups = size / element_size / 8;
+        const size_t done = groups*8*element_size;
+
+        thread_local std::vector<char> planes;
+        planes.resize(done);
+        for (size_t j = 0; j < element_size; j++) {
+            byte_unshuffle(src + j*8*groups, planes.data() + j*8*groups, 8*groups, 8);
+        }
+        _transpose_words(planes.data(), done / 8);
+        byte_unshuffle(planes.data(), dst, done, element_size);
+        std::memcpy(dst + done, src + done, size - done);
+    }
+
+} // namespace biomxt
@@ -0,0 +1,213 @@
+#include "biomxt/utils/sparse_block.hpp"
+#include <cstring>
+#include <string>
+#include <stdexcept>
+#include <algorithm>
+
+
+namespace biomxt {
+
+    namespace {
+
+        /**
+         * @brief Index of the lowest set bit, mask must not be 0.
+         */
+        inline uint32_t _lowest_bit(uint64_t mask) {
+#if defined(__GNUC__)
+            return __builtin_ctzll(mask);
+#else
+            uint32_t k = 0;
+            while (!(mask & 1)) {
+                mask >>= 1;
+                k++;
+            }
+            return k;
+#endif
+        }
+
+        /**
+         * @brief Count of set bits.
+         */
+        inline uint32_t _popcount(uint64_t mask) {
+#if defined(__GNUC__)
+            return __builtin_popcountll(mask);
+#else
+            uint32_t n = 0;
+            for (; mask; mask &= mask - 1) n++;
+            return n;
+#endif
+        }
+
+        // Elements are compared as unsigned words of the same size, so every bit pattern is exact
+        template <typename U> size_t _count_nonzeros(const char* src, size_t count) {
+            size_t nnz = 0;
+            for (size_t i = 0; i < count; i++) {
+                U value;
+                std::memcpy(&value, src + i * sizeof(U), sizeof(U));
+                nnz += value != 0;
+            }
+            return nnz;
+        }
+
+        template <typename U> size_t _bitmap_encode(const char* src, size_t count, char* dst) {
+            char* out = dst + biomxt::bitmap_size(count);
+            const char* values = out;
+            for (size_t base = 0; base < count; base += 64) {
+                const size_t n = std::min<size_t>(64, count - base);
+                uint64_t mask = 0;
+                for (size_t k = 0; k < n; k++) {
+                    U value;
+                    std::memcpy(&value, src + (base + k) * sizeof(U), sizeof(U));
+                    std::memcpy(out, &value, sizeof(U));
+                    const uint64_t nonzero = value != 0;
+                    out += nonzero * sizeof(U);
+                    mask |= nonzero << k;
+                }
+                std::memcpy(dst + base / 8, &mask, biomxt::bitmap_size(n));
+            }
+            return (out - values) / sizeof(U);
+        }
+
+        template <typename U> size_t _bitmap_decode(const char* bitmap, const char* values, size_t nnz, size_t count, char* dst) {
+            size_t taken = 0;
+            for (size_t base = 0; base < count; base += 64) {
+                const size_t n = std::min<size_t>(64, count - base);
+                uint64_t mask = 0;
+                std::memcpy(&mask, bitmap + base / 8, biomxt::bitmap_size(n));
+                if (n < 64) mask &= (uint64_t(1) << n) - 1;
+                taken += _popcount(mask);
+                if (taken > nnz) break;
+                for (; mask; mask &= mask - 1) {
+                    std::memcpy(dst + (base + _lowest_bit(mask)) * sizeof(U), values, sizeof(U));
+                    values += sizeof(U);
+                }
+            }
+            return taken;
+        }
+
+        template <typename U> void _sparsify(const char* src, size_t count, std::vector<uint32_t>& indices, std::vector<char>& values) {
+            for (size_t i = 0; i < count; i++) {
+                U value;
+                std::memcpy(&value, src + i * sizeof(U), sizeof(U));
+                if (value == 0) continue;
+                indices.push_back(static_cast<uint32_t>(i));
+                values.insert(values.end(), src + i * sizeof(U), src + (i + 1) * sizeof(U));
+            }
+        }
+
+        template <typename U> void _sparsify_strided(const char* src, size_t begin, size_t count, size_t stride, uint32_t index_base, std::vector<uint32_t>& indices, std::vector<char>& values) {
+            for (size_t k = 0; k < count; k++) {
+                const char* element = src + (begin + k * stride) * sizeof(U);
+                U value;
+                std::memcpy(&value, element, sizeof(U));
+                if (value == 0) continue;
+                indices.push_back(index_base + static_cast<uint32_t>(k));
+                values.insert(values.end(), element, element + sizeof(U));
+            }
+        }
+
+        /**
+         * @brief Count of set bits of a bitmap in positions [from, to).
+         */
+        size_t _count_bits(const char* bitmap, size_t from, size_t to) {
+            size_t n = 0;
+            while (from < to) {
+                const size_t base = from & ~size_t(63);
+                const size_t end = std::min(base + 64, to);
+                uint64_t mask = 0;
+                std::memcpy(&mask, bitmap + base / 8, biomxt::bitmap_size(end - base));
+                mask >>= from - base;
+                if (end - from < 64) mask &= (uint64_t(1) << (end - from)) - 1;
+                n += _popcount(mask);
+                from = end;
+            }
+            return n;
+        }
+
+    } // namespace
+
+    size_t count_nonzeros(const char* src, size_t size, size_t element_size) {
+        const size_t count = size / element_size;
+        switch (element_size) {
+            case 1: return _count_nonzeros<uint8_t>(src, count);
+            case 2: return _count_nonzeros<uint16_t>(src, count);
+            case 4: return _count_nonzeros<uint32_t>(src, count);
+            case 8: return _count_nonzeros<uint64_t>(src, count);
+            default:
+                throw std::invalid_argument("biomxt::count_nonzeros: Unsupported element size [" + std::to_string(element_size) + "]");
+        }
+    }
+
+    size_t bitmap_encode(const char* src, size_t size, size_t element_size, char* dst) {
+        const size_t count = size / element_size;
+        switch (element_size) {
+            case 1: return _bitmap_encode<uint8_t>(src, count, dst);
+            case 2: return _bitmap_encode<uint16_t>(src, count, dst);
+            case 4: return _bitmap_encode<uint32_t>(src, count, dst);
+            case 8: return _bitmap_encode<uint64_t>(src, count, dst);
+            default:
+                throw std::invalid_argument("biomxt::bitmap_encode: Unsupported element size [" + std::to_string(element_size) + "]");
+        }
+    }
+
+    void bitmap_decode(const char* bitmap, const char* values, size_t nnz, size_t size, size_t element_size, char* dst) {
+        const size_t count = size / element_size;
+        std::memset(dst, 0, size);
+        size_t taken = 0;
+        switch (element_size) {
+            case 1: taken = _bitmap_decode<uint8_t>(bitmap, values, nnz, count, dst); break;
+            case 2: taken = _bitmap_decode<uint16_t>(bitmap, values, nnz, count, dst); break;
+            case 4: taken = _bitmap_decode<uint32_t>(bitmap, values, nnz, count, dst); break;
+            case 8: taken = _bitmap_decode<uint64_t>(bitmap, values, nnz, count, dst); break;
+            default:
+                throw std::invalid_argument("biomxt::bitmap_decode: Unsupported element size [" + std::to_string(element_size) + "]");
+        }
+        if (taken != nnz) {
+            throw std::runtime_error("biomxt::bitmap_decode: Bitmap has [" + std::to_string(taken) + "] nonzeros or more, expected [" + std::to_string(nnz) + "]");
+        }
+    }
+
+    void sparsify(const char* src, size_t size, size_t element_size, std::vector<uint32_t>& indices, std::vector<char>& values) {
+        const size_t count = size / element_size;
+        indices.clear();
+        values.clear();
+        switch (element_size) {
+            case 1: _sparsify<uint8_t>(src, count, indices, values); break;
+            case 2: _sparsify<uint16_t>(src, count, indices, values); break;
+            case 4: _sparsify<uint32_t>(src, count, indices, values); break;
+            case 8: _sparsify<uint64_t>(src, count, indices, values); break;
+            default:
+                throw std::invalid_argument("biomxt::sparsify: Unsupported element size [" + std::to_string(element_size) + "]");
+        }
+    }
+
+    void sparsify_strided(const char* src, size_t element_size, size_t begin, size_t count, size_t stride, uint32_t index_base, std::vector<uint32_t>& indices, std::vector<char>& values) {
+        switch (element_size) {
+            case 1: _sparsify_strided<uint8_t>(src, begin, count, stride, index_base, indices, values); break;
+            case 2: _sparsify_strided<uint16_t>(src, begin, count, stride, index_base, indices, values); break;
+            case 4: _sparsify_strided<uint32_t>(src, begin, count, stride, index_base, indices, values); break;
+            case 8: _sparsify_strided<uint64_t>(src, begin, count, stride, index_base, indices, values); break;
+            default:
+                throw std::invalid_argument("biomxt::sparsify_strided: Unsupported element size [" + std::to_string(element_size) + "]");
+        }
+    }
+
+    void bitmap_gather(const char* bitmap, const char* packed, size_t nnz, size_t element_size, size_t begin, size_t count, size_t stride, uint32_t index_base, std::vector<uint32_t>& indices, std::vector<char>& values) {
+        // Rank of each position, i.e. its element in the packed values, follows from the set bits since the previous one
+        size_t position = begin;
+        size_t rank = _count_bits(bitmap, 0, begin);
+        for (size_t k = 0; k < count; k++) {
+            if (k > 0) {
+                rank += _count_bits(bitmap, position, position + stride);
+                position += stride;
+            }
+            if (!(static_cast<uint8_t>(bitmap[position / 8]) >> (position % 8) & 1)) continue;
+            if (rank >= nnz) {
+                throw std::runtime_error("biomxt::bitmap_gather: Bitmap has more than [" + std::to_string(nnz) + "] nonzeros");
+            }
+            indices.push_back(index_base + static_cast<uint32_t>(k));
+            values.insert(values.end(), packed + rank * element_size, packed + (rank + 1) * element_size);
+        }
+    }
+
+} // namespace biomxt
@@ -0,0 +1,77 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <string>
+#include "biomxt/utils/block_pipeline.hpp"
+
+
+#define ARG_ROW_SIZE                16384
+#define ARG_BLOCK_WIDTH             512
+#define ARG_BLOCK_HEIGHT            512
+#define TEST_EPOCHES                5
+
+
+uint64_t get_timestamp() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Previous assembly: column by column out of separate row vectors
+template <typename T> void assemble_block_by_column(const std::vector<std::vector<T>>& rows, uint32_t column_begin, uint32_t width, uint32_t height, std::vector<T>& block) {
+    block.resize(width * height);
+    for (uint32_t steps = 0; steps < width; steps++) {
+        for (uint32_t i = 0; i < height; i++) {
+            block[width * i + steps] = rows[i][column_begin + steps];
+        }
+    }
+}
+
+template <typename T> void run_test(const std::string& dtype) {
+    std::vector<T> arena(static_cast<size_t>(ARG_ROW_SIZE) * ARG_BLOCK_HEIGHT);
+    std::vector<std::vector<T>> rows(ARG_BLOCK_HEIGHT, std::vector<T>(ARG_ROW_SIZE));
+    for (size_t i = 0; i < arena.size(); i++) {
+        arena[i] = static_cast<T>(i % 1000);
+        rows[i / ARG_ROW_SIZE][i % ARG_ROW_SIZE] = arena[i];
+    }
+    std::vector<T> block;
+    std::vector<T> expected;
+    double bytes = static_cast<double>(arena.size() * sizeof(T)) * TEST_EPOCHES;
+
+    // Check both give the same block
+    for (uint32_t column = 0; column < ARG_ROW_SIZE; column += ARG_BLOCK_WIDTH) {
+        biomxt::assemble_block(arena.data(), ARG_ROW_SIZE, column, ARG_BLOCK_WIDTH, ARG_BLOCK_HEIGHT, block);
+        assemble_block_by_column(rows, column, ARG_BLOCK_WIDTH, ARG_BLOCK_HEIGHT, expected);
+        if (block != expected) {
+            std::cerr << "Error: " << dtype << " block at column " << column << " mismatch." << std::endl;
+            std::exit(1);
+        }
+    }
+
+    uint64_t start_time = get_timestamp();
+    for (size_t epoch = 0; epoch < TEST_EPOCHES; epoch++) {
+        for (uint32_t column = 0; column < ARG_ROW_SIZE; column += ARG_BLOCK_WIDTH) {
+            biomxt::assemble_block(arena.data(), ARG_ROW_SIZE, column, ARG_BLOCK_WIDTH, ARG_BLOCK_HEIGHT, block);
+        }
+    }
+    double arena_time = static_cast<double>(get_timestamp() - start_time) / 1e6;
+
+    start_time = get_timestamp();
+    for (size_t epoch = 0; epoch < TEST_EPOCHES; epoch++) {
+        for (uint32_t column = 0; column < ARG_ROW_SIZE; column += ARG_BLOCK_WIDTH) {
+            assemble_block_by_column(rows, column, ARG_BLOCK_WIDTH, ARG_BLOCK_HEIGHT, block);
+        }
+    }
+    double column_time = static_cast<double>(get_timestamp() - start_time) / 1e6;
+
+    std::cout << dtype << "\tarena: " << bytes / arena_time / 1e9 << " GB/s"
+              << "\tby column: " << bytes / column_time / 1e9 << " GB/s" << std::endl;
+}
+
+int main() {
+    std::cout << "Block assembly throughput, " << ARG_BLOCK_WIDTH << "x" << ARG_BLOCK_HEIGHT << " blocks out of " << ARG_ROW_SIZE << " columns" << std::endl;
+    run_test<int16_t>("int16");
+    run_test<int32_t>("int32");
+    run_test<int64_t>("int64");
+    run_test<float>("float32");
+    run_test<double>("float64");
+    return 0;
+}
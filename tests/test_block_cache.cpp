@@ -0,0 +1,141 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <cstdint>
+#include <cstdio>
+#include "biomxt/cache/block_cache.hpp"
+#include "test_check.hpp"
+
+
+#define ARG_BLOCK_SIZE              4096
+#define ARG_CACHE_BLOCKS            8
+#define SNAPSHOT_FILE               "test_block_cache.snapshot"
+
+
+// Pinned blocks survive LRU eviction, take at most half of the limit, and go back to LRU once unpinned
+void check_pin(const biomxt::UUID& uuid) {
+    const size_t entry_size = sizeof(biomxt::BlockKey) + ARG_BLOCK_SIZE;
+    biomxt::BlockCache cache;
+    cache.set_memory_limit(entry_size * ARG_CACHE_BLOCKS);
+    auto key = [&](uint64_t block_index) { return biomxt::BlockKey(block_index, uuid); };
+
+    for (uint64_t i = 0; i < ARG_CACHE_BLOCKS; i++) check(cache.insert(key(i), make_block(i, ARG_BLOCK_SIZE)), "block " + std::to_string(i) + " not inserted.");
+    for (uint64_t i = 0; i < ARG_CACHE_BLOCKS / 2; i++) check(cache.pin(key(i)), "block " + std::to_string(i) + " not pinned.");
+    check(!cache.pin(key(ARG_CACHE_BLOCKS / 2)), "pinned blocks exceed half of the memory limit.");
+    check(!cache.insert(key(100), make_block(100, ARG_BLOCK_SIZE), true), "pinned insert exceeds half of the memory limit.");
+    check(cache.get_memory_pinned() == entry_size * ARG_CACHE_BLOCKS / 2, "pinned memory is not counted.");
+
+    // A rejected insert of a resident key keeps the old entry
+    check(!cache.insert(key(0), std::vector<char>(ARG_BLOCK_SIZE * 3), true), "larger pinned block exceeds half of the memory limit.");
+    check(cache.contains(key(0)) && cache.get_memory_pinned() == entry_size * ARG_CACHE_BLOCKS / 2, "rejected insert dropped the pinned block.");
+
+    // A full round of inserts evicts every unpinned block but no pinned one
+    for (uint64_t i = ARG_CACHE_BLOCKS; i < ARG_CACHE_BLOCKS * 3; i++) check(cache.insert(key(i), make_block(i, ARG_BLOCK_SIZE)), "block " + std::to_string(i) + " not inserted next to pinned blocks.");
+    for (uint64_t i = 0; i < ARG_CACHE_BLOCKS / 2; i++) check(cache.contains(key(i)), "pinned block " + std::to_string(i) + " evicted.");
+    for (uint64_t i = ARG_CACHE_BLOCKS / 2; i < ARG_CACHE_BLOCKS * 2; i++) check(!cache.contains(key(i)), "unpinned block " + std::to_string(i) + " not evicted.");
+    check(cache.get_memory_used() <= cache.get_memory_limit(), "memory used exceeds the limit.");
+
+    std::vector<char> buffer;
+    check(cache.get_block_data(key(0), buffer, 0, ARG_BLOCK_SIZE) && buffer == make_block(0, ARG_BLOCK_SIZE), "pinned block data mismatches.");
+
+    // Unpinned block becomes the most recent entry, then ages out like any other
+    check(cache.unpin(key(0)), "block 0 not unpinned.");
+    check(!cache.unpin(key(0)), "block 0 unpinned twice.");
+    check(cache.insert(key(100), make_block(100, ARG_BLOCK_SIZE), true), "pinned insert rejected after unpin.");
+    check(cache.get_memory_pinned() == entry_size * ARG_CACHE_BLOCKS / 2, "pinned memory not updated on unpin.");
+    for (uint64_t i = ARG_CACHE_BLOCKS * 3; i < ARG_CACHE_BLOCKS * 4; i++) cache.insert(key(i), make_block(i, ARG_BLOCK_SIZE));
+    check(!cache.contains(key(0)), "unpinned block 0 not evicted.");
+    check(cache.contains(key(100)), "pinned block 100 evicted.");
+
+    // Lowering the limit evicts unpinned blocks only
+    cache.unpin_all();
+    check(cache.get_memory_pinned() == 0, "pinned memory left after unpin all.");
+    check(cache.pin(key(1)) && cache.pin(key(2)), "blocks 1 and 2 not pinned again.");
+    cache.set_memory_limit(entry_size * 2);
+    check(cache.contains(key(1)) && cache.contains(key(2)) && !cache.contains(key(100)), "lower limit evicts pinned blocks or keeps unpinned ones.");
+    check(cache.pin(key(1)) && cache.get_memory_pinned() == entry_size * 2, "pin of pinned block changes pinned memory.");
+}
+
+// Restored cache holds the same blocks, pinned ones pinned again and the others in the same recency order
+void check_snapshot(const biomxt::UUID& uuid, bool with_payload) {
+    const size_t entry_size = sizeof(biomxt::BlockKey) + ARG_BLOCK_SIZE;
+    auto key = [&](uint64_t block_index) { return biomxt::BlockKey(block_index, uuid); };
+    biomxt::BlockCache cache;
+    cache.set_memory_limit(entry_size * (ARG_CACHE_BLOCKS + 1));
+    for (uint64_t i = 0; i < ARG_CACHE_BLOCKS; i++) cache.insert(key(i), make_block(i, ARG_BLOCK_SIZE), i < 2);
+    // Blocks of another file are skipped on restore
+    cache.insert(biomxt::BlockKey(0, biomxt::UUID::generate()), make_block(0, ARG_BLOCK_SIZE));
+    // Unpinned blocks from most to least recent: 2, 7, 6, 5, 4, 3
+    check(cache.touch(key(2)), "block 2 not resident.");
+    check(cache.save_snapshot(SNAPSHOT_FILE, with_payload) == ARG_CACHE_BLOCKS + 1, "snapshot misses blocks.");
+
+    biomxt::BlockCache restored;
+    restored.set_memory_limit(entry_size * ARG_CACHE_BLOCKS);
+    std::vector<biomxt::BlockKey> pending, pending_pinned;
+    size_t inserted = restored.restore_snapshot(SNAPSHOT_FILE, uuid, ARG_BLOCK_SIZE, pending, pending_pinned);
+    if (with_payload) {
+        check(inserted == ARG_CACHE_BLOCKS && pending.empty() && pending_pinned.empty(), "payloads not restored.");
+    } else {
+        // Caller loads pending blocks, pinned first
+        check(inserted == 0 && pending.size() == ARG_CACHE_BLOCKS - 2 && pending_pinned.size() == 2, "pending keys mismatch.");
+        for (const biomxt::BlockKey& k : pending_pinned) restored.insert(biomxt::BlockKey(k), make_block(k.block_index(), ARG_BLOCK_SIZE), true);
+        for (auto it = pending.rbegin(); it != pending.rend(); ++it) restored.insert(biomxt::BlockKey(*it), make_block(it->block_index(), ARG_BLOCK_SIZE));
+    }
+    check(restored.get_memory_pinned() == entry_size * 2, "pinned blocks not pinned again on restore.");
+
+    std::vector<char> buffer;
+    for (uint64_t i = 0; i < ARG_CACHE_BLOCKS; i++) {
+        check(restored.contains(key(i)), "block " + std::to_string(i) + " not restored.");
+    }
+    // Three new blocks evict the three least recent restored ones, 3, 4 and 5
+    for (uint64_t i = 100; i < 103; i++) restored.insert(key(i), make_block(i, ARG_BLOCK_SIZE));
+    for (uint64_t i = 0; i < ARG_CACHE_BLOCKS; i++) {
+        check(restored.contains(key(i)) == (i < 3 || i > 5), "recency order of block " + std::to_string(i) + " not restored.");
+    }
+    for (uint64_t i : {0, 1, 2, 6, 7}) {
+        check(restored.get_block_data(key(i), buffer, 0, ARG_BLOCK_SIZE) && buffer == make_block(i, ARG_BLOCK_SIZE), "restored block " + std::to_string(i) + " mismatches.");
+    }
+
+    // Smaller cache only reads payloads of the most recent blocks it can hold
+    if (with_payload) {
+        biomxt::BlockCache small;
+        small.set_memory_limit(entry_size * 3);
+        check(small.restore_snapshot(SNAPSHOT_FILE, uuid, ARG_BLOCK_SIZE, pending, pending_pinned) == 3, "payloads beyond memory limit restored.");
+        check(small.contains(key(0)) && small.contains(key(1)) && small.contains(key(2)), "most recent payloads not restored.");
+    }
+    std::remove(SNAPSHOT_FILE);
+}
+
+// Payload size beyond the block size is reported as corruption, not allocated
+void check_corrupted_snapshot(const biomxt::UUID& uuid) {
+    biomxt::BlockCache cache;
+    cache.insert(biomxt::BlockKey(0, uuid), make_block(0, ARG_BLOCK_SIZE));
+    cache.save_snapshot(SNAPSHOT_FILE, true);
+    {
+        // Payload size of the first entry, after the 16 bytes header, UUID and block index
+        std::fstream file(SNAPSHOT_FILE, std::ios::in | std::ios::out | std::ios::binary);
+        uint64_t payload_size = UINT64_MAX / 2;
+        file.seekp(16 + 16 + 8);
+        file.write(reinterpret_cast<const char*>(&payload_size), sizeof(payload_size));
+    }
+    std::vector<biomxt::BlockKey> pending, pending_pinned;
+    bool thrown = false;
+    try {
+        cache.restore_snapshot(SNAPSHOT_FILE, uuid, ARG_BLOCK_SIZE, pending, pending_pinned);
+    } catch (const std::runtime_error& e) {
+        thrown = std::string(e.what()).find("Corrupted snapshot") != std::string::npos;
+    }
+    std::remove(SNAPSHOT_FILE);
+    check(thrown, "corrupted payload size not reported.");
+}
+
+int main() {
+    check_pin(biomxt::UUID::generate());
+    std::cout << "Block cache pin checks passed" << std::endl;
+
+    check_snapshot(biomxt::UUID::generate(), true);
+    check_snapshot(biomxt::UUID::generate(), false);
+    check_corrupted_snapshot(biomxt::UUID::generate());
+    std::cout << "Block cache snapshot checks passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include <cstddef>
+
+
+// Stop the test with a message if a condition does not hold
+inline void check(bool condition, const std::string& message) {
+    if (!condition) {
+        std::cerr << "Error: " << message << std::endl;
+        std::exit(1);
+    }
+}
+
+// Block of a given size whose content is derived from its index, so that a block read back under another index shows
+inline std::vector<char> make_block(uint64_t block_index, size_t size) {
+    std::vector<char> block(size);
+    for (size_t i = 0; i < block.size(); i++) block[i] = static_cast<char>(block_index * 31 + i);
+    return block;
+}
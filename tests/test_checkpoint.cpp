@@ -0,0 +1,112 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include "biomxt/biomxt_writer.hpp"
+#include "biomxt/biomxt_file.hpp"
+#include "biomxt/utils/checkpoint.hpp"
+#include "test_check.hpp"
+
+
+#define OUTPUT_FILE                 "test_checkpoint.bmxt"
+#define ARG_NCOL                    300
+#define ARG_BLOCK_WIDTH             64
+#define ARG_BLOCK_HEIGHT            32
+#define ARG_ROWS_PER_CHECKPOINT     100
+#define ARG_CHECKPOINTS             40
+#define ARG_NROW                    (ARG_ROWS_PER_CHECKPOINT * ARG_CHECKPOINTS + ARG_BLOCK_HEIGHT * 2 + 17)
+
+
+uint64_t get_timestamp() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void write_rows(biomxt::BiomxtWriter<int32_t>& writer, uint32_t row_begin, uint32_t row_end) {
+    std::vector<int32_t> values(ARG_NCOL);
+    for (uint32_t i = row_begin; i < row_end; i++) {
+        for (uint32_t j = 0; j < ARG_NCOL; j++) values[j] = i * 7 + j;
+        writer.write_row("row_" + std::to_string(i), values);
+    }
+}
+
+int main() {
+    const std::string checkpoint_file = biomxt::checkpoint_path(OUTPUT_FILE);
+    std::filesystem::remove(checkpoint_file);
+    std::vector<std::string> colnames;
+    for (uint32_t j = 0; j < ARG_NCOL; j++) colnames.push_back("col_" + std::to_string(j));
+    biomxt::ConvertOptions options;
+    options.block_width = ARG_BLOCK_WIDTH;
+    options.block_height = ARG_BLOCK_HEIGHT;
+    options.threads = 2;
+
+    // Checkpoint every few rows, each one only appends what it adds
+    uint64_t checkpoint_rows = 0;
+    uint64_t sidecar_size = 0;
+    uint64_t max_growth = 0;
+    double checkpoint_time = 0;
+    {
+        biomxt::BiomxtWriter<int32_t> writer(OUTPUT_FILE, colnames, options);
+        for (uint32_t c = 0; c < ARG_CHECKPOINTS; c++) {
+            write_rows(writer, c * ARG_ROWS_PER_CHECKPOINT, (c + 1) * ARG_ROWS_PER_CHECKPOINT);
+            uint64_t start_time = get_timestamp();
+            biomxt::ConvertCheckpoint checkpoint;
+            checkpoint_rows = writer.checkpoint(checkpoint);
+            check(checkpoint.row_offset + checkpoint.rownames.size() == checkpoint_rows, "checkpoint rows mismatch.");
+            check(c == 0 ? !checkpoint.colnames.empty() : checkpoint.colnames.empty() && checkpoint.row_offset > 0, "column names not only in the first checkpoint.");
+            checkpoint.input_offset = checkpoint_rows;
+            biomxt::save_checkpoint(checkpoint_file, checkpoint);
+            checkpoint_time += static_cast<double>(get_timestamp() - start_time) / 1e6;
+
+            uint64_t size = std::filesystem::file_size(checkpoint_file);
+            if (c > 0) max_growth = std::max(max_growth, size - sidecar_size);
+            sidecar_size = size;
+        }
+        // Rows after the last checkpoint are lost with the writer, as in a crash
+        write_rows(writer, ARG_CHECKPOINTS * ARG_ROWS_PER_CHECKPOINT, ARG_CHECKPOINTS * ARG_ROWS_PER_CHECKPOINT + 50);
+    }
+    // Records hold about a checkpoint of rows, not all rows so far
+    check(max_growth < 200 * (ARG_ROWS_PER_CHECKPOINT + ARG_BLOCK_HEIGHT), "checkpoint grows with all rows so far: " + std::to_string(max_growth) + " bytes.");
+
+    // A torn record at the end is dropped and truncated away
+    {
+        std::ofstream sidecar(checkpoint_file, std::ios::binary | std::ios::app);
+        sidecar.write("BMXr\x01\x02\x03", 7);
+    }
+    biomxt::ConvertCheckpoint checkpoint = biomxt::load_checkpoint(checkpoint_file);
+    check(std::filesystem::file_size(checkpoint_file) == sidecar_size, "torn record not truncated.");
+    check(checkpoint.rownames.size() == checkpoint_rows && checkpoint.input_offset == checkpoint_rows && checkpoint.colnames == colnames, "loaded checkpoint mismatches the last one.");
+    check(checkpoint.block_table.size() == checkpoint_rows / ARG_BLOCK_HEIGHT * ((ARG_NCOL + ARG_BLOCK_WIDTH - 1) / ARG_BLOCK_WIDTH), "loaded block table mismatches.");
+
+    // Resume, checkpoint once more on the same sidecar, and finish
+    {
+        biomxt::BiomxtWriter<int32_t> writer(OUTPUT_FILE, checkpoint, options);
+        write_rows(writer, checkpoint_rows, checkpoint_rows + ARG_BLOCK_HEIGHT);
+        biomxt::ConvertCheckpoint resumed;
+        writer.checkpoint(resumed);
+        check(resumed.row_offset == checkpoint_rows && resumed.rownames.size() == ARG_BLOCK_HEIGHT, "resumed checkpoint does not continue the sidecar.");
+        biomxt::save_checkpoint(checkpoint_file, resumed);
+        check(biomxt::load_checkpoint(checkpoint_file).rownames.size() == checkpoint_rows + ARG_BLOCK_HEIGHT, "resumed checkpoint not appended.");
+        write_rows(writer, checkpoint_rows + ARG_BLOCK_HEIGHT, ARG_NROW);
+        writer.finish();
+    }
+
+    biomxt::BiomxtFile file(OUTPUT_FILE);
+    check(file.get_header().nrow == ARG_NROW, "resumed file misses rows.");
+    std::vector<char> buffer;
+    for (uint32_t i = 0; i < ARG_NROW; i++) {
+        check(file.get_row_names()[i] == "row_" + std::to_string(i), "row name " + std::to_string(i) + " mismatches.");
+        file.read_row_data(i, buffer);
+        const int32_t* values = reinterpret_cast<const int32_t*>(buffer.data());
+        for (uint32_t j = 0; j < ARG_NCOL; j++) check(values[j] == static_cast<int32_t>(i * 7 + j), "row " + std::to_string(i) + " mismatches.");
+    }
+    file.close();
+    std::filesystem::remove(OUTPUT_FILE);
+    std::filesystem::remove(checkpoint_file);
+
+    std::cout << ARG_CHECKPOINTS << " checkpoints of " << ARG_ROWS_PER_CHECKPOINT << " rows\tsidecar: " << sidecar_size << " bytes\t" << checkpoint_time * 1e3 / ARG_CHECKPOINTS << " ms/checkpoint" << std::endl;
+    std::cout << "Checkpoint checks passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,139 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <string>
+#include <algorithm>
+#include "biomxt/biomxt_file.hpp"
+#include "biomxt/utils/block_codec.hpp"
+
+
+#define ARG_BLOCK_WIDTH             512
+#define ARG_BLOCK_HEIGHT            512
+#define ARG_BLOCK_COUNT             32
+#define ARG_SMALL_BLOCK             64
+#define ARG_DICTIONARY_SIZE         (32 << 10)
+#define ARG_SPARSITY                0.9
+#define ARG_SPARSE_THRESHOLD        0.3
+#define ARG_MIN_DECODE_SPEED        3000
+#define TEST_EPOCHES                10
+
+
+uint64_t get_timestamp() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Expression-like float32 blocks: mostly zeros, small counts otherwise
+std::vector<std::vector<char>> make_blocks(uint32_t width, uint32_t height, uint32_t count) {
+    std::default_random_engine generator;
+    std::uniform_real_distribution<double> sparsity_dist(0.0, 1.0);
+    std::geometric_distribution<int> count_dist(0.3);
+    std::vector<std::vector<char>> blocks(count);
+    for (auto& block : blocks) {
+        std::vector<float> values(static_cast<size_t>(width) * height);
+        for (float& value : values) {
+            value = sparsity_dist(generator) < ARG_SPARSITY ? 0.0f : static_cast<float>(1 + count_dist(generator));
+        }
+        block.assign(reinterpret_cast<const char*>(values.data()), reinterpret_cast<const char*>(values.data() + values.size()));
+    }
+    return blocks;
+}
+
+// Raw blocks of an existing file, e.g. a real dataset converted by the CLI
+std::vector<std::vector<char>> load_blocks(const std::string& path) {
+    biomxt::BiomxtFile file(path);
+    uint32_t count = std::min<uint32_t>(file.get_header().block_count, ARG_BLOCK_COUNT);
+    std::vector<std::vector<char>> blocks(count);
+    for (uint32_t i = 0; i < count; i++) {
+        file.read_block(i, blocks[i]);
+    }
+    return blocks;
+}
+
+void run_test(const std::vector<std::vector<char>>& blocks, biomxt::CompressAlgorithm algo, const biomxt::BlockDictionary* dictionary = nullptr, float sparse_threshold = 0, const biomxt::CodecPolicy& policy = {}) {
+    const uint8_t flags = biomxt::block_flags(sparse_threshold, biomxt::IntegerCodec::NONE, policy);
+    size_t raw_size = 0;
+    size_t compressed_size = 0;
+    std::vector<std::vector<char>> compressed(blocks.size());
+    uint64_t start_time = get_timestamp();
+    for (size_t i = 0; i < blocks.size(); i++) {
+        compressed[i].resize(biomxt::pack_block(blocks[i].data(), blocks[i].size(), sizeof(float), algo, biomxt::BlockFilter::NONE, sparse_threshold, biomxt::IntegerCodec::NONE, compressed[i], dictionary, policy));
+        raw_size += blocks[i].size();
+        compressed_size += compressed[i].size();
+    }
+    double compress_time = static_cast<double>(get_timestamp() - start_time) / 1e9;
+
+    // Latency of every single block decode, as a reader missing the cache would see it
+    std::vector<char> buffer;
+    std::vector<double> latencies;
+    for (size_t epoch = 0; epoch < TEST_EPOCHES; epoch++) {
+        for (size_t i = 0; i < blocks.size(); i++) {
+            buffer.resize(blocks[i].size());
+            start_time = get_timestamp();
+            biomxt::unpack_block(compressed[i].data(), compressed[i].size(), sizeof(float), algo, biomxt::BlockFilter::NONE, flags, buffer.data(), buffer.size(), dictionary);
+            latencies.push_back(static_cast<double>(get_timestamp() - start_time) / 1e3);
+            if (epoch == 0 && buffer != blocks[i]) {
+                std::cerr << "Error: " << biomxt::algo_to_string(algo) << " block " << i << " mismatch." << std::endl;
+                std::exit(1);
+            }
+        }
+    }
+    std::sort(latencies.begin(), latencies.end());
+    double total = 0;
+    for (double latency : latencies) total += latency;
+
+    std::cout << (policy.adaptive ? "adaptive>=" + std::to_string(policy.min_decode_speed) : biomxt::algo_to_string(algo)) << (dictionary ? "+dict" : "") << (sparse_threshold > 0 ? "+sparse" : "")
+              << "\tratio: " << static_cast<double>(raw_size) / compressed_size << "x"
+              << "\tcompress: " << raw_size / compress_time / 1e6 << " MB/s"
+              << "\tdecode p50: " << latencies[latencies.size() / 2] << " us"
+              << "\tp99: " << latencies[latencies.size() * 99 / 100] << " us"
+              << "\tthroughput: " << raw_size * TEST_EPOCHES / total / 1e3 << " GB/s" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::vector<char>> blocks = argc > 1 ? load_blocks(argv[1]) : make_blocks(ARG_BLOCK_WIDTH, ARG_BLOCK_HEIGHT, ARG_BLOCK_COUNT);
+    if (blocks.empty()) {
+        std::cerr << "Error: No blocks to test." << std::endl;
+        return 1;
+    }
+    std::cout << "Per-block decode latency, " << blocks.size() << " blocks of " << blocks[0].size() / 1024 << " KB"
+              << (argc > 1 ? " from " + std::string(argv[1]) : " of synthetic counts") << std::endl;
+    for (biomxt::CompressAlgorithm algo : {biomxt::CompressAlgorithm::ZSTD, biomxt::CompressAlgorithm::LZ4, biomxt::CompressAlgorithm::LZ4HC, biomxt::CompressAlgorithm::GZIP}) {
+        run_test(blocks, algo);
+    }
+
+    // Bitmap and packed nonzeros instead of dense blocks, the codec sees far less data
+    for (biomxt::CompressAlgorithm algo : {biomxt::CompressAlgorithm::ZSTD, biomxt::CompressAlgorithm::LZ4}) {
+        run_test(blocks, algo, nullptr, ARG_SPARSE_THRESHOLD);
+    }
+
+    // Codec chosen per block, for the smallest block or the smallest one decoding fast enough
+    for (uint32_t min_decode_speed : {0, ARG_MIN_DECODE_SPEED}) {
+        run_test(blocks, biomxt::CompressAlgorithm::ZSTD, nullptr, 0, {true, min_decode_speed});
+    }
+
+    // Codec under a speed limit is chosen from static costs, so the same block always packs to the same bytes
+    std::vector<char> first, second;
+    for (const std::vector<char>& block : blocks) {
+        first.resize(biomxt::pack_block(block.data(), block.size(), sizeof(float), biomxt::CompressAlgorithm::ZSTD, biomxt::BlockFilter::NONE, 0, biomxt::IntegerCodec::NONE, first, nullptr, {true, ARG_MIN_DECODE_SPEED}));
+        second.resize(biomxt::pack_block(block.data(), block.size(), sizeof(float), biomxt::CompressAlgorithm::ZSTD, biomxt::BlockFilter::NONE, 0, biomxt::IntegerCodec::NONE, second, nullptr, {true, ARG_MIN_DECODE_SPEED}));
+        if (first != second) {
+            std::cerr << "Error: adaptive block under a speed limit is not deterministic." << std::endl;
+            return 1;
+        }
+    }
+
+    // Small blocks lose ratio standalone, a dictionary trained on some of them wins it back
+    std::vector<std::vector<char>> small_blocks = make_blocks(ARG_SMALL_BLOCK, ARG_SMALL_BLOCK, ARG_BLOCK_COUNT * 64);
+    std::vector<char> samples;
+    std::vector<size_t> sample_sizes;
+    for (size_t i = 0; i < small_blocks.size(); i += 4) {
+        samples.insert(samples.end(), small_blocks[i].begin(), small_blocks[i].end());
+        sample_sizes.push_back(small_blocks[i].size());
+    }
+    biomxt::BlockDictionary dictionary(biomxt::train_dictionary(samples, sample_sizes, ARG_DICTIONARY_SIZE), true);
+    std::cout << "Small blocks, " << small_blocks.size() << " blocks of " << small_blocks[0].size() / 1024 << " KB, dictionary of " << dictionary.data().size() / 1024 << " KB" << std::endl;
+    run_test(small_blocks, biomxt::CompressAlgorithm::ZSTD);
+    run_test(small_blocks, biomxt::CompressAlgorithm::ZSTD, &dictionary);
+    return 0;
+}
@@ -0,0 +1,115 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include "zlib.h"
+#include "zstd.h"
+#include "biomxt/utils/compressed_reader.hpp"
+#include "test_check.hpp"
+
+
+#define GZIP_FILE                   "test_compressed.csv.gz"
+#define ZSTD_FILE                   "test_compressed.csv.zst"
+#define ARG_MEMBERS                 3
+#define ARG_LINES_PER_MEMBER        20000
+#define ARG_BUFFER_SIZE             (64 * 1024)
+#define ARG_MAX_BUFFERS             2
+
+
+uint64_t get_timestamp() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Csv lines of one member, distinct per member so that a skipped or repeated member shows
+std::string make_text(uint32_t member) {
+    std::string text;
+    for (uint32_t i = 0; i < ARG_LINES_PER_MEMBER; i++) {
+        text += "row_" + std::to_string(member) + "_" + std::to_string(i) + "," + std::to_string(i % 7) + ",0," + std::to_string(member) + "\n";
+    }
+    return text;
+}
+
+// One gzip member, as `gzip` writes it
+std::string gzip_member(const std::string& text) {
+    z_stream stream{};
+    check(deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK, "failed to initialize gzip compression.");
+    std::string member(deflateBound(&stream, text.size()), '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(text.data()));
+    stream.avail_in = text.size();
+    stream.next_out = reinterpret_cast<Bytef*>(member.data());
+    stream.avail_out = member.size();
+    check(deflate(&stream, Z_FINISH) == Z_STREAM_END, "failed to compress gzip member.");
+    member.resize(stream.total_out);
+    deflateEnd(&stream);
+    return member;
+}
+
+// One zstd frame, as `zstd` writes it
+std::string zstd_frame(const std::string& text) {
+    std::string frame(ZSTD_compressBound(text.size()), '\0');
+    size_t size = ZSTD_compress(frame.data(), frame.size(), text.data(), text.size(), 3);
+    check(!ZSTD_isError(size), "failed to compress zstd frame.");
+    frame.resize(size);
+    return frame;
+}
+
+void write_file(const std::string& path, const std::string& content) {
+    std::ofstream file(path, std::ios::binary);
+    file.write(content.data(), content.size());
+}
+
+// Read the whole stream, in buffers no larger than the buffer size
+std::string read_all(const std::string& path, biomxt::TextCompression compression) {
+    biomxt::CompressedReader reader(path, compression, ARG_BUFFER_SIZE, ARG_MAX_BUFFERS);
+    std::string text;
+    std::string buffer;
+    while (reader.next(buffer)) {
+        check(buffer.size() <= ARG_BUFFER_SIZE, "buffer exceeds buffer size.");
+        text += buffer;
+    }
+    return text;
+}
+
+// Concatenated members or frames read as one stream, a truncated stream is reported
+void check_compression(const std::string& path, biomxt::TextCompression compression, std::string (*compress)(const std::string&)) {
+    const std::string name = biomxt::text_compression_to_string(compression);
+    std::string expected;
+    std::string content;
+    for (uint32_t member = 0; member < ARG_MEMBERS; member++) {
+        std::string text = make_text(member);
+        expected += text;
+        content += compress(text);
+    }
+    write_file(path, content);
+    check(biomxt::detect_text_compression(path) == compression, name + ": compression not detected.");
+
+    uint64_t start_time = get_timestamp();
+    std::string text = read_all(path, compression);
+    double cost_time = static_cast<double>(get_timestamp() - start_time) / 1e6;
+    check(text == expected, name + ": " + std::to_string(ARG_MEMBERS) + " concatenated members not read as one stream.");
+    std::cout << "\t" << name << "\t" << content.size() << " -> " << text.size() << " bytes\t" << text.size() / cost_time / 1e6 << " MB/s" << std::endl;
+
+    // Cut inside the last member, and right after the header of a member
+    for (size_t size : {content.size() - 5, content.size() - compress(make_text(ARG_MEMBERS - 1)).size() + 12}) {
+        write_file(path, content.substr(0, size));
+        bool thrown = false;
+        try {
+            read_all(path, compression);
+        } catch (const std::runtime_error& e) {
+            thrown = std::string(e.what()).find("truncated") != std::string::npos;
+        }
+        check(thrown, name + ": stream truncated to " + std::to_string(size) + " bytes not reported.");
+    }
+    std::filesystem::remove(path);
+}
+
+int main() {
+    std::cout << "Reads of " << ARG_MEMBERS << " concatenated members" << std::endl;
+    check_compression(GZIP_FILE, biomxt::TextCompression::GZIP, gzip_member);
+    check_compression(ZSTD_FILE, biomxt::TextCompression::ZSTD, zstd_frame);
+    std::cout << "Compressed reader checks passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <vector>
+#include <random>
+#include <cstddef>
+
+
+// Counts: mostly zeros, small integers otherwise, the same values for every call of the same type and count
+template <typename T> std::vector<T> make_counts(size_t count, double sparsity) {
+    std::default_random_engine generator;
+    std::uniform_real_distribution<double> sparsity_dist(0.0, 1.0);
+    std::geometric_distribution<int> value_dist(0.3);
+    std::vector<T> values(count);
+    for (T& value : values) {
+        value = sparsity_dist(generator) < sparsity ? T(0) : static_cast<T>(value_dist(generator) + 1);
+    }
+    return values;
+}
@@ -1,18 +1,33 @@
 #include <iostream>
 #include <cassert>
-#include "biomxt/internel/utils/csv_parser.hpp"
+#include "biomxt/utils/csv_parser.hpp"
 
 
-void parse_and_show(const std::string& line, char separation = ',') {
+void parse_and_show(const std::string& line, char separation = ',') try {
     size_t count = biomxt::csv_parse_line(line, separation);
     std::vector<std::string> cells(count);
-    biomxt::csv_parse_line(line, cells, separation);
+    if (count > 0) biomxt::csv_parse_line(line, cells, separation);
     std::cout << "Line: [" << line << "]" << std::endl;
     std::cout << "Parsed Cells Count: " << cells.size() << std::endl;
     for(size_t i=0; i<cells.size(); ++i) {
         std::cout << "Cell [" << i << "]: [" << cells[i] << "]" << std::endl;
     }
     std::cout << std::endl;
+} catch (const std::exception& e) {
+    std::cout << "Line: [" << line << "]" << std::endl;
+    std::cout << "Error: " << e.what() << std::endl << std::endl;
+}
+
+void tokenize_and_show(const std::string& line, char separation = ',') {
+    std::vector<std::string_view> cells;
+    std::string unescape_buffer;
+    size_t count = biomxt::csv_tokenize_line(line, cells, separation, unescape_buffer);
+    std::cout << "Line: [" << line << "]" << std::endl;
+    std::cout << "Tokenized Cells Count: " << count << std::endl;
+    for(size_t i=0; i<cells.size(); ++i) {
+        std::cout << "Cell [" << i << "]: [" << cells[i] << "]" << std::endl;
+    }
+    std::cout << std::endl;
 }
 
 int main() {
@@ -24,5 +39,8 @@ int main() {
     parse_and_show("\"Gene A\",1.23,\"Cell \"\"Alpha\", ,\"-0.5e-10");
     parse_and_show("\"Gene A\";1.23;\"Cell \"\"Alpha\"\"\"; ;-0.5e-10", ';');
     parse_and_show("\"Gene A\"\t1.23\t\"Cell \"\"Alpha\"\"\"\t \t-0.5e-10", '\t');
+    tokenize_and_show("\"Gene A\",1.23,\"Cell \"\"Alpha\"\"\", ,-0.5e-10");
+    tokenize_and_show("\"Gene A\"\t1.23\t\"Cell, \"\"Alpha\"\"\"\t \t-0.5e-10\r", '\t');
+    tokenize_and_show("gene_with_a_long_name_over_thirty_two_bytes,0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16");
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,131 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#if !defined(_WIN32)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+#include "biomxt/cache/disk_block_cache.hpp"
+#include "test_check.hpp"
+
+
+#define CACHE_DIRECTORY             "test_disk_cache"
+#define ARG_BLOCK_SIZE              (16 * 1024)
+#define ARG_CACHE_BLOCKS            64
+#define ARG_PROCESSES               4
+#define ARG_WRITES_PER_PROCESS      512
+
+
+uint64_t get_timestamp() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Size of block files actually on disk
+uint64_t directory_size() {
+    uint64_t size = 0;
+    for (const auto& file : std::filesystem::recursive_directory_iterator(CACHE_DIRECTORY)) {
+        if (file.is_regular_file() && file.path().extension() == ".blk") size += file.file_size();
+    }
+    return size;
+}
+
+// Round trip, LRU eviction, corruption detection and re-indexing on open
+void check_cache(const biomxt::UUID& uuid) {
+    const uint64_t file_size = ARG_BLOCK_SIZE + 24;
+    std::vector<char> buffer;
+    {
+        biomxt::DiskBlockCache cache(CACHE_DIRECTORY, file_size * ARG_CACHE_BLOCKS);
+        for (uint64_t i = 0; i < ARG_CACHE_BLOCKS; i++) {
+            std::vector<char> block = make_block(i, ARG_BLOCK_SIZE);
+            check(cache.put({i, uuid}, block.data(), block.size()), "block " + std::to_string(i) + " not written.");
+        }
+        // Block 0 becomes the most recent one, block 1 is evicted by the next write
+        check(cache.get({0, uuid}, buffer, ARG_BLOCK_SIZE) && buffer == make_block(0, ARG_BLOCK_SIZE), "block 0 mismatches.");
+        std::vector<char> block = make_block(ARG_CACHE_BLOCKS, ARG_BLOCK_SIZE);
+        cache.put({ARG_CACHE_BLOCKS, uuid}, block.data(), block.size());
+        check(cache.get({0, uuid}, buffer, ARG_BLOCK_SIZE) && !cache.get({1, uuid}, buffer, ARG_BLOCK_SIZE), "least recent block not evicted.");
+        check(cache.get_disk_used() == file_size * ARG_CACHE_BLOCKS && directory_size() == cache.get_disk_used(), "disk used mismatches the directory.");
+
+        // A corrupted file is detected and removed
+        std::filesystem::path path = std::filesystem::path(CACHE_DIRECTORY) / uuid.to_string() / "2.blk";
+        {
+            std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+            file.seekp(24 + 100);
+            file.put('\x7f');
+        }
+        check(!cache.get({2, uuid}, buffer, ARG_BLOCK_SIZE) && !std::filesystem::exists(path), "corrupted block not removed.");
+    }
+
+    // Reopening indexes the files left, a fresh temporary file may be another writer's and is kept, a stale one is removed
+    std::filesystem::path live_tmp = std::filesystem::path(CACHE_DIRECTORY) / uuid.to_string() / "3.blk.tmp.1.1";
+    std::filesystem::path stale_tmp = std::filesystem::path(CACHE_DIRECTORY) / uuid.to_string() / "4.blk.tmp.1.2";
+    std::ofstream(live_tmp) << "live";
+    std::ofstream(stale_tmp) << "stale";
+    std::filesystem::last_write_time(stale_tmp, std::filesystem::file_time_type::clock::now() - std::chrono::hours(2));
+    biomxt::DiskBlockCache cache(CACHE_DIRECTORY, file_size * ARG_CACHE_BLOCKS);
+    check(cache.get_disk_used() == file_size * (ARG_CACHE_BLOCKS - 1), "blocks not indexed on open.");
+    check(std::filesystem::exists(live_tmp) && !std::filesystem::exists(stale_tmp), "temporary files not told apart by age.");
+    for (uint64_t i = 3; i <= ARG_CACHE_BLOCKS; i++) {
+        check(cache.get({i, uuid}, buffer, ARG_BLOCK_SIZE) && buffer == make_block(i, ARG_BLOCK_SIZE), "reindexed block " + std::to_string(i) + " mismatches.");
+    }
+    std::filesystem::remove_all(CACHE_DIRECTORY);
+}
+
+#if !defined(_WIN32)
+// Processes write the same blocks into one directory, no write fails, every hit is intact and capacity holds for the directory
+void run_process(uint32_t process, const biomxt::UUID& uuid) {
+    const uint64_t capacity = (ARG_BLOCK_SIZE + 24) * ARG_CACHE_BLOCKS;
+    biomxt::DiskBlockCache cache(CACHE_DIRECTORY, capacity);
+    std::vector<char> buffer;
+    uint64_t hits = 0;
+    uint64_t start_time = get_timestamp();
+    for (uint64_t i = 0; i < ARG_WRITES_PER_PROCESS; i++) {
+        // All processes write the same block at about the same time
+        uint64_t block_index = (i * 7) % (ARG_CACHE_BLOCKS * 4);
+        std::vector<char> block = make_block(block_index, ARG_BLOCK_SIZE);
+        check(cache.put({block_index, uuid}, block.data(), block.size()), "process " + std::to_string(process) + " failed to write block " + std::to_string(block_index) + ".");
+        uint64_t read_index = (i * 7 + process * 3) % (ARG_CACHE_BLOCKS * 4);
+        if (cache.get({read_index, uuid}, buffer, ARG_BLOCK_SIZE)) {
+            check(buffer == make_block(read_index, ARG_BLOCK_SIZE), "process " + std::to_string(process) + " read a broken block " + std::to_string(read_index) + ".");
+            hits++;
+        }
+    }
+    double cost_time = static_cast<double>(get_timestamp() - start_time) / 1e6;
+    std::cout << "\tprocess " << process << "\thits: " << hits << "\t" << cost_time * 1e6 / ARG_WRITES_PER_PROCESS << " us/block" << std::endl;
+}
+
+void check_processes(const biomxt::UUID& uuid) {
+    const uint64_t capacity = (ARG_BLOCK_SIZE + 24) * ARG_CACHE_BLOCKS;
+    std::cout << "Shared directory of " << ARG_PROCESSES << " processes, " << ARG_CACHE_BLOCKS * 4 << " blocks over " << ARG_CACHE_BLOCKS << " blocks of capacity" << std::endl;
+    std::vector<pid_t> children;
+    for (uint32_t process = 0; process < ARG_PROCESSES; process++) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            run_process(process, uuid);
+            _exit(0);
+        }
+        children.push_back(pid);
+    }
+    for (pid_t pid : children) {
+        int status = 0;
+        waitpid(pid, &status, 0);
+        check(WIFEXITED(status) && WEXITSTATUS(status) == 0, "writer process failed.");
+    }
+    check(directory_size() <= capacity + capacity / 8 * ARG_PROCESSES, "processes together exceed capacity by " + std::to_string(directory_size() - capacity) + " bytes.");
+    std::filesystem::remove_all(CACHE_DIRECTORY);
+}
+#endif
+
+int main() {
+    std::filesystem::remove_all(CACHE_DIRECTORY);
+    check_cache(biomxt::UUID::generate());
+    std::cout << "Disk cache checks passed" << std::endl;
+#if !defined(_WIN32)
+    check_processes(biomxt::UUID::generate());
+    std::cout << "Disk cache process checks passed" << std::endl;
+#endif
+    return 0;
+}
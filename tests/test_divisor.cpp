@@ -0,0 +1,77 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdint>
+#include "biomxt/utils/fast_divisor.hpp"
+
+
+#define ARG_INDEX_COUNT             (1 << 22)
+#define TEST_EPOCHES                20
+
+
+uint64_t get_timestamp() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Quotient and remainder match hardware division, around 32-bit boundaries too
+void check_divisor(uint32_t divisor, const std::vector<uint64_t>& indices) {
+    biomxt::FastDivisor fast(divisor);
+    for (uint64_t n : indices) {
+        if (fast.divide(n) != n / divisor || fast.remainder(n) != n % divisor) {
+            std::cerr << "Error: " << n << " divided by " << divisor << " gives " << fast.divide(n) << " remainder " << fast.remainder(n) << "." << std::endl;
+            std::exit(1);
+        }
+    }
+}
+
+// Divide every index, volatile divisor keeps the compiler from folding hardware division
+void run_test(uint32_t divisor, const std::vector<uint64_t>& indices) {
+    volatile uint32_t hardware_divisor = divisor;
+    const uint64_t d = hardware_divisor;
+    biomxt::FastDivisor fast(divisor);
+    uint64_t sum = 0;
+
+    uint64_t start_time = get_timestamp();
+    for (size_t epoch = 0; epoch < TEST_EPOCHES; epoch++) {
+        for (uint64_t n : indices) sum += n / d + n % d;
+    }
+    double hardware_time = static_cast<double>(get_timestamp() - start_time) / 1e6;
+
+    start_time = get_timestamp();
+    for (size_t epoch = 0; epoch < TEST_EPOCHES; epoch++) {
+        for (uint64_t n : indices) sum -= fast.divide(n) + fast.remainder(n);
+    }
+    double fast_time = static_cast<double>(get_timestamp() - start_time) / 1e6;
+
+    std::cout << "\tdivisor " << divisor
+              << "\thardware: " << hardware_time * 1e9 / (static_cast<double>(indices.size()) * TEST_EPOCHES) << " ns"
+              << "\tfast: " << fast_time * 1e9 / (static_cast<double>(indices.size()) * TEST_EPOCHES) << " ns"
+              << (sum == 0 ? "" : "\tMISMATCH") << std::endl;
+    if (sum != 0) std::exit(1);
+}
+
+int main() {
+    std::default_random_engine generator;
+    std::uniform_int_distribution<uint64_t> small_dist(0, UINT32_MAX);
+    std::uniform_int_distribution<uint64_t> large_dist(0, UINT64_MAX);
+    std::vector<uint64_t> indices;
+    for (uint64_t n = 0; n < 100000; n++) indices.push_back(n);
+    for (uint64_t n = UINT32_MAX - 100000; n <= static_cast<uint64_t>(UINT32_MAX) + 100000; n++) indices.push_back(n);
+    for (size_t i = 0; i < 100000; i++) indices.push_back(large_dist(generator));
+    indices.push_back(UINT64_MAX);
+
+    for (uint32_t divisor : {1u, 2u, 3u, 7u, 37u, 100u, 500u, 512u, 641u, 1000u, 4096u, 65535u, 1000003u, 0x7FFFFFFFu, 0x80000000u, UINT32_MAX}) {
+        check_divisor(divisor, indices);
+    }
+    std::uniform_int_distribution<uint32_t> divisor_dist(1, UINT32_MAX);
+    for (size_t i = 0; i < 1000; i++) check_divisor(divisor_dist(generator), indices);
+    std::cout << "Fast divisor checks passed" << std::endl;
+
+    // Row indices of a file, all within 32 bits
+    std::vector<uint64_t> rows(ARG_INDEX_COUNT);
+    for (uint64_t& n : rows) n = small_dist(generator);
+    std::cout << "Row index division, " << ARG_INDEX_COUNT << " indices" << std::endl;
+    for (uint32_t divisor : {512u, 500u, 37u}) run_test(divisor, rows);
+    return 0;
+}
@@ -0,0 +1,143 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <string>
+#include <cstring>
+#include <cmath>
+#include "biomxt/struct/data_type.hpp"
+#include "biomxt/utils/block_codec.hpp"
+#include "biomxt/utils/expand_float.hpp"
+
+
+#define ARG_BLOCK_WIDTH             512
+#define ARG_BLOCK_HEIGHT            512
+#define ARG_SPARSITY                0.8
+#define TEST_EPOCHES                50
+
+
+uint64_t get_timestamp() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool same_float(float a, float b) {
+    if (std::isnan(a) || std::isnan(b)) return std::isnan(a) && std::isnan(b);
+    uint32_t ua, ub;
+    std::memcpy(&ua, &a, sizeof(ua));
+    std::memcpy(&ub, &b, sizeof(ub));
+    return ua == ub;
+}
+
+// Every 16-bit pattern: SIMD expansion matches scalar, and quantizing the expanded value gives the pattern back
+void check_exhaustive(biomxt::DataType dtype) {
+    std::vector<uint16_t> bits(65536);
+    for (size_t i = 0; i < bits.size(); i++) bits[i] = static_cast<uint16_t>(i);
+    std::vector<float> expanded(bits.size());
+    biomxt::expand_to_float(reinterpret_cast<const char*>(bits.data()), bits.size(), dtype, expanded.data());
+
+    const bool half = dtype == biomxt::DataType::FLOAT16;
+    for (size_t i = 0; i < bits.size(); i++) {
+        const float scalar = half ? biomxt::half_bits_to_float(bits[i]) : biomxt::bfloat16_bits_to_float(bits[i]);
+        const uint16_t requantized = half ? biomxt::float_to_half_bits(scalar) : biomxt::float_to_bfloat16_bits(scalar);
+        if (!same_float(scalar, expanded[i]) || (!std::isnan(scalar) && requantized != bits[i])) {
+            std::cerr << "Error: " << biomxt::dtype_to_string(dtype) << " bits " << bits[i] << " expand to " << expanded[i] << ", scalar " << scalar << "." << std::endl;
+            std::exit(1);
+        }
+    }
+}
+
+// Midpoints between neighbouring halves round to the even one, anything off a midpoint to the nearest
+void check_half_rounding() {
+    for (uint32_t bits = 0; bits < 0x7BFF; bits++) {
+        const float low = biomxt::half_bits_to_float(static_cast<uint16_t>(bits));
+        const float high = biomxt::half_bits_to_float(static_cast<uint16_t>(bits + 1));
+        const float mid = low + (high - low) / 2;
+        const uint16_t even = (bits & 1) ? static_cast<uint16_t>(bits + 1) : static_cast<uint16_t>(bits);
+        if (biomxt::float_to_half_bits(mid) != even
+            || biomxt::float_to_half_bits(std::nextafter(mid, low)) != bits
+            || biomxt::float_to_half_bits(std::nextafter(mid, high)) != bits + 1) {
+            std::cerr << "Error: float16 rounding between bits " << bits << " and " << bits + 1 << "." << std::endl;
+            std::exit(1);
+        }
+    }
+    if (biomxt::float_to_half_bits(65520.0f) != 0x7C00 || biomxt::float_to_half_bits(65519.0f) != 0x7BFF) {
+        std::cerr << "Error: float16 overflow rounding." << std::endl;
+        std::exit(1);
+    }
+}
+
+// Integer expansion over ragged lengths, so that every scalar tail is taken
+template <typename T> void check_integers(biomxt::DataType dtype) {
+    std::vector<T> values(1000);
+    for (size_t i = 0; i < values.size(); i++) values[i] = static_cast<T>(i * 2654435761u);
+    std::vector<float> expanded(values.size());
+    for (size_t count : {0, 1, 7, 15, 16, 17, 999, 1000}) {
+        std::fill(expanded.begin(), expanded.end(), -1.0f);
+        biomxt::expand_to_float(reinterpret_cast<const char*>(values.data()), count, dtype, expanded.data());
+        for (size_t i = 0; i < values.size(); i++) {
+            const float expected = i < count ? static_cast<float>(values[i]) : -1.0f;
+            if (expanded[i] != expected) {
+                std::cerr << "Error: " << biomxt::dtype_to_string(dtype) << " expansion of " << count << " values mismatches at " << i << "." << std::endl;
+                std::exit(1);
+            }
+        }
+    }
+}
+
+// Normalized expression: mostly zeros, log-normal otherwise
+std::vector<float> make_expression(size_t count) {
+    std::default_random_engine generator;
+    std::uniform_real_distribution<double> sparsity_dist(0.0, 1.0);
+    std::lognormal_distribution<float> value_dist(0.0f, 1.0f);
+    std::vector<float> values(count);
+    for (float& value : values) {
+        value = sparsity_dist(generator) < ARG_SPARSITY ? 0.0f : value_dist(generator);
+    }
+    return values;
+}
+
+template <typename T> void run_test(const std::vector<float>& block, size_t float_packed_size) {
+    const biomxt::DataType dtype = biomxt::dtype_from_type<T>::value;
+    std::vector<T> stored(block.begin(), block.end());
+    const char* raw = reinterpret_cast<const char*>(stored.data());
+    const size_t size = stored.size() * sizeof(T);
+    std::vector<char> packed;
+    size_t packed_size = biomxt::pack_block(raw, size, sizeof(T), biomxt::CompressAlgorithm::ZSTD, biomxt::BlockFilter::SHUFFLE, 0, biomxt::IntegerCodec::NONE, packed);
+
+    double max_error = 0;
+    std::vector<float> expanded(stored.size());
+    biomxt::expand_to_float(raw, stored.size(), dtype, expanded.data());
+    for (size_t i = 0; i < block.size(); i++) {
+        if (block[i] != 0) max_error = std::max(max_error, std::fabs(static_cast<double>(expanded[i]) - block[i]) / block[i]);
+    }
+
+    uint64_t start_time = get_timestamp();
+    for (size_t epoch = 0; epoch < TEST_EPOCHES; epoch++) {
+        biomxt::expand_to_float(raw, stored.size(), dtype, expanded.data());
+    }
+    double expand_time = static_cast<double>(get_timestamp() - start_time) / 1e6;
+
+    std::cout << "\t" << biomxt::dtype_to_string(dtype)
+              << "\tsize vs float32: " << static_cast<double>(packed_size) / float_packed_size
+              << "\tmax rel error: " << max_error
+              << "\texpand: " << static_cast<double>(stored.size()) * sizeof(float) * TEST_EPOCHES / expand_time / 1e9 << " GB/s of float" << std::endl;
+}
+
+int main() {
+    check_exhaustive(biomxt::DataType::FLOAT16);
+    check_exhaustive(biomxt::DataType::BFLOAT16);
+    check_half_rounding();
+    check_integers<uint8_t>(biomxt::DataType::UINT8);
+    check_integers<uint16_t>(biomxt::DataType::UINT16);
+    std::cout << "Reduced float checks passed" << std::endl;
+
+    std::vector<float> block = make_expression(static_cast<size_t>(ARG_BLOCK_WIDTH) * ARG_BLOCK_HEIGHT);
+    std::vector<char> packed;
+    size_t float_packed_size = biomxt::pack_block(reinterpret_cast<const char*>(block.data()), block.size() * sizeof(float), sizeof(float), biomxt::CompressAlgorithm::ZSTD, biomxt::BlockFilter::SHUFFLE, 0, biomxt::IntegerCodec::NONE, packed);
+
+    std::cout << "Reduced floats on " << ARG_BLOCK_WIDTH << "x" << ARG_BLOCK_HEIGHT << " blocks of expression, " << ARG_SPARSITY * 100 << "% zeros, zstd+shuffle" << std::endl;
+    run_test<float>(block, float_packed_size);
+    run_test<biomxt::float16>(block, float_packed_size);
+    run_test<biomxt::bfloat16>(block, float_packed_size);
+    return 0;
+}
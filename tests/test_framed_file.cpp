@@ -0,0 +1,120 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include "biomxt/biomxt_writer.hpp"
+#include "biomxt/biomxt_file.hpp"
+#include "biomxt/cache/block_cache.hpp"
+#include "biomxt/cache/disk_block_cache.hpp"
+#include "test_check.hpp"
+#include "test_counts.hpp"
+
+
+#define OUTPUT_FILE                 "test_framed_file.bmxt"
+#define CACHE_DIRECTORY             "test_framed_file_cache"
+#define ARG_NROW                    301
+#define ARG_NCOL                    207
+#define ARG_BLOCK_WIDTH             64
+#define ARG_BLOCK_HEIGHT            64
+#define ARG_FRAME_HEIGHT            6
+#define ARG_SPARSITY                0.8
+
+
+uint64_t get_timestamp() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void write_file(const std::vector<int32_t>& dense, bool column_major) {
+    std::vector<std::string> colnames;
+    for (uint32_t j = 0; j < ARG_NCOL; j++) colnames.push_back("col_" + std::to_string(j));
+    biomxt::ConvertOptions options;
+    options.block_width = ARG_BLOCK_WIDTH;
+    options.block_height = ARG_BLOCK_HEIGHT;
+    options.frame_height = ARG_FRAME_HEIGHT;
+    options.column_major = column_major;
+    options.sparse_threshold = 0.5f;
+    options.threads = 2;
+    biomxt::BiomxtWriter<int32_t> writer(OUTPUT_FILE, colnames, options);
+    for (uint32_t i = 0; i < ARG_NROW; i++) {
+        writer.write_row("row_" + std::to_string(i), std::vector<int32_t>(dense.begin() + static_cast<size_t>(i) * ARG_NCOL, dense.begin() + static_cast<size_t>(i + 1) * ARG_NCOL));
+    }
+    writer.finish();
+}
+
+// Every row read with a hint matches the dense reference, returns seconds spent
+double check_rows(biomxt::BiomxtFile& file, const std::vector<int32_t>& dense, biomxt::AccessHint hint, const std::string& name) {
+    std::vector<char> buffer;
+    uint64_t start_time = get_timestamp();
+    for (uint32_t i = 0; i < ARG_NROW; i++) {
+        file.read_row_data(i, buffer, hint);
+        const int32_t* values = reinterpret_cast<const int32_t*>(buffer.data());
+        for (uint32_t j = 0; j < ARG_NCOL; j++) {
+            check(values[j] == dense[static_cast<size_t>(i) * ARG_NCOL + j], name + ": row " + std::to_string(i) + " mismatches at column " + std::to_string(j) + ".");
+        }
+    }
+    return static_cast<double>(get_timestamp() - start_time) / 1e6;
+}
+
+// Every column read with a hint matches the dense reference, returns seconds spent
+double check_columns(biomxt::BiomxtFile& file, const std::vector<int32_t>& dense, biomxt::AccessHint hint, const std::string& name) {
+    std::vector<char> buffer;
+    uint64_t start_time = get_timestamp();
+    for (uint32_t j = 0; j < ARG_NCOL; j++) {
+        file.read_column_data(j, buffer, hint);
+        const int32_t* values = reinterpret_cast<const int32_t*>(buffer.data());
+        for (uint32_t i = 0; i < ARG_NROW; i++) {
+            check(values[i] == dense[static_cast<size_t>(i) * ARG_NCOL + j], name + ": column " + std::to_string(j) + " mismatches at row " + std::to_string(i) + ".");
+        }
+    }
+    return static_cast<double>(get_timestamp() - start_time) / 1e6;
+}
+
+// Lines along frames, i.e. rows of row-major blocks or columns of column-major blocks
+double check_lines(biomxt::BiomxtFile& file, const std::vector<int32_t>& dense, bool column_major, biomxt::AccessHint hint, const std::string& name) {
+    return column_major ? check_columns(file, dense, hint, name) : check_rows(file, dense, hint, name);
+}
+
+void check_layout(const std::vector<int32_t>& dense, bool column_major) {
+    const std::string layout = column_major ? "column-major" : "row-major";
+    write_file(dense, column_major);
+    biomxt::BlockCache block_cache;
+    biomxt::BiomxtFile file(OUTPUT_FILE, &block_cache);
+    check((file.get_header().flags & biomxt::FileFlag::HAS_BLOCK_FRAMES) != 0, layout + ": file not framed.");
+
+    // Frame-wise reads leave the block cache empty
+    double random_time = check_lines(file, dense, column_major, biomxt::AccessHint::RANDOM, layout + " random");
+    check_lines(file, dense, column_major, biomxt::AccessHint::NOCACHE, layout + " nocache");
+    check(block_cache.get_memory_used() == 0, layout + ": frame-wise reads entered the block cache.");
+
+    // With disk cache whole stored blocks are read and kept on disk
+    std::filesystem::remove_all(CACHE_DIRECTORY);
+    {
+        biomxt::DiskBlockCache disk_cache(CACHE_DIRECTORY, 64 * 1024 * 1024);
+        file.set_disk_cache(&disk_cache);
+        check_lines(file, dense, column_major, biomxt::AccessHint::RANDOM, layout + " random with disk cache");
+        check(disk_cache.get_disk_used() > 0, layout + ": frame-wise reads skipped the disk cache.");
+        check_lines(file, dense, column_major, biomxt::AccessHint::RANDOM, layout + " random from disk cache");
+        file.set_disk_cache(nullptr);
+    }
+    std::filesystem::remove_all(CACHE_DIRECTORY);
+
+    // Whole blocks enter the block cache, then serve lines as they are
+    double normal_time = check_lines(file, dense, column_major, biomxt::AccessHint::NORMAL, layout + " normal");
+    check(block_cache.get_memory_used() > 0, layout + ": whole blocks not cached.");
+    check_lines(file, dense, column_major, biomxt::AccessHint::RANDOM, layout + " random from block cache");
+    check_lines(file, dense, !column_major, biomxt::AccessHint::NORMAL, layout + " across frames");
+    file.close();
+    std::cout << "\t" << layout << "\trandom: " << random_time * 1e3 << " ms\tnormal: " << normal_time * 1e3 << " ms" << std::endl;
+}
+
+int main() {
+    std::vector<int32_t> dense = make_counts<int32_t>(static_cast<size_t>(ARG_NROW) * ARG_NCOL, ARG_SPARSITY);
+    std::cout << "All rows and columns of a " << ARG_NROW << "x" << ARG_NCOL << " file, frames of " << ARG_FRAME_HEIGHT << std::endl;
+    check_layout(dense, false);
+    check_layout(dense, true);
+    std::filesystem::remove(OUTPUT_FILE);
+    std::cout << "Framed file checks passed" << std::endl;
+    return 0;
+}
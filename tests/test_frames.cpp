@@ -0,0 +1,97 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstring>
+#include "biomxt/utils/block_codec.hpp"
+#include "test_counts.hpp"
+
+
+#define ARG_BLOCK_WIDTH             512
+#define ARG_BLOCK_HEIGHT            512
+#define ARG_SPARSITY                0.8
+#define ARG_ROW_READS               2000
+
+
+uint64_t get_timestamp() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Whole framed block and every single frame unpack to the raw block, ragged last frames included
+void check_frames(const std::vector<float>& block, uint32_t width, uint32_t frame_height, uint8_t flags, float sparse_threshold) {
+    const char* raw = reinterpret_cast<const char*>(block.data());
+    const size_t size = block.size() * sizeof(float);
+    const size_t row_size = width * sizeof(float);
+    std::vector<char> packed;
+    size_t packed_size = biomxt::pack_framed_block(raw, size, sizeof(float), row_size, frame_height, biomxt::CompressAlgorithm::ZSTD, biomxt::BlockFilter::SHUFFLE, sparse_threshold, biomxt::IntegerCodec::NONE, packed);
+
+    std::vector<char> unpacked(size);
+    biomxt::unpack_framed_block(packed.data(), packed_size, sizeof(float), row_size, frame_height, biomxt::CompressAlgorithm::ZSTD, biomxt::BlockFilter::SHUFFLE, flags, unpacked.data(), size);
+    bool ok = std::memcmp(unpacked.data(), raw, size) == 0;
+
+    std::vector<char> frame(frame_height * row_size);
+    const size_t frames = biomxt::frame_count(size / row_size, frame_height);
+    for (size_t f = 0; ok && f < frames; f++) {
+        size_t frame_size = biomxt::unpack_block_frame(packed.data(), packed_size, sizeof(float), row_size, frame_height, size, f, biomxt::CompressAlgorithm::ZSTD, biomxt::BlockFilter::SHUFFLE, flags, frame.data());
+        ok = std::memcmp(frame.data(), raw + f * frame_height * row_size, frame_size) == 0;
+    }
+    if (!ok) {
+        std::cerr << "Error: framed block of width " << width << " and frame height " << frame_height << " does not unpack to its raw block." << std::endl;
+        std::exit(1);
+    }
+}
+
+void run_test(const std::vector<float>& block, uint32_t frame_height) {
+    const char* raw = reinterpret_cast<const char*>(block.data());
+    const size_t size = block.size() * sizeof(float);
+    const size_t row_size = ARG_BLOCK_WIDTH * sizeof(float);
+    std::vector<char> whole, framed;
+    size_t whole_size = biomxt::pack_block(raw, size, sizeof(float), biomxt::CompressAlgorithm::ZSTD, biomxt::BlockFilter::SHUFFLE, 0, biomxt::IntegerCodec::NONE, whole);
+    size_t framed_size = biomxt::pack_framed_block(raw, size, sizeof(float), row_size, frame_height, biomxt::CompressAlgorithm::ZSTD, biomxt::BlockFilter::SHUFFLE, 0, biomxt::IntegerCodec::NONE, framed);
+
+    std::default_random_engine generator;
+    std::uniform_int_distribution<size_t> row_dist(0, ARG_BLOCK_HEIGHT - 1);
+    std::vector<size_t> rows(ARG_ROW_READS);
+    for (size_t& row : rows) row = row_dist(generator);
+    std::vector<char> buffer(size);
+    std::vector<char> row_buffer(row_size);
+
+    // One row out of a whole block
+    uint64_t start_time = get_timestamp();
+    for (size_t row : rows) {
+        biomxt::unpack_block(whole.data(), whole_size, sizeof(float), biomxt::CompressAlgorithm::ZSTD, biomxt::BlockFilter::SHUFFLE, 0, buffer.data(), size);
+        std::memcpy(row_buffer.data(), buffer.data() + row * row_size, row_size);
+    }
+    double whole_time = static_cast<double>(get_timestamp() - start_time) / 1e6;
+
+    // One row out of its frame
+    start_time = get_timestamp();
+    for (size_t row : rows) {
+        biomxt::unpack_block_frame(framed.data(), framed_size, sizeof(float), row_size, frame_height, size, row / frame_height, biomxt::CompressAlgorithm::ZSTD, biomxt::BlockFilter::SHUFFLE, 0, buffer.data());
+        std::memcpy(row_buffer.data(), buffer.data() + (row % frame_height) * row_size, row_size);
+    }
+    double frame_time = static_cast<double>(get_timestamp() - start_time) / 1e6;
+
+    std::cout << "\tframe height " << frame_height
+              << "\tsize vs whole: " << static_cast<double>(framed_size) / whole_size
+              << "\twhole block: " << whole_time * 1e6 / ARG_ROW_READS << " us/row"
+              << "\tframe: " << frame_time * 1e6 / ARG_ROW_READS << " us/row"
+              << "\tspeedup: " << whole_time / frame_time << "x" << std::endl;
+}
+
+int main() {
+    // Widths and frame heights that leave a short last frame, with and without sparse frames
+    for (uint32_t width : {1u, 7u, 100u}) {
+        std::vector<float> block = make_counts<float>(static_cast<size_t>(width) * 37, ARG_SPARSITY);
+        for (uint32_t frame_height : {1u, 4u, 36u, 37u, 64u}) {
+            check_frames(block, width, frame_height, 0, 0);
+            check_frames(block, width, frame_height, biomxt::FileFlag::HAS_BLOCK_ENCODING, 0.3f);
+        }
+    }
+    std::cout << "Framed block checks passed" << std::endl;
+
+    std::vector<float> block = make_counts<float>(static_cast<size_t>(ARG_BLOCK_WIDTH) * ARG_BLOCK_HEIGHT, ARG_SPARSITY);
+    std::cout << "Single row reads on " << ARG_BLOCK_WIDTH << "x" << ARG_BLOCK_HEIGHT << " blocks of counts, " << ARG_SPARSITY * 100 << "% zeros, zstd+shuffle" << std::endl;
+    for (uint32_t frame_height : {4u, 16u, 64u}) run_test(block, frame_height);
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <string>
+#include <cstring>
+#include <limits>
+#include "biomxt/utils/block_codec.hpp"
+#include "biomxt/utils/int_codec.hpp"
+#include "test_counts.hpp"
+
+
+#define ARG_BLOCK_WIDTH             512
+#define ARG_BLOCK_HEIGHT            512
+#define ARG_SPARSITY                0.8
+#define TEST_EPOCHES                20
+
+
+uint64_t get_timestamp() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Round trip of every codec, including extremes and a ragged group
+template <typename T> void check_round_trip(const std::string& dtype) {
+    std::vector<T> values = make_counts<T>(1000, ARG_SPARSITY);
+    values[3] = std::numeric_limits<T>::min();
+    values[4] = std::numeric_limits<T>::max();
+    values[500] = -7;
+    const char* raw = reinterpret_cast<const char*>(values.data());
+    const size_t size = values.size() * sizeof(T);
+    std::vector<char> encoded;
+    std::vector<T> decoded(values.size());
+    char* out = reinterpret_cast<char*>(decoded.data());
+
+    biomxt::for_encode(raw, size, sizeof(T), encoded);
+    biomxt::for_decode(encoded.data(), encoded.size(), size, sizeof(T), out);
+    bool ok = decoded == values;
+    biomxt::delta_encode(raw, size, sizeof(T), encoded);
+    biomxt::delta_decode(encoded.data(), encoded.size(), size, sizeof(T), out);
+    ok = ok && decoded == values;
+    biomxt::fixed_encode(raw, size, sizeof(T), encoded);
+    biomxt::fixed_decode(encoded.data(), encoded.size(), size, sizeof(T), out);
+    ok = ok && decoded == values;
+    if (!ok) {
+        std::cerr << "Error: " << dtype << " integer codec round trip mismatch." << std::endl;
+        std::exit(1);
+    }
+}
+
+template <typename T> void run_test(const std::string& dtype) {
+    check_round_trip<T>(dtype);
+
+    std::vector<T> block = make_counts<T>(static_cast<size_t>(ARG_BLOCK_WIDTH) * ARG_BLOCK_HEIGHT, ARG_SPARSITY);
+    const char* raw = reinterpret_cast<const char*>(block.data());
+    const size_t size = block.size() * sizeof(T);
+    std::vector<char> packed;
+    std::vector<char> restored(size);
+
+    std::cout << dtype << std::endl;
+    for (biomxt::IntegerCodec codec : {biomxt::IntegerCodec::NONE, biomxt::IntegerCodec::FOR, biomxt::IntegerCodec::DELTA, biomxt::IntegerCodec::FIXED}) {
+        for (biomxt::CompressAlgorithm algo : {biomxt::CompressAlgorithm::STORE, biomxt::CompressAlgorithm::ZSTD, biomxt::CompressAlgorithm::LZ4}) {
+            if (codec == biomxt::IntegerCodec::NONE && algo == biomxt::CompressAlgorithm::STORE) continue;
+            const uint8_t flags = biomxt::block_flags(0, codec, {});
+            size_t packed_size = biomxt::pack_block(raw, size, sizeof(T), algo, biomxt::BlockFilter::NONE, 0, codec, packed);
+            biomxt::unpack_block(packed.data(), packed_size, sizeof(T), algo, biomxt::BlockFilter::NONE, flags, restored.data(), size);
+            if (std::memcmp(raw, restored.data(), size) != 0) {
+                std::cerr << "Error: " << dtype << " " << biomxt::integer_codec_to_string(codec) << "+" << biomxt::algo_to_string(algo) << " round trip mismatch." << std::endl;
+                std::exit(1);
+            }
+
+            uint64_t start_time = get_timestamp();
+            for (size_t epoch = 0; epoch < TEST_EPOCHES; epoch++) {
+                biomxt::unpack_block(packed.data(), packed_size, sizeof(T), algo, biomxt::BlockFilter::NONE, flags, restored.data(), size);
+            }
+            double decode_time = static_cast<double>(get_timestamp() - start_time) / 1e6;
+
+            std::cout << "\t" << biomxt::integer_codec_to_string(codec) << "+" << biomxt::algo_to_string(algo)
+                      << "\tratio: " << static_cast<double>(size) / packed_size << "x"
+                      << "\tdecode: " << static_cast<double>(size) * TEST_EPOCHES / decode_time / 1e9 << " GB/s" << std::endl;
+        }
+    }
+}
+
+int main() {
+    std::cout << "Integer codecs on " << ARG_BLOCK_WIDTH << "x" << ARG_BLOCK_HEIGHT << " blocks of counts, " << ARG_SPARSITY * 100 << "% zeros" << std::endl;
+    run_test<int16_t>("int16");
+    run_test<int32_t>("int32");
+    return 0;
+}
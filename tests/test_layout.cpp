@@ -0,0 +1,151 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <string>
+#include <cstring>
+#include <filesystem>
+#include "biomxt/utils/block_codec.hpp"
+#include "biomxt/utils/block_pipeline.hpp"
+#include "biomxt/biomxt_writer.hpp"
+#include "biomxt/biomxt_file.hpp"
+#include "test_counts.hpp"
+
+
+#define ARG_BLOCK_WIDTH             512
+#define ARG_BLOCK_HEIGHT            512
+#define ARG_SPARSITY                0.8
+#define ARG_FRAME_COLUMNS           8
+#define ARG_COLUMN_READS            2000
+#define OUTPUT_FILE                 "test_layout.bmxt"
+#define ARG_FILE_NROW               150
+#define ARG_FILE_NCOL               101
+#define ARG_FILE_BLOCK_WIDTH        32
+#define ARG_FILE_BLOCK_HEIGHT       24
+
+
+uint64_t get_timestamp() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Column-major block assembled from the transposed view holds cell (i, j) at j*height + i
+void check_transpose(uint32_t width, uint32_t height) {
+    std::vector<float> rows = make_counts<float>(static_cast<size_t>(width) * 3 * height, ARG_SPARSITY);
+    const uint32_t row_size = width * 3;
+    for (uint32_t column_begin : {0u, width, width * 2}) {
+        std::vector<float> block;
+        biomxt::assemble_block_strided(rows.data() + column_begin, 1, row_size, 0, height, width, block);
+        for (uint32_t i = 0; i < height; i++) {
+            for (uint32_t j = 0; j < width; j++) {
+                if (block[static_cast<size_t>(j) * height + i] != rows[static_cast<size_t>(i) * row_size + column_begin + j]) {
+                    std::cerr << "Error: column-major block of " << width << "x" << height << " mismatches at (" << i << ", " << j << ")." << std::endl;
+                    std::exit(1);
+                }
+            }
+        }
+    }
+}
+
+// File of column-major blocks, ragged at both edges, reads every row and column as the dense reference
+void check_file() {
+    std::vector<float> dense = make_counts<float>(static_cast<size_t>(ARG_FILE_NROW) * ARG_FILE_NCOL, ARG_SPARSITY);
+    std::vector<std::string> colnames;
+    for (uint32_t j = 0; j < ARG_FILE_NCOL; j++) colnames.push_back("col_" + std::to_string(j));
+    biomxt::ConvertOptions options;
+    options.block_width = ARG_FILE_BLOCK_WIDTH;
+    options.block_height = ARG_FILE_BLOCK_HEIGHT;
+    options.column_major = true;
+    options.threads = 2;
+    {
+        biomxt::BiomxtWriter<float> writer(OUTPUT_FILE, colnames, options);
+        for (uint32_t i = 0; i < ARG_FILE_NROW; i++) {
+            writer.write_row("row_" + std::to_string(i), std::vector<float>(dense.begin() + static_cast<size_t>(i) * ARG_FILE_NCOL, dense.begin() + static_cast<size_t>(i + 1) * ARG_FILE_NCOL));
+        }
+        writer.finish();
+    }
+
+    biomxt::BiomxtFile file(OUTPUT_FILE);
+    bool ok = (file.get_header().flags & biomxt::FileFlag::COLUMN_MAJOR_BLOCKS) != 0;
+    std::vector<char> buffer;
+    for (uint32_t i = 0; ok && i < ARG_FILE_NROW; i++) {
+        file.read_row_data(i, buffer);
+        ok = std::memcmp(buffer.data(), dense.data() + static_cast<size_t>(i) * ARG_FILE_NCOL, ARG_FILE_NCOL * sizeof(float)) == 0;
+    }
+    for (uint32_t j = 0; ok && j < ARG_FILE_NCOL; j++) {
+        file.read_column_data(j, buffer);
+        const float* values = reinterpret_cast<const float*>(buffer.data());
+        for (uint32_t i = 0; ok && i < ARG_FILE_NROW; i++) ok = values[i] == dense[static_cast<size_t>(i) * ARG_FILE_NCOL + j];
+    }
+    file.close();
+    std::filesystem::remove(OUTPUT_FILE);
+    if (!ok) {
+        std::cerr << "Error: rows or columns of a file of column-major blocks mismatch." << std::endl;
+        std::exit(1);
+    }
+}
+
+int main() {
+    for (uint32_t width : {1u, 7u, 64u, 100u}) {
+        for (uint32_t height : {1u, 5u, 37u, 64u}) check_transpose(width, height);
+    }
+    check_file();
+    std::cout << "Column-major block checks passed" << std::endl;
+
+    const size_t size = static_cast<size_t>(ARG_BLOCK_WIDTH) * ARG_BLOCK_HEIGHT * sizeof(float);
+    const size_t column_size = ARG_BLOCK_HEIGHT * sizeof(float);
+    std::vector<float> rows = make_counts<float>(static_cast<size_t>(ARG_BLOCK_WIDTH) * ARG_BLOCK_HEIGHT, ARG_SPARSITY);
+    std::vector<float> columns;
+    biomxt::assemble_block_strided(rows.data(), 1, ARG_BLOCK_WIDTH, 0, ARG_BLOCK_HEIGHT, ARG_BLOCK_WIDTH, columns);
+
+    std::vector<char> row_major, column_major, framed;
+    size_t row_major_size = biomxt::pack_block(reinterpret_cast<const char*>(rows.data()), size, sizeof(float), biomxt::CompressAlgorithm::ZSTD, biomxt::BlockFilter::SHUFFLE, 0, biomxt::IntegerCodec::NONE, row_major);
+    size_t column_major_size = biomxt::pack_block(reinterpret_cast<const char*>(columns.data()), size, sizeof(float), biomxt::CompressAlgorithm::ZSTD, biomxt::BlockFilter::SHUFFLE, 0, biomxt::IntegerCodec::NONE, column_major);
+    size_t framed_size = biomxt::pack_framed_block(reinterpret_cast<const char*>(columns.data()), size, sizeof(float), column_size, ARG_FRAME_COLUMNS, biomxt::CompressAlgorithm::ZSTD, biomxt::BlockFilter::SHUFFLE, 0, biomxt::IntegerCodec::NONE, framed);
+
+    std::default_random_engine generator;
+    std::uniform_int_distribution<size_t> column_dist(0, ARG_BLOCK_WIDTH - 1);
+    std::vector<size_t> targets(ARG_COLUMN_READS);
+    for (size_t& column : targets) column = column_dist(generator);
+    std::vector<char> buffer(size);
+    std::vector<char> column(column_size);
+    std::vector<char> expected(column_size);
+
+    // Strided gather out of a row-major block
+    uint64_t start_time = get_timestamp();
+    for (size_t j : targets) {
+        biomxt::unpack_block(row_major.data(), row_major_size, sizeof(float), biomxt::CompressAlgorithm::ZSTD, biomxt::BlockFilter::SHUFFLE, 0, buffer.data(), size);
+        for (size_t i = 0; i < ARG_BLOCK_HEIGHT; i++) {
+            std::memcpy(column.data() + i * sizeof(float), buffer.data() + (i * ARG_BLOCK_WIDTH + j) * sizeof(float), sizeof(float));
+        }
+    }
+    double row_major_time = static_cast<double>(get_timestamp() - start_time) / 1e6;
+
+    // Contiguous slice of a column-major block
+    start_time = get_timestamp();
+    for (size_t j : targets) {
+        biomxt::unpack_block(column_major.data(), column_major_size, sizeof(float), biomxt::CompressAlgorithm::ZSTD, biomxt::BlockFilter::SHUFFLE, 0, buffer.data(), size);
+        std::memcpy(column.data(), buffer.data() + j * column_size, column_size);
+    }
+    double column_major_time = static_cast<double>(get_timestamp() - start_time) / 1e6;
+
+    // Slice of the frame holding the column
+    start_time = get_timestamp();
+    for (size_t j : targets) {
+        biomxt::unpack_block_frame(framed.data(), framed_size, sizeof(float), column_size, ARG_FRAME_COLUMNS, size, j / ARG_FRAME_COLUMNS, biomxt::CompressAlgorithm::ZSTD, biomxt::BlockFilter::SHUFFLE, 0, buffer.data());
+        std::memcpy(column.data(), buffer.data() + (j % ARG_FRAME_COLUMNS) * column_size, column_size);
+    }
+    double framed_time = static_cast<double>(get_timestamp() - start_time) / 1e6;
+
+    std::memcpy(expected.data(), columns.data() + targets.back() * ARG_BLOCK_HEIGHT, column_size);
+    if (column != expected) {
+        std::cerr << "Error: column read out of a framed column-major block mismatches." << std::endl;
+        return 1;
+    }
+
+    std::cout << "Single column reads on " << ARG_BLOCK_WIDTH << "x" << ARG_BLOCK_HEIGHT << " blocks of counts, " << ARG_SPARSITY * 100 << "% zeros, zstd+shuffle" << std::endl;
+    std::cout << "\trow-major\tsize: " << row_major_size << "\t" << row_major_time * 1e6 / ARG_COLUMN_READS << " us/column" << std::endl;
+    std::cout << "\tcolumn-major\tsize: " << column_major_size << "\t" << column_major_time * 1e6 / ARG_COLUMN_READS << " us/column" << std::endl;
+    std::cout << "\tframes of " << ARG_FRAME_COLUMNS << "\tsize: " << framed_size << "\t" << framed_time * 1e6 / ARG_COLUMN_READS << " us/column"
+              << "\tspeedup: " << row_major_time / framed_time << "x" << std::endl;
+    return 0;
+}
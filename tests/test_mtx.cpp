@@ -0,0 +1,129 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <filesystem>
+#include "biomxt/biomxt_converter.hpp"
+#include "biomxt/biomxt_file.hpp"
+#include "test_check.hpp"
+#include "test_counts.hpp"
+
+
+#define MATRIX_FILE                 "test_mtx.mtx"
+#define FEATURES_FILE               "test_mtx_features.tsv"
+#define BARCODES_FILE               "test_mtx_barcodes.tsv"
+#define OUTPUT_FILE                 "test_mtx.bmxt"
+#define ARG_NROW                    75
+#define ARG_NCOL                    101
+#define ARG_BLOCK_WIDTH             16
+#define ARG_BLOCK_HEIGHT            8
+#define ARG_SPARSITY                0.9
+#define ARG_DUPLICATES              200
+
+
+uint64_t get_timestamp() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Dense reference of features by barcodes, and its entries in shuffled order with overwritten duplicates ahead of the last one
+std::vector<int32_t> write_matrix() {
+    std::vector<int32_t> dense = make_counts<int32_t>(static_cast<size_t>(ARG_NROW) * ARG_NCOL, ARG_SPARSITY);
+    std::vector<std::pair<uint32_t, uint32_t>> cells;
+    for (uint32_t i = 0; i < ARG_NROW; i++) {
+        for (uint32_t j = 0; j < ARG_NCOL; j++) {
+            if (dense[static_cast<size_t>(i) * ARG_NCOL + j] != 0) cells.push_back({i, j});
+        }
+    }
+    std::default_random_engine generator;
+    std::shuffle(cells.begin(), cells.end(), generator);
+
+    // Each duplicated cell is written first with a stale value, the right value comes later
+    std::vector<std::pair<uint32_t, uint32_t>> stale(cells.begin(), cells.begin() + std::min<size_t>(ARG_DUPLICATES, cells.size()));
+    std::ofstream matrix(MATRIX_FILE);
+    matrix << "%%MatrixMarket matrix coordinate integer general\n% generated by test_mtx\n";
+    matrix << ARG_NROW << " " << ARG_NCOL << " " << stale.size() + cells.size() << "\n";
+    for (const auto& [i, j] : stale) matrix << i + 1 << " " << j + 1 << " " << 1000 + i << "\n";
+    for (const auto& [i, j] : cells) matrix << i + 1 << " " << j + 1 << " " << dense[static_cast<size_t>(i) * ARG_NCOL + j] << "\n";
+
+    std::ofstream features(FEATURES_FILE);
+    for (uint32_t i = 0; i < ARG_NROW; i++) features << "gene_" << i << "\tGene" << i << "\tGene Expression\n";
+    std::ofstream barcodes(BARCODES_FILE);
+    for (uint32_t j = 0; j < ARG_NCOL; j++) barcodes << "cell_" << j << "\n";
+    return dense;
+}
+
+// Every row and column read through the file matches the dense reference
+void check_file(const std::vector<int32_t>& dense, bool transpose, const std::string& name) {
+    const uint32_t nrow = transpose ? ARG_NCOL : ARG_NROW;
+    const uint32_t ncol = transpose ? ARG_NROW : ARG_NCOL;
+    auto cell = [&](uint32_t i, uint32_t j) { return transpose ? dense[static_cast<size_t>(j) * ARG_NCOL + i] : dense[static_cast<size_t>(i) * ARG_NCOL + j]; };
+
+    biomxt::BiomxtFile file(OUTPUT_FILE);
+    check(file.get_header().nrow == nrow && file.get_header().ncol == ncol, name + ": shape mismatches.");
+    check(file.get_row_names()[1] == (transpose ? "cell_1" : "gene_1") && file.get_column_names()[2] == (transpose ? "gene_2" : "cell_2"), name + ": names mismatch.");
+    std::vector<char> buffer;
+    for (uint32_t i = 0; i < nrow; i++) {
+        file.read_row_data(i, buffer);
+        const int32_t* values = reinterpret_cast<const int32_t*>(buffer.data());
+        for (uint32_t j = 0; j < ncol; j++) {
+            check(values[j] == cell(i, j), name + ": row " + std::to_string(i) + " mismatches at column " + std::to_string(j) + ".");
+        }
+    }
+    for (uint32_t j = 0; j < ncol; j++) {
+        file.read_column_data(j, buffer);
+        const int32_t* values = reinterpret_cast<const int32_t*>(buffer.data());
+        for (uint32_t i = 0; i < nrow; i++) {
+            check(values[i] == cell(i, j), name + ": column " + std::to_string(j) + " mismatches at row " + std::to_string(i) + ".");
+        }
+    }
+}
+
+void check_convert(const std::vector<int32_t>& dense, biomxt::ConvertOptions options, const std::string& name) {
+    options.block_width = ARG_BLOCK_WIDTH;
+    options.block_height = ARG_BLOCK_HEIGHT;
+    options.threads = 3;
+    options.max_inflight_block_rows = 2;
+    std::vector<std::string> warnings;
+    uint64_t start_time = get_timestamp();
+    biomxt::mtx_to_bmxt<int32_t>(MATRIX_FILE, FEATURES_FILE, BARCODES_FILE, OUTPUT_FILE, options, warnings);
+    double cost_time = static_cast<double>(get_timestamp() - start_time) / 1e6;
+    check(warnings.empty(), name + ": unexpected warning: " + (warnings.empty() ? "" : warnings[0]));
+    for (const auto& entry : std::filesystem::directory_iterator(".")) {
+        check(entry.path().filename().string().rfind(std::string(OUTPUT_FILE) + ".spill.", 0) != 0, name + ": spill directory left behind.");
+    }
+    check_file(dense, options.transpose, name);
+    std::cout << "\t" << name << "\t" << cost_time * 1e3 << " ms" << std::endl;
+}
+
+int main() {
+    std::vector<int32_t> dense = write_matrix();
+    std::cout << "Conversions of a " << ARG_NROW << "x" << ARG_NCOL << " mtx with " << ARG_DUPLICATES << " duplicates" << std::endl;
+
+    biomxt::ConvertOptions options;
+    check_convert(dense, options, "in memory");
+
+    // Every entry is spilled to disk as soon as it is read
+    options.memory_budget = 0;
+    check_convert(dense, options, "spilled");
+
+    options.transpose = true;
+    check_convert(dense, options, "transposed");
+
+    options.transpose = false;
+    options.column_major = true;
+    options.frame_height = 4;
+    options.sparse_threshold = 0.5f;
+    options.integer_codec = biomxt::IntegerCodec::AUTO;
+    check_convert(dense, options, "column-major frames");
+
+    std::filesystem::remove(MATRIX_FILE);
+    std::filesystem::remove(FEATURES_FILE);
+    std::filesystem::remove(BARCODES_FILE);
+    std::filesystem::remove(OUTPUT_FILE);
+    std::cout << "Mtx conversion checks passed" << std::endl;
+    return 0;
+}
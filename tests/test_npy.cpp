@@ -0,0 +1,151 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include "biomxt/biomxt_converter.hpp"
+#include "biomxt/biomxt_file.hpp"
+#include "biomxt/struct/reduced_float.hpp"
+#include "test_check.hpp"
+
+
+#define INPUT_FILE                  "test_npy.npy"
+#define OUTPUT_FILE                 "test_npy.bmxt"
+#define ARG_NROW                    45
+#define ARG_NCOL                    70
+#define ARG_BLOCK_WIDTH             16
+#define ARG_BLOCK_HEIGHT            16
+
+
+uint64_t get_timestamp() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Cell (i, j) of the reference array, distinct enough to catch swapped rows or columns
+template <typename T> T make_value(uint32_t i, uint32_t j) {
+    return T(static_cast<float>((i * 7 + j * 3) % 251));
+}
+
+// Array data in C or Fortran order
+template <typename T> std::vector<T> make_array(bool fortran_order) {
+    std::vector<T> values(static_cast<size_t>(ARG_NROW) * ARG_NCOL);
+    for (uint32_t i = 0; i < ARG_NROW; i++) {
+        for (uint32_t j = 0; j < ARG_NCOL; j++) {
+            values[fortran_order ? static_cast<size_t>(j) * ARG_NROW + i : static_cast<size_t>(i) * ARG_NCOL + j] = make_value<T>(i, j);
+        }
+    }
+    return values;
+}
+
+// Version 1.0 npy file, header padded with spaces so that data starts at a multiple of 64
+template <typename T> void write_npy(const std::string& descr, bool fortran_order) {
+    std::string dict = "{'descr': '" + descr + "', 'fortran_order': " + (fortran_order ? "True" : "False") + ", 'shape': (" + std::to_string(ARG_NROW) + ", " + std::to_string(ARG_NCOL) + "), }";
+    dict.append(64 - (10 + dict.size() + 1) % 64, ' ');
+    dict.push_back('\n');
+    const uint16_t header_len = dict.size();
+    std::vector<T> values = make_array<T>(fortran_order);
+    std::ofstream file(INPUT_FILE, std::ios::binary);
+    file.write("\x93NUMPY\x01\x00", 8);
+    file.write(reinterpret_cast<const char*>(&header_len), sizeof(header_len));
+    file.write(dict.data(), dict.size());
+    file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+}
+
+void write_raw(const std::vector<float>& values) {
+    std::ofstream file(INPUT_FILE, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(float));
+}
+
+// Every row and column of the converted file matches the reference, byte for byte
+template <typename T> void check_file(const std::string& name) {
+    biomxt::BiomxtFile file(OUTPUT_FILE);
+    check(file.get_header().nrow == ARG_NROW && file.get_header().ncol == ARG_NCOL, name + ": shape mismatches.");
+    check(file.get_header().dtype == biomxt::dtype_from_type<T>::value, name + ": data type mismatches.");
+    std::vector<char> buffer;
+    for (uint32_t i = 0; i < ARG_NROW; i++) {
+        file.read_row_data(i, buffer);
+        for (uint32_t j = 0; j < ARG_NCOL; j++) {
+            T expected = make_value<T>(i, j);
+            check(std::memcmp(buffer.data() + static_cast<size_t>(j) * sizeof(T), &expected, sizeof(T)) == 0, name + ": row " + std::to_string(i) + " mismatches at column " + std::to_string(j) + ".");
+        }
+    }
+    for (uint32_t j = 0; j < ARG_NCOL; j++) {
+        file.read_column_data(j, buffer);
+        for (uint32_t i = 0; i < ARG_NROW; i++) {
+            T expected = make_value<T>(i, j);
+            check(std::memcmp(buffer.data() + static_cast<size_t>(i) * sizeof(T), &expected, sizeof(T)) == 0, name + ": column " + std::to_string(j) + " mismatches at row " + std::to_string(i) + ".");
+        }
+    }
+}
+
+biomxt::ConvertOptions make_options() {
+    biomxt::ConvertOptions options;
+    options.block_width = ARG_BLOCK_WIDTH;
+    options.block_height = ARG_BLOCK_HEIGHT;
+    options.threads = 3;
+    return options;
+}
+
+template <typename T> void check_npy(const std::string& descr, bool fortran_order) {
+    const std::string name = descr + (fortran_order ? " Fortran order" : " C order");
+    write_npy<T>(descr, fortran_order);
+    std::vector<std::string> warnings;
+    uint64_t start_time = get_timestamp();
+    biomxt::npy_to_bmxt<T>(INPUT_FILE, "", "", OUTPUT_FILE, make_options(), warnings);
+    double cost_time = static_cast<double>(get_timestamp() - start_time) / 1e6;
+    check_file<T>("npy " + name);
+    std::cout << "\tnpy " << name << "\t" << cost_time * 1e3 << " ms" << std::endl;
+}
+
+void check_raw(bool fortran_order) {
+    const std::string name = fortran_order ? "Fortran order" : "C order";
+    write_raw(make_array<float>(fortran_order));
+    std::vector<std::string> warnings;
+    uint64_t start_time = get_timestamp();
+    biomxt::raw_to_bmxt<float>(INPUT_FILE, ARG_NROW, ARG_NCOL, fortran_order, "", "", OUTPUT_FILE, make_options(), warnings);
+    double cost_time = static_cast<double>(get_timestamp() - start_time) / 1e6;
+    check_file<float>("raw " + name);
+    std::cout << "\traw " << name << "\t" << cost_time * 1e3 << " ms" << std::endl;
+}
+
+// Big-endian arrays and a type mismatch are rejected
+void check_rejected() {
+    std::vector<std::string> warnings;
+    bool thrown = false;
+    write_npy<float>(">f4", false);
+    try {
+        biomxt::npy_to_bmxt<float>(INPUT_FILE, "", "", OUTPUT_FILE, make_options(), warnings);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    check(thrown, "big-endian array not rejected.");
+
+    thrown = false;
+    write_npy<uint8_t>("|u1", false);
+    try {
+        biomxt::npy_to_bmxt<int16_t>(INPUT_FILE, "", "", OUTPUT_FILE, make_options(), warnings);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    check(thrown, "array type mismatch not rejected.");
+}
+
+int main() {
+    std::cout << "Conversions of " << ARG_NROW << "x" << ARG_NCOL << " arrays" << std::endl;
+    for (bool fortran_order : {false, true}) {
+        check_npy<float>("<f4", fortran_order);
+        check_npy<int32_t>("<i4", fortran_order);
+        check_npy<uint8_t>("|u1", fortran_order);
+        check_npy<biomxt::float16>("<f2", fortran_order);
+        check_raw(fortran_order);
+    }
+    check_rejected();
+
+    std::filesystem::remove(INPUT_FILE);
+    std::filesystem::remove(OUTPUT_FILE);
+    std::cout << "Npy and raw conversion checks passed" << std::endl;
+    return 0;
+}
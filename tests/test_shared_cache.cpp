@@ -0,0 +1,146 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+#if defined(__linux__)
+#include <sys/wait.h>
+#include <unistd.h>
+#include "biomxt/cache/shared_block_cache.hpp"
+#endif
+#include "test_check.hpp"
+
+
+#define SEGMENT_NAME                "/biomxt_test_shared_cache"
+#define ARG_SLOT_SIZE               (64 * 1024)
+#define ARG_CACHE_SLOTS             32
+#define ARG_PROCESSES               4
+#define ARG_BLOCKS_PER_PROCESS      64
+#define ARG_READS_PER_PROCESS       200000
+
+
+uint64_t get_timestamp() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#if defined(__linux__)
+// Block size derived from its index, edge-like blocks are a fraction of the slot
+size_t block_size(uint64_t block_index) {
+    return block_index % 4 == 0 ? ARG_SLOT_SIZE : ARG_SLOT_SIZE / (block_index % 4 + 2);
+}
+
+// Exposes the segment lock, to die while holding it
+class DyingCache : public biomxt::SharedBlockCache {
+    public:
+        using biomxt::SharedBlockCache::SharedBlockCache;
+        void die_locked() {
+            _SegmentLock lock(this);
+            _exit(0);
+        }
+};
+
+// Small blocks only take the pages they need
+void check_pages(const biomxt::UUID& uuid) {
+    biomxt::SharedBlockCache cache(SEGMENT_NAME, ARG_SLOT_SIZE * ARG_CACHE_SLOTS, ARG_SLOT_SIZE);
+    uint64_t inserted = 0;
+    for (uint64_t i = 1; i < ARG_CACHE_SLOTS * 4; i += 4) inserted += cache.insert({i, uuid}, make_block(i, block_size(i)));
+    check(inserted == ARG_CACHE_SLOTS, "small blocks not inserted.");
+    check(cache.get_memory_used() <= ARG_SLOT_SIZE * ARG_CACHE_SLOTS / 2, "small blocks take whole slots.");
+    std::vector<char> buffer;
+    for (uint64_t i = 1; i < ARG_CACHE_SLOTS * 4; i += 4) {
+        check(cache.get_block_data({i, uuid}, buffer, 0, block_size(i)) && buffer == make_block(i, block_size(i)), "small block " + std::to_string(i) + " mismatches.");
+    }
+    biomxt::SharedBlockCache::remove(SEGMENT_NAME);
+}
+
+// A rejected insert of a resident key keeps the old copy
+void check_replace(const biomxt::UUID& uuid) {
+    biomxt::SharedBlockCache cache(SEGMENT_NAME, ARG_SLOT_SIZE * ARG_CACHE_SLOTS, ARG_SLOT_SIZE);
+    check(cache.insert({1, uuid}, make_block(1, block_size(1)), true), "small block not pinned.");
+    // Fill pinned pages with whole slots, then the smallest blocks
+    for (uint64_t i = 0; cache.insert({i, uuid}, make_block(i, block_size(i)), true); i += 4) {}
+    for (uint64_t i = 3; cache.insert({i, uuid}, make_block(i, block_size(i)), true); i += 4) {}
+    check(!cache.insert({1, uuid}, std::vector<char>(ARG_SLOT_SIZE), true), "larger pinned block exceeds the pinned pages.");
+    std::vector<char> buffer;
+    check(cache.get_block_data({1, uuid}, buffer, 0, block_size(1)) && buffer == make_block(1, block_size(1)), "rejected insert dropped the pinned block.");
+    biomxt::SharedBlockCache::remove(SEGMENT_NAME);
+}
+
+// Every process inserts its own blocks, and reads blocks of all processes while others evict them
+void run_process(uint32_t process, const biomxt::UUID& uuid) {
+    biomxt::SharedBlockCache cache(SEGMENT_NAME, ARG_SLOT_SIZE * ARG_CACHE_SLOTS, ARG_SLOT_SIZE);
+    std::vector<std::vector<char>> blocks;
+    for (uint64_t block_index = 0; block_index < ARG_PROCESSES * ARG_BLOCKS_PER_PROCESS; block_index++) blocks.push_back(make_block(block_index, block_size(block_index)));
+    for (uint64_t i = 0; i < ARG_BLOCKS_PER_PROCESS; i++) {
+        uint64_t block_index = process * ARG_BLOCKS_PER_PROCESS + i;
+        cache.insert({block_index, uuid}, std::vector<char>(blocks[block_index]));
+    }
+
+    uint64_t hits = 0;
+    uint64_t seed = process + 1;
+    std::vector<char> buffer;
+    uint64_t start_time = get_timestamp();
+    for (uint64_t i = 0; i < ARG_READS_PER_PROCESS; i++) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        uint64_t block_index = (seed >> 33) % (ARG_PROCESSES * ARG_BLOCKS_PER_PROCESS);
+        size_t offset = (seed >> 20) % 1024;
+        size_t size = 4096;
+        if (cache.get_block_data({block_index, uuid}, buffer, offset, size)) {
+            const std::vector<char>& expected = blocks[block_index];
+            check(std::equal(expected.begin() + offset, expected.begin() + offset + size, buffer.begin()), "process " + std::to_string(process) + " read a torn block " + std::to_string(block_index) + ".");
+            hits++;
+        } else if (i % 16 == 0) {
+            cache.insert({block_index, uuid}, std::vector<char>(blocks[block_index]));
+        }
+    }
+    double cost_time = static_cast<double>(get_timestamp() - start_time) / 1e6;
+    std::cout << "\tprocess " << process << "\thits: " << hits << "\t" << cost_time * 1e9 / ARG_READS_PER_PROCESS << " ns/read" << std::endl;
+}
+
+int main() {
+    biomxt::UUID uuid = biomxt::UUID::generate();
+    biomxt::SharedBlockCache::remove(SEGMENT_NAME);
+    check_pages(uuid);
+    check_replace(uuid);
+    std::cout << "Shared cache page checks passed" << std::endl;
+
+    biomxt::SharedBlockCache cache(SEGMENT_NAME, ARG_SLOT_SIZE * ARG_CACHE_SLOTS, ARG_SLOT_SIZE);
+    std::cout << "Concurrent reads of " << ARG_PROCESSES << " processes, " << ARG_PROCESSES * ARG_BLOCKS_PER_PROCESS << " blocks over " << ARG_CACHE_SLOTS << " slots" << std::endl;
+    std::vector<pid_t> children;
+    for (uint32_t process = 0; process < ARG_PROCESSES; process++) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            run_process(process, uuid);
+            _exit(0);
+        }
+        children.push_back(pid);
+    }
+    for (pid_t pid : children) {
+        int status = 0;
+        waitpid(pid, &status, 0);
+        check(WIFEXITED(status) && WEXITSTATUS(status) == 0, "reader process failed.");
+    }
+    check(cache.get_memory_used() <= cache.get_memory_limit(), "memory used exceeds the limit.");
+
+    // A process dying with the lock held leaves the cache to be reset by the next locker
+    check(cache.insert({0, uuid}, make_block(0, block_size(0))), "block 0 not inserted.");
+    pid_t pid = fork();
+    if (pid == 0) {
+        DyingCache dying(SEGMENT_NAME, ARG_SLOT_SIZE * ARG_CACHE_SLOTS, ARG_SLOT_SIZE);
+        dying.die_locked();
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    check(!cache.contains({0, uuid}) && cache.get_memory_used() == 0, "cache not reset after lock owner died.");
+    check(cache.insert({0, uuid}, make_block(0, block_size(0))) && cache.contains({0, uuid}), "cache not usable after lock owner died.");
+
+    biomxt::SharedBlockCache::remove(SEGMENT_NAME);
+    std::cout << "Shared cache process checks passed" << std::endl;
+    return 0;
+}
+#else
+int main() {
+    std::cout << "Shared cache is only supported on Linux, checks skipped" << std::endl;
+    return 0;
+}
+#endif
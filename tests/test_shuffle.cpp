@@ -0,0 +1,88 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <string>
+#include <cstring>
+#include "biomxt/utils/block_codec.hpp"
+#include "biomxt/utils/shuffle.hpp"
+
+
+#define ARG_BLOCK_WIDTH             512
+#define ARG_BLOCK_HEIGHT            512
+#define ARG_SPARSITY                0.8
+#define TEST_EPOCHES                20
+
+
+uint64_t get_timestamp() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Reference byte shuffle: byte b of element i goes to b*count + i
+void byte_shuffle_scalar(const char* src, char* dst, size_t size, size_t element_size) {
+    size_t count = size / element_size;
+    for (size_t i = 0; i < count; i++) {
+        for (size_t b = 0; b < element_size; b++) {
+            dst[b * count + i] = src[i * element_size + b];
+        }
+    }
+    std::memcpy(dst + count * element_size, src + count * element_size, size - count * element_size);
+}
+
+template <typename T> void run_test(const std::string& dtype) {
+    // Sparse block with small values, as most expression matrices
+    std::vector<T> block(static_cast<size_t>(ARG_BLOCK_WIDTH) * ARG_BLOCK_HEIGHT);
+    std::default_random_engine generator;
+    std::uniform_real_distribution<double> sparsity_dist(0.0, 1.0);
+    std::uniform_int_distribution<int> value_dist(1, 200);
+    for (size_t i = 0; i < block.size(); i++) {
+        block[i] = sparsity_dist(generator) < ARG_SPARSITY ? T(0) : static_cast<T>(value_dist(generator));
+    }
+    const char* raw = reinterpret_cast<const char*>(block.data());
+    size_t size = block.size() * sizeof(T);
+    std::vector<char> filtered(size);
+    std::vector<char> restored(size);
+    std::vector<char> expected(size);
+    std::vector<char> compressed;
+
+    // Check shuffle against the reference, including a ragged tail
+    for (size_t tail : {size, size - sizeof(T) * 5 - 1}) {
+        biomxt::byte_shuffle(raw, filtered.data(), tail, sizeof(T));
+        byte_shuffle_scalar(raw, expected.data(), tail, sizeof(T));
+        if (std::memcmp(filtered.data(), expected.data(), tail) != 0) {
+            std::cerr << "Error: " << dtype << " byte shuffle mismatch with reference." << std::endl;
+            std::exit(1);
+        }
+    }
+
+    std::cout << dtype;
+    for (biomxt::BlockFilter filter : {biomxt::BlockFilter::NONE, biomxt::BlockFilter::SHUFFLE, biomxt::BlockFilter::BITSHUFFLE}) {
+        biomxt::filter_block(raw, size, filter, sizeof(T), filtered.data());
+        size_t compressed_size = biomxt::compress_block(filtered.data(), size, biomxt::CompressAlgorithm::ZSTD, compressed);
+        biomxt::unfilter_block(filtered.data(), size, filter, sizeof(T), restored.data());
+        if (std::memcmp(raw, restored.data(), size) != 0) {
+            std::cerr << "Error: " << dtype << " " << biomxt::filter_to_string(filter) << " round trip mismatch." << std::endl;
+            std::exit(1);
+        }
+
+        uint64_t start_time = get_timestamp();
+        for (size_t epoch = 0; epoch < TEST_EPOCHES; epoch++) {
+            biomxt::unfilter_block(filtered.data(), size, filter, sizeof(T), restored.data());
+        }
+        double unfilter_time = static_cast<double>(get_timestamp() - start_time) / 1e6;
+
+        std::cout << "\t" << biomxt::filter_to_string(filter) << ": ratio " << static_cast<double>(size) / compressed_size
+                  << "x, unfilter " << static_cast<double>(size) * TEST_EPOCHES / unfilter_time / 1e9 << " GB/s";
+    }
+    std::cout << std::endl;
+}
+
+int main() {
+    std::cout << "Block filters on " << ARG_BLOCK_WIDTH << "x" << ARG_BLOCK_HEIGHT << " blocks, " << ARG_SPARSITY * 100 << "% zeros, zstd level 3" << std::endl;
+    run_test<int16_t>("int16");
+    run_test<int32_t>("int32");
+    run_test<int64_t>("int64");
+    run_test<float>("float32");
+    run_test<double>("float64");
+    return 0;
+}
@@ -0,0 +1,118 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include "biomxt/biomxt_writer.hpp"
+#include "biomxt/biomxt_file.hpp"
+#include "biomxt/cache/block_cache.hpp"
+#include "test_check.hpp"
+#include "test_counts.hpp"
+
+
+#define OUTPUT_FILE                 "test_sparse_read.bmxt"
+#define ARG_NROW                    530
+#define ARG_NCOL                    301
+#define ARG_BLOCK_WIDTH             64
+#define ARG_BLOCK_HEIGHT            128
+#define ARG_FRAME_HEIGHT            16
+#define ARG_SPARSITY                0.9
+#define ARG_DENSE_ROWS              128
+
+
+uint64_t get_timestamp() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Sparse counts, with a first block row of nonzeros so that its blocks stay dense
+std::vector<float> make_dense() {
+    std::vector<float> dense = make_counts<float>(static_cast<size_t>(ARG_NROW) * ARG_NCOL, ARG_SPARSITY);
+    for (size_t k = 0; k < static_cast<size_t>(ARG_DENSE_ROWS) * ARG_NCOL; k++) dense[k] = static_cast<float>(k % 13 + 1);
+    return dense;
+}
+
+void write_file(const std::vector<float>& dense, bool column_major, uint32_t frame_height) {
+    std::vector<std::string> colnames;
+    for (uint32_t j = 0; j < ARG_NCOL; j++) colnames.push_back("col_" + std::to_string(j));
+    biomxt::ConvertOptions options;
+    options.block_width = ARG_BLOCK_WIDTH;
+    options.block_height = ARG_BLOCK_HEIGHT;
+    options.frame_height = frame_height;
+    options.column_major = column_major;
+    options.sparse_threshold = 0.5f;
+    options.filter = biomxt::BlockFilter::SHUFFLE;
+    options.threads = 2;
+    biomxt::BiomxtWriter<float> writer(OUTPUT_FILE, colnames, options);
+    for (uint32_t i = 0; i < ARG_NROW; i++) {
+        writer.write_row("row_" + std::to_string(i), std::vector<float>(dense.begin() + static_cast<size_t>(i) * ARG_NCOL, dense.begin() + static_cast<size_t>(i + 1) * ARG_NCOL));
+    }
+    writer.finish();
+}
+
+// Nonzeros of a dense line, as the sparse reads should hand them out
+void sparsify_line(const std::vector<float>& dense, size_t begin, size_t count, size_t stride, std::vector<uint32_t>& indices, std::vector<float>& values) {
+    indices.clear();
+    values.clear();
+    for (size_t k = 0; k < count; k++) {
+        float value = dense[begin + k * stride];
+        if (value == 0) continue;
+        indices.push_back(static_cast<uint32_t>(k));
+        values.push_back(value);
+    }
+}
+
+// Every sparse row and column matches the dense reference, returns seconds spent
+double check_reads(biomxt::BiomxtFile& file, const std::vector<float>& dense, const std::string& name) {
+    std::vector<uint32_t> indices, expected_indices;
+    std::vector<char> values;
+    std::vector<float> expected_values;
+    uint64_t start_time = get_timestamp();
+    for (uint32_t i = 0; i < ARG_NROW; i++) {
+        file.read_row_sparse(i, indices, values);
+        sparsify_line(dense, static_cast<size_t>(i) * ARG_NCOL, ARG_NCOL, 1, expected_indices, expected_values);
+        check(indices == expected_indices && values.size() == expected_values.size() * sizeof(float) && std::equal(expected_values.begin(), expected_values.end(), reinterpret_cast<const float*>(values.data())), name + ": row " + std::to_string(i) + " mismatches.");
+    }
+    for (uint32_t j = 0; j < ARG_NCOL; j++) {
+        file.read_column_sparse(j, indices, values);
+        sparsify_line(dense, j, ARG_NROW, ARG_NCOL, expected_indices, expected_values);
+        check(indices == expected_indices && values.size() == expected_values.size() * sizeof(float) && std::equal(expected_values.begin(), expected_values.end(), reinterpret_cast<const float*>(values.data())), name + ": column " + std::to_string(j) + " mismatches.");
+    }
+    return static_cast<double>(get_timestamp() - start_time) / 1e6;
+}
+
+void check_layout(const std::vector<float>& dense, bool column_major, uint32_t frame_height) {
+    const std::string name = std::string(column_major ? "column-major" : "row-major") + (frame_height > 0 ? " frames of " + std::to_string(frame_height) : "");
+    write_file(dense, column_major, frame_height);
+    biomxt::BlockCache block_cache;
+    biomxt::BiomxtFile file(OUTPUT_FILE, &block_cache);
+
+    // Sparse blocks are read from their bitmap and left out of the block cache, dense ones are cached unless framed
+    file.set_access_hint(biomxt::AccessHint::NOCACHE);
+    double bitmap_time = check_reads(file, dense, name + " nocache");
+    check(block_cache.get_memory_used() == 0, name + ": nocache reads entered the block cache.");
+    file.set_access_hint(biomxt::AccessHint::NORMAL);
+    check_reads(file, dense, name);
+    check((block_cache.get_memory_used() > 0) == (frame_height == 0), name + ": dense blocks not cached as by read_block.");
+
+    // Blocks resident in the block cache are sparsified from their dense data
+    for (uint64_t index = 0; index < file.get_header().block_count; index++) {
+        std::vector<char> buffer;
+        file.read_block(index, buffer);
+    }
+    double cached_time = check_reads(file, dense, name + " cached");
+    file.close();
+    std::cout << "\t" << name << "\tfrom file: " << bitmap_time * 1e3 << " ms\tfrom cache: " << cached_time * 1e3 << " ms" << std::endl;
+}
+
+int main() {
+    std::vector<float> dense = make_dense();
+    std::cout << "Sparse rows and columns of a " << ARG_NROW << "x" << ARG_NCOL << " file, " << ARG_SPARSITY * 100 << "% zeros past the first block row" << std::endl;
+    for (bool column_major : {false, true}) {
+        check_layout(dense, column_major, 0);
+        check_layout(dense, column_major, ARG_FRAME_HEIGHT);
+    }
+    std::filesystem::remove(OUTPUT_FILE);
+    std::cout << "Sparse read checks passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,73 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <string>
+#include "biomxt/biomxt_writer.hpp"
+#include "biomxt/biomxt_file.hpp"
+
+
+#define ARG_OUTPUT_FILE             "test_data/writer_test.bmxt"
+#define ARG_NROW                    10000
+#define ARG_NCOL                    3000
+#define ARG_BATCH_SIZE              700
+#define ARG_BLOCK_WIDTH             512
+#define ARG_BLOCK_HEIGHT            512
+
+
+uint64_t get_timestamp() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int main() {
+    std::vector<std::string> colnames;
+    for (uint32_t j = 0; j < ARG_NCOL; j++) colnames.push_back("col_" + std::to_string(j));
+
+    biomxt::ConvertOptions options;
+    options.block_width = ARG_BLOCK_WIDTH;
+    options.block_height = ARG_BLOCK_HEIGHT;
+
+    // Write single rows and batches not aligned to block height
+    uint64_t start_time = get_timestamp();
+    biomxt::BiomxtWriter<int32_t> writer(ARG_OUTPUT_FILE, colnames, options);
+    std::vector<int32_t> batch;
+    std::vector<std::string> rownames;
+    uint32_t row = 0;
+    while (row < ARG_NROW) {
+        uint32_t count = row % 3 == 0 ? 1 : std::min<uint32_t>(ARG_BATCH_SIZE, ARG_NROW - row);
+        batch.resize(static_cast<size_t>(count) * ARG_NCOL);
+        rownames.clear();
+        for (uint32_t i = 0; i < count; i++) {
+            rownames.push_back("row_" + std::to_string(row + i));
+            for (uint32_t j = 0; j < ARG_NCOL; j++) batch[static_cast<size_t>(i) * ARG_NCOL + j] = (row + i) * 7 + j;
+        }
+        if (count == 1) {
+            writer.write_row(rownames[0], batch.data());
+        } else {
+            writer.write_rows(rownames, batch.data());
+        }
+        row += count;
+    }
+    biomxt::FileHeader header = writer.finish();
+    std::cout << "Write cost time: " << static_cast<double>(get_timestamp() - start_time) / 1000.0 << " s" << std::endl;
+    print_bmxt_header(header);
+
+    // Read back and compare
+    biomxt::BlockCache cache;
+    biomxt::BiomxtFile file(ARG_OUTPUT_FILE, &cache);
+    size_t mismatch = 0;
+    for (uint32_t i = 0; i < ARG_NROW; i += 97) {
+        if (file.get_row_names()[i] != "row_" + std::to_string(i)) mismatch++;
+        file.read_row(i, [&](auto cells) {
+            for (uint32_t j = 0; j < ARG_NCOL; j++) {
+                if (cells[j] != static_cast<int32_t>(i * 7 + j)) mismatch++;
+            }
+            return 0;
+        });
+    }
+    if (mismatch > 0) {
+        std::cerr << "Mismatched values: " << mismatch << std::endl;
+        return 1;
+    }
+    std::cout << "Read back matches." << std::endl;
+    return 0;
+}